@@ -33,13 +33,29 @@ SOURCES += \
         shared/CppUtils-Network/NetAddress.cpp \
         shared/CppUtils-Network/Socket.cpp \
         shared/CppUtils-Network/SystemErrorInfo.cpp \
+        src/AudioSpectrum.cpp \
+        src/Calibration.cpp \
         src/Client.cpp \
         src/Color.cpp \
+        src/ColorOps.cpp \
+        src/DeviceId.cpp \
+        src/DeviceIdentity.cpp \
         src/DeviceInfo.cpp \
+        src/DeviceListCache.cpp \
+        src/DeviceListDiff.cpp \
+        src/DeviceSnapshot.cpp \
+        src/DeviceView.cpp \
+        src/EffectEngine.cpp \
         src/Exceptions.cpp \
+        src/FrameSampler.cpp \
+        src/LayoutMap.cpp \
         src/MiscUtils.cpp \
+        src/Palette.cpp \
         src/ProtocolCommon.cpp \
         src/ProtocolMessages.cpp \
+        src/RenderExecutor.cpp \
+        src/StringTable.cpp \
+        src/StringView.cpp \
         src/test/main.cpp
 
 HEADERS += \
@@ -62,9 +78,26 @@ HEADERS += \
         shared/CppUtils-Network/NetAddress.hpp \
         shared/CppUtils-Network/Socket.hpp \
         shared/CppUtils-Network/SystemErrorInfo.hpp \
+        include/OpenRGB/AudioSpectrum.hpp \
+        include/OpenRGB/Calibration.hpp \
         include/OpenRGB/Client.hpp \
         include/OpenRGB/Color.hpp \
+        include/OpenRGB/ColorOps.hpp \
+        include/OpenRGB/DeviceId.hpp \
         include/OpenRGB/DeviceInfo.hpp \
+        include/OpenRGB/DeviceListCache.hpp \
+        include/OpenRGB/DeviceListDiff.hpp \
+        include/OpenRGB/DeviceSnapshot.hpp \
+        include/OpenRGB/DeviceView.hpp \
+        include/OpenRGB/EffectEngine.hpp \
+        include/OpenRGB/FrameSampler.hpp \
+        include/OpenRGB/LayoutMap.hpp \
+        include/OpenRGB/Palette.hpp \
+        include/OpenRGB/RenderExecutor.hpp \
+        include/OpenRGB/SmallVector.hpp \
+        include/OpenRGB/StringTable.hpp \
+        include/OpenRGB/StringView.hpp \
+        src/DeviceIdentity.hpp \
         src/MiscUtils.hpp \
         src/ProtocolCommon.hpp \
         src/ProtocolMessages.hpp
@@ -81,6 +114,7 @@ win32 {
 }
 
 unix {
+    LIBS += -pthread
     target.path = /usr/lib
     INSTALLS += target
 }
@@ -0,0 +1,157 @@
+//======================================================================================================================
+//  shows the spectrum of an audio stream on all devices until the stream ends or an INTERRUPT signal
+//    - the audio is read as raw PCM or a WAV file from a file, a named pipe or the standard input, for example:
+//        parec --format=s16le --rate=44100 --channels=2 | AudioSpectrum -
+//        ffmpeg -i song.mp3 -f s16le -ar 44100 -ac 2 - | AudioSpectrum -
+//        AudioSpectrum recording.wav
+//    - every 5 seconds prints how long it took from an audio block being read to its colors being sent
+//======================================================================================================================
+
+/// \file
+
+#include <cstdio>    // printf
+#include <csignal>   // signal
+#include <string>
+#include <memory>
+#include <thread>    // sleep
+#include <chrono>
+using namespace std::chrono;
+
+#include "OpenRGB/Client.hpp"
+#include "OpenRGB/AudioSpectrum.hpp"
+using orgb::DeviceList;
+using orgb::Device;
+using orgb::RequestStatus;
+using orgb::AudioStatus;
+using orgb::PcmReader;
+using orgb::SpectrumAnalyzer;
+using orgb::SpectrumLayer;
+using orgb::EffectEngine;
+using orgb::Palette;
+using orgb::AudioLatency;
+using orgb::LatencyReport;
+
+#include "OpenRGB/Exceptions.hpp"
+
+
+static bool keepRunning = false;
+
+void signalFunc( int )
+{
+	keepRunning = false;
+	printf( "INTERRUPT signal received, quitting...\n" );
+}
+
+int main( int argc, char * argv [] )
+{
+	if (argc < 2 || argc > 3)
+	{
+		printf( "Usage: %s <PCM or WAV file, '-' for the standard input> [<host>]\n", argv[0] );
+		printf( "Raw PCM is expected as 16-bit little-endian stereo at 44100 Hz.\n" );
+		return 1;
+	}
+	const std::string inputPath = argv[1];
+	const std::string hostName = argc > 2 ? argv[2] : "127.0.0.1";
+
+	PcmReader reader;
+	AudioStatus audioStatus = reader.open( inputPath );
+	if (audioStatus != AudioStatus::Success)
+	{
+		printf( "Cannot read %s: %s (system error code: %d)\n", inputPath.c_str(), enumString( audioStatus ), int( reader.lastSystemError() ) );
+		return 1;
+	}
+	const uint32_t sampleRate = reader.format().sampleRate;
+
+	orgb::Client client( "My OpenRGB Client" );
+	DeviceList devices;
+	try
+	{
+		client.connectX( hostName );
+		devices = client.requestDeviceListX();
+		for (const Device & device : devices)
+		{
+			client.switchToCustomModeX( device );
+			// OpenRGB doesn't like when you send multiple requests at once
+			std::this_thread::sleep_for( milliseconds( 50 ) );
+		}
+	}
+	catch (const orgb::Exception & error)
+	{
+		printf( "Error: %s\n", error.errorMessage() );
+		return 1;
+	}
+
+	SpectrumAnalyzer analyzer;
+	if (!analyzer.setup( sampleRate ))
+	{
+		printf( "Cannot analyze audio at %u Hz\n", sampleRate );
+		return 1;
+	}
+
+	EffectEngine engine;
+	engine.setDevices( devices );
+	engine.addLayer( std::unique_ptr< orgb::Layer >( new SpectrumLayer( analyzer, Palette( orgb::palettes::Fire ) ) ) );
+
+	// a block of 1/60 s gives 60 frames per second
+	const size_t blockFrames = sampleRate / 60;
+	std::vector< float > samples( blockFrames );
+
+	LatencyReport report;
+	uint64_t framesTotal = 0;
+
+	keepRunning = true;
+	signal( SIGINT, signalFunc );
+
+	const steady_clock::time_point start = steady_clock::now();
+	while (keepRunning)
+	{
+		size_t framesRead;
+		audioStatus = reader.read( samples.data(), blockFrames, framesRead );
+		if (audioStatus != AudioStatus::Success)
+		{
+			printf( "%s\n", enumString( audioStatus ) );
+			break;
+		}
+		framesTotal += framesRead;
+
+		// a file is read faster than it plays, so wait until the audio would have been captured
+		const microseconds audioTime( framesTotal * 1000000 / sampleRate );
+		std::this_thread::sleep_until( start + audioTime );
+
+		AudioLatency latency;
+		latency.block = microseconds( framesRead * 1000000 / sampleRate );
+
+		steady_clock::time_point blockRead = steady_clock::now();
+		analyzer.process( samples.data(), framesRead );
+
+		steady_clock::time_point analyzed = steady_clock::now();
+		engine.render( duration< double >( audioTime ).count() );
+
+		steady_clock::time_point rendered = steady_clock::now();
+		RequestStatus requestStatus = engine.send( client );
+		if (requestStatus != RequestStatus::Success)
+		{
+			printf( "Cannot send the colors: %s\n", enumString( requestStatus ) );
+			break;
+		}
+
+		steady_clock::time_point sent = steady_clock::now();
+		latency.analysis = duration_cast< microseconds >( analyzed - blockRead );
+		latency.render = duration_cast< microseconds >( rendered - analyzed );
+		latency.send = duration_cast< microseconds >( sent - rendered );
+		report.add( latency );
+
+		if (report.blockCount() == 5 * 60)
+		{
+			print( report );
+			report.reset();
+		}
+	}
+
+	if (report.blockCount() > 0)
+	{
+		print( report );
+	}
+
+	return 0;
+}
@@ -0,0 +1,167 @@
+//======================================================================================================================
+//  lights up all devices by the colors of a video until the stream ends or an INTERRUPT signal
+//    - the frames are read as raw RGB pixels without any header from a file, a named pipe or the standard input,
+//      for example:
+//        ffmpeg -re -i movie.mp4 -f rawvideo -pix_fmt rgb24 -s 480x270 - | ScreenAmbient - 480 270
+//    - or from a shared memory that another program keeps overwriting with the current frame, which is sampled
+//      60 times per second:
+//        ScreenAmbient shm:/dev/shm/screen 1920 1080
+//    - matrix zones show the whole image scaled down, linear zones go around its edges clockwise from
+//      the top-left corner and single LEDs show its average color
+//======================================================================================================================
+
+/// \file
+
+#include <cstdio>    // printf
+#include <cstdlib>   // atoi
+#include <csignal>   // signal
+#include <string>
+#include <thread>    // sleep
+#include <chrono>
+using namespace std::chrono;
+
+#include "OpenRGB/Client.hpp"
+#include "OpenRGB/FrameSampler.hpp"
+using orgb::DeviceList;
+using orgb::Device;
+using orgb::Zone;
+using orgb::ZoneType;
+using orgb::RequestStatus;
+using orgb::FrameStatus;
+using orgb::RawFrameReader;
+using orgb::FrameSampler;
+using orgb::ImageView;
+using orgb::ImageArea;
+using orgb::PixelFormat;
+using orgb::Edge;
+
+#include "OpenRGB/Exceptions.hpp"
+
+
+static bool keepRunning = false;
+
+void signalFunc( int )
+{
+	keepRunning = false;
+	printf( "INTERRUPT signal received, quitting...\n" );
+}
+
+// splits the LEDs of a linear zone between the edges of the image by the lengths of the edges
+static void addAroundEdges( FrameSampler & sampler, const Zone & zone, uint32_t width, uint32_t height )
+{
+	const Edge edges [] = { Edge::Top, Edge::Right, Edge::Bottom, Edge::Left };
+	const uint32_t edgeLengths [] = { width, height, width, height };
+	const uint32_t perimeter = 2 * (width + height);
+
+	uint32_t firstLed = zone.startIdx;
+	uint32_t ledsBefore = 0;
+	uint32_t lengthBefore = 0;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		lengthBefore += edgeLengths[i];
+		uint32_t ledsUntilHere = uint32_t( uint64_t( zone.leds_count ) * lengthBefore / perimeter );
+		uint32_t ledCount = ledsUntilHere - ledsBefore;
+		sampler.addStrip( zone.parentIdx, firstLed, ledCount, edges[i], 0.1f );
+		firstLed += ledCount;
+		ledsBefore = ledsUntilHere;
+	}
+}
+
+int main( int argc, char * argv [] )
+{
+	if (argc < 4 || argc > 5)
+	{
+		printf( "Usage: %s <raw RGB frames, '-' for the standard input, 'shm:<path>' for a shared memory> <width> <height> [<host>]\n", argv[0] );
+		return 1;
+	}
+	const std::string inputPath = argv[1];
+	const uint32_t width = uint32_t( atoi( argv[2] ) );
+	const uint32_t height = uint32_t( atoi( argv[3] ) );
+	const std::string hostName = argc > 4 ? argv[4] : "127.0.0.1";
+
+	const bool isShared = inputPath.compare( 0, 4, "shm:" ) == 0;
+	RawFrameReader reader;
+	FrameStatus frameStatus = isShared
+		? reader.openShared( inputPath.substr( 4 ), width, height, PixelFormat::RGB24 )
+		: reader.open( inputPath, width, height, PixelFormat::RGB24 );
+	if (frameStatus != FrameStatus::Success)
+	{
+		printf( "Cannot read %s: %s (system error code: %d)\n", inputPath.c_str(), enumString( frameStatus ), int( reader.lastSystemError() ) );
+		return 1;
+	}
+
+	orgb::Client client( "My OpenRGB Client" );
+	DeviceList devices;
+	try
+	{
+		client.connectX( hostName );
+		devices = client.requestDeviceListX();
+		for (const Device & device : devices)
+		{
+			client.switchToCustomModeX( device );
+			// OpenRGB doesn't like when you send multiple requests at once
+			std::this_thread::sleep_for( milliseconds( 50 ) );
+		}
+	}
+	catch (const orgb::Exception & error)
+	{
+		printf( "Error: %s\n", error.errorMessage() );
+		return 1;
+	}
+
+	FrameSampler sampler;
+	sampler.setDevices( devices );
+	for (const Device & device : devices)
+	{
+		for (const Zone & zone : device.zones)
+		{
+			if (zone.type == ZoneType::Matrix)
+				sampler.addMatrix( zone );
+			else if (zone.type == ZoneType::Linear)
+				addAroundEdges( sampler, zone, width, height );
+			else
+				for (uint32_t i = 0; i < zone.leds_count; ++i)
+					sampler.addArea( device.idx, zone.startIdx + i, ImageArea() );
+		}
+	}
+
+	keepRunning = true;
+	signal( SIGINT, signalFunc );
+
+	steady_clock::time_point nextFrame = steady_clock::now();
+	while (keepRunning)
+	{
+		ImageView image;
+		frameStatus = reader.read( image );
+		if (frameStatus == FrameStatus::Success)
+		{
+			sampler.sample( image );
+
+			for (const Device & device : devices)
+			{
+				RequestStatus requestStatus = client.setDeviceColors( device, sampler.colors( device.idx ) );
+				if (requestStatus != RequestStatus::Success)
+				{
+					printf( "Cannot send the colors: %s\n", enumString( requestStatus ) );
+					keepRunning = false;
+					break;
+				}
+			}
+		}
+		// a truncated shared memory is being rewritten by its producer, the next frame will be complete again
+		else if (frameStatus != FrameStatus::TooSmall)
+		{
+			printf( "%s\n", enumString( frameStatus ) );
+			break;
+		}
+
+		// a stream gives the frames at its own pace, the shared memory has to be polled
+		if (isShared)
+		{
+			nextFrame += microseconds( 1000000 / 60 );
+			std::this_thread::sleep_until( nextFrame );
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,319 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: audio-reactive effect showing the spectrum of a PCM stream
+//======================================================================================================================
+
+#ifndef OPENRGB_AUDIO_SPECTRUM_INCLUDED
+#define OPENRGB_AUDIO_SPECTRUM_INCLUDED
+
+
+#include "EffectEngine.hpp"
+#include "Palette.hpp"
+#include "SystemErrorType.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  PCM input
+
+/// Result of opening or reading a PCM stream.
+enum class AudioStatus
+{
+	Success,            ///< The operation was successful.
+	EndOfStream,        ///< All the audio of the stream has been read.
+	CannotOpen,         ///< The file could not be opened, see PcmReader::lastSystemError().
+	InvalidHeader,      ///< The stream starts like a WAV file, but its header is damaged or incomplete.
+	UnsupportedFormat,  ///< The WAV file contains other samples than 16-bit integers or 32-bit floats.
+	ReadError,          ///< Reading the stream has failed, see PcmReader::lastSystemError().
+	InvalidFormat,      ///< The format given for a raw stream has no channels or a zero sample rate.
+};
+const char * enumString( AudioStatus status ) noexcept;
+
+/// How a single sample is stored in the stream.
+enum class SampleFormat : uint8_t
+{
+	Int16,    ///< signed 16-bit integer, little endian
+	Float32,  ///< 32-bit IEEE float between -1.0 and 1.0, little endian
+};
+
+/// Layout of the samples in a PCM stream, the channels of one frame are interleaved.
+struct PcmFormat
+{
+	uint32_t sampleRate;
+	uint16_t channelCount;
+	SampleFormat sampleFormat;
+
+	/// The format of a CD, which is also what most audio tools output by default.
+	PcmFormat() noexcept : sampleRate( 44100 ), channelCount( 2 ), sampleFormat( SampleFormat::Int16 ) {}
+	PcmFormat( uint32_t sampleRate, uint16_t channelCount, SampleFormat sampleFormat ) noexcept
+		: sampleRate( sampleRate ), channelCount( channelCount ), sampleFormat( sampleFormat ) {}
+
+	size_t frameSize() const noexcept  { return channelCount * (sampleFormat == SampleFormat::Int16 ? 2 : 4); }
+};
+
+
+//======================================================================================================================
+/// Reads raw PCM samples from a file, a named pipe or the standard input and mixes them to mono.
+/** The stream is read sequentially without seeking, so it can be the output of a program capturing the audio,
+  * for example "parec --format=s16le" or "ffmpeg -f s16le -", or a WAV file recorded for testing.
+  * When the stream starts with a WAV header, the format is taken from it, otherwise it's the one given to open(). */
+
+class PcmReader
+{
+
+ public:
+
+	PcmReader() noexcept;
+	~PcmReader() noexcept;
+
+	PcmReader( const PcmReader & other ) = delete;
+	PcmReader & operator=( const PcmReader & other ) = delete;
+
+	/// Opens a file or a named pipe, "-" means the standard input.
+	/** \param rawFormat format of the samples when the stream doesn't have a WAV header,
+	  *                  InvalidFormat is returned without opening anything when it has no channels or no sample rate */
+	AudioStatus open( const std::string & path, const PcmFormat & rawFormat = PcmFormat() );
+
+	void close() noexcept;
+
+	bool isOpen() const noexcept  { return _file != nullptr; }
+
+	/// Format of the samples, valid after open() succeeds.
+	const PcmFormat & format() const noexcept  { return _format; }
+
+	/// Reads the next frames, mixes their channels to mono and converts them to values between -1.0 and 1.0.
+	/** Blocks until all the frames are available, so when reading a live capture, the blocks come at the pace
+	  * of the audio. Fewer frames than requested are read only at the end of the stream.
+	  * \param framesRead how many frames were stored into samples
+	  * \returns EndOfStream when no frames are left */
+	AudioStatus read( float * samples, size_t frameCount, size_t & framesRead );
+
+	system_error_t lastSystemError() const noexcept  { return _lastSystemError; }
+
+ private:
+
+	size_t readBytes( uint8_t * dst, size_t size ) noexcept;
+	AudioStatus readWavHeader();
+
+ private:
+
+	FILE * _file;
+	bool _ownsFile;  ///< false for the standard input
+	PcmFormat _format;
+	uint64_t _dataLeft;  ///< bytes left in the data chunk of a WAV file, UINT64_MAX for raw streams
+	std::vector< uint8_t > _pending;  ///< bytes read while looking for a WAV header that turned out to be samples
+	std::vector< uint8_t > _buffer;   ///< raw bytes of the frames being read
+	system_error_t _lastSystemError;
+
+};
+
+
+//======================================================================================================================
+/// Parameters of SpectrumAnalyzer.
+
+struct SpectrumConfig
+{
+	uint32_t fftSize;    ///< samples analyzed at once, a power of 2, the frequency resolution is sampleRate / fftSize
+	uint32_t bandCount;  ///< number of frequency bands the spectrum is reduced to
+	float minFrequency;  ///< lower edge of the first band in Hz
+	float maxFrequency;  ///< upper edge of the last band in Hz, the bands in between are spaced logarithmically
+	float floor;         ///< level in dB below the full scale that is shown as 0, everything louder than 0 dB is 1
+	float attack;        ///< how much of a rise of a band is shown after one block, 1.0 shows it immediately
+	float decay;         ///< how much of a fall of a band is shown after one block, small values make the bars fall slowly
+
+	SpectrumConfig() noexcept
+		: fftSize( 1024 ), bandCount( 16 ), minFrequency( 40.0f ), maxFrequency( 16000.0f ), floor( -60.0f ),
+		  attack( 0.7f ), decay( 0.2f ) {}
+};
+
+
+//======================================================================================================================
+/// Reduces blocks of audio to the smoothed levels of a few frequency bands.
+/** Every block of samples is appended to a history of the last fftSize samples, which is multiplied by the Hann window
+  * and transformed by a real FFT. The power of the bins belonging to every band is summed, converted to dB and mapped
+  * to 0.0 .. 1.0 between SpectrumConfig::floor and 0 dB. The result is smoothed over time, separately for rising and
+  * falling levels. Blocks shorter than fftSize overlap, so the levels can be updated at any frame rate. */
+
+class SpectrumAnalyzer
+{
+
+ public:
+
+	SpectrumAnalyzer() noexcept : _sampleRate( 0 ), _loudness( 0.0f ) {}
+
+	static constexpr uint32_t maxFftSize = 1u << 20;  ///< about 24 s of audio at 44100 Hz
+
+	/// Prepares the window, the FFT tables and the edges of the bands, and resets the levels to 0.
+	/** The FFT size is rounded up to a power of 2 and at least 16, the maximum frequency is limited to half
+	  * of the sample rate. When the sample rate is 0, the FFT size is larger than maxFftSize, or the frequencies
+	  * are not finite, the minimum is negative or not below the maximum, false is returned and the analyzer stays
+	  * unchanged. */
+	bool setup( uint32_t sampleRate, const SpectrumConfig & config = SpectrumConfig() );
+
+	/// Analyzes the last fftSize samples after appending these mono samples to the history.
+	void process( const float * samples, size_t count ) noexcept;
+
+	const SpectrumConfig & config() const noexcept  { return _config; }
+	uint32_t sampleRate() const noexcept  { return _sampleRate; }
+
+	/// Smoothed levels of the bands between 0.0 and 1.0, from the lowest frequency to the highest.
+	const float * bands() const noexcept  { return _levels.data(); }
+	size_t bandCount() const noexcept  { return _levels.size(); }
+
+	/// Level at a position between 0.0 (the lowest band) and 1.0 (the highest band), interpolated between the bands.
+	float levelAt( float position ) const noexcept;
+
+	/// Smoothed level of the whole signal between 0.0 and 1.0, on the same scale as the bands.
+	float loudness() const noexcept  { return _loudness; }
+
+	/// Unsmoothed magnitudes of the bins 0 .. fftSize / 2 from the last analysis, for custom processing.
+	const float * magnitudes() const noexcept  { return _magnitudes.data(); }
+
+ private:
+
+	void transform() noexcept;
+
+ private:
+
+	SpectrumConfig _config;
+	uint32_t _sampleRate;
+
+	std::vector< float > _history;     ///< the last fftSize samples, the newest at the end
+	std::vector< float > _window;      ///< Hann window scaled so that a full-scale sine gives magnitude 1.0 in its bin
+	std::vector< float > _real;        ///< fftSize / 2 complex values of the FFT, even samples as real parts
+	std::vector< float > _imag;        ///< ... and the odd samples as imaginary parts
+	std::vector< float > _cos;         ///< twiddle factors of the fftSize-point transform
+	std::vector< float > _sin;
+	std::vector< uint32_t > _reversed; ///< bit-reversed indexes of the fftSize / 2 complex values
+	std::vector< float > _magnitudes;  ///< fftSize / 2 + 1 bins
+
+	/// first and past-the-last bin of every band, the narrow bands at low frequencies may share a bin
+	std::vector< std::pair< uint32_t, uint32_t > > _bandBins;
+	std::vector< float > _levels;
+	float _loudness;
+
+};
+
+
+//======================================================================================================================
+/// Effect layer showing the levels of a SpectrumAnalyzer on all the devices.
+/** Every column of a matrix zone is a bar of the band at its horizontal position, the bar grows from the bottom row
+  * and the LEDs are colored by the palette from its start at the bottom to its end at the top.
+  * The LEDs of linear zones and of devices without zones are spread over the bands from the lowest to the highest,
+  * they take the color of the palette at their position and the level of the band becomes their alpha.
+  * Single-LED zones show the loudness, as the color of the palette and as the alpha.
+  * Unlit LEDs are transparent, so the layers below show through.
+  *
+  * The analyzer is only read, call SpectrumAnalyzer::process() before EffectEngine::render() every frame. */
+
+class SpectrumLayer : public ParallelLayer
+{
+
+ public:
+
+	SpectrumLayer( const SpectrumAnalyzer & analyzer, const Palette & palette,
+	               colorops::BlendMode blendMode = colorops::BlendMode::Normal, uint8_t opacity = 255 )
+		: ParallelLayer( blendMode, opacity ), _analyzer( analyzer ), _palette( palette ) {}
+
+	const Palette & palette() const noexcept  { return _palette; }
+	void setPalette( const Palette & palette ) noexcept  { _palette = palette; }
+
+ protected:
+
+	void reset( LayerCanvas & canvas ) override;
+	void renderPart( const RenderPart & part, Color * colors, double time ) override;
+
+ private:
+
+	/// Where a LED is in the spectrum, computed when the devices change.
+	struct Placement
+	{
+		float band;    ///< position between the lowest and the highest band, negative for the loudness
+		float height;  ///< height of the center of the LED in a matrix from 0.0 to 1.0, negative outside matrices
+	};
+
+	const SpectrumAnalyzer & _analyzer;
+	Palette _palette;
+	std::vector< std::vector< Placement > > _placements;  ///< device position in the list -> LED index -> placement
+
+};
+
+
+//======================================================================================================================
+//  latency
+
+/// Where the time went between an audio block being read and its colors being sent to the devices.
+struct AudioLatency
+{
+	std::chrono::microseconds block;     ///< length of the audio in the block, the oldest sample waited this long to be read
+	std::chrono::microseconds analysis;  ///< SpectrumAnalyzer::process()
+	std::chrono::microseconds render;    ///< EffectEngine::render()
+	std::chrono::microseconds send;      ///< EffectEngine::send(), until the last message was written to the socket
+
+	AudioLatency() noexcept : block( 0 ), analysis( 0 ), render( 0 ), send( 0 ) {}
+
+	/// The processing after the block was read, this has to fit into the length of the next block.
+	std::chrono::microseconds processing() const noexcept  { return analysis + render + send; }
+
+	/// From the oldest sample of the block being captured to the colors being on the wire.
+	std::chrono::microseconds total() const noexcept  { return block + processing(); }
+};
+
+/// Average and worst latencies of many audio blocks, to check that the processing fits into the time budget.
+class LatencyReport
+{
+
+ public:
+
+	LatencyReport() noexcept : _blockCount( 0 ), _overruns( 0 ), _maximumTotal( 0 ) {}
+
+	void add( const AudioLatency & latency ) noexcept;
+	void reset() noexcept  { *this = LatencyReport(); }
+
+	size_t blockCount() const noexcept  { return _blockCount; }
+
+	/// Average of every stage over all the added blocks.
+	AudioLatency average() const noexcept;
+
+	/// The worst value of every stage, each of them may come from a different block.
+	const AudioLatency & maximum() const noexcept  { return _maximum; }
+
+	/// The worst total latency of a single block.
+	std::chrono::microseconds maximumTotal() const noexcept  { return _maximumTotal; }
+
+	/// Number of blocks whose processing took longer than the block itself, so the audio piled up in the input.
+	size_t overruns() const noexcept  { return _overruns; }
+
+ private:
+
+	size_t _blockCount;
+	size_t _overruns;
+	AudioLatency _sum;
+	AudioLatency _maximum;
+	std::chrono::microseconds _maximumTotal;
+
+};
+
+/// Prints a table of the average and the maximum of every stage and the share of the budget they take.
+void print( const LatencyReport & report );
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_AUDIO_SPECTRUM_INCLUDED
@@ -0,0 +1,92 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: correction of colors for the specifics of a device
+//======================================================================================================================
+
+#ifndef OPENRGB_CALIBRATION_INCLUDED
+#define OPENRGB_CALIBRATION_INCLUDED
+
+
+#include "Color.hpp"
+#include "ColorOps.hpp"  // ColorMatrix, ChannelLUT
+
+#include <cstddef>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Correction of colors for one device, so that the same Color looks the same on different kinds of devices.
+/** Each color goes through 3 steps:
+  *   1. The channels are mixed by a 3x3 matrix, which fixes LEDs whose red, green or blue have a different hue.
+  *   2. The channels are scaled by the white point, which fixes a tint of white and balances the brightness.
+  *   3. Each channel goes through its gamma curve, which fixes how the brightness of the LEDs grows with the value.
+  *
+  * The settings are converted to a fixed-point matrix and lookup tables when changed, so that apply() is a single
+  * pass over the frame, see colorops::transform(). Give the calibration to Client::setDeviceCalibration()
+  * and all the colors sent to that device get corrected automatically. */
+
+class Calibration
+{
+
+ public:
+
+	/// Calibration that keeps the colors unchanged.
+	Calibration() noexcept;
+
+	/// Mixes the channels, row 0 gives the new red as a weighted sum of the old red, green and blue and so on.
+	/** The weights are used with a precision of 1/256 and limited to -128.0 .. 127.99.
+	  * \returns false when any of the weights is infinite or NaN, the previous matrix is kept then */
+	bool setMatrix( const float (& matrix) [3][3] ) noexcept;
+
+	/// Color the device should get instead of white, all other colors are scaled by the same ratio per channel.
+	void setWhitePoint( Color whitePoint ) noexcept;
+
+	/// Sets the same gamma for all channels, values above 1.0 make the dark shades darker and more distinct.
+	/** \returns false when the gamma is zero, negative or NaN, the previous gamma is kept then */
+	bool setGamma( float gamma ) noexcept  { return setGamma( gamma, gamma, gamma ); }
+	bool setGamma( float red, float green, float blue ) noexcept;
+
+	const float (& matrix() const noexcept) [3][3]  { return _matrix; }
+	Color whitePoint() const noexcept  { return _whitePoint; }
+	float redGamma() const noexcept    { return _gamma[0]; }
+	float greenGamma() const noexcept  { return _gamma[1]; }
+	float blueGamma() const noexcept   { return _gamma[2]; }
+
+	/// Whether the calibration keeps the colors unchanged, in which case it doesn't need to be applied at all.
+	bool isIdentity() const noexcept  { return _isIdentityMatrix && _isIdentityGamma; }
+
+	/// Corrects a frame of colors, \p dst may be the same as \p src. The padding stays unchanged.
+	void apply( Color * dst, const Color * src, size_t count ) const noexcept;
+
+	/// Corrects a single color.
+	Color apply( Color color ) const noexcept;
+
+ private:
+
+	void updateMatrix() noexcept;
+
+ private:
+
+	float _matrix [3][3];
+	Color _whitePoint;
+	float _gamma [3];
+
+	colorops::ColorMatrix _fixedMatrix;  ///< _matrix with the rows scaled by _whitePoint
+	colorops::ChannelLUT _gammaLUTs [3];
+	bool _isIdentityMatrix;
+	bool _isIdentityGamma;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_CALIBRATION_INCLUDED
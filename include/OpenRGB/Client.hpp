@@ -10,7 +10,11 @@
 
 
 #include "DeviceInfo.hpp"
+#include "DeviceListCache.hpp"
+#include "DeviceSnapshot.hpp"
+#include "DeviceView.hpp"
 #include "Color.hpp"
+#include "Calibration.hpp"
 #include "SystemErrorType.hpp"  // HACK: read the comment at the top of that header file
 
 #include <string>  // client name
@@ -27,6 +31,10 @@ namespace orgb {
 
 constexpr uint16_t defaultPort = 6742;
 
+enum class MessageType : uint32_t;
+struct Header;
+struct ReplyControllerData;
+
 
 //======================================================================================================================
 
@@ -80,6 +88,35 @@ struct DeviceListResult
 	DeviceList devices;    ///< output of a successfull request
 };
 
+/// Result and output of a request for a device list that can be shared between threads
+struct SharedDeviceListResult
+{
+	RequestStatus status;  ///< whether the request suceeded or why it didn't
+	std::shared_ptr< const DeviceList > devices;  ///< output of a successfull request
+};
+
+/// Which devices have changed since the last time the device list was downloaded
+struct DeviceListChanges
+{
+	std::vector< uint32_t > added;     ///< indexes of the devices that are new, in the updated list
+	std::vector< uint32_t > removed;   ///< indexes of the devices that are no longer present, in the original list
+	std::vector< uint32_t > modified;  ///< indexes of the devices whose description has changed, in the updated list
+};
+
+/// Result and output of a device list refresh
+struct DeviceListRefreshResult
+{
+	RequestStatus status;       ///< whether the request suceeded or why it didn't
+	DeviceListChanges changes;  ///< output of a successfull request
+};
+
+/// Result and output of a device view list request
+struct DeviceViewListResult
+{
+	RequestStatus status;  ///< whether the request suceeded or why it didn't
+	std::vector< DeviceView > devices;  ///< output of a successfull request
+};
+
 /// Result and output of a device count request
 struct DeviceCountResult
 {
@@ -139,7 +176,76 @@ class Client
 	bool setTimeout( std::chrono::milliseconds timeout ) noexcept;
 
 	/// Queries the server for information about all its RGB devices.
-	DeviceListResult requestDeviceList() noexcept;
+	/** Use the \p options to parse the devices in a less complete but cheaper way. */
+	DeviceListResult requestDeviceList( const DeviceListOptions & options = DeviceListOptions() ) noexcept;
+
+	/// Queries the server for information about all its RGB devices and stores it into an existing DeviceList.
+	/** The devices are parsed into the Device objects of the list that was replaced by the previous call, and only
+	  * when everything is received, they are swapped into \p devices. So when you pass the same list on every refresh,
+	  * the strings and vectors of the devices re-use the memory they have allocated before, and the memory is allocated
+	  * only when the devices grow. References to the previous devices stay valid until the next call.
+	  * If the request fails, the list is left unchanged. */
+	RequestStatus requestDeviceList( DeviceList & devices, const DeviceListOptions & options = DeviceListOptions() ) noexcept;
+
+	/// Queries the server for information about all its RGB devices and publishes the result as the current device list.
+	/** The published list is immutable and its search indexes are already built, so it can be read by any number
+	  * of threads without locking. The threads obtain it via currentDeviceList() and can keep using it for as long
+	  * as they need, even while a newer one is being downloaded. If the request fails, nothing is published. */
+	SharedDeviceListResult requestSharedDeviceList( const DeviceListOptions & options = DeviceListOptions() ) noexcept;
+
+	/// Returns the device list that was most recently published, or nullptr if there is none yet.
+	/** The first list is published by requestSharedDeviceList(). From then on, also every successful
+	  * requestDeviceList(), refreshDeviceList(), requestDeviceListCached() and verifyCachedDevice() that replaces
+	  * the list publishes a copy of it, so the returned list is never older than the one the caller of those methods
+	  * has. Until the first list is published nothing is copied, so that the clients that don't share their list
+	  * don't pay for it and the in-place requestDeviceList() doesn't allocate.
+	  * Unlike the other methods of the Client, this one can be called from any thread at any time. */
+	std::shared_ptr< const DeviceList > currentDeviceList() const noexcept;
+
+	/// Loads the device list from a cache file if it still matches the server, otherwise downloads it and saves it there.
+	/** This is meant for short-lived processes that need to resolve device, zone or LED names, but don't want to
+	  * download the whole device list every time. The cache is considered valid while the number of devices
+	  * on the server stays the same, see DeviceListCache for details. Failure to save the cache is not reported.
+	  * Before changing a device from the cached list, check it by verifyCachedDevice().
+	  * \param cacheFilePath when empty, DeviceListCache::defaultFilePath() of the connected server is used,
+	  *                      when the current user has no cache directory, the list is simply downloaded
+	  * \param options how to parse the devices, whether they are loaded from the cache or downloaded */
+	DeviceListResult requestDeviceListCached(
+		const std::string & cacheFilePath = "", const DeviceListOptions & options = DeviceListOptions()
+	) noexcept;
+
+	/// Checks that a device of a list from requestDeviceListCached() is still the same device on the server.
+	/** Only this one device is downloaded and its DeviceListCache::fingerprint() is compared with the cached one.
+	  * When they differ, the whole list is downloaded again into \p devices and saved into the cache, so the caller
+	  * has to look up the device again. If the request fails, the list is left unchanged.
+	  * \param cacheFilePath the same one that was given to requestDeviceListCached()
+	  * \param options the same ones that were given to requestDeviceListCached() */
+	RequestStatus verifyCachedDevice(
+		DeviceList & devices, uint32_t deviceIdx, const std::string & cacheFilePath = "",
+		const DeviceListOptions & options = DeviceListOptions()
+	) noexcept;
+
+	/// Updates a device list downloaded earlier via requestDeviceList() to the current state on the server.
+	/** Devices are matched by their serial, location and name, and those left unmatched by only their serial and location,
+	  * so a renamed device is reported as modified, not as removed and added. Devices that haven't changed at all are kept
+	  * as they are, only their index is updated if they have moved, so pointers and references to them stay valid.
+	  * The protocol can't tell which devices have changed, so all of them are still downloaded, but only the changed
+	  * ones are parsed and allocated again. A device whose current colors or active mode have changed is parsed again
+	  * too, but it's reported as modified only when its description (modes, zones, LEDs, ...) has changed.
+	  * If the request fails, the list is left unchanged.
+	  * \param options how to parse the changed devices, should be the same as when the list was requested */
+	DeviceListRefreshResult refreshDeviceList(
+		DeviceList & devices, const DeviceListOptions & options = DeviceListOptions()
+	) noexcept;
+
+	/// Queries the server for information about all its RGB devices and stores it into a flat DeviceSnapshot.
+	/** The snapshot is cleared and refilled in place, so when you pass the same object on every refresh,
+	  * the already allocated memory gets re-used. If the request fails, the snapshot is left empty. */
+	RequestStatus requestDeviceSnapshot( DeviceSnapshot & snapshot ) noexcept;
+
+	/// Queries the server for information about all its RGB devices, but keeps the replies in their raw form.
+	/** Use this when you need only a few attributes of each device, DeviceView parses them only when accessed. */
+	DeviceViewListResult requestDeviceViewList() noexcept;
 
 	/// Queries the server for the number of its RGB devices.
 	/** This is useful when for some reason you want to request the devices manually one by one. */
@@ -147,7 +253,7 @@ class Client
 
 	/// Queries the server for information about a single RGB devices.
 	/** After you set a color or change a mode, you can optionally use this to update */
-	DeviceInfoResult requestDeviceInfo( uint32_t deviceIdx ) noexcept;
+	DeviceInfoResult requestDeviceInfo( uint32_t deviceIdx, const DeviceListOptions & options = DeviceListOptions() ) noexcept;
 
 	/// Checks if the device list you downloaded earlier via requestDeviceList() hasn't been changed on the server.
 	/** In case it has been changed, you need to call requestDeviceList() again. */
@@ -170,6 +276,10 @@ class Client
 	/// Sets one unified color for the whole device.
 	RequestStatus setDeviceColor( const Device & device, Color color ) noexcept;
 
+	/// Sets an individual color for every LED of the device in a single message.
+	/** The colors are in the same order as Device::leds and there should be as many of them as there are LEDs. */
+	RequestStatus setDeviceColors( const Device & device, const std::vector< Color > & colors ) noexcept;
+
 	/// Sets a color of a particular zone of a device.
 	RequestStatus setZoneColor( const Zone & zone, Color color ) noexcept;
 
@@ -179,6 +289,20 @@ class Client
 	/// Sets a color of a single selected LED.
 	RequestStatus setLEDColor( const LED & led, Color color ) noexcept;
 
+	/// Sets a correction that will be applied to all the colors sent to the device, see Calibration.
+	/** It's applied by setDeviceColor(), setDeviceColors(), setZoneColor() and setLEDColor(), right before
+	  * the colors are serialized, so the colors you pass there stay unchanged. The calibration belongs to the device
+	  * identified by its serial, location and name, not to its index. Whenever the client receives the description
+	  * of a device, by any of the methods that request the devices, the calibration is moved to the device's current
+	  * index, and a device that took over the index of a calibrated one doesn't get its calibration. */
+	void setDeviceCalibration( const Device & device, const Calibration & calibration );
+
+	/// Calibration of the device, or nullptr if it has none.
+	const Calibration * deviceCalibration( const Device & device ) const noexcept;
+
+	/// Removes the calibration of the device, its colors will be sent unchanged.
+	void resetDeviceCalibration( const Device & device );
+
 	/// Queries the server for a list of saved profiles.
 	ProfileListResult requestProfileList();
 
@@ -213,7 +337,54 @@ class Client
 	/** \throws UserError when the client is not connected
 	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
 	  * \throws SystemError when there was an error inside the operating system */
-	DeviceList requestDeviceListX();
+	DeviceList requestDeviceListX( const DeviceListOptions & options = DeviceListOptions() );
+
+	/// Exception-throwing variant of requestDeviceList( DeviceList & ).
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	void requestDeviceListX( DeviceList & devices, const DeviceListOptions & options = DeviceListOptions() );
+
+	/// Exception-throwing variant of requestSharedDeviceList().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	std::shared_ptr< const DeviceList > requestSharedDeviceListX( const DeviceListOptions & options = DeviceListOptions() );
+
+	/// Exception-throwing variant of requestDeviceListCached().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	DeviceList requestDeviceListCachedX(
+		const std::string & cacheFilePath = "", const DeviceListOptions & options = DeviceListOptions()
+	);
+
+	/// Exception-throwing variant of verifyCachedDevice().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	void verifyCachedDeviceX(
+		DeviceList & devices, uint32_t deviceIdx, const std::string & cacheFilePath = "",
+		const DeviceListOptions & options = DeviceListOptions()
+	);
+
+	/// Exception-throwing variant of refreshDeviceList().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	DeviceListChanges refreshDeviceListX( DeviceList & devices, const DeviceListOptions & options = DeviceListOptions() );
+
+	/// Exception-throwing variant of requestDeviceSnapshot().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	void requestDeviceSnapshotX( DeviceSnapshot & snapshot );
+
+	/// Exception-throwing variant of requestDeviceViewList().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	std::vector< DeviceView > requestDeviceViewListX();
 
 	/// Exception-throwing variant of requestDeviceCount().
 	/** \throws UserError when the client is not connected
@@ -225,7 +396,7 @@ class Client
 	/** \throws UserError when the client is not connected
 	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
 	  * \throws SystemError when there was an error inside the operating system */
-	std::unique_ptr< Device > requestDeviceInfoX( uint32_t deviceIdx );
+	std::unique_ptr< Device > requestDeviceInfoX( uint32_t deviceIdx, const DeviceListOptions & options = DeviceListOptions() );
 
 	/// Exception-throwing variant of checkForDeviceUpdates().
 	/** \throws ConnectionError when the server closes the connection or sends an invalid packet
@@ -256,6 +427,12 @@ class Client
 	  * \throws SystemError when there was an error inside the operating system */
 	void setDeviceColorX( const Device & device, Color color );
 
+	/// Exception-throwing variant of setDeviceColors().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent
+	  * \throws SystemError when there was an error inside the operating system */
+	void setDeviceColorsX( const Device & device, const std::vector< Color > & colors );
+
 	/// Exception-throwing variant of setZoneColor().
 	/** \throws UserError when the client is not connected
 	  * \throws ConnectionError when a request couldn't be sent
@@ -314,14 +491,27 @@ class Client
 	ConnectStatus _connect( const std::string & host, uint16_t port );
 	bool _disconnect() noexcept;
 	bool _setTimeout( std::chrono::milliseconds timeout ) noexcept;
-	DeviceListResult _requestDeviceList();
+	DeviceListResult _requestDeviceList( const DeviceListOptions & options = DeviceListOptions() );
+	DeviceListResult _downloadDeviceList( const DeviceListOptions & options );
+	RequestStatus _requestDeviceList( DeviceList & devices, const DeviceListOptions & options );
+	SharedDeviceListResult _requestSharedDeviceList( const DeviceListOptions & options );
+	DeviceListResult _requestDeviceListCached( const std::string & cacheFilePath, const DeviceListOptions & options );
+	RequestStatus _verifyCachedDevice(
+		DeviceList & devices, uint32_t deviceIdx, const std::string & cacheFilePath, const DeviceListOptions & options
+	);
+	DeviceListRefreshResult _refreshDeviceList( DeviceList & devices, const DeviceListOptions & options );
+	RequestStatus _requestDeviceSnapshot( DeviceSnapshot & snapshot );
+	DeviceViewListResult _requestDeviceViewList();
 	DeviceCountResult _requestDeviceCount();
-	DeviceInfoResult _requestDeviceInfo( uint32_t deviceIdx );
+	DeviceInfoResult _requestDeviceInfo( uint32_t deviceIdx, const DeviceListOptions & options = DeviceListOptions() );
+	template< typename DevicePointers >
+	std::shared_ptr< const DeviceList > copyIfShared( const DevicePointers & devices ) const;
 	UpdateStatus _checkForDeviceUpdates() noexcept;
 	RequestStatus _switchToCustomMode( const Device & device );
 	RequestStatus _changeMode( const Device & device, const Mode & mode );
 	RequestStatus _saveMode( const Device & device, const Mode & mode );
 	RequestStatus _setDeviceColor( const Device & device, Color color );
+	RequestStatus _setDeviceColors( const Device & device, const std::vector< Color > & colors );
 	RequestStatus _setZoneColor( const Zone & zone, Color color );
 	RequestStatus _setZoneSize( const Zone & zone, uint32_t newSize );
 	RequestStatus _setLEDColor( const LED & led, Color color );
@@ -331,7 +521,7 @@ class Client
 	RequestStatus _deleteProfile( const std::string & profileName );
 
 	template< typename Message, typename ... ConstructorArgs >
-	bool sendMessage( ConstructorArgs ... args );
+	bool sendMessage( ConstructorArgs && ... args );
 
 	template< typename Message >
 	struct RecvResult
@@ -342,8 +532,16 @@ class Client
 	template< typename Message >
 	RecvResult< Message > awaitMessage() noexcept;
 
+	RequestStatus awaitMessageBody( MessageType expectedType, Header & header, std::vector< uint8_t > & bodyBuffer ) noexcept;
+
+	RecvResult< ReplyControllerData > awaitDeviceData( const DeviceListOptions & options = DeviceListOptions() ) noexcept;
+
 	UpdateStatus checkForUpdateMessageArrival() noexcept;
 
+	const Calibration * calibrationOf( uint32_t deviceIdx ) const noexcept;
+	void rebindCalibration( uint32_t deviceIdx, const std::vector< uint8_t > & replyBody ) noexcept;
+	void updateCalibrationIndexes();
+
 #ifndef NO_EXCEPTIONS
 	void connectStatusToException( ConnectStatus status );
 	void requestStatusToException( RequestStatus status );
@@ -358,6 +556,44 @@ class Client
 
 	uint32_t _negotiatedProtocolVersion;
 
+	// where we are connected, identifies the device list cache
+	std::string _host;
+	uint16_t _port;
+
+	// the last published device list, only accessed via std::atomic_load and std::atomic_store
+	std::shared_ptr< const DeviceList > _sharedDeviceList;
+
+	// the list swapped out by the last in-place requestDeviceList(), its devices are overwritten by the next one
+	DeviceList _spareDeviceList;
+
+	// names of the objects in the device snapshots, kept across refreshes until it grows too much
+	std::shared_ptr< StringTable > _stringTable;
+	size_t _snapshotNameCount;  ///< names in the last snapshot, to tell when the table has grown too much
+
+	// re-used for receiving message bodies that are parsed directly from the raw bytes
+	std::vector< uint8_t > _bodyBuffer;
+
+	// re-used for serializing the messages, so that sending a frame of colors repeatedly doesn't allocate
+	std::vector< uint8_t > _sendBuffer;
+
+	struct DeviceCalibration
+	{
+		std::string identity;  ///< see identityKey()
+		uint32_t deviceIdx;    ///< current index of the device, noDevice when it's not in the list
+		Calibration calibration;
+	};
+	static constexpr uint32_t noDevice = UINT32_MAX;
+
+	// corrections of the colors sent to the devices, bound to their identities
+	std::vector< DeviceCalibration > _calibrations;
+	// device index -> index into _calibrations, noDevice when the device has none
+	std::vector< uint32_t > _calibrationIndexes;
+	// re-used for the identity keys of the received devices
+	std::string _identityKey;
+
+	// re-used for the corrected colors of a device, so that the caller's colors stay unchanged
+	std::vector< Color > _calibratedColors;
+
 	bool _isDeviceListOutOfDate;
 
 };
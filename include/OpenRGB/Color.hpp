@@ -9,6 +9,8 @@
 #define OPENRGB_COLOR_INCLUDED
 
 
+#include "StringView.hpp"
+
 #include <cstdint>
 #include <iosfwd>
 #include <string>
@@ -23,9 +25,26 @@ namespace orgb {
 
 
 //======================================================================================================================
-/// Simple representation of a color with 3 8-bit values for red, green, blue components
+/// Color in the hue, saturation, value model, with all components in 8 bits.
+/** The hue goes around the whole circle from 0 (red) over 85 (green) and 171 (blue) back to 255 (almost red again),
+  * so it can simply be incremented with the natural wrap-around for rainbow effects. */
+
+struct HSV
+{
+	uint8_t h;  ///< hue, 0-255 maps to 0-360 degrees
+	uint8_t s;  ///< saturation, 0 is gray, 255 is the pure hue
+	uint8_t v;  ///< value, 0 is black, 255 is full brightness
+
+	HSV() noexcept = default;
+	constexpr HSV( uint8_t hue, uint8_t saturation, uint8_t value ) noexcept : h( hue ), s( saturation ), v( value ) {}
+};
 
 
+//======================================================================================================================
+/// Simple representation of a color with 3 8-bit values for red, green, blue components
+/** The constructor is constexpr, so colors can be constants evaluated at compile time and tables of them
+  * can be stored in read-only data without any initialization at startup, see also the literal _rgb. */
+
 class Color
 {
 
@@ -37,15 +56,32 @@ class Color
 	uint8_t padding;
 
 	Color() noexcept = default;
-	Color( uint8_t red, uint8_t green, uint8_t blue ) noexcept : r( red ), g( green ), b( blue ) {}
+	constexpr Color( uint8_t red, uint8_t green, uint8_t blue ) noexcept : r( red ), g( green ), b( blue ), padding( 0 ) {}
 
 	/// Attempts to deduce a color from a string description.
 	/** Possible ways to define a color are:
 	  * 1. hex number of 6 digits, for example "AB34EF", may be preceeded by '#' character
-	  * 2. a word, for example "red", "cyan", "black", case doesn't matter */
-	bool fromString( const std::string & str ) noexcept;
+	  * 2. '#' followed by 3 hex digits, each of them repeated, for example "#A3E" means "#AA33EE"
+	  * 3. one of the 148 CSS color names, for example "red", "cyan", "cornflowerblue", case doesn't matter,
+	  *    see impl::ColorNames::namedColors
+	  * 4. CSS function rgb() with numbers 0-255 or percentages, for example "rgb(255, 136, 0)" or "rgb(100% 50% 0%)"
+	  * 5. CSS function hsl() with the hue in degrees, for example "hsl(30, 100%, 50%)"
+	  *
+	  * Nothing is allocated, so it can be used to parse colors in bulk.
+	  * When the string is not valid, false is returned and the color stays unchanged. */
+	bool fromString( StringView str ) noexcept;
+
+	/// Fully saturated color of a hue at full brightness, see HSV.
+	static Color fromHue( uint8_t hue ) noexcept;
 
-	// predefined basic colors for instant use
+	/// Converts a color from the hue, saturation, value model using integer math only.
+	/** To convert whole frames use colorops::fromHSV(), which gives the same results faster. */
+	static Color fromHSV( HSV hsv ) noexcept;
+
+	/// Converts the color to the hue, saturation, value model, gray colors get hue 0.
+	HSV toHSV() const noexcept;
+
+	// predefined basic colors for instant use, initialized at compile time
 	static const Color Black;
 	static const Color White;
 	static const Color Red;
@@ -62,11 +98,320 @@ class Color
 	friend std::ostream & operator<<( std::ostream & os, Color color ) noexcept;
 	friend std::istream & operator>>( std::istream & is, Color & color ) noexcept;
 
+	// the padding is not part of the color
+	friend constexpr bool operator==( Color a, Color b ) noexcept  { return a.r == b.r && a.g == b.g && a.b == b.b; }
+	friend constexpr bool operator!=( Color a, Color b ) noexcept  { return !(a == b); }
+
 };
 
 void print( Color color );
 
 
+//======================================================================================================================
+//  compile-time parsing
+
+namespace impl {
+
+constexpr bool isHexDigit( char c ) noexcept
+{
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+constexpr bool areHexDigits( const char * str, size_t length ) noexcept
+{
+	return length == 0 || (isHexDigit( str[0] ) && areHexDigits( str + 1, length - 1 ));
+}
+
+constexpr uint8_t hexDigitValue( char c ) noexcept
+{
+	return uint8_t( c <= '9' ? c - '0' : c <= 'F' ? c - 'A' + 10 : c - 'a' + 10 );
+}
+
+constexpr uint8_t hexByte( const char * str ) noexcept
+{
+	return uint8_t( hexDigitValue( str[0] ) * 16 + hexDigitValue( str[1] ) );
+}
+
+constexpr Color hexColor( const char * str ) noexcept
+{
+	return Color( hexByte( str ), hexByte( str + 2 ), hexByte( str + 4 ) );
+}
+
+/// Color from 3 hex digits, where every digit is repeated, so "F80" is the same as "FF8800".
+constexpr Color shortHexColor( const char * str ) noexcept
+{
+	return Color( uint8_t( hexDigitValue( str[0] ) * 17 ), uint8_t( hexDigitValue( str[1] ) * 17 ), uint8_t( hexDigitValue( str[2] ) * 17 ) );
+}
+
+constexpr char toLower( char c ) noexcept
+{
+	return c >= 'A' && c <= 'Z' ? char( c - 'A' + 'a' ) : c;
+}
+
+/// Compares a string of a given length with a lower-case null-terminated name, case-insensitively.
+constexpr bool equalsName( const char * str, size_t length, const char * name ) noexcept
+{
+	return length == 0 ? *name == '\0' : *name != '\0' && toLower( *str ) == *name && equalsName( str + 1, length - 1, name + 1 );
+}
+
+struct NamedColor
+{
+	const char * name;
+	Color color;
+};
+
+/// Tables of the color names, used both during compile-time evaluation and at run time.
+/** They are static members of a class template rather than namespace-scope constants, because those would have
+  * internal linkage, and the inline functions below, which use the tables at run time, would then refer to a different
+  * copy in every translation unit. The members of a template are a single entity shared by the whole program. */
+template< typename Unused = void >
+struct NameTables
+{
+	/// Colors that Color::fromString() and the literal _rgb accept by their names, all 148 CSS named colors.
+	/** The only exception is "green", which is #00FF00 like Color::Green, not #008000 as in CSS. */
+	static constexpr NamedColor namedColors [] =
+	{
+		{ "aliceblue",            Color( 0xF0, 0xF8, 0xFF ) },
+		{ "antiquewhite",         Color( 0xFA, 0xEB, 0xD7 ) },
+		{ "aqua",                 Color( 0x00, 0xFF, 0xFF ) },
+		{ "aquamarine",           Color( 0x7F, 0xFF, 0xD4 ) },
+		{ "azure",                Color( 0xF0, 0xFF, 0xFF ) },
+		{ "beige",                Color( 0xF5, 0xF5, 0xDC ) },
+		{ "bisque",               Color( 0xFF, 0xE4, 0xC4 ) },
+		{ "black",                Color( 0x00, 0x00, 0x00 ) },
+		{ "blanchedalmond",       Color( 0xFF, 0xEB, 0xCD ) },
+		{ "blue",                 Color( 0x00, 0x00, 0xFF ) },
+		{ "blueviolet",           Color( 0x8A, 0x2B, 0xE2 ) },
+		{ "brown",                Color( 0xA5, 0x2A, 0x2A ) },
+		{ "burlywood",            Color( 0xDE, 0xB8, 0x87 ) },
+		{ "cadetblue",            Color( 0x5F, 0x9E, 0xA0 ) },
+		{ "chartreuse",           Color( 0x7F, 0xFF, 0x00 ) },
+		{ "chocolate",            Color( 0xD2, 0x69, 0x1E ) },
+		{ "coral",                Color( 0xFF, 0x7F, 0x50 ) },
+		{ "cornflowerblue",       Color( 0x64, 0x95, 0xED ) },
+		{ "cornsilk",             Color( 0xFF, 0xF8, 0xDC ) },
+		{ "crimson",              Color( 0xDC, 0x14, 0x3C ) },
+		{ "cyan",                 Color( 0x00, 0xFF, 0xFF ) },
+		{ "darkblue",             Color( 0x00, 0x00, 0x8B ) },
+		{ "darkcyan",             Color( 0x00, 0x8B, 0x8B ) },
+		{ "darkgoldenrod",        Color( 0xB8, 0x86, 0x0B ) },
+		{ "darkgray",             Color( 0xA9, 0xA9, 0xA9 ) },
+		{ "darkgreen",            Color( 0x00, 0x64, 0x00 ) },
+		{ "darkgrey",             Color( 0xA9, 0xA9, 0xA9 ) },
+		{ "darkkhaki",            Color( 0xBD, 0xB7, 0x6B ) },
+		{ "darkmagenta",          Color( 0x8B, 0x00, 0x8B ) },
+		{ "darkolivegreen",       Color( 0x55, 0x6B, 0x2F ) },
+		{ "darkorange",           Color( 0xFF, 0x8C, 0x00 ) },
+		{ "darkorchid",           Color( 0x99, 0x32, 0xCC ) },
+		{ "darkred",              Color( 0x8B, 0x00, 0x00 ) },
+		{ "darksalmon",           Color( 0xE9, 0x96, 0x7A ) },
+		{ "darkseagreen",         Color( 0x8F, 0xBC, 0x8F ) },
+		{ "darkslateblue",        Color( 0x48, 0x3D, 0x8B ) },
+		{ "darkslategray",        Color( 0x2F, 0x4F, 0x4F ) },
+		{ "darkslategrey",        Color( 0x2F, 0x4F, 0x4F ) },
+		{ "darkturquoise",        Color( 0x00, 0xCE, 0xD1 ) },
+		{ "darkviolet",           Color( 0x94, 0x00, 0xD3 ) },
+		{ "deeppink",             Color( 0xFF, 0x14, 0x93 ) },
+		{ "deepskyblue",          Color( 0x00, 0xBF, 0xFF ) },
+		{ "dimgray",              Color( 0x69, 0x69, 0x69 ) },
+		{ "dimgrey",              Color( 0x69, 0x69, 0x69 ) },
+		{ "dodgerblue",           Color( 0x1E, 0x90, 0xFF ) },
+		{ "firebrick",            Color( 0xB2, 0x22, 0x22 ) },
+		{ "floralwhite",          Color( 0xFF, 0xFA, 0xF0 ) },
+		{ "forestgreen",          Color( 0x22, 0x8B, 0x22 ) },
+		{ "fuchsia",              Color( 0xFF, 0x00, 0xFF ) },
+		{ "gainsboro",            Color( 0xDC, 0xDC, 0xDC ) },
+		{ "ghostwhite",           Color( 0xF8, 0xF8, 0xFF ) },
+		{ "gold",                 Color( 0xFF, 0xD7, 0x00 ) },
+		{ "goldenrod",            Color( 0xDA, 0xA5, 0x20 ) },
+		{ "gray",                 Color( 0x80, 0x80, 0x80 ) },
+		{ "green",                Color( 0x00, 0xFF, 0x00 ) },
+		{ "greenyellow",          Color( 0xAD, 0xFF, 0x2F ) },
+		{ "grey",                 Color( 0x80, 0x80, 0x80 ) },
+		{ "honeydew",             Color( 0xF0, 0xFF, 0xF0 ) },
+		{ "hotpink",              Color( 0xFF, 0x69, 0xB4 ) },
+		{ "indianred",            Color( 0xCD, 0x5C, 0x5C ) },
+		{ "indigo",               Color( 0x4B, 0x00, 0x82 ) },
+		{ "ivory",                Color( 0xFF, 0xFF, 0xF0 ) },
+		{ "khaki",                Color( 0xF0, 0xE6, 0x8C ) },
+		{ "lavender",             Color( 0xE6, 0xE6, 0xFA ) },
+		{ "lavenderblush",        Color( 0xFF, 0xF0, 0xF5 ) },
+		{ "lawngreen",            Color( 0x7C, 0xFC, 0x00 ) },
+		{ "lemonchiffon",         Color( 0xFF, 0xFA, 0xCD ) },
+		{ "lightblue",            Color( 0xAD, 0xD8, 0xE6 ) },
+		{ "lightcoral",           Color( 0xF0, 0x80, 0x80 ) },
+		{ "lightcyan",            Color( 0xE0, 0xFF, 0xFF ) },
+		{ "lightgoldenrodyellow", Color( 0xFA, 0xFA, 0xD2 ) },
+		{ "lightgray",            Color( 0xD3, 0xD3, 0xD3 ) },
+		{ "lightgreen",           Color( 0x90, 0xEE, 0x90 ) },
+		{ "lightgrey",            Color( 0xD3, 0xD3, 0xD3 ) },
+		{ "lightpink",            Color( 0xFF, 0xB6, 0xC1 ) },
+		{ "lightsalmon",          Color( 0xFF, 0xA0, 0x7A ) },
+		{ "lightseagreen",        Color( 0x20, 0xB2, 0xAA ) },
+		{ "lightskyblue",         Color( 0x87, 0xCE, 0xFA ) },
+		{ "lightslategray",       Color( 0x77, 0x88, 0x99 ) },
+		{ "lightslategrey",       Color( 0x77, 0x88, 0x99 ) },
+		{ "lightsteelblue",       Color( 0xB0, 0xC4, 0xDE ) },
+		{ "lightyellow",          Color( 0xFF, 0xFF, 0xE0 ) },
+		{ "lime",                 Color( 0x00, 0xFF, 0x00 ) },
+		{ "limegreen",            Color( 0x32, 0xCD, 0x32 ) },
+		{ "linen",                Color( 0xFA, 0xF0, 0xE6 ) },
+		{ "magenta",              Color( 0xFF, 0x00, 0xFF ) },
+		{ "maroon",               Color( 0x80, 0x00, 0x00 ) },
+		{ "mediumaquamarine",     Color( 0x66, 0xCD, 0xAA ) },
+		{ "mediumblue",           Color( 0x00, 0x00, 0xCD ) },
+		{ "mediumorchid",         Color( 0xBA, 0x55, 0xD3 ) },
+		{ "mediumpurple",         Color( 0x93, 0x70, 0xDB ) },
+		{ "mediumseagreen",       Color( 0x3C, 0xB3, 0x71 ) },
+		{ "mediumslateblue",      Color( 0x7B, 0x68, 0xEE ) },
+		{ "mediumspringgreen",    Color( 0x00, 0xFA, 0x9A ) },
+		{ "mediumturquoise",      Color( 0x48, 0xD1, 0xCC ) },
+		{ "mediumvioletred",      Color( 0xC7, 0x15, 0x85 ) },
+		{ "midnightblue",         Color( 0x19, 0x19, 0x70 ) },
+		{ "mintcream",            Color( 0xF5, 0xFF, 0xFA ) },
+		{ "mistyrose",            Color( 0xFF, 0xE4, 0xE1 ) },
+		{ "moccasin",             Color( 0xFF, 0xE4, 0xB5 ) },
+		{ "navajowhite",          Color( 0xFF, 0xDE, 0xAD ) },
+		{ "navy",                 Color( 0x00, 0x00, 0x80 ) },
+		{ "oldlace",              Color( 0xFD, 0xF5, 0xE6 ) },
+		{ "olive",                Color( 0x80, 0x80, 0x00 ) },
+		{ "olivedrab",            Color( 0x6B, 0x8E, 0x23 ) },
+		{ "orange",               Color( 0xFF, 0xA5, 0x00 ) },
+		{ "orangered",            Color( 0xFF, 0x45, 0x00 ) },
+		{ "orchid",               Color( 0xDA, 0x70, 0xD6 ) },
+		{ "palegoldenrod",        Color( 0xEE, 0xE8, 0xAA ) },
+		{ "palegreen",            Color( 0x98, 0xFB, 0x98 ) },
+		{ "paleturquoise",        Color( 0xAF, 0xEE, 0xEE ) },
+		{ "palevioletred",        Color( 0xDB, 0x70, 0x93 ) },
+		{ "papayawhip",           Color( 0xFF, 0xEF, 0xD5 ) },
+		{ "peachpuff",            Color( 0xFF, 0xDA, 0xB9 ) },
+		{ "peru",                 Color( 0xCD, 0x85, 0x3F ) },
+		{ "pink",                 Color( 0xFF, 0xC0, 0xCB ) },
+		{ "plum",                 Color( 0xDD, 0xA0, 0xDD ) },
+		{ "powderblue",           Color( 0xB0, 0xE0, 0xE6 ) },
+		{ "purple",               Color( 0x80, 0x00, 0x80 ) },
+		{ "rebeccapurple",        Color( 0x66, 0x33, 0x99 ) },
+		{ "red",                  Color( 0xFF, 0x00, 0x00 ) },
+		{ "rosybrown",            Color( 0xBC, 0x8F, 0x8F ) },
+		{ "royalblue",            Color( 0x41, 0x69, 0xE1 ) },
+		{ "saddlebrown",          Color( 0x8B, 0x45, 0x13 ) },
+		{ "salmon",               Color( 0xFA, 0x80, 0x72 ) },
+		{ "sandybrown",           Color( 0xF4, 0xA4, 0x60 ) },
+		{ "seagreen",             Color( 0x2E, 0x8B, 0x57 ) },
+		{ "seashell",             Color( 0xFF, 0xF5, 0xEE ) },
+		{ "sienna",               Color( 0xA0, 0x52, 0x2D ) },
+		{ "silver",               Color( 0xC0, 0xC0, 0xC0 ) },
+		{ "skyblue",              Color( 0x87, 0xCE, 0xEB ) },
+		{ "slateblue",            Color( 0x6A, 0x5A, 0xCD ) },
+		{ "slategray",            Color( 0x70, 0x80, 0x90 ) },
+		{ "slategrey",            Color( 0x70, 0x80, 0x90 ) },
+		{ "snow",                 Color( 0xFF, 0xFA, 0xFA ) },
+		{ "springgreen",          Color( 0x00, 0xFF, 0x7F ) },
+		{ "steelblue",            Color( 0x46, 0x82, 0xB4 ) },
+		{ "tan",                  Color( 0xD2, 0xB4, 0x8C ) },
+		{ "teal",                 Color( 0x00, 0x80, 0x80 ) },
+		{ "thistle",              Color( 0xD8, 0xBF, 0xD8 ) },
+		{ "tomato",               Color( 0xFF, 0x63, 0x47 ) },
+		{ "turquoise",            Color( 0x40, 0xE0, 0xD0 ) },
+		{ "violet",               Color( 0xEE, 0x82, 0xEE ) },
+		{ "wheat",                Color( 0xF5, 0xDE, 0xB3 ) },
+		{ "white",                Color( 0xFF, 0xFF, 0xFF ) },
+		{ "whitesmoke",           Color( 0xF5, 0xF5, 0xF5 ) },
+		{ "yellow",               Color( 0xFF, 0xFF, 0x00 ) },
+		{ "yellowgreen",          Color( 0x9A, 0xCD, 0x32 ) },
+	};
+
+	// Perfect hash of the names: the lowest 6 bits of the hash select a displacement that moves the names with these bits
+	// into distinct slots of a table of 256. The displacements were found by a brute force search, when the names change,
+	// the search has to be repeated, the static_assert in Color.cpp then fails until that's done.
+	static constexpr uint8_t nameDisplacements [64] =
+	{
+		  0,   0,   0,   0,   0,   1,   3,   0,   0,   1,   1,   0,   0,   3,   3,   2,
+		  0,   0,   1,  12,   0,   0,   2,   0,  12,   5,   0,   0,   0,   9,   5,   5,
+		  2,   0,   0,   0,   2,   0,   0,   0,   7,   0,   3,   0,   7,   4,   3,   3,
+		  0,   0,   1,   9,   0,   5,   0,   3,   0,   0,   0,   8,   1,   3,   1,   2,
+	};
+	static constexpr uint8_t nameSlots [256] =  ///< index into namedColors, 255 for an empty slot
+	{
+		255, 100,  99, 136, 139, 255,  75, 114, 118,  50, 128, 129, 255, 255, 111,  16,
+		 78,  80, 255, 255, 255,  45,  29, 255, 255,  34,  15, 255, 103, 255, 255, 255,
+		 96,  69, 255, 255,  48, 255,  44, 255, 255,  52, 255, 255,  14, 255, 255,  90,
+		123, 255,  25, 255, 255,  19, 117,  81, 255, 110,  39, 126, 101, 255,  94,   6,
+		255, 255,  97,  92, 255, 255, 255,  12,   7, 124, 143, 255, 255,  49,  41,  83,
+		255, 255,  42,  11, 255, 255, 255, 116, 255, 255, 109, 255,  40, 130,   5, 255,
+		 85, 255, 255,  79, 255, 255, 255, 255, 107, 125,  20, 255, 255,  54, 105, 255,
+		 22, 106,  72,   1, 255,  10,  27,  74,  32, 255, 113,  71, 255,  64, 255, 255,
+		121,  55,  28, 255,  51,  17,   8,  47,  56,  86,  70,  59, 255,  37,  26,  43,
+		255,  61, 255,   4, 255,  35, 255, 255, 108, 255, 255,  95,  38,   0, 255,  33,
+		138, 255, 255, 255, 255,  67, 255, 146,  63,  98, 255, 255, 255, 115, 255,  46,
+		 68,  62,  36, 255, 134, 119, 255,  65, 255, 255, 255, 255,  77, 255,  31,  87,
+		 13, 255,  89, 255,  30,  53, 255, 255, 255,  76, 112, 140,  24, 255,  82, 135,
+		133, 255, 255,  88, 145, 255, 102,   9, 131, 122, 255, 255, 255,  21, 255, 255,
+		141,   3, 104, 255, 142,  23, 137, 255, 255,  91,  84,  93, 255, 255, 255,  60,
+		255, 120, 255,  73,  18, 127, 132, 255, 255,  58,  57,   2, 255, 147,  66, 144,
+	};
+};
+template< typename Unused > constexpr NamedColor NameTables< Unused >::namedColors [];
+template< typename Unused > constexpr uint8_t NameTables< Unused >::nameDisplacements [64];
+template< typename Unused > constexpr uint8_t NameTables< Unused >::nameSlots [256];
+
+typedef NameTables<> ColorNames;
+
+constexpr size_t namedColorCount = sizeof( ColorNames::namedColors ) / sizeof( ColorNames::namedColors[0] );
+constexpr size_t maxNameLength = 20;  ///< "lightgoldenrodyellow"
+
+/// Case-insensitive FNV-1a hash of a name.
+constexpr uint32_t nameHash( const char * str, size_t length, uint32_t hash = 2166136261u ) noexcept
+{
+	return length == 0 ? hash : nameHash( str + 1, length - 1, (hash ^ uint8_t( *str | 0x20 )) * 16777619u );
+}
+
+constexpr uint8_t nameSlot( uint32_t hash ) noexcept
+{
+	return uint8_t( ((hash + ColorNames::nameDisplacements[ hash & 63 ]) * 0x9E3779B1u) >> 24 );
+}
+
+constexpr size_t checkNamedColor( const char * str, size_t length, uint8_t idx ) noexcept
+{
+	return idx != 255 && equalsName( str, length, ColorNames::namedColors[ idx ].name ) ? idx : namedColorCount;
+}
+
+/// Index into ColorNames::namedColors, or namedColorCount if there is no color of this name.
+/** Only one name is compared, the one in the slot the hash points to. */
+constexpr size_t findNamedColor( const char * str, size_t length ) noexcept
+{
+	return length > maxNameLength ? namedColorCount : checkNamedColor( str, length, ColorNames::nameSlots[ nameSlot( nameHash( str, length ) ) ] );
+}
+
+/// Intentionally not constexpr, calling it during compile-time evaluation is what makes an invalid literal an error.
+Color invalidColorLiteral( const char * literal ) noexcept;
+
+constexpr Color parseColorLiteral( const char * str, size_t length ) noexcept
+{
+	return length == 7 && str[0] == '#' && areHexDigits( str + 1, 6 ) ? hexColor( str + 1 )
+	     : length == 4 && str[0] == '#' && areHexDigits( str + 1, 3 ) ? shortHexColor( str + 1 )
+	     : length == 6 && areHexDigits( str, 6 ) ? hexColor( str )
+	     : findNamedColor( str, length ) != namedColorCount ? ColorNames::namedColors[ findNamedColor( str, length ) ].color
+	     : invalidColorLiteral( str );
+}
+
+} // namespace impl
+
+
+inline namespace literals {
+
+/// Color literal in the hex and name formats of Color::fromString(), for example "#FF8800"_rgb or "cyan"_rgb.
+/** When used in a constant expression, for example to initialize a constexpr variable or a static table,
+  * the literal is parsed by the compiler and an invalid one is a compile error. Elsewhere an invalid literal
+  * can only be detected at runtime, it then gives black. */
+constexpr Color operator"" _rgb( const char * str, size_t length ) noexcept
+{
+	return impl::parseColorLiteral( str, length );
+}
+
+} // namespace literals
+
+
 //======================================================================================================================
 
 
@@ -0,0 +1,180 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: bulk operations over whole frames of colors
+//======================================================================================================================
+
+#ifndef OPENRGB_COLOR_OPS_INCLUDED
+#define OPENRGB_COLOR_OPS_INCLUDED
+
+
+#include "Color.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Operations over contiguous arrays of colors, like Device::colors or the frames an effect renders every tick.
+/** The operations are implemented with SSE2, AVX2 or NEON instructions depending on what the CPU supports,
+  * the best implementation is selected on the first call. All of them accept the destination being the same
+  * array as one of the sources, so they can work in place. Partial overlap of the arrays is not supported.
+  *
+  * The padding byte of Color is treated as a fourth channel by fill(), addSaturated() and lerp(),
+  * blend() uses it as alpha, scale() and applyLUT() leave it unchanged. */
+
+namespace colorops {
+
+
+/// Instruction set used to implement the operations.
+enum class SimdLevel : uint8_t
+{
+	Scalar,  ///< plain C++, always available
+	SSE2,
+	AVX2,
+	NEON,
+};
+const char * enumString( SimdLevel level ) noexcept;
+
+/// The instruction set that is currently used.
+SimdLevel simdLevel() noexcept;
+
+/// Whether the CPU and the compiler support this instruction set.
+bool isSupported( SimdLevel level ) noexcept;
+
+/// Forces a specific instruction set, for example to compare the performance or to rule out a bug in the SIMD code.
+/** \returns false when the level is not supported, the current one is kept then. */
+bool setSimdLevel( SimdLevel level ) noexcept;
+
+
+//-- operations --------------------------------------------------------------------------------------------------------
+
+/// Sets all colors to the same value.
+void fill( Color * dst, size_t count, Color color ) noexcept;
+
+/// Multiplies every channel by a factor, where 255 keeps the value and 0 makes it black.
+/** Each channel has its own factor, use the same value in all of them to change the brightness. */
+void scale( Color * dst, const Color * src, size_t count, Color factor ) noexcept;
+
+/// Multiplies all channels by the same factor, where 255 keeps the brightness and 0 makes it black.
+inline void scale( Color * dst, const Color * src, size_t count, uint8_t brightness ) noexcept
+{
+	scale( dst, src, count, Color( brightness, brightness, brightness ) );
+}
+
+/// Adds the colors channel by channel, the sums are clamped to 255.
+void addSaturated( Color * dst, const Color * a, const Color * b, size_t count ) noexcept;
+
+/// Crossfades from frame \p a to frame \p b, 0 gives exactly \p a and 255 gives exactly \p b.
+void lerp( Color * dst, const Color * a, const Color * b, size_t count, uint8_t amount ) noexcept;
+
+
+//-- compositing -------------------------------------------------------------------------------------------------------
+
+/// How a layer is combined with the colors below it, see blend().
+enum class BlendMode : uint8_t
+{
+	Normal,    ///< the layer covers the colors below
+	Add,       ///< the colors are added, the sums are clamped to 255
+	Multiply,  ///< the colors are multiplied, which can only make them darker
+	Screen,    ///< the inverted colors are multiplied, which can only make them lighter
+	Lighten,   ///< the lighter of the two values in every channel
+};
+const char * enumString( BlendMode mode ) noexcept;
+
+/// Blends a layer over a frame, the padding byte of the layer's colors is used as their alpha.
+/** Every channel becomes lerp( dst, mode( dst, src ), alpha * opacity ), so alpha 0 leaves the destination
+  * unchanged and alpha 255 with opacity 255 gives the full result of the blend mode. The padding of the destination
+  * stays unchanged. */
+void blend( Color * dst, const Color * src, size_t count, BlendMode mode, uint8_t opacity ) noexcept;
+
+
+//-- color models ------------------------------------------------------------------------------------------------------
+
+/// Converts a frame from the hue, saturation, value model, the results are exactly the same as from Color::fromHSV().
+/** The pure hues are taken from a table and only the saturation and value are applied with vector instructions,
+  * so rainbow effects over thousands of LEDs cost about the same as scale(). */
+void fromHSV( Color * dst, const HSV * src, size_t count ) noexcept;
+
+/// Converts a frame to the hue, saturation, value model, the results are exactly the same as from Color::toHSV().
+void toHSV( HSV * dst, const Color * src, size_t count ) noexcept;
+
+
+//-- lookup tables -----------------------------------------------------------------------------------------------------
+
+/// Maps every 8-bit value of a channel to a new one, typically to apply gamma correction.
+struct ChannelLUT
+{
+	uint8_t values [256];
+
+	/// Table that keeps the values unchanged.
+	static ChannelLUT identity() noexcept;
+
+	/// Table of the function 255 * (x / 255) ^ gamma, rounded to the nearest integer.
+	/** Values above 1.0 make the colors darker and the dark shades more distinct, which is what most LEDs need.
+	  * Zero, negative values and NaN have no meaningful table, they give the identity(). */
+	static ChannelLUT gamma( float gamma ) noexcept;
+};
+
+/// Replaces every index with the color at that index of a table of 256 colors, typically the table of a Palette.
+/** With AVX2 the colors are loaded by gather instructions, 8 at once. */
+void lookup( Color * dst, const uint8_t * indexes, size_t count, const Color * table ) noexcept;
+
+/// Replaces every position with a color interpolated between two neighbouring entries of a table of 257 colors.
+/** The high byte of the position selects the entry and the low byte is the fraction towards the next one,
+  * so the table needs one more entry at the end. All 4 bytes of the colors are interpolated. */
+void lookupInterpolated( Color * dst, const uint16_t * positions, size_t count, const Color * table ) noexcept;
+
+/// Replaces every channel of every color with the value from the table.
+/** Table lookups can't be vectorized with these instruction sets, but the loop is simple enough for
+  * the compiler to unroll it, so this is still a lot faster than calling pow() per LED. */
+void applyLUT( Color * dst, const Color * src, size_t count, const ChannelLUT & lut ) noexcept;
+
+/// Replaces every channel of every color with the value from the table of that channel.
+void applyLUT( Color * dst, const Color * src, size_t count, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept;
+
+
+//-- color correction --------------------------------------------------------------------------------------------------
+
+/// 3x3 matrix that mixes the channels of a color, in fixed point with 8 fractional bits, so 256 means 1.0.
+/** Row 0 gives the new red as a weighted sum of the old red, green and blue, rows 1 and 2 give the green and blue. */
+struct ColorMatrix
+{
+	int16_t values [3][3];
+
+	/// Matrix that keeps the colors unchanged.
+	static ColorMatrix identity() noexcept;
+
+	/// Converts a matrix of real numbers, the values are rounded to 1/256 and clamped to -128.0 .. 127.99, NaN becomes 0.
+	static ColorMatrix fromFloats( const float (& values) [3][3] ) noexcept;
+};
+
+/// Multiplies every color by the matrix, clamps the channels to 0..255 and then replaces them with the values
+/// from the tables, all in a single pass over the frame. The padding stays unchanged.
+/** This is what Calibration uses to correct the colors before they are sent to a device. */
+void transform( Color * dst, const Color * src, size_t count, const ColorMatrix & matrix, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept;
+
+
+//-- images ------------------------------------------------------------------------------------------------------------
+
+/// Adds up the bytes at every position within a pixel over a row of an image, to average the colors of its areas.
+/** \param bytesPerPixel 3 for packed RGB or BGR, 4 for RGBA, BGRA and alike, other values work too but are not vectorized
+  * \param sums one sum per byte of a pixel, the row is added to them, so an area can be summed row by row into
+  *        the same array, 32 bits are enough for 16 million pixels */
+void sumPixels( const uint8_t * pixels, size_t pixelCount, uint32_t bytesPerPixel, uint32_t * sums ) noexcept;
+
+
+} // namespace colorops
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_COLOR_OPS_INCLUDED
@@ -0,0 +1,139 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: stable identifiers of devices, zones and LEDs that survive device list updates
+//======================================================================================================================
+
+#ifndef OPENRGB_DEVICE_ID_INCLUDED
+#define OPENRGB_DEVICE_ID_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+// Device::idx, Zone::parentIdx and LED::parentIdx are positions in the server's device list, so they point
+// to a different device when a device before it is plugged in or out. These identifiers are derived from the serial,
+// location and name of the device instead, so they can be stored for a long time and resolved to the current
+// objects after every update of the device list using IdResolver.
+
+/// Stable identifier of a device, see IdResolver.
+struct DeviceId
+{
+	uint64_t value;  ///< hash of the device's identity, 0 means no device
+
+	DeviceId() noexcept : value( 0 ) {}
+	explicit DeviceId( uint64_t value ) noexcept : value( value ) {}
+
+	bool isValid() const noexcept  { return value != 0; }
+
+	friend bool operator==( DeviceId a, DeviceId b ) noexcept  { return a.value == b.value; }
+	friend bool operator!=( DeviceId a, DeviceId b ) noexcept  { return a.value != b.value; }
+};
+
+/// Stable identifier of a zone, see IdResolver.
+struct ZoneId
+{
+	DeviceId device;
+	uint32_t zoneIdx;  ///< index of the zone within the device
+
+	ZoneId() noexcept : zoneIdx( 0 ) {}
+	ZoneId( DeviceId device, uint32_t zoneIdx ) noexcept : device( device ), zoneIdx( zoneIdx ) {}
+
+	bool isValid() const noexcept  { return device.isValid(); }
+
+	friend bool operator==( ZoneId a, ZoneId b ) noexcept  { return a.device == b.device && a.zoneIdx == b.zoneIdx; }
+	friend bool operator!=( ZoneId a, ZoneId b ) noexcept  { return !(a == b); }
+};
+
+/// Stable identifier of an LED, see IdResolver.
+struct LedId
+{
+	DeviceId device;
+	uint32_t ledIdx;  ///< index of the LED within the device
+
+	LedId() noexcept : ledIdx( 0 ) {}
+	LedId( DeviceId device, uint32_t ledIdx ) noexcept : device( device ), ledIdx( ledIdx ) {}
+
+	bool isValid() const noexcept  { return device.isValid(); }
+
+	friend bool operator==( LedId a, LedId b ) noexcept  { return a.device == b.device && a.ledIdx == b.ledIdx; }
+	friend bool operator!=( LedId a, LedId b ) noexcept  { return !(a == b); }
+};
+
+
+//======================================================================================================================
+/// Translates the stable identifiers to the objects in the current device list.
+/** Call update() every time the device list is downloaded or refreshed, after that every resolve() is
+  * a single hash map lookup. The resolver keeps a pointer to the list passed to update(), so the list must stay
+  * alive and unchanged until the next update().
+  *
+  * When there are more devices with the same serial, location and name, they are told apart by their order.
+  *
+  * The devices are indexed by their position in the list, which is usually the same as Device::idx,
+  * but doesn't have to be, for example in a list assembled by DeviceList::append(). */
+
+class IdResolver
+{
+
+ public:
+
+	IdResolver() noexcept : _devices( nullptr ) {}
+	explicit IdResolver( const DeviceList & devices )  { update( devices ); }
+
+	/// Rebuilds the mapping for a new version of the device list.
+	void update( const DeviceList & devices );
+
+	/// Identifier of the device at a specific position in the current list.
+	/** \returns invalid id when the position is out of range */
+	DeviceId deviceId( uint32_t position ) const noexcept  { return position < _ids.size() ? _ids[ position ] : DeviceId(); }
+
+	/// Identifiers of the objects of the current list.
+	/** \returns invalid id when the object is not from the current list */
+	DeviceId deviceId( const Device & device ) const noexcept;
+	ZoneId zoneId( const Zone & zone ) const noexcept;
+	LedId ledId( const LED & led ) const noexcept;
+
+	/// Finds the device in the current list.
+	/** \returns nullptr when the device is no longer present. */
+	const Device * resolve( DeviceId id ) const noexcept;
+
+	/// Finds the zone in the current list.
+	/** \returns nullptr when the device is no longer present or it has fewer zones now. */
+	const Zone * resolve( ZoneId id ) const noexcept;
+
+	/// Finds the LED in the current list.
+	/** \returns nullptr when the device is no longer present or it has fewer LEDs now. */
+	const LED * resolve( LedId id ) const noexcept;
+
+ private:
+
+	/// Position of the device in the current list that the object belongs to, or npos.
+	uint32_t positionOf( const Device & device ) const noexcept;
+	template< typename Object >
+	uint32_t positionOf( const Object & object, const std::vector< Object > Device::* objects ) const noexcept;
+
+	static constexpr uint32_t npos = UINT32_MAX;
+
+	const DeviceList * _devices;
+	std::vector< DeviceId > _ids;  ///< position in the list -> id
+	std::unordered_map< uint64_t, uint32_t > _positions;  ///< id -> position in the list
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_DEVICE_ID_INCLUDED
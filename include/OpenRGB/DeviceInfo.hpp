@@ -12,6 +12,8 @@
 #include "OpenRGB/Exceptions.hpp"
 
 #include "Color.hpp"
+#include "StringView.hpp"
+#include "SmallVector.hpp"
 
 #include <string>
 #include <vector>
@@ -21,6 +23,11 @@
 namespace orgb {
 
 
+struct DeviceIndex;
+struct DeviceListIndex;
+struct LedNames;
+
+
 //======================================================================================================================
 //  enums
 
@@ -104,12 +111,13 @@ class LED
 	const uint32_t parentIdx;  ///< index of the parent device in the device list
 
 	// LED description
-	const std::string  name;
+	const std::string  name;   ///< empty when the device was parsed with DeviceListOptions::lazyLedNames, see Device::ledName()
 	const uint32_t     value;  ///< device-specific value
 
  private:  // for internal use only
 
 	friend struct protocol;
+	friend class Device;
 	LED();
 	size_t calcSize( uint32_t protocolVersion ) const noexcept;
 	void serialize( own::BinaryOutputStream & stream, uint32_t protocolVersion ) const;
@@ -139,7 +147,22 @@ class Zone
 	// optional
 	const uint32_t     matrix_height;  ///< if the zone type is matrix, this is its height
 	const uint32_t     matrix_width;   ///< if the zone type is matrix, this is its width
-	const std::vector< uint32_t >  matrix_values;  ///< TODO: what is this?
+	/// if the zone type is matrix, this maps its positions (row by row) to indexes of LEDs within this zone,
+	/// positions without a LED have value noLED
+	const std::vector< uint32_t >  matrix_values;
+
+	// derived from the description above, so that it doesn't have to be calculated by every application
+	const uint32_t     startIdx;       ///< index of the first LED of this zone in the device's list of LEDs and colors
+	/// matrix_values converted to indexes into the device's list of LEDs and colors, noLED where there is no LED
+	const std::vector< uint32_t >  matrix_leds;
+
+	/// Value of matrix_values and matrix_leds at positions where there is no LED.
+	static constexpr uint32_t noLED = UINT32_MAX;
+
+	/// Index of the LED at a position of the matrix, into the device's list of LEDs and colors.
+	/** The caller is responsible for the position being within matrix_height and matrix_width.
+	  * \returns noLED when there is no LED at this position */
+	uint32_t ledAt( uint32_t row, uint32_t col ) const noexcept  { return matrix_leds[ row * matrix_width + col ]; }
 
  private:  // for internal use only
 
@@ -189,7 +212,8 @@ class Mode
 	      Direction     direction;
 	const ColorMode     color_mode;  ///< how the colors of a mode are set
 	/// Mode-specific list of colors.
-	      std::vector< Color >  colors;
+	/** Modes rarely have more than a few colors, so they are stored inside the Mode object without allocating. */
+	      SmallVector< Color, 4 >  colors;
 
  private:  // for internal use only
 
@@ -205,6 +229,60 @@ class Mode
 };
 
 
+//======================================================================================================================
+/// Options of how the devices are parsed from the server's replies.
+
+struct DeviceListOptions
+{
+	/// Don't create a separate std::string for the name of every LED.
+	/** The names of all LEDs of a device are then kept in a single buffer and LED::name stays empty,
+	  * use Device::ledName() to read them and Device::hasLedNames() to find out which way a device was parsed.
+	  * This saves time and memory with devices that have thousands of LEDs. */
+	bool lazyLedNames;
+
+	DeviceListOptions() noexcept : lazyLedNames( false ) {}
+};
+
+
+//======================================================================================================================
+/// How much memory the description of devices occupies, see Device::memoryUsage() and memoryUsage( const DeviceList & ).
+/** This is an estimate computed from the sizes and capacities of the containers, the overhead of the heap allocator
+  * and the search indexes that are built on demand are not included. */
+
+struct MemoryUsage
+{
+	/// Bytes occupied by one kind of objects.
+	struct Breakdown
+	{
+		size_t objects;  ///< the objects themselves, including the unused capacity of the vectors that hold them
+		size_t strings;  ///< heap buffers of their strings, short strings stored inside the string object count as 0
+		size_t vectors;  ///< heap buffers of the vectors they own
+
+		Breakdown() noexcept : objects( 0 ), strings( 0 ), vectors( 0 ) {}
+
+		size_t total() const noexcept  { return objects + strings + vectors; }
+
+		Breakdown & operator+=( const Breakdown & other ) noexcept;
+	};
+
+	Breakdown devices;  ///< Device objects, their strings and their lists of colors
+	Breakdown modes;    ///< Mode objects, their names and the mode colors that don't fit inside the Mode object
+	Breakdown zones;    ///< Zone objects, their names, matrix_values and matrix_leds
+	Breakdown leds;     ///< LED objects and their names, also the ones stored by DeviceListOptions::lazyLedNames
+
+	size_t deviceCount;
+	size_t modeCount;
+	size_t zoneCount;
+	size_t ledCount;
+
+	MemoryUsage() noexcept : deviceCount( 0 ), modeCount( 0 ), zoneCount( 0 ), ledCount( 0 ) {}
+
+	size_t total() const noexcept  { return devices.total() + modes.total() + zones.total() + leds.total(); }
+
+	MemoryUsage & operator+=( const MemoryUsage & other ) noexcept;
+};
+
+
 //======================================================================================================================
 /// Represents an RGB-capable device. Device can have modes, zones and individual LEDs.
 
@@ -236,65 +314,43 @@ class Device
 
 	/// Finds the first mode with a specific name.
 	/** \returns nullptr when mode with this name is not found. */
-	const Mode * findMode( const std::string & name ) const noexcept
-	{
-		for (const auto & mode : modes)
-			if (mode.name == name)
-				return &mode;
-		return nullptr;
-	}
+	const Mode * findMode( const std::string & name ) const noexcept;
 
 	/// Finds the first zone with a specific name.
 	/** \returns nullptr when zone with this name is not found. */
-	const Zone * findZone( const std::string & name ) const noexcept
-	{
-		for (const auto & zone : zones)
-			if (zone.name == name)
-				return &zone;
-		return nullptr;
-	}
+	const Zone * findZone( const std::string & name ) const noexcept;
 
 	/// Finds the first LED with a specific name.
 	/** \returns nullptr when LED with this name is not found. */
-	const LED * findLED( const std::string & name ) const noexcept
-	{
-		for (const auto & led : leds)
-			if (led.name == name)
-				return &led;
-		return nullptr;
-	}
+	const LED * findLED( const std::string & name ) const noexcept;
+
+	/// Name of an LED, works also when LED::name was left empty because of DeviceListOptions::lazyLedNames.
+	/** The caller is responsible for the index being in range. */
+	StringView ledName( uint32_t ledIdx ) const noexcept;
+
+	/// Whether the LED names are stored only in a shared buffer, see DeviceListOptions::lazyLedNames.
+	bool hasLazyLedNames() const noexcept  { return _ledNames != nullptr; }
+
+	/// Whether LED::name of every LED is filled, otherwise the names can only be read by ledName().
+	bool hasLedNames() const noexcept  { return _ledNames == nullptr; }
+
+	/// How much memory the description of this device occupies.
+	/** The buffer of DeviceListOptions::lazyLedNames is counted whole even when it's shared with copies of the device. */
+	MemoryUsage memoryUsage() const noexcept;
 
 #ifndef NO_EXCEPTIONS
 
 	/// Exception-throwing variant of findModeX( const std::string & ) const.
 	/** \throws NotFound when mode with this name is not found. */
-	const Mode & findModeX( const std::string & name ) const
-	{
-		for (const auto & mode : modes)
-			if (mode.name == name)
-				return mode;
-		throw NotFound( "Mode of such name was not found" );
-	}
+	const Mode & findModeX( const std::string & name ) const;
 
 	/// Exception-throwing variant of findZoneX( const std::string & ) const.
 	/** \throws NotFound when zone with this name is not found. */
-	const Zone & findZoneX( const std::string & name ) const
-	{
-		for (const auto & zone : zones)
-			if (zone.name == name)
-				return zone;
-		throw NotFound( "Zone of such name was not found" );
-	}
+	const Zone & findZoneX( const std::string & name ) const;
 
 	/// Exception-throwing variant of findLEDX( const std::string & ) const.
 	/** \throws NotFound when LED with this name is not found. */
-	const LED & findLEDX( const std::string & name ) const
-	{
-		for (const auto & led : leds)
-			if (led.name == name)
-				return led;
-		throw NotFound( "LED of such name was not found" );
-	}
+	const LED & findLEDX( const std::string & name ) const;
 
 #endif // NO_EXCEPTIONS
 
@@ -303,14 +359,40 @@ class Device
 	friend struct ReplyControllerData;
 	size_t calcSize( uint32_t protocolVersion ) const noexcept;
 	void serialize( own::BinaryOutputStream & stream, uint32_t protocolVersion ) const;
-	bool deserialize( own::BinaryInputStream & stream, uint32_t protocolVersion, uint32_t deviceIdx ) noexcept;
+	bool deserialize( own::BinaryInputStream & stream, uint32_t protocolVersion, uint32_t deviceIdx, const DeviceListOptions & options = DeviceListOptions() ) noexcept;
+	bool deserializeLazyLeds( own::BinaryInputStream & stream, uint32_t deviceIdx ) noexcept;
 
 	friend class DeviceList;
+	friend class DeviceView;
+	friend class DeviceListCache;
 	friend class Client;
 	Device();
 	Device( const Device & other ) = default;
 	Device( Device && other ) = default;
 
+	std::shared_ptr< const DeviceIndex > buildIndex() const;
+	std::shared_ptr< const DeviceIndex > index() const noexcept;  ///< nullptr when there is not enough memory to build it
+
+	/// Moves the device to a different position in the device list.
+	void setIdx( uint32_t deviceIdx ) noexcept;
+
+	/// Remembers the hashes of the raw server reply this device was parsed from, so that its changes can be detected.
+	void hashReply( const std::vector< uint8_t > & replyBody, uint32_t protocolVersion ) noexcept;
+
+	/// hash of the raw server reply this device was parsed from, 0 when unknown
+	uint64_t _contentHash;
+	/// hash of the same reply without the current state (active mode and colors), 0 when unknown
+	uint64_t _descriptionHash;
+
+	/// name -> index maps of the modes, zones and LEDs, built on first search
+	/** The content of the device never changes, so the copies can share it. It's accessed only by std::atomic_load
+	  * and std::atomic_compare_exchange_strong, so that concurrent searches are safe. */
+	mutable std::shared_ptr< const DeviceIndex > _index;
+
+	/// names of all LEDs when parsed with DeviceListOptions::lazyLedNames, otherwise nullptr
+	/** The copies of the device share it, so it's modified only when this device is the only owner. */
+	std::shared_ptr< LedNames > _ledNames;
+
 };
 
 
@@ -348,12 +430,12 @@ class DeviceList
 	size_t size() const noexcept { return _list.size(); }
 
 	/// Use this if you intend to populate the DeviceList manually using individual calls to Client::requestDeviceInfo().
-	void append( std::unique_ptr< Device > && device )  { _list.push_back( std::move(device) ); }
+	void append( std::unique_ptr< Device > && device )  { _list.push_back( std::move(device) ); _index.reset(); }
 
 	/// Use this to update your DeviceList after the call to Client::requestDeviceInfo().
-	void replace( uint32_t deviceIdx, std::unique_ptr< Device > && device )  { _list[ deviceIdx ] = std::move(device); }
+	void replace( uint32_t deviceIdx, std::unique_ptr< Device > && device )  { _list[ deviceIdx ] = std::move(device); _index.reset(); }
 
-	void clear() noexcept  { _list.clear(); }
+	void clear() noexcept  { _list.clear(); _index.reset(); }
 
 	PointerIterator< DeviceListType::const_iterator > begin() const noexcept  { return _list.begin(); }
 	PointerIterator< DeviceListType::const_iterator > end() const noexcept    { return _list.end(); }
@@ -364,74 +446,74 @@ class DeviceList
 	template< typename FuncType >
 	void forEach( DeviceType deviceType, FuncType loopBody ) const
 	{
-		for (const Device & device : *this)
-			if (device.type == deviceType)
-				loopBody( device );
+		if (std::shared_ptr< const std::vector< uint32_t > > deviceIndexes = devicesOfType( deviceType ))
+			for (uint32_t deviceIdx : *deviceIndexes)
+				loopBody( *_list[ deviceIdx ] );
 	}
 
 	/// Iterate over all devices of specific vendor.
 	template< typename FuncType >
 	void forEach( const std::string & vendor, FuncType loopBody ) const
 	{
-		for (const Device & device : *this)
-			if (device.vendor == vendor)
-				loopBody( device );
+		if (std::shared_ptr< const std::vector< uint32_t > > deviceIndexes = devicesOfVendor( vendor ))
+			for (uint32_t deviceIdx : *deviceIndexes)
+				loopBody( *_list[ deviceIdx ] );
 	}
 
 	/// Finds the first device of specific type.
 	/** \returns nullptr when device of this type is not found */
-	const Device * find( DeviceType deviceType ) const noexcept
-	{
-		for (const Device & device : *this)
-			if (device.type == deviceType)
-				return &device;
-		return nullptr;
-	}
+	const Device * find( DeviceType deviceType ) const noexcept;
 
 	/// Finds the first device with a specific name.
 	/** \returns nullptr when device with this name is not found */
-	const Device * find( const std::string & deviceName ) const noexcept
-	{
-		for (const Device & device : *this)
-			if (device.name == deviceName)
-				return &device;
-		return nullptr;
-	}
+	const Device * find( const std::string & deviceName ) const noexcept;
 
 #ifndef NO_EXCEPTIONS
 
 	/// Exception-throwing variant of find( DeviceType ) const
 	/** \throws NotFound when device of this type is not found */
-	const Device & findX( DeviceType deviceType ) const
-	{
-		for (const Device & device : *this)
-			if (device.type == deviceType)
-				return device;
-		throw NotFound( "Device of such type was not found" );
-	}
+	const Device & findX( DeviceType deviceType ) const;
 
 	/// Exception-throwing variant of find( const std::string & ) const.
 	/** \throws NotFound when device with this name is not found */
-	const Device & findX( const std::string & deviceName ) const
-	{
-		for (const Device & device : *this)
-			if (device.name == deviceName)
-				return device;
-		throw NotFound( "Device of such name was not found" );
-	}
+	const Device & findX( const std::string & deviceName ) const;
 
 #endif // NO_EXCEPTIONS
 
+	/// Builds the search indexes of the list and of all its devices right away.
+	/** The indexes are otherwise built lazily on the first search, which makes the first search slower.
+	  * Searching from multiple threads at the same time is safe either way. */
+	void buildIndexes() const;
+
  private:  // for internal use only
 
 	// this should only be used by the Client when constructing the list from the server response
 	friend class Client;
+	friend class DeviceListCache;
 	void reserve( size_t newSize )   { _list.reserve( newSize ); }
-	void append( Device && device )  { _list.emplace_back( new Device( std::move(device) ) ); }
+	void append( Device && device )  { _list.emplace_back( new Device( std::move(device) ) ); _index.reset(); }
+
+	std::shared_ptr< const DeviceListIndex > indexX() const;
+	std::shared_ptr< const DeviceListIndex > index() const noexcept;  ///< nullptr when there is not enough memory to build it
+	std::shared_ptr< const std::vector< uint32_t > > devicesOfType( DeviceType deviceType ) const;
+	std::shared_ptr< const std::vector< uint32_t > > devicesOfVendor( const std::string & vendor ) const;
+
+	friend MemoryUsage memoryUsage( const DeviceList & devices ) noexcept;
+
+ private:
+
+	/// name -> device, type -> devices and vendor -> devices maps, built on first search after the list has changed
+	/** Accessed by std::atomic_load and std::atomic_compare_exchange_strong from the const methods,
+	  * like Device::_index. */
+	mutable std::shared_ptr< const DeviceListIndex > _index;
 
 };
 
 
+/// How much memory the description of all the devices in the list occupies.
+MemoryUsage memoryUsage( const DeviceList & devices ) noexcept;
+
+
 //======================================================================================================================
 //  printing utils
 
@@ -439,11 +521,13 @@ void print( const Device & device, unsigned int indentLevel = 0 );
 void print( const Mode & mode, unsigned int indentLevel = 0 );
 void print( const Zone & zone, unsigned int indentLevel = 0 );
 void print( const LED & led, unsigned int indentLevel = 0 );
+void print( const MemoryUsage & usage, unsigned int indentLevel = 0 );
 
 void print( std::ostream & os, const Device & device, unsigned int indentLevel = 0 );
 void print( std::ostream & os, const Mode & mode, unsigned int indentLevel = 0 );
 void print( std::ostream & os, const Zone & zone, unsigned int indentLevel = 0 );
 void print( std::ostream & os, const LED & led, unsigned int indentLevel = 0 );
+void print( std::ostream & os, const MemoryUsage & usage, unsigned int indentLevel = 0 );
 
 
 //======================================================================================================================
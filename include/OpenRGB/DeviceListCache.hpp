@@ -0,0 +1,159 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: persistent on-disk cache of a device list
+//======================================================================================================================
+
+#ifndef OPENRGB_DEVICE_LIST_CACHE_INCLUDED
+#define OPENRGB_DEVICE_LIST_CACHE_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "StringView.hpp"
+
+#include <string>
+#include <cstdint>
+#include <memory>
+
+
+namespace orgb {
+
+
+class MappedFile;
+
+
+//======================================================================================================================
+
+/// All the possible ways how an operation with the device list cache can end up
+enum class CacheStatus
+{
+	Success,      ///< The operation was successful.
+	NotFound,     ///< The cache file does not exist yet.
+	Invalid,      ///< The cache file is corrupted or was written by an incompatible version of this library.
+	OutOfDate,    ///< The cache file belongs to a different server or the number of devices has changed since.
+	Untrusted,    ///< The cache file is not a regular file owned by the current user, or other users can write into it.
+	SystemError,  ///< The cache file could not be opened, read or written.
+};
+const char * enumString( CacheStatus status ) noexcept;
+
+/// Result and output of loading the device list cache
+struct CachedDeviceListResult
+{
+	CacheStatus status;  ///< whether the cache was loaded or why it wasn't
+	DeviceList devices;  ///< output of a successfull load
+};
+
+
+//======================================================================================================================
+/// Binary file storing a device list of a particular server, so that short-lived processes don't need to download it.
+/** The file is keyed by the server endpoint and for every device it stores the description in the protocol format
+  * together with the fingerprints of the server's original reply. The fingerprints are restored into the loaded
+  * devices, so a list loaded from the cache can be brought up to date by Client::refreshDeviceList() with only
+  * the changed devices being parsed again.
+  *
+  * An opened cache file is memory-mapped and only its header and the table of devices are read right away.
+  * The devices are parsed one by one on demand, so a process that needs just one device can look it up by name
+  * and parse only that one, see open(), findDevice() and loadDevice(). Before a device is parsed, its data are
+  * checked against the stored checksum and after it's parsed, it's checked against the stored fingerprint().
+  *
+  * Whether the cache is still valid can only be cheaply checked by comparing the number of devices with the server.
+  * Changes that keep the number of devices the same are detected by comparing the fingerprint() of a cached device
+  * with the device on the server, see Client::verifyCachedDevice(), or by Client::refreshDeviceList().
+  *
+  * The cache is only loaded from a regular file owned by the current user, which other users can't write into,
+  * and it's saved via a newly created temporary file, so that other users can't make the process parse a file
+  * of their choice or overwrite some other file through a symbolic link. Because save() replaces the file instead
+  * of writing into it, a file that is mapped by another process is never truncated under its hands. */
+
+class DeviceListCache
+{
+
+ public:
+
+	/// Default location of the cache file for a particular server, in the cache directory of the current user.
+	/** That is $XDG_CACHE_HOME or ~/.cache on Linux and %LOCALAPPDATA% on Windows.
+	  * \returns empty string when the current user has no such directory */
+	static std::string defaultFilePath( const std::string & host, uint16_t port );
+
+	/// Writes the device list into a cache file, replacing the previous one.
+	/** The missing directories on the path are created accessible only by the current user.
+	  * \param endpoint identifier of the server the device list came from, usually "host:port" */
+	static CacheStatus save( const std::string & filePath, const std::string & endpoint, const DeviceList & devices ) noexcept;
+
+	/// Loads the whole device list from a cache file, if it matches the given server and number of devices.
+	/** This is a shortcut for open() followed by loadDevice() of every device.
+	  * \param endpoint must be the same as the one used when saving the cache
+	  * \param expectedDeviceCount the current number of devices on the server, see Client::requestDeviceCount()
+	  * \param options how to parse the cached devices */
+	static CachedDeviceListResult load(
+		const std::string & filePath, const std::string & endpoint, uint32_t expectedDeviceCount,
+		const DeviceListOptions & options = DeviceListOptions()
+	) noexcept;
+
+	/// Summary of the parts of a device that the cached device must have the same as the device on the server.
+	/** It consists of the type, the name and the number of zones and LEDs, so that when a device is replaced
+	  * by a different one at the same index, the cached device is not used to address LEDs the new one doesn't have. */
+	static uint64_t fingerprint( const Device & device ) noexcept;
+
+	//-- lazy access ---------------------------------------------------------------------------------------------------
+
+	DeviceListCache() noexcept;
+	~DeviceListCache() noexcept;
+
+	DeviceListCache( const DeviceListCache & other ) = delete;
+	DeviceListCache & operator=( const DeviceListCache & other ) = delete;
+
+	/// Maps a cache file into memory, if it matches the given server and number of devices.
+	/** Only the header and the table of devices are checked, none of the devices is parsed yet.
+	  * \param endpoint must be the same as the one used when saving the cache
+	  * \param expectedDeviceCount the current number of devices on the server, see Client::requestDeviceCount() */
+	CacheStatus open(
+		const std::string & filePath, const std::string & endpoint, uint32_t expectedDeviceCount
+	) noexcept;
+
+	/// Unmaps the file, which invalidates all the names returned by deviceName().
+	void close() noexcept;
+
+	bool isOpen() const noexcept  { return _file != nullptr; }
+
+	/// Number of devices in the opened cache file, 0 when no file is opened.
+	uint32_t deviceCount() const noexcept  { return _deviceCount; }
+
+	/// Name of a cached device read directly from the mapped file, without parsing or verifying the device.
+	/** The name is valid until the file is closed.
+	  * \returns empty string when the device index is out of range or the device data are malformed */
+	StringView deviceName( uint32_t deviceIdx ) const noexcept;
+
+	/// Finds the first cached device with a specific name, without parsing any device.
+	/** \returns index of the device or UINT32_MAX when device with this name is not found */
+	uint32_t findDevice( StringView name ) const noexcept;
+
+	/// Parses a single device from the opened cache file.
+	/** \param options how to parse the device
+	  * \returns nullptr when the device index is out of range, the device data don't match their checksum
+	  *          or the parsed device doesn't match its fingerprint() */
+	std::unique_ptr< Device > loadDevice(
+		uint32_t deviceIdx, const DeviceListOptions & options = DeviceListOptions()
+	) const noexcept;
+
+ private:
+
+	struct DeviceEntry;
+	bool readDeviceEntry( uint32_t deviceIdx, DeviceEntry & entry ) const noexcept;
+
+	std::unique_ptr< MappedFile > _file;  ///< nullptr when no file is opened
+	uint32_t _protocolVersion;
+	uint32_t _deviceCount;
+	size_t _tableOffset;  ///< where the table of devices starts in the file
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_DEVICE_LIST_CACHE_INCLUDED
@@ -0,0 +1,90 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: comparison of two versions of the device list
+//======================================================================================================================
+
+#ifndef OPENRGB_DEVICE_LIST_DIFF_INCLUDED
+#define OPENRGB_DEVICE_LIST_DIFF_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+/// What has happened to a device between the old and the new device list
+enum class DeviceDiffKind : uint8_t
+{
+	Added,     ///< The device is only in the new list.
+	Removed,   ///< The device is only in the old list.
+	Moved,     ///< The device is the same, only its index has changed.
+	Modified,  ///< The description of the device has changed and maybe its index too.
+};
+const char * enumString( DeviceDiffKind kind ) noexcept;
+
+/// Which parts of a modified device have changed
+enum DeviceDiffFields : uint32_t
+{
+	DescriptionChanged  = (1 << 0),  ///< type, name, vendor, description or version
+	ModesChanged        = (1 << 1),  ///< number of modes or any attribute of any mode
+	ActiveModeChanged   = (1 << 2),  ///< index of the active mode
+	ZonesResized        = (1 << 3),  ///< leds_count of some zones, see DeviceDiff::resizedZones
+	ZonesChanged        = (1 << 4),  ///< number of zones or any other attribute of any zone
+	LedsChanged         = (1 << 5),  ///< number of LEDs, their names or values
+};
+std::string deviceDiffFieldsToString( uint32_t fields );
+
+/// Change of a single device
+struct DeviceDiff
+{
+	static constexpr uint32_t npos = UINT32_MAX;
+
+	DeviceDiffKind kind;
+	uint32_t oldIdx;  ///< index of the device in the old list, npos when the device was added
+	uint32_t newIdx;  ///< index of the device in the new list, npos when the device was removed
+	uint32_t fields;  ///< see DeviceDiffFields for possible bit flags, 0 unless the device was modified
+	std::vector< uint32_t > resizedZones;  ///< indexes of the zones whose number of LEDs has changed
+
+	bool moved() const noexcept  { return oldIdx != npos && newIdx != npos && oldIdx != newIdx; }
+};
+
+/// All the changes between two device lists
+struct DeviceListDiff
+{
+	/// One record for every device that has changed, the devices that stayed the same at the same index are omitted.
+	/** The added, moved and modified devices come first ordered by their new index, then the removed devices
+	  * ordered by their old index. */
+	std::vector< DeviceDiff > devices;
+
+	bool empty() const noexcept  { return devices.empty(); }
+};
+
+
+//======================================================================================================================
+/// Finds out what has changed between two versions of the device list.
+/** Use this after you have received UpdateStatus::OutOfDate and downloaded the new list to find out which
+  * of your objects bound to the devices need to be rebuilt.
+  *
+  * The devices are matched by their serial, location and name, not by their index. A device that has no match
+  * is then matched by only its serial and location, so a device that has been renamed is reported as Modified
+  * with DescriptionChanged instead of being Removed and Added. The current colors of the LEDs are not compared,
+  * because they change all the time without the device list being updated. */
+DeviceListDiff diff( const DeviceList & oldList, const DeviceList & newList );
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_DEVICE_LIST_DIFF_INCLUDED
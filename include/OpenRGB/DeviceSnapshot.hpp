@@ -0,0 +1,230 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: flat structure-of-arrays representation of the device list
+//======================================================================================================================
+
+#ifndef OPENRGB_DEVICE_SNAPSHOT_INCLUDED
+#define OPENRGB_DEVICE_SNAPSHOT_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "Color.hpp"
+#include "StringTable.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace own {
+	class BinaryInputStream;
+}
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Continuous range of elements in one of the DeviceSnapshot arrays.
+
+struct IndexRange
+{
+	uint32_t first;  ///< index of the first element of the range
+	uint32_t count;  ///< number of elements in the range
+
+	uint32_t end() const noexcept { return first + count; }
+};
+
+/// Handle to a string stored in the string table of a DeviceSnapshot.
+using NameRef = InternedString;
+
+
+//======================================================================================================================
+/// Attributes of all devices in the snapshot, each vector is indexed by the device index.
+
+struct DeviceArrays
+{
+	std::vector< DeviceType >  type;
+	std::vector< NameRef >     name;
+	std::vector< NameRef >     vendor;
+	std::vector< NameRef >     description;
+	std::vector< NameRef >     version;
+	std::vector< NameRef >     serial;
+	std::vector< NameRef >     location;
+	std::vector< uint32_t >    active_mode;  ///< index of the mode relative to the device
+	std::vector< IndexRange >  modes;        ///< range of this device's modes in ModeArrays
+	std::vector< IndexRange >  zones;        ///< range of this device's zones in ZoneArrays
+	std::vector< IndexRange >  leds;         ///< range of this device's LEDs in LedArrays
+	std::vector< IndexRange >  colors;       ///< range of this device's colors in DeviceSnapshot::colors()
+
+	size_t size() const noexcept  { return type.size(); }
+};
+
+/// Attributes of all modes of all devices, see Mode for their meaning.
+struct ModeArrays
+{
+	std::vector< uint32_t >    device;  ///< index of the parent device
+	std::vector< NameRef >     name;
+	std::vector< uint32_t >    value;
+	std::vector< uint32_t >    flags;
+	std::vector< uint32_t >    speed_min;
+	std::vector< uint32_t >    speed_max;
+	std::vector< uint32_t >    brightness_min;
+	std::vector< uint32_t >    brightness_max;
+	std::vector< uint32_t >    colors_min;
+	std::vector< uint32_t >    colors_max;
+	std::vector< uint32_t >    speed;
+	std::vector< uint32_t >    brightness;
+	std::vector< Direction >   direction;
+	std::vector< ColorMode >   color_mode;
+	std::vector< IndexRange >  colors;       ///< range of this mode's colors in #colorValues
+	std::vector< Color >       colorValues;  ///< mode-specific colors of all modes
+
+	size_t size() const noexcept  { return device.size(); }
+};
+
+/// Attributes of all zones of all devices, see Zone for their meaning.
+struct ZoneArrays
+{
+	std::vector< uint32_t >    device;  ///< index of the parent device
+	std::vector< NameRef >     name;
+	std::vector< ZoneType >    type;
+	std::vector< uint32_t >    leds_min;
+	std::vector< uint32_t >    leds_max;
+	std::vector< uint32_t >    leds_count;
+	std::vector< uint32_t >    matrix_height;
+	std::vector< uint32_t >    matrix_width;
+	std::vector< IndexRange >  leds;          ///< range of this zone's LEDs in LedArrays, limited to the LEDs of its device
+	std::vector< IndexRange >  matrix;        ///< range of this zone's matrix values in #matrixValues
+	std::vector< uint32_t >    matrixValues;  ///< matrix values of all zones
+
+	size_t size() const noexcept  { return device.size(); }
+};
+
+/// Attributes of all LEDs of all devices, see LED for their meaning.
+struct LedArrays
+{
+	std::vector< uint32_t >  device;  ///< index of the parent device
+	std::vector< NameRef >   name;
+	std::vector< uint32_t >  value;
+
+	size_t size() const noexcept  { return device.size(); }
+};
+
+
+//======================================================================================================================
+/// Alternative representation of the whole device list, optimized for iterating over many devices and LEDs at once.
+/** Instead of a tree of small objects, all the modes, zones and LEDs of all devices are stored in a few contiguous
+  * arrays (one per attribute) and every device refers to its sub-objects by an IndexRange. Every distinct name
+  * is stored only once in a StringTable and referred to by NameRef, so two names are equal exactly when their
+  * handles are equal. The snapshots filled by the same Client share one table, which is kept across refreshes
+  * until it holds many more names than the devices have, then a refresh starts a new one. So only the names
+  * of snapshots filled by the same Client since then can be compared by their handles. The names of the Device
+  * objects in a DeviceList are not interned, they stay separate std::string copies.
+  *
+  * Pass the same snapshot object to Client::requestDeviceSnapshot() on every refresh and the arrays will be refilled
+  * in place, so after the first refresh the update needs no allocations unless the devices have grown. */
+
+class DeviceSnapshot
+{
+
+ public:
+
+	static constexpr uint32_t npos = UINT32_MAX;  ///< returned by the find methods when nothing was found
+
+	DeviceSnapshot() noexcept {}
+
+	/// Fills the snapshot from an already downloaded device list.
+	explicit DeviceSnapshot( const DeviceList & deviceList ) { assign( deviceList ); }
+
+	/// Replaces the content of the snapshot with the content of a device list, keeping the allocated memory.
+	void assign( const DeviceList & deviceList );
+
+	/// Removes all content, but keeps the allocated memory for the next refill.
+	void clear() noexcept;
+
+	size_t deviceCount() const noexcept  { return _devices.size(); }
+	size_t modeCount() const noexcept    { return _modes.size(); }
+	size_t zoneCount() const noexcept    { return _zones.size(); }
+	size_t ledCount() const noexcept     { return _leds.size(); }
+
+	const DeviceArrays & devices() const noexcept  { return _devices; }
+	const ModeArrays & modes() const noexcept      { return _modes; }
+	const ZoneArrays & zones() const noexcept      { return _zones; }
+	const LedArrays & leds() const noexcept        { return _leds; }
+
+	/// Current colors of all LEDs of all devices, use DeviceArrays::colors to find the range of a particular device.
+	const std::vector< Color > & colors() const noexcept  { return _colors; }
+
+	/// Returns a '\0'-terminated string stored in the string table.
+	const char * str( NameRef name ) const noexcept  { return name.c_str(); }
+
+	/// Converts a string stored in the string table to std::string.
+	std::string string( NameRef name ) const  { return name.str(); }
+
+	/// Looks up the handle of a name, so that it can be compared with the handles in the arrays.
+	/** \returns false when no object in the snapshot can have such name. */
+	bool findName( StringView str, NameRef & name ) const;
+
+	/// Finds the first device with a specific name.
+	/** \returns index into DeviceArrays or npos when such device is not found. */
+	uint32_t findDevice( const std::string & name ) const;
+
+	/// Finds the first device of specific type.
+	/** \returns index into DeviceArrays or npos when such device is not found. */
+	uint32_t findDevice( DeviceType type ) const noexcept;
+
+	/// Finds the first mode of a device with a specific name.
+	/** \returns index into ModeArrays or npos when such mode is not found or the device index is out of range. */
+	uint32_t findMode( uint32_t deviceIdx, const std::string & name ) const;
+
+	/// Finds the first zone of a device with a specific name.
+	/** \returns index into ZoneArrays or npos when such zone is not found or the device index is out of range. */
+	uint32_t findZone( uint32_t deviceIdx, const std::string & name ) const;
+
+	/// Finds the first LED of a device with a specific name.
+	/** \returns index into LedArrays or npos when such LED is not found or the device index is out of range. */
+	uint32_t findLED( uint32_t deviceIdx, const std::string & name ) const;
+
+	/// The table holding the names of this snapshot.
+	const std::shared_ptr< StringTable > & stringTable() const noexcept  { return _strings; }
+
+ private:  // for internal use only
+
+	friend class Client;
+	void reserve( size_t deviceCount );
+	bool appendDevice( own::BinaryInputStream & stream, uint32_t protocolVersion );
+	void appendDevice( const Device & device );
+	void clampZoneLeds( uint32_t deviceIdx ) noexcept;
+
+	void setStringTable( const std::shared_ptr< StringTable > & strings ) noexcept  { _strings = strings; }
+	StringTable & strings();
+	NameRef addName( StringView str );
+	bool readName( own::BinaryInputStream & stream, NameRef & name );
+	uint32_t findInRange( const std::vector< NameRef > & names, IndexRange range, const std::string & name ) const;
+	/// upper estimate of the distinct names, for StringTable::isOversized()
+	size_t nameCount() const noexcept  { return _devices.size() * 6 + _modes.size() + _zones.size() + _leds.size(); }
+
+ private:
+
+	DeviceArrays _devices;
+	ModeArrays _modes;
+	ZoneArrays _zones;
+	LedArrays _leds;
+	std::vector< Color > _colors;
+
+	std::shared_ptr< StringTable > _strings;  ///< created on first use, unless provided by the Client
+	std::string _readBuffer;                 ///< re-used when reading strings from the stream to avoid allocations
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_DEVICE_SNAPSHOT_INCLUDED
@@ -0,0 +1,149 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: read-only view of a device that is parsed lazily from the raw server reply
+//======================================================================================================================
+
+#ifndef OPENRGB_DEVICE_VIEW_INCLUDED
+#define OPENRGB_DEVICE_VIEW_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "DeviceSnapshot.hpp"  // IndexRange
+#include "StringView.hpp"
+#include "Color.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Read-only view of an RGB device that keeps the raw bytes of the server's reply and parses them on demand.
+/** Unlike Device, constructing a DeviceView does not copy any string. On the first call of any accessor
+  * a small index of offsets into the raw data is built and all the strings are then returned as StringView
+  * pointing directly into the raw data, so they are only valid as long as this object is alive.
+  *
+  * If the reply from the server turns out to be malformed or contains values that Device would reject,
+  * isValid() returns false and all the accessors return empty values. The same is returned for an index
+  * of a mode, zone or LED that is out of range.
+  *
+  * Because the index is built by the first call of a const method, the const methods are NOT safe
+  * to call from multiple threads at the same time, unless isValid() was called before sharing the object. */
+
+class DeviceView
+{
+
+ public:
+
+	DeviceView() noexcept : _idx( 0 ), _protocolVersion( 0 ) {}
+
+	/// Index of this device in the device list.
+	uint32_t idx() const noexcept  { return _idx; }
+
+	/// Whether the raw data could be parsed.
+	bool isValid() const;
+
+	//-- device description --------------------------------------------------------------------------------------------
+
+	DeviceType  type() const;
+	StringView  name() const;
+	StringView  vendor() const;
+	StringView  description() const;
+	StringView  version() const;
+	StringView  serial() const;
+	StringView  location() const;
+	uint32_t    activeMode() const;
+
+	//-- device subobjects ---------------------------------------------------------------------------------------------
+
+	size_t  modeCount() const;
+	size_t  zoneCount() const;
+	size_t  ledCount() const;
+	size_t  colorCount() const;
+
+	StringView  modeName( uint32_t modeIdx ) const;
+	uint32_t    modeValue( uint32_t modeIdx ) const;
+	uint32_t    modeFlags( uint32_t modeIdx ) const;  ///< see ModeFlags for possible bit flags
+	ColorMode   modeColorMode( uint32_t modeIdx ) const;
+
+	StringView  zoneName( uint32_t zoneIdx ) const;
+	ZoneType    zoneType( uint32_t zoneIdx ) const;
+	uint32_t    zoneLedsCount( uint32_t zoneIdx ) const;
+	IndexRange  zoneLeds( uint32_t zoneIdx ) const;  ///< range of this zone's LEDs, limited to the device's LEDs
+	uint32_t    zoneMatrixHeight( uint32_t zoneIdx ) const;
+	uint32_t    zoneMatrixWidth( uint32_t zoneIdx ) const;
+
+	StringView  ledName( uint32_t ledIdx ) const;
+	uint32_t    ledValue( uint32_t ledIdx ) const;
+
+	Color       color( uint32_t ledIdx ) const;
+
+	/// Finds the first mode with a specific name.
+	/** \returns index of the mode or UINT32_MAX when mode with this name is not found. */
+	uint32_t findMode( StringView name ) const;
+
+	/// Finds the first zone with a specific name.
+	/** \returns index of the zone or UINT32_MAX when zone with this name is not found. */
+	uint32_t findZone( StringView name ) const;
+
+	/// Finds the first LED with a specific name.
+	/** \returns index of the LED or UINT32_MAX when LED with this name is not found. */
+	uint32_t findLED( StringView name ) const;
+
+	/// Fully parses the raw data into a standard Device object, for when you need more than the view provides.
+	/** \param options how to parse the device, the same ones as Client::requestDeviceList() takes
+	  * \returns nullptr when the raw data are malformed. */
+	std::unique_ptr< Device > toDevice( const DeviceListOptions & options = DeviceListOptions() ) const;
+
+	/// The raw body of the server's reply this view is reading from.
+	const std::vector< uint8_t > & rawData() const noexcept  { return _data; }
+
+ private:  // for internal use only
+
+	friend class Client;
+	DeviceView( uint32_t deviceIdx, uint32_t protocolVersion, std::vector< uint8_t > && replyBody ) noexcept
+		: _idx( deviceIdx ), _protocolVersion( protocolVersion ), _data( std::move( replyBody ) ) {}
+
+	bool buildIndex() const;
+	bool hasMode( uint32_t modeIdx ) const  { return buildIndex() && modeIdx < _index.modes.size(); }
+	bool hasZone( uint32_t zoneIdx ) const  { return buildIndex() && zoneIdx < _index.zones.size(); }
+	bool hasLED( uint32_t ledIdx ) const    { return buildIndex() && ledIdx < _index.leds.size(); }
+	StringView stringAt( uint32_t offset ) const noexcept;
+	uint32_t uint32At( uint32_t offset ) const noexcept;
+
+ private:
+
+	uint32_t _idx;
+	uint32_t _protocolVersion;
+	std::vector< uint8_t > _data;
+
+	/// offsets into the raw data, built lazily on first access
+	struct Index
+	{
+		enum State : uint8_t { NotBuilt, Valid, Invalid } state = NotBuilt;
+		uint32_t type = 0;
+		uint32_t strings [6] = {};  // name, vendor, description, version, serial, location
+		uint32_t activeMode = 0;
+		std::vector< uint32_t > modes;  // offset of every mode
+		std::vector< uint32_t > zones;  // offset of every zone
+		std::vector< uint32_t > leds;   // offset of every LED
+		uint32_t colors = 0;            // offset of the first color
+		uint32_t colorCount = 0;
+	};
+	mutable Index _index;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_DEVICE_VIEW_INCLUDED
@@ -0,0 +1,308 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: stack of effect layers composited into the colors of the devices
+//======================================================================================================================
+
+#ifndef OPENRGB_EFFECT_ENGINE_INCLUDED
+#define OPENRGB_EFFECT_ENGINE_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "ColorOps.hpp"  // BlendMode
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+
+namespace orgb {
+
+
+class Client;
+enum class RequestStatus;
+class RenderExecutor;
+
+
+//======================================================================================================================
+/// Colors of one layer for all the devices, the padding byte of every Color is used as its alpha.
+/** The canvas keeps its content between the frames, so a layer only needs to draw the devices that changed.
+  * Draw into a device with draw(), that marks the device as changed, so that the engine composites it again.
+  * The devices are identified by their position in the device list, which is the same as Device::idx
+  * for the lists downloaded by the Client, but not for lists assembled by DeviceList::append(). */
+
+class LayerCanvas
+{
+
+ public:
+
+	LayerCanvas() noexcept : _devices( nullptr ) {}
+
+	const DeviceList & devices() const noexcept  { return *_devices; }
+	size_t deviceCount() const noexcept  { return _frames.size(); }
+	size_t ledCount( uint32_t deviceIdx ) const noexcept  { return _frames[ deviceIdx ].size(); }
+
+	/// Colors of a device to be modified, marks the device as changed.
+	/** There is one color for every LED of the device, in the same order as Device::leds. */
+	Color * draw( uint32_t deviceIdx ) noexcept  { _changed[ deviceIdx ] = true; return _frames[ deviceIdx ].data(); }
+
+	/// Current colors of a device.
+	const Color * frame( uint32_t deviceIdx ) const noexcept  { return _frames[ deviceIdx ].data(); }
+
+	/// Whether the device was drawn into since the last composition.
+	bool isChanged( uint32_t deviceIdx ) const noexcept  { return _changed[ deviceIdx ] != 0; }
+
+	/// Makes all the LEDs of all devices fully transparent.
+	void clear() noexcept;
+
+ private:
+
+	friend class EffectEngine;
+	void assign( const DeviceList & devices );
+	void resetChanges() noexcept;
+
+ private:
+
+	const DeviceList * _devices;
+	std::vector< std::vector< Color > > _frames;  ///< device index -> colors of its LEDs
+	std::vector< uint8_t > _changed;  ///< device index -> whether draw() was called, not vector<bool> for speed
+
+};
+
+
+//======================================================================================================================
+/// One effect in the stack of the EffectEngine, derive from this to implement your effect.
+
+class Layer
+{
+
+ public:
+
+	Layer( colorops::BlendMode blendMode = colorops::BlendMode::Normal, uint8_t opacity = 255 ) noexcept
+		: _blendMode( blendMode ), _opacity( opacity ), _enabled( true ), _propertiesChanged( true ), _isParallel( false ) {}
+	virtual ~Layer() = default;
+
+	colorops::BlendMode blendMode() const noexcept  { return _blendMode; }
+	uint8_t opacity() const noexcept                { return _opacity; }
+	bool isEnabled() const noexcept                 { return _enabled; }
+
+	void setBlendMode( colorops::BlendMode blendMode ) noexcept  { _propertiesChanged |= blendMode != _blendMode; _blendMode = blendMode; }
+	void setOpacity( uint8_t opacity ) noexcept                  { _propertiesChanged |= opacity != _opacity; _opacity = opacity; }
+	void setEnabled( bool enabled ) noexcept                     { _propertiesChanged |= enabled != _enabled; _enabled = enabled; }
+
+ protected:
+
+	/// Called when the engine gets a new device list, after the canvas has been resized and cleared.
+	virtual void reset( LayerCanvas & /*canvas*/ ) {}
+
+	/// Called every frame, draw into the devices whose colors should change.
+	/** When nothing is drawn, the layer is skipped in the composition of this frame.
+	  * \param time seconds since an arbitrary point in time, use it to animate the effect */
+	virtual void render( LayerCanvas & canvas, double time ) = 0;
+
+ private:
+
+	friend class EffectEngine;
+	friend class ParallelLayer;
+
+	colorops::BlendMode _blendMode;
+	uint8_t _opacity;
+	bool _enabled;
+	bool _propertiesChanged;  ///< since the last composition
+	bool _isParallel;         ///< this is a ParallelLayer
+
+};
+
+
+//======================================================================================================================
+/// Part of a device that a ParallelLayer draws as one task, either the whole device or a range of LEDs of a zone.
+
+struct RenderPart
+{
+	const Device * device;
+	uint32_t deviceIdx;  ///< position of the device in the device list, see LayerCanvas
+	const Zone * zone;  ///< zone containing the LEDs, nullptr when the part is the whole device
+	uint32_t firstLed;  ///< index into Device::leds of the first LED of the part
+	uint32_t ledCount;
+};
+
+
+//======================================================================================================================
+/// Layer that draws every part of every device independently, so that the parts can be rendered in parallel.
+/** Every frame the engine first calls beginFrame() on its own thread and then renderPart() for all the parts
+  * of all the devices. When the engine has a RenderExecutor, the parts are rendered by its threads at the same time,
+  * so renderPart() must not modify anything shared between the parts and must not throw.
+  * Devices with many LEDs are split into their zones and large zones into ranges of LEDs,
+  * see EffectEngine::setSplitThreshold(). All the devices are considered changed in every frame. */
+
+class ParallelLayer : public Layer
+{
+
+ public:
+
+	ParallelLayer( colorops::BlendMode blendMode = colorops::BlendMode::Normal, uint8_t opacity = 255 ) noexcept
+		: Layer( blendMode, opacity ) { _isParallel = true; }
+
+ protected:
+
+	/// Called every frame before the parts are rendered, prepare the state shared by all the parts here.
+	virtual void beginFrame( double /*time*/ ) {}
+
+	/// Draws one part of a device.
+	/** \param colors colors of the LEDs of the part, colors[0] belongs to the LED part.firstLed */
+	virtual void renderPart( const RenderPart & part, Color * colors, double time ) = 0;
+
+ private:
+
+	friend class EffectEngine;
+
+	void render( LayerCanvas & /*canvas*/, double time ) override final  { beginFrame( time ); }
+
+};
+
+
+//======================================================================================================================
+/// Statistics of the last frame of the EffectEngine.
+
+struct FrameStats
+{
+	uint32_t devicesComposited;  ///< devices whose layers changed, so their colors had to be composited again
+	uint32_t devicesSent;        ///< devices whose colors changed, so they were sent to the server
+	uint32_t ledsComposited;     ///< LEDs of the composited devices times the number of enabled layers
+
+	FrameStats() noexcept : devicesComposited( 0 ), devicesSent( 0 ), ledsComposited( 0 ) {}
+};
+
+
+//======================================================================================================================
+/// How long one task of the last frame of the EffectEngine took and which thread ran it.
+
+struct TaskTiming
+{
+	const Layer * layer;  ///< the layer whose part was rendered, nullptr when the task was the composition of a device
+	uint32_t deviceIdx;   ///< position of the device in the device list
+	uint32_t firstLed;
+	uint32_t ledCount;
+	uint32_t threadIdx;   ///< thread of the RenderExecutor, 0 is the thread that called EffectEngine::render()
+	std::chrono::nanoseconds duration;
+};
+
+
+//======================================================================================================================
+/// Renders a stack of effect layers and sends the composited colors to the devices.
+/** Every frame, all the layers draw into their own canvas, then for every device that was drawn into by any layer
+  * the layers are blended from the bottom to the top over black using their blend mode and opacity.
+  * Only the devices whose final colors differ from what was sent the last time are sent to the server,
+  * each of them by a single UpdateLEDs message.
+  *
+  * By default everything runs on the thread calling render(). With setExecutor(), the parts of the ParallelLayers
+  * and the compositions of the devices are spread over the threads of a RenderExecutor, all of them finish
+  * before render() returns, so update() sends only complete frames.
+  *
+  * The engine keeps a pointer to the device list, so the list must stay alive and unchanged until the next
+  * call of setDevices(). The devices are identified by their position in the list, see LayerCanvas. */
+
+class EffectEngine
+{
+
+ public:
+
+	EffectEngine() noexcept : _devices( nullptr ), _executor( nullptr ), _splitThreshold( 256 ), _recompositeAll( true ) {}
+
+	/// Starts rendering a new device list, all the canvases are resized and cleared and Layer::reset() is called.
+	void setDevices( const DeviceList & devices );
+
+	/// Renders the parts of the ParallelLayers and composites the devices on the threads of the executor.
+	/** The executor is not owned by the engine, it must stay alive until it's replaced. nullptr, which is the default,
+	  * renders everything on the thread calling render(). */
+	void setExecutor( RenderExecutor * executor ) noexcept  { _executor = executor; }
+	RenderExecutor * executor() const noexcept  { return _executor; }
+
+	/// Devices with more LEDs than this are rendered by ParallelLayers per zone, and the zones with more LEDs than this
+	/// are split further into ranges of at most this many LEDs.
+	void setSplitThreshold( uint32_t ledCount );
+	uint32_t splitThreshold() const noexcept  { return _splitThreshold; }
+
+	/// Adds a layer on top of the others.
+	/** \returns reference to the added layer, it's owned by the engine */
+	Layer & addLayer( std::unique_ptr< Layer > layer );
+
+	/// Removes a layer and destroys it.
+	void removeLayer( const Layer & layer );
+
+	size_t layerCount() const noexcept  { return _layers.size(); }
+	Layer & layer( size_t layerIdx ) noexcept  { return *_layers[ layerIdx ].layer; }
+
+	/// Renders and composites the next frame without sending it, the result is available via colors().
+	/** \returns which devices have different colors than after the previous frame */
+	const std::vector< uint8_t > & render( double time );
+
+	/// Renders and composites the next frame and sends the devices whose colors have changed.
+	/** When a device fails to be sent, the rest is not attempted and they will be sent in the next frame. */
+	RequestStatus update( Client & client, double time );
+
+	/// Sends the devices whose colors have changed since they were last sent, each by a single UpdateLEDs message.
+	/** This is the second half of update(), call it after render() to measure the rendering and the sending separately. */
+	RequestStatus send( Client & client );
+
+	/// Composited colors of a device from the last frame.
+	const std::vector< Color > & colors( uint32_t deviceIdx ) const noexcept  { return _result[ deviceIdx ]; }
+
+	const FrameStats & lastFrameStats() const noexcept  { return _stats; }
+
+	/// Timing of every part rendered by a ParallelLayer and of every device composition in the last frame.
+	/** The sequential layers are not included, they are rendered before the tasks start. */
+	const std::vector< TaskTiming > & lastFrameTimings() const noexcept  { return _timings; }
+
+ private:
+
+	struct LayerEntry
+	{
+		std::unique_ptr< Layer > layer;
+		LayerCanvas canvas;
+	};
+
+	struct RenderTask
+	{
+		LayerEntry * entry;
+		uint32_t partIdx;
+	};
+
+	void splitIntoParts();
+	template< typename Task >
+	void runTasks( size_t taskCount, Task && task );
+	void renderPart( size_t taskIdx, unsigned threadIdx, double time ) noexcept;
+	void composite( uint32_t deviceIdx ) noexcept;
+
+ private:
+
+	const DeviceList * _devices;
+	std::vector< LayerEntry > _layers;  ///< from the bottom to the top
+
+	RenderExecutor * _executor;
+	uint32_t _splitThreshold;
+	std::vector< RenderPart > _parts;          ///< all devices split into parts for the ParallelLayers
+	std::vector< RenderTask > _renderTasks;    ///< parts of the ParallelLayers in the current frame
+	std::vector< uint32_t > _compositeTasks;   ///< devices to composite in the current frame
+	std::vector< TaskTiming > _timings;        ///< render tasks followed by composite tasks
+
+	std::vector< std::vector< Color > > _result;  ///< device index -> composited colors
+	std::vector< std::vector< Color > > _next;    ///< device index -> buffer for the next composition of the device
+	std::vector< uint8_t > _changed;              ///< device index -> whether _result changed in the last frame
+	std::vector< uint8_t > _unsent;               ///< device index -> whether _result hasn't been sent yet
+
+	bool _recompositeAll;  ///< the layers have been added or removed since the last composition
+	FrameStats _stats;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_EFFECT_ENGINE_INCLUDED
@@ -0,0 +1,264 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: averaging areas of images or video frames into colors of LEDs for ambient lighting
+//======================================================================================================================
+
+#ifndef OPENRGB_FRAME_SAMPLER_INCLUDED
+#define OPENRGB_FRAME_SAMPLER_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "SystemErrorType.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  images
+
+/// Order and size of the channels of one pixel.
+enum class PixelFormat : uint8_t
+{
+	RGB24,   ///< 3 bytes: red, green, blue
+	BGR24,   ///< 3 bytes: blue, green, red, the order of Windows bitmaps
+	RGBA32,  ///< 4 bytes: red, green, blue, and alpha or padding, which is ignored
+	BGRA32,  ///< 4 bytes: blue, green, red, and alpha or padding, the usual format of screen captures
+};
+
+inline uint32_t bytesPerPixel( PixelFormat format ) noexcept
+{
+	return format == PixelFormat::RGB24 || format == PixelFormat::BGR24 ? 3 : 4;
+}
+
+/// Pixels of an image stored by someone else, row by row from the top.
+struct ImageView
+{
+	const uint8_t * pixels;
+	uint32_t width;
+	uint32_t height;
+	size_t stride;  ///< bytes from the start of a row to the start of the next one
+	PixelFormat format;
+
+	ImageView() noexcept : pixels( nullptr ), width( 0 ), height( 0 ), stride( 0 ), format( PixelFormat::RGB24 ) {}
+	/** \param stride 0 means the rows follow each other without any padding */
+	ImageView( const uint8_t * pixels, uint32_t width, uint32_t height, PixelFormat format, size_t stride = 0 ) noexcept
+		: pixels( pixels ), width( width ), height( height ),
+		  stride( stride != 0 ? stride : size_t( width ) * bytesPerPixel( format ) ), format( format ) {}
+
+	size_t byteCount() const noexcept  { return stride * height; }
+};
+
+/// Rectangle within an image in coordinates relative to its size, so that it doesn't depend on the resolution.
+/** 0.0 is the left or the top edge of the image and 1.0 is the right or the bottom edge. */
+struct ImageArea
+{
+	float x;
+	float y;
+	float width;
+	float height;
+
+	ImageArea() noexcept : x( 0.0f ), y( 0.0f ), width( 1.0f ), height( 1.0f ) {}
+	ImageArea( float x, float y, float width, float height ) noexcept : x( x ), y( y ), width( width ), height( height ) {}
+};
+
+/// Edge of an image along which a LED strip goes, the LEDs are expected in the clockwise order.
+enum class Edge : uint8_t
+{
+	Top,     ///< from the left to the right
+	Right,   ///< from the top to the bottom
+	Bottom,  ///< from the right to the left
+	Left,    ///< from the bottom to the top
+};
+
+
+//======================================================================================================================
+/// Averages areas of images into colors of LEDs, typically to light up the surroundings of a screen by what it shows.
+/** Every LED that should follow the image is assigned an area of it. The areas are in relative coordinates
+  * and they are converted to rectangles of pixels when the first image of a new resolution arrives, so that sampling
+  * a frame is only summing rows of pixels, which is done by colorops::sumPixels() using SIMD instructions.
+  * The image is read from the top to the bottom, every row once for all the areas crossing it.
+  * In orgbbench with SSE2, a full HD frame takes about 0.3 ms with LED strips around its edges reaching 10 % into
+  * the image, and about 0.65 ms with a grid of areas covering all of it. That is bound by the memory bandwidth,
+  * copying 8 MB takes 0.7 ms on the same machine. setRowStep() makes both proportionally faster.
+  *
+  * The colors are stored in a frame per device, one Color for every LED in the order of Device::leds, so that they can
+  * be sent by Client::setDeviceColors() or drawn into a LayerCanvas. The LEDs without an area stay black.
+  * The devices are identified by their position in the device list, which is the same as Device::idx
+  * for the lists downloaded by the Client. */
+
+class FrameSampler
+{
+
+ public:
+
+	FrameSampler() noexcept : _imageWidth( 0 ), _imageHeight( 0 ), _rowStep( 1 ) {}
+
+	/// Sizes the frames of colors by a device list and removes all the areas.
+	/** It's not needed when the areas are given by device and LED indexes, the frames then grow as the areas are added. */
+	void setDevices( const DeviceList & devices );
+
+	/// Assigns a LED an area of the image.
+	void addArea( uint32_t deviceIdx, uint32_t ledIdx, const ImageArea & area );
+
+	/// Divides an area into a grid of cells of the size of the matrix and assigns every LED of the matrix its cell.
+	/** The device is identified by Zone::parentIdx, so the zone must come from a list downloaded by the Client. */
+	void addMatrix( const Zone & zone, const ImageArea & area = ImageArea() );
+
+	/// Divides a part of an edge of the image evenly between consecutive LEDs of a strip.
+	/** \param firstLed index into Device::leds of the LED at the start of the part
+	  * \param depth how far the areas reach from the edge into the image, relative to the image's width or height
+	  * \param from start of the part of the edge, 0.0 is the corner where the edge starts in the clockwise order
+	  * \param to end of the part of the edge, 1.0 is the corner where the edge ends in the clockwise order */
+	void addStrip( uint32_t deviceIdx, uint32_t firstLed, uint32_t ledCount, Edge edge, float depth,
+	               float from = 0.0f, float to = 1.0f );
+
+	/// Removes all the areas, the colors of all the LEDs become black.
+	void clearAreas() noexcept;
+
+	size_t areaCount() const noexcept  { return _areas.size(); }
+
+	/// Sums only every n-th row of every area, which makes the sampling n times faster.
+	/** Images are smooth enough for the average of e.g. every 4th row of a large area to be the same color,
+	  * the default is 1, which sums all the rows. */
+	void setRowStep( uint32_t rowStep ) noexcept  { _rowStep = rowStep > 0 ? rowStep : 1; }
+	uint32_t rowStep() const noexcept  { return _rowStep; }
+
+	/// Calculates the colors of all the LEDs that have an area from the pixels of an image.
+	/** The image may have a different resolution than the previous one, the rectangles of pixels are then recalculated,
+	  * which doesn't allocate anything. */
+	void sample( const ImageView & image ) noexcept;
+
+	size_t deviceCount() const noexcept  { return _frames.size(); }
+
+	/// Colors of a device from the last sampled image.
+	const std::vector< Color > & colors( uint32_t deviceIdx ) const noexcept  { return _frames[ deviceIdx ]; }
+
+ private:
+
+	struct Area
+	{
+		uint32_t deviceIdx;
+		uint32_t ledIdx;
+		ImageArea relative;
+		// rectangle of pixels in the current resolution
+		uint32_t left;
+		uint32_t top;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	struct ActiveArea
+	{
+		uint32_t areaIdx;
+		uint32_t nextRow;  ///< the next row of the image to add to its sums
+	};
+
+	struct Sums
+	{
+		uint32_t channels [4];
+		Sums() noexcept : channels{ 0, 0, 0, 0 } {}
+	};
+
+	void resizeFrame( uint32_t deviceIdx, uint32_t ledCount );
+	void computeRectangles( uint32_t imageWidth, uint32_t imageHeight ) noexcept;
+
+ private:
+
+	std::vector< Area > _areas;
+	std::vector< uint32_t > _order;     ///< indexes of the areas sorted by their top row, then by their left column
+	std::vector< ActiveArea > _active;  ///< areas crossing the row being summed, as many places as there are areas
+	std::vector< Sums > _sums;          ///< sums of the channels of every area
+	std::vector< std::vector< Color > > _frames;  ///< device index -> colors of its LEDs
+
+	uint32_t _imageWidth;   ///< resolution the rectangles were calculated for, 0 when they need to be recalculated
+	uint32_t _imageHeight;
+	uint32_t _rowStep;
+
+};
+
+
+//======================================================================================================================
+//  frame sources
+
+/// Result of opening or reading raw frames.
+enum class FrameStatus
+{
+	Success,      ///< The operation was successful.
+	EndOfStream,  ///< All the frames of the stream have been read.
+	CannotOpen,   ///< The file could not be opened, see RawFrameReader::lastSystemError().
+	TooSmall,     ///< The shared memory is smaller than one frame.
+	ReadError,    ///< Reading the stream has failed, see RawFrameReader::lastSystemError().
+};
+const char * enumString( FrameStatus status ) noexcept;
+
+
+//======================================================================================================================
+/// Reads raw frames of a fixed resolution and format without any header, from a stream or a shared memory.
+/** A stream is a file, a named pipe or the standard input, where the frames follow each other, for example
+  * the output of "ffmpeg -i video.mp4 -f rawvideo -pix_fmt rgb24 -s 480x270 -". The frames are copied into
+  * an internal buffer, so the view stays valid until the next read().
+  *
+  * A shared memory is a file, like one in /dev/shm, that another process keeps overwriting with the current frame.
+  * Every read() copies the current frame from it into the internal buffer. It's not mapped into memory, because
+  * the producer may truncate the file at any time and touching a mapping beyond the new end would crash the process.
+  * Copying a full HD RGB frame from /dev/shm takes about 0.7 ms. When the producer is in the middle of writing a frame,
+  * the copy mixes two consecutive frames, which only lasts a moment. */
+
+class RawFrameReader
+{
+
+ public:
+
+	RawFrameReader() noexcept;
+	~RawFrameReader() noexcept;
+
+	RawFrameReader( const RawFrameReader & other ) = delete;
+	RawFrameReader & operator=( const RawFrameReader & other ) = delete;
+
+	/// Opens a stream of frames, "-" means the standard input.
+	FrameStatus open( const std::string & path, uint32_t width, uint32_t height, PixelFormat format );
+
+	/// Opens a shared memory containing one frame.
+	/** \param offset where the frame starts within the file, in case the producer puts a header in front of it */
+	FrameStatus openShared( const std::string & path, uint32_t width, uint32_t height, PixelFormat format, size_t offset = 0 );
+
+	void close() noexcept;
+
+	bool isOpen() const noexcept  { return _file != nullptr; }
+
+	/// Blocks until the next frame of a stream is read, or copies the current frame of a shared memory.
+	/** \returns EndOfStream when no complete frame is left in the stream,
+	  *          TooSmall when the shared memory has been truncated, the next read may succeed again */
+	FrameStatus read( ImageView & image );
+
+	system_error_t lastSystemError() const noexcept  { return _lastSystemError; }
+
+ private:
+
+	FILE * _file;
+	bool _ownsFile;  ///< false for the standard input
+	bool _isShared;  ///< the file is a shared memory that is read from _sharedOffset every time
+	size_t _sharedOffset;
+	ImageView _frame;  ///< the current frame in _buffer
+	std::vector< uint8_t > _buffer;
+	system_error_t _lastSystemError;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_FRAME_SAMPLER_INCLUDED
@@ -0,0 +1,115 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: spatial layout of the LEDs for position-based effects
+//======================================================================================================================
+
+#ifndef OPENRGB_LAYOUT_MAP_INCLUDED
+#define OPENRGB_LAYOUT_MAP_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "DeviceSnapshot.hpp"  // IndexRange
+
+#include <cstdint>
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Position and size of a device in a common plane, like a room or a desk, in any units you like.
+
+struct DevicePlacement
+{
+	float x;       ///< left edge of the device
+	float y;       ///< top edge of the device
+	float width;
+	float height;
+};
+
+
+//======================================================================================================================
+/// Coordinates of all the LEDs of a DeviceList, for effects that depend on the position of the LEDs.
+/** The protocol doesn't say where the LEDs physically are, so the layout is derived from the zones:
+  * the zones of a device are stacked from top to bottom, a matrix zone takes as many rows as the matrix has
+  * and the other zones take one row. Within its rows the LEDs of a matrix zone are placed according to the matrix,
+  * the LEDs of a linear zone are spread evenly from left to right and a single LED is in the middle.
+  *
+  * By default the devices are placed below each other as unit squares, use placeDevice() to describe where
+  * they really are. The coordinates are stored as separate contiguous float arrays indexed by a global LED index,
+  * so that an effect can process all the LEDs in one pass. LEDs of a device are at indexes deviceLeds(). */
+
+class LayoutMap
+{
+
+ public:
+
+	LayoutMap() noexcept {}
+	explicit LayoutMap( const DeviceList & devices )  { assign( devices ); }
+
+	/// Builds the layout of a new device list, the placements of the devices are reset to the default.
+	void assign( const DeviceList & devices );
+
+	void clear() noexcept;
+
+	/// Moves a device to a different place in the plane and updates the coordinates of all LEDs.
+	void placeDevice( uint32_t deviceIdx, const DevicePlacement & placement );
+
+	const DevicePlacement & placement( uint32_t deviceIdx ) const noexcept  { return _placements[ deviceIdx ]; }
+
+	size_t deviceCount() const noexcept  { return _deviceLeds.size(); }
+	size_t ledCount() const noexcept     { return _localX.size(); }
+
+	/// Range of the device's LEDs in the coordinate arrays, the order is the same as in Device::leds.
+	IndexRange deviceLeds( uint32_t deviceIdx ) const noexcept  { return _deviceLeds[ deviceIdx ]; }
+
+	//-- coordinates of the LEDs ---------------------------------------------------------------------------------------
+
+	/// Position within the device, from 0.0 (left) to 1.0 (right).
+	const float * localX() const noexcept  { return _localX.data(); }
+	/// Position within the device, from 0.0 (top) to 1.0 (bottom).
+	const float * localY() const noexcept  { return _localY.data(); }
+
+	/// Position along the zone from 0.0 to 1.0, useful for LED strips.
+	const float * linear() const noexcept  { return _linear.data(); }
+
+	/// Position in the plane, where the longer side of the area covered by all devices goes from 0.0 to 1.0.
+	/** The shorter side goes from 0.0 to less than 1.0, so that circles stay circles. */
+	const float * x() const noexcept  { return _x.data(); }
+	const float * y() const noexcept  { return _y.data(); }
+
+	/// Size of the area covered by all devices in the normalized coordinates of x() and y().
+	float width() const noexcept   { return _width; }
+	float height() const noexcept  { return _height; }
+
+ private:
+
+	void updatePlaneCoords() noexcept;
+
+ private:
+
+	std::vector< DevicePlacement > _placements;
+	std::vector< IndexRange > _deviceLeds;
+
+	std::vector< float > _localX;
+	std::vector< float > _localY;
+	std::vector< float > _linear;
+	std::vector< float > _x;
+	std::vector< float > _y;
+
+	float _width = 0.0f;
+	float _height = 0.0f;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_LAYOUT_MAP_INCLUDED
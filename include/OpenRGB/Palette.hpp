@@ -0,0 +1,149 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: color gradients sampled through a precomputed table
+//======================================================================================================================
+
+#ifndef OPENRGB_PALETTE_INCLUDED
+#define OPENRGB_PALETTE_INCLUDED
+
+
+#include "Color.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// One color of a gradient at a position between 0 (the start) and 255 (the end).
+/** This is a plain aggregate, so the stops of a palette can be defined as a constexpr array, see palettes. */
+
+struct PaletteStop
+{
+	uint8_t position;
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+};
+
+
+//======================================================================================================================
+/// Gradient through any number of color stops, for effects like fire or ocean that pick a color for every LED.
+/** The gradient is computed once into a table of 256 colors, sampling it then costs a single load,
+  * or two loads and a blend when sampled between the table entries with a 16-bit position.
+  * Whole frames are mapped with map(), which uses colorops::lookup() and colorops::lookupInterpolated().
+  *
+  * The stops must be sorted by their position. The colors before the first stop and after the last stop
+  * are the colors of those stops, two stops at the same position make a sharp edge.
+  * The padding of all the colors in the table is 0. */
+
+class Palette
+{
+
+ public:
+
+	static const size_t TableSize = 256;
+
+	/// Palette with all colors black.
+	Palette() noexcept;
+
+	Palette( const PaletteStop * stops, size_t stopCount ) noexcept;
+
+	template< size_t StopCount >
+	Palette( const PaletteStop (& stops) [StopCount] ) noexcept : Palette( stops, StopCount ) {}
+
+	Palette( std::initializer_list< PaletteStop > stops ) noexcept : Palette( stops.begin(), stops.size() ) {}
+
+	/// Color at one of the 256 positions of the gradient.
+	Color operator[]( uint8_t index ) const noexcept  { return _table[ index ]; }
+
+	/// Color at a 16-bit position, interpolated between the two nearest table entries.
+	/** Position 0 is the start of the gradient and 0xFF00 is its end, values above it stay at the end. */
+	Color sample( uint16_t position ) const noexcept;
+
+	/// Color at a position between 0.0 (the start) and 1.0 (the end), values outside are clamped.
+	Color sample( float position ) const noexcept;
+
+	/// Maps a frame of 8-bit indexes to colors, the same as operator[] for every index.
+	void map( Color * dst, const uint8_t * indexes, size_t count ) const noexcept;
+
+	/// Maps a frame of 16-bit positions to colors, the same as sample( uint16_t ) for every position.
+	void map( Color * dst, const uint16_t * positions, size_t count ) const noexcept;
+
+	/// All the 256 colors of the gradient.
+	const Color * table() const noexcept  { return _table; }
+
+ private:
+
+	Color _table [TableSize + 1];  ///< the last entry repeats the previous one, so that interpolation never reads past it
+
+};
+
+
+//======================================================================================================================
+/// Stops of the built-in palettes, construct a Palette from them to use them.
+/** Example: \code
+  *   static const Palette fire( palettes::Fire );
+  *   fire.map( frame.data(), heat.data(), heat.size() );
+  * \endcode */
+
+namespace palettes {
+
+/// black through deep red, orange and yellow to white
+constexpr PaletteStop Fire [] =
+{
+	{   0,   0,   0,   0 },
+	{  64, 128,   0,   0 },
+	{ 128, 255,  32,   0 },
+	{ 192, 255, 160,   0 },
+	{ 240, 255, 255,  96 },
+	{ 255, 255, 255, 255 },
+};
+
+/// deep blue through blue and teal to the light cyan of the foam
+constexpr PaletteStop Ocean [] =
+{
+	{   0,   0,   0,  32 },
+	{  80,   0,  32, 160 },
+	{ 160,   0, 128, 160 },
+	{ 224,  64, 224, 224 },
+	{ 255, 200, 255, 255 },
+};
+
+/// night sky through green and teal to violet
+constexpr PaletteStop Aurora [] =
+{
+	{   0,   0,   8,  24 },
+	{  64,   0, 160,  64 },
+	{ 128,  32, 255, 128 },
+	{ 192,  16, 128, 192 },
+	{ 255, 128,   0, 192 },
+};
+
+/// full circle of the hues, starting and ending with red
+constexpr PaletteStop Rainbow [] =
+{
+	{   0, 255,   0,   0 },
+	{  43, 255, 255,   0 },
+	{  85,   0, 255,   0 },
+	{ 128,   0, 255, 255 },
+	{ 171,   0,   0, 255 },
+	{ 213, 255,   0, 255 },
+	{ 255, 255,   0,   0 },
+};
+
+} // namespace palettes
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_PALETTE_INCLUDED
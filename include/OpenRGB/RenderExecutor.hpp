@@ -0,0 +1,125 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: pool of threads that run the tasks of a frame in parallel
+//======================================================================================================================
+
+#ifndef OPENRGB_RENDER_EXECUTOR_INCLUDED
+#define OPENRGB_RENDER_EXECUTOR_INCLUDED
+
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Pool of threads that run batches of independent tasks, like rendering the devices of one frame.
+/** At the start of a batch, every thread gets a contiguous range of the tasks. When a thread finishes its own range,
+  * it steals the remaining tasks from the ends of the ranges of the other threads, so a few expensive devices
+  * don't leave the other threads idle. The thread that calls run() works too and run() returns only after
+  * all the tasks are finished, so the results can be used right away.
+  *
+  * Give it to EffectEngine::setExecutor() to render the layers and composite the devices in parallel. */
+
+class RenderExecutor
+{
+
+ public:
+
+	/// Starts the threads.
+	/** \param threadCount number of threads working on a batch, including the one calling run(),
+	  *                    0 means one per CPU core
+	  * \throws std::system_error when a thread can't be started, the already started ones are stopped first */
+	explicit RenderExecutor( unsigned threadCount = 0 );
+
+	/// Stops and joins the threads.
+	~RenderExecutor() noexcept;
+
+	RenderExecutor( const RenderExecutor & other ) = delete;
+	RenderExecutor & operator=( const RenderExecutor & other ) = delete;
+
+	/// Number of threads working on a batch, including the one calling run().
+	unsigned threadCount() const noexcept  { return _threadCount; }
+
+	/// Calls task( taskIdx, threadIdx ) for every taskIdx from 0 to taskCount - 1 and waits until all are finished.
+	/** The calls run in parallel, so the task must be safe to call from multiple threads for different indexes.
+	  * threadIdx is between 0 and threadCount() - 1, 0 is the thread calling run(). The task must not throw.
+	  * Only one thread may call run() at a time. */
+	template< typename Task >
+	void run( size_t taskCount, Task && task )
+	{
+		runBatch( taskCount, &invoke< typename std::remove_reference< Task >::type >, &task );
+	}
+
+	/// Number of tasks of the last batch that were run by a different thread than the one they were assigned to.
+	uint32_t lastStolenCount() const noexcept  { return _stolenCount.load( std::memory_order_relaxed ); }
+
+ private:
+
+	using Invoker = void (*)( void * task, size_t taskIdx, unsigned threadIdx );
+
+	template< typename Task >
+	static void invoke( void * task, size_t taskIdx, unsigned threadIdx )
+	{
+		(*static_cast< Task * >( task ))( taskIdx, threadIdx );
+	}
+
+	void runBatch( size_t taskCount, Invoker invoker, void * task );
+	void threadLoop( unsigned threadIdx ) noexcept;
+	void work( unsigned threadIdx ) noexcept;
+	bool popOwn( unsigned threadIdx, size_t & taskIdx ) noexcept;
+	bool steal( unsigned threadIdx, size_t & taskIdx ) noexcept;
+
+ private:
+
+	static constexpr size_t cacheLineSize = 64;
+
+	/// Tasks of one thread, the owner takes them from the front and the other threads steal them from the back.
+	/** Each queue is in its own cache line, so that the threads don't slow each other down by taking their own tasks. */
+	struct alignas( cacheLineSize ) Queue
+	{
+		std::atomic< uint64_t > range;  ///< index of the first task in the low 32 bits, index after the last in the high
+	};
+
+	void stopThreads() noexcept;
+
+	unsigned _threadCount;
+	// operator new of C++11 doesn't respect alignment above alignof( std::max_align_t ), so the queues are placed
+	// into a buffer larger by one cache line
+	std::unique_ptr< unsigned char [] > _queueBuffer;
+	Queue * _queues;
+	std::vector< std::thread > _threads;
+
+	// the current batch
+	Invoker _invoker;
+	void * _task;
+	std::atomic< uint32_t > _stolenCount;
+
+	std::mutex _mutex;
+	std::condition_variable _batchStarted;
+	std::condition_variable _batchFinished;
+	uint64_t _batchNumber;     ///< incremented for every batch, so that the threads know there is a new one
+	unsigned _busyThreads;     ///< background threads that haven't finished the current batch yet
+	bool _stopping;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_RENDER_EXECUTOR_INCLUDED
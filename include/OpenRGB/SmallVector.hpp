@@ -0,0 +1,286 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: vector with inline storage for a few elements
+//======================================================================================================================
+
+#ifndef OPENRGB_SMALL_VECTOR_INCLUDED
+#define OPENRGB_SMALL_VECTOR_INCLUDED
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Contiguous container with the same basic interface as std::vector, that stores up to N elements inside itself.
+/** Only when it grows over N elements it allocates memory on the heap like std::vector.
+  * To keep it simple, it is limited to trivially copyable types, so the elements can be moved around by memcpy. */
+
+template< typename Type, size_t N >
+class SmallVector
+{
+	static_assert( std::is_trivially_copyable< Type >::value, "SmallVector supports only trivially copyable types" );
+	static_assert( N > 0, "use std::vector when you don't want any inline storage" );
+
+ public:
+
+	using value_type = Type;
+	using size_type = size_t;
+	using reference = Type &;
+	using const_reference = const Type &;
+	using iterator = Type *;
+	using const_iterator = const Type *;
+
+	static constexpr size_t inlineCapacity = N;
+
+	SmallVector() noexcept : _data( inlineData() ), _size( 0 ), _capacity( N ) {}
+
+	explicit SmallVector( size_t count, const Type & value = Type() ) : SmallVector()
+	{
+		resize( count, value );
+	}
+
+	SmallVector( std::initializer_list< Type > list ) : SmallVector()
+	{
+		assign( list.begin(), list.end() );
+	}
+
+	template< typename InputIter, typename = typename std::iterator_traits< InputIter >::iterator_category >
+	SmallVector( InputIter first, InputIter last ) : SmallVector()
+	{
+		assign( first, last );
+	}
+
+	// implicit, so that the code written for the std::vector members that became SmallVector still compiles
+	SmallVector( const std::vector< Type > & vec ) : SmallVector()
+	{
+		assign( vec.begin(), vec.end() );
+	}
+
+	SmallVector( const SmallVector & other ) : SmallVector()
+	{
+		assign( other.begin(), other.end() );
+	}
+
+	SmallVector( SmallVector && other ) noexcept : SmallVector()
+	{
+		steal( other );
+	}
+
+	~SmallVector()
+	{
+		freeHeap();
+	}
+
+	SmallVector & operator=( const SmallVector & other )
+	{
+		if (this != &other)
+			assign( other.begin(), other.end() );
+		return *this;
+	}
+
+	SmallVector & operator=( SmallVector && other ) noexcept
+	{
+		if (this != &other)
+		{
+			freeHeap();
+			_data = inlineData();
+			_size = 0;
+			_capacity = N;
+			steal( other );
+		}
+		return *this;
+	}
+
+	SmallVector & operator=( std::initializer_list< Type > list )
+	{
+		assign( list.begin(), list.end() );
+		return *this;
+	}
+
+	SmallVector & operator=( const std::vector< Type > & vec )
+	{
+		assign( vec.begin(), vec.end() );
+		return *this;
+	}
+
+	//-- element access ------------------------------------------------------------------------------------------------
+
+	Type * data() noexcept                           { return _data; }
+	const Type * data() const noexcept               { return _data; }
+	Type & operator[]( size_t pos ) noexcept         { return _data[ pos ]; }
+	const Type & operator[]( size_t pos ) const noexcept  { return _data[ pos ]; }
+	Type & front() noexcept                          { return _data[0]; }
+	const Type & front() const noexcept              { return _data[0]; }
+	Type & back() noexcept                           { return _data[ _size - 1 ]; }
+	const Type & back() const noexcept               { return _data[ _size - 1 ]; }
+
+	iterator begin() noexcept               { return _data; }
+	const_iterator begin() const noexcept   { return _data; }
+	const_iterator cbegin() const noexcept  { return _data; }
+	iterator end() noexcept                 { return _data + _size; }
+	const_iterator end() const noexcept     { return _data + _size; }
+	const_iterator cend() const noexcept    { return _data + _size; }
+
+	//-- capacity ------------------------------------------------------------------------------------------------------
+
+	size_t size() const noexcept      { return _size; }
+	bool empty() const noexcept       { return _size == 0; }
+	size_t capacity() const noexcept  { return _capacity; }
+
+	/// Whether the elements are stored in the inline storage and not on the heap.
+	bool isInline() const noexcept  { return _data == inlineData(); }
+
+	void reserve( size_t newCapacity )
+	{
+		if (newCapacity > _capacity)
+			reallocate( newCapacity );
+	}
+
+	//-- modifiers -----------------------------------------------------------------------------------------------------
+
+	void clear() noexcept  { _size = 0; }
+
+	void push_back( const Type & value )
+	{
+		if (_size == _capacity)
+		{
+			Type copy = value;  // the value may be one of our elements
+			reallocate( _capacity * 2 );
+			_data[ _size++ ] = copy;
+		}
+		else
+		{
+			_data[ _size++ ] = value;
+		}
+	}
+
+	template< typename ... Args >
+	Type & emplace_back( Args && ... args )
+	{
+		push_back( Type( std::forward< Args >( args ) ... ) );
+		return back();
+	}
+
+	void pop_back() noexcept  { --_size; }
+
+	void resize( size_t newSize, const Type & value = Type() )
+	{
+		if (newSize > _capacity)
+		{
+			Type copy = value;
+			reallocate( newSize );
+			for (size_t i = _size; i < newSize; ++i)
+				_data[i] = copy;
+		}
+		else
+		{
+			for (size_t i = _size; i < newSize; ++i)
+				_data[i] = value;
+		}
+		_size = uint32_t( newSize );
+	}
+
+	template< typename InputIter >
+	void assign( InputIter first, InputIter last )
+	{
+		_size = 0;
+		size_t count = size_t( std::distance( first, last ) );
+		reserve( count );
+		for (; first != last; ++first)
+			_data[ _size++ ] = *first;
+	}
+
+	/// Converts to std::vector, for the APIs that require it.
+	std::vector< Type > toVector() const  { return std::vector< Type >( begin(), end() ); }
+
+	//-- comparison ----------------------------------------------------------------------------------------------------
+
+	friend bool operator==( const SmallVector & a, const SmallVector & b )  { return equal( a.begin(), a.size(), b.begin(), b.size() ); }
+	friend bool operator!=( const SmallVector & a, const SmallVector & b )  { return !(a == b); }
+	friend bool operator==( const SmallVector & a, const std::vector< Type > & b )  { return equal( a.begin(), a.size(), b.data(), b.size() ); }
+	friend bool operator!=( const SmallVector & a, const std::vector< Type > & b )  { return !(a == b); }
+	friend bool operator==( const std::vector< Type > & a, const SmallVector & b )  { return b == a; }
+	friend bool operator!=( const std::vector< Type > & a, const SmallVector & b )  { return !(b == a); }
+
+ private:
+
+	Type * inlineData() noexcept              { return reinterpret_cast< Type * >( _inline ); }
+	const Type * inlineData() const noexcept  { return reinterpret_cast< const Type * >( _inline ); }
+
+	static bool equal( const Type * a, size_t aSize, const Type * b, size_t bSize )
+	{
+		if (aSize != bSize)
+			return false;
+		for (size_t i = 0; i < aSize; ++i)
+			if (!(a[i] == b[i]))
+				return false;
+		return true;
+	}
+
+	void reallocate( size_t newCapacity )
+	{
+		Type * newData = static_cast< Type * >( ::operator new( newCapacity * sizeof( Type ) ) );
+		if (_size > 0)
+			std::memcpy( static_cast< void * >( newData ), _data, _size * sizeof( Type ) );
+		freeHeap();
+		_data = newData;
+		_capacity = uint32_t( newCapacity );
+	}
+
+	void freeHeap() noexcept
+	{
+		if (!isInline())
+			::operator delete( _data );
+	}
+
+	// expects this object to be empty and inline
+	void steal( SmallVector & other ) noexcept
+	{
+		if (other.isInline())
+		{
+			std::memcpy( static_cast< void * >( inlineData() ), other._data, other._size * sizeof( Type ) );
+		}
+		else
+		{
+			_data = other._data;
+			_capacity = other._capacity;
+			other._data = other.inlineData();
+			other._capacity = N;
+		}
+		_size = other._size;
+		other._size = 0;
+	}
+
+ private:
+
+	Type * _data;  ///< points either to #_inline or to the heap
+	uint32_t _size;
+	uint32_t _capacity;
+	alignas( Type ) unsigned char _inline [ N * sizeof( Type ) ];
+
+};
+
+template< typename Type, size_t N >
+constexpr size_t SmallVector< Type, N >::inlineCapacity;
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_SMALL_VECTOR_INCLUDED
@@ -0,0 +1,117 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: table of unique strings shared by many objects
+//======================================================================================================================
+
+#ifndef OPENRGB_STRING_TABLE_INCLUDED
+#define OPENRGB_STRING_TABLE_INCLUDED
+
+
+#include "StringView.hpp"
+
+#include <cstddef>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <iosfwd>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Handle to a string stored in a StringTable.
+/** The handle is just a pointer, so it's cheap to copy and two handles from the same table can be compared
+  * by comparing the pointers. Handles from different tables must not be compared.
+  * A default-constructed handle represents an empty string. */
+
+class InternedString
+{
+	const std::string * _str;
+
+ public:
+
+	constexpr InternedString() noexcept : _str( nullptr ) {}
+
+	const std::string & str() const noexcept;
+	const char * c_str() const noexcept  { return _str ? _str->c_str() : ""; }
+	size_t size() const noexcept         { return _str ? _str->size() : 0; }
+	bool empty() const noexcept          { return !_str; }
+
+	StringView view() const noexcept  { return _str ? StringView( *_str ) : StringView(); }
+	operator StringView() const noexcept  { return view(); }
+
+	friend bool operator==( InternedString a, InternedString b ) noexcept  { return a._str == b._str; }
+	friend bool operator!=( InternedString a, InternedString b ) noexcept  { return a._str != b._str; }
+
+	friend std::ostream & operator<<( std::ostream & os, InternedString str );
+
+ private:
+
+	friend class StringTable;
+	explicit InternedString( const std::string * str ) noexcept : _str( str ) {}
+
+};
+
+
+//======================================================================================================================
+/// Stores every distinct string only once and hands out InternedString handles to it.
+/** Names like "Direct", "Static" or "Key: A" repeat across devices and across refreshes, so objects that keep
+  * many of them can hold handles into one shared table instead of their own copies. In this library that's only
+  * DeviceSnapshot, Device and its sub-objects keep their own copies, because their names are public std::string
+  * members.
+  *
+  * The table only grows, the strings are never removed, so the handles stay valid as long as the table exists.
+  * To bound its size, the owner replaces it by a new table once isOversized() says so, while the objects holding
+  * handles into the old one keep it alive by a shared_ptr. All methods can be called from multiple threads
+  * at the same time. */
+
+class StringTable
+{
+
+ public:
+
+	StringTable() {}
+
+	StringTable( const StringTable & other ) = delete;
+	StringTable & operator=( const StringTable & other ) = delete;
+
+	/// Returns the handle to a string equal to \p str, adds the string to the table if it isn't there yet.
+	InternedString intern( StringView str );
+
+	/// Looks up a string without adding it.
+	/** \returns false when no string equal to \p str is in the table. */
+	bool find( StringView str, InternedString & result ) const;
+
+	/// Number of distinct strings in the table.
+	size_t size() const;
+
+	/// Tells whether the table holds so many strings beyond those still in use that it should be replaced.
+	/** A table refilled with changing names, like the names of devices that come and go, would otherwise grow forever.
+	  * \param stringsInUse how many strings the current users of the table need, an upper estimate is enough */
+	bool isOversized( size_t stringsInUse ) const;
+
+ private:
+
+	struct Hash
+	{
+		size_t operator()( StringView str ) const noexcept;
+	};
+
+	mutable std::mutex _mutex;
+	std::deque< std::string > _storage;  ///< deque doesn't move its elements when growing, so the handles stay valid
+	std::unordered_map< StringView, const std::string *, Hash > _lookup;  ///< the keys point into #_storage
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_STRING_TABLE_INCLUDED
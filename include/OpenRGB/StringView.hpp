@@ -0,0 +1,71 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: non-owning reference to a string
+//======================================================================================================================
+
+#ifndef OPENRGB_STRING_VIEW_INCLUDED
+#define OPENRGB_STRING_VIEW_INCLUDED
+
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <iosfwd>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Non-owning reference to a sequence of characters, a minimal substitute of C++17 std::string_view.
+/** The referenced characters are NOT guaranteed to be terminated by '\0'. */
+
+class StringView
+{
+	const char * _data;
+	size_t _size;
+
+ public:
+
+	constexpr StringView() noexcept : _data( "" ), _size( 0 ) {}
+	constexpr StringView( const char * data, size_t size ) noexcept : _data( data ), _size( size ) {}
+	StringView( const char * cstr ) noexcept : _data( cstr ), _size( strlen( cstr ) ) {}
+	StringView( const std::string & str ) noexcept : _data( str.data() ), _size( str.size() ) {}
+
+	constexpr const char * data() const noexcept  { return _data; }
+	constexpr size_t size() const noexcept        { return _size; }
+	constexpr size_t length() const noexcept      { return _size; }
+	constexpr bool empty() const noexcept         { return _size == 0; }
+
+	constexpr const char * begin() const noexcept  { return _data; }
+	constexpr const char * end() const noexcept    { return _data + _size; }
+
+	constexpr char operator[]( size_t pos ) const noexcept  { return _data[ pos ]; }
+
+	/// Makes an owning copy of the referenced characters.
+	std::string str() const  { return std::string( _data, _size ); }
+	explicit operator std::string() const  { return str(); }
+
+	friend bool operator==( StringView a, StringView b ) noexcept
+	{
+		return a._size == b._size && memcmp( a._data, b._data, a._size ) == 0;
+	}
+	friend bool operator!=( StringView a, StringView b ) noexcept
+	{
+		return !(a == b);
+	}
+
+	friend std::ostream & operator<<( std::ostream & os, StringView str );
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_STRING_VIEW_INCLUDED
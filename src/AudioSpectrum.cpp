@@ -0,0 +1,617 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: audio-reactive effect showing the spectrum of a PCM stream
+//======================================================================================================================
+
+#include "OpenRGB/AudioSpectrum.hpp"
+
+#include "Essential.hpp"
+
+#include "LangUtils.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <algorithm>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+using std::chrono::microseconds;
+
+#ifdef _WIN32
+	#include <io.h>     // _setmode, _fileno
+	#include <fcntl.h>  // _O_BINARY
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  PcmReader
+
+const char * enumString( AudioStatus status ) noexcept
+{
+	static const char * const AudioStatusStr [] =
+	{
+		"The operation was successful.",
+		"All the audio of the stream has been read.",
+		"The file could not be opened.",
+		"The stream starts like a WAV file, but its header is damaged or incomplete.",
+		"The WAV file contains other samples than 16-bit integers or 32-bit floats.",
+		"Reading the stream has failed.",
+		"The format given for a raw stream has no channels or a zero sample rate.",
+	};
+	static_assert( size_t(AudioStatus::InvalidFormat) + 1 == fut::size(AudioStatusStr), "update the AudioStatusStr" );
+
+	if (size_t(status) < fut::size(AudioStatusStr))
+	{
+		return AudioStatusStr[ size_t(status) ];
+	}
+	else
+	{
+		return "<invalid status>";
+	}
+}
+
+static inline uint16_t readLE16( const uint8_t * bytes ) noexcept
+{
+	return uint16_t( bytes[0] | (bytes[1] << 8) );
+}
+
+static inline uint32_t readLE32( const uint8_t * bytes ) noexcept
+{
+	return uint32_t( bytes[0] ) | (uint32_t( bytes[1] ) << 8) | (uint32_t( bytes[2] ) << 16) | (uint32_t( bytes[3] ) << 24);
+}
+
+PcmReader::PcmReader() noexcept
+	: _file( nullptr ), _ownsFile( false ), _dataLeft( UINT64_MAX ), _lastSystemError( 0 )
+{}
+
+PcmReader::~PcmReader() noexcept
+{
+	close();
+}
+
+AudioStatus PcmReader::open( const string & path, const PcmFormat & rawFormat )
+{
+	close();
+
+	// read() divides by the frame size and the analysis by the sample rate
+	if (rawFormat.channelCount == 0 || rawFormat.sampleRate == 0)
+	{
+		return AudioStatus::InvalidFormat;
+	}
+
+	if (path == "-")
+	{
+	 #ifdef _WIN32
+		_setmode( _fileno( stdin ), _O_BINARY );  // otherwise the bytes of CR LF would be merged
+	 #endif
+		_file = stdin;
+		_ownsFile = false;
+	}
+	else
+	{
+		_file = fopen( path.c_str(), "rb" );
+		if (!_file)
+		{
+			_lastSystemError = system_error_t( errno );
+			return AudioStatus::CannotOpen;
+		}
+		_ownsFile = true;
+	}
+
+	_format = rawFormat;
+	_dataLeft = UINT64_MAX;
+	_pending.clear();
+
+	AudioStatus status = readWavHeader();
+	if (status != AudioStatus::Success)
+	{
+		close();
+	}
+	return status;
+}
+
+void PcmReader::close() noexcept
+{
+	if (_file && _ownsFile)
+	{
+		fclose( _file );
+	}
+	_file = nullptr;
+	_ownsFile = false;
+}
+
+size_t PcmReader::readBytes( uint8_t * dst, size_t size ) noexcept
+{
+	size_t fromPending = std::min( size, _pending.size() );
+	if (fromPending > 0)
+	{
+		memcpy( dst, _pending.data(), fromPending );
+		_pending.erase( _pending.begin(), _pending.begin() + ptrdiff_t( fromPending ) );
+	}
+
+	size_t fromFile = fread( dst + fromPending, 1, size - fromPending, _file );
+	if (fromPending + fromFile < size && ferror( _file ))
+	{
+		_lastSystemError = system_error_t( errno );
+	}
+	return fromPending + fromFile;
+}
+
+AudioStatus PcmReader::readWavHeader()
+{
+	// the stream can't be rewound, so when it's not a WAV file, the bytes read so far are the first samples
+	uint8_t riff [12];
+	size_t riffSize = readBytes( riff, sizeof( riff ) );
+	if (riffSize < sizeof( riff ) || memcmp( riff, "RIFF", 4 ) != 0 || memcmp( riff + 8, "WAVE", 4 ) != 0)
+	{
+		if (ferror( _file ))
+			return AudioStatus::ReadError;
+		_pending.assign( riff, riff + riffSize );
+		return AudioStatus::Success;
+	}
+
+	bool hasFormat = false;
+	while (true)
+	{
+		uint8_t chunkHeader [8];
+		if (readBytes( chunkHeader, sizeof( chunkHeader ) ) < sizeof( chunkHeader ))
+			return AudioStatus::InvalidHeader;
+		uint32_t chunkSize = readLE32( chunkHeader + 4 );
+
+		if (memcmp( chunkHeader, "data", 4 ) == 0)
+		{
+			if (!hasFormat)
+				return AudioStatus::InvalidHeader;
+			// writers that stream the file don't know the size in advance
+			_dataLeft = chunkSize == 0 || chunkSize == UINT32_MAX ? UINT64_MAX : chunkSize;
+			return AudioStatus::Success;
+		}
+
+		// chunks are aligned to 2 bytes
+		uint64_t bytesLeft = uint64_t( chunkSize ) + (chunkSize & 1);
+
+		if (memcmp( chunkHeader, "fmt ", 4 ) == 0)
+		{
+			uint8_t fmt [40];  // the extensible format is the longest one
+			if (chunkSize < 16 || bytesLeft > sizeof( fmt ) || readBytes( fmt, size_t( bytesLeft ) ) < bytesLeft)
+				return AudioStatus::InvalidHeader;
+			bytesLeft = 0;
+
+			uint16_t formatTag = readLE16( fmt );
+			uint16_t channelCount = readLE16( fmt + 2 );
+			uint32_t sampleRate = readLE32( fmt + 4 );
+			uint16_t bitsPerSample = readLE16( fmt + 14 );
+			if (formatTag == 0xFFFE && chunkSize >= 26)  // WAVE_FORMAT_EXTENSIBLE, the real tag starts the sub-format
+				formatTag = readLE16( fmt + 24 );
+			if (channelCount == 0 || sampleRate == 0)
+				return AudioStatus::InvalidHeader;
+
+			if (formatTag == 1 && bitsPerSample == 16)
+				_format = PcmFormat( sampleRate, channelCount, SampleFormat::Int16 );
+			else if (formatTag == 3 && bitsPerSample == 32)
+				_format = PcmFormat( sampleRate, channelCount, SampleFormat::Float32 );
+			else
+				return AudioStatus::UnsupportedFormat;
+			hasFormat = true;
+		}
+
+		// skip the chunks we don't need, like LIST with the metadata
+		uint8_t skipped [256];
+		while (bytesLeft > 0)
+		{
+			size_t toSkip = size_t( std::min( bytesLeft, uint64_t( sizeof( skipped ) ) ) );
+			if (readBytes( skipped, toSkip ) < toSkip)
+				return AudioStatus::InvalidHeader;
+			bytesLeft -= toSkip;
+		}
+	}
+}
+
+AudioStatus PcmReader::read( float * samples, size_t frameCount, size_t & framesRead )
+{
+	framesRead = 0;
+	if (!_file)
+	{
+		return AudioStatus::ReadError;
+	}
+
+	const size_t frameSize = _format.frameSize();
+	uint64_t byteCount = std::min( uint64_t( frameCount ) * frameSize, _dataLeft - _dataLeft % frameSize );
+	if (_buffer.size() < byteCount)
+	{
+		_buffer.resize( size_t( byteCount ) );
+	}
+
+	size_t bytesRead = readBytes( _buffer.data(), size_t( byteCount ) );
+	if (_dataLeft != UINT64_MAX)
+	{
+		_dataLeft -= bytesRead;
+	}
+	framesRead = bytesRead / frameSize;  // an incomplete frame can only be at the end of the stream
+	if (framesRead == 0)
+	{
+		return ferror( _file ) ? AudioStatus::ReadError : AudioStatus::EndOfStream;
+	}
+
+	const uint8_t * bytes = _buffer.data();
+	const uint32_t channelCount = _format.channelCount;
+	if (_format.sampleFormat == SampleFormat::Int16)
+	{
+		const float scale = 1.0f / (32768.0f * float( channelCount ));
+		for (size_t frameIdx = 0; frameIdx < framesRead; ++frameIdx)
+		{
+			int32_t sum = 0;
+			for (uint32_t channel = 0; channel < channelCount; ++channel, bytes += 2)
+				sum += int16_t( readLE16( bytes ) );
+			samples[ frameIdx ] = float( sum ) * scale;
+		}
+	}
+	else
+	{
+		const float scale = 1.0f / float( channelCount );
+		for (size_t frameIdx = 0; frameIdx < framesRead; ++frameIdx)
+		{
+			float sum = 0.0f;
+			for (uint32_t channel = 0; channel < channelCount; ++channel, bytes += 4)
+			{
+				uint32_t bits = readLE32( bytes );
+				float sample;
+				memcpy( &sample, &bits, sizeof( sample ) );
+				sum += sample;
+			}
+			samples[ frameIdx ] = sum * scale;
+		}
+	}
+
+	return AudioStatus::Success;
+}
+
+
+//======================================================================================================================
+//  SpectrumAnalyzer
+
+static const float Pi = 3.14159265358979f;
+
+constexpr uint32_t SpectrumAnalyzer::maxFftSize;
+
+bool SpectrumAnalyzer::setup( uint32_t sampleRate, const SpectrumConfig & config )
+{
+	// rounding a size above 2^31 up to a power of 2 would never end
+	if (sampleRate == 0 || config.fftSize > maxFftSize)
+	{
+		return false;
+	}
+	// the edges of the bands would be NaN or out of order
+	if (!std::isfinite( config.minFrequency ) || !std::isfinite( config.maxFrequency )
+	 || config.minFrequency < 0.0f || config.minFrequency >= config.maxFrequency)
+	{
+		return false;
+	}
+
+	_config = config;
+	_sampleRate = sampleRate;
+
+	uint32_t fftSize = 16;
+	while (fftSize < config.fftSize)
+		fftSize <<= 1;
+	_config.fftSize = fftSize;
+	const uint32_t halfSize = fftSize / 2;
+
+	_history.assign( fftSize, 0.0f );
+
+	// the window sums to fftSize / 2, a sine of amplitude A then gives A * fftSize / 4 in its bin
+	_window.resize( fftSize );
+	for (uint32_t i = 0; i < fftSize; ++i)
+		_window[i] = (0.5f - 0.5f * std::cos( 2.0f * Pi * float( i ) / float( fftSize ) )) * (4.0f / float( fftSize ));
+
+	_real.resize( halfSize );
+	_imag.resize( halfSize );
+	_cos.resize( halfSize + 1 );
+	_sin.resize( halfSize + 1 );
+	for (uint32_t i = 0; i <= halfSize; ++i)
+	{
+		_cos[i] = std::cos( 2.0f * Pi * float( i ) / float( fftSize ) );
+		_sin[i] = std::sin( 2.0f * Pi * float( i ) / float( fftSize ) );
+	}
+	uint32_t bitCount = 0;
+	while ((1u << bitCount) < halfSize)
+		++bitCount;
+	_reversed.resize( halfSize );
+	for (uint32_t i = 0; i < halfSize; ++i)
+	{
+		uint32_t reversed = 0;
+		for (uint32_t bit = 0; bit < bitCount; ++bit)
+			reversed |= ((i >> bit) & 1) << (bitCount - 1 - bit);
+		_reversed[i] = reversed;
+	}
+	_magnitudes.assign( halfSize + 1, 0.0f );
+
+	// logarithmically spaced bands, each of them at least one bin wide
+	const float nyquist = float( sampleRate ) / 2.0f;
+	const float maxFrequency = std::min( config.maxFrequency, nyquist );
+	const float minFrequency = std::min( std::max( config.minFrequency, 1.0f ), maxFrequency );
+	const float binsPerHz = float( fftSize ) / float( sampleRate );
+	_bandBins.resize( config.bandCount );
+	for (uint32_t band = 0; band < config.bandCount; ++band)
+	{
+		float lowEdge = minFrequency * std::pow( maxFrequency / minFrequency, float( band ) / float( config.bandCount ) );
+		float highEdge = minFrequency * std::pow( maxFrequency / minFrequency, float( band + 1 ) / float( config.bandCount ) );
+		uint32_t firstBin = std::min( std::max( uint32_t( lowEdge * binsPerHz + 0.5f ), 1u ), halfSize );
+		uint32_t endBin = std::min( std::max( uint32_t( highEdge * binsPerHz + 0.5f ), firstBin + 1 ), halfSize + 1 );
+		_bandBins[ band ] = std::make_pair( firstBin, endBin );
+	}
+
+	_levels.assign( config.bandCount, 0.0f );
+	_loudness = 0.0f;
+	return true;
+}
+
+void SpectrumAnalyzer::transform() noexcept
+{
+	// complex FFT of half the size, with the even samples as the real parts and the odd samples as the imaginary parts
+	const uint32_t fftSize = _config.fftSize;
+	const uint32_t halfSize = fftSize / 2;
+	float * const re = _real.data();
+	float * const im = _imag.data();
+
+	for (uint32_t i = 0; i < halfSize; ++i)
+	{
+		uint32_t source = _reversed[i];
+		re[i] = _history[ 2 * source ] * _window[ 2 * source ];
+		im[i] = _history[ 2 * source + 1 ] * _window[ 2 * source + 1 ];
+	}
+
+	for (uint32_t size = 2; size <= halfSize; size <<= 1)
+	{
+		const uint32_t half = size / 2;
+		const uint32_t stride = fftSize / size;
+		for (uint32_t start = 0; start < halfSize; start += size)
+		{
+			for (uint32_t j = 0; j < half; ++j)
+			{
+				float wr = _cos[ j * stride ], wi = -_sin[ j * stride ];
+				uint32_t a = start + j, b = a + half;
+				float tr = wr * re[b] - wi * im[b];
+				float ti = wr * im[b] + wi * re[b];
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+
+	// separate the spectra of the even and the odd samples and combine them into the spectrum of the whole signal
+	for (uint32_t k = 0; k <= halfSize; ++k)
+	{
+		uint32_t mirrored = (halfSize - k) % halfSize;
+		float zr = re[ k % halfSize ], zi = im[ k % halfSize ];
+		float cr = re[ mirrored ], ci = -im[ mirrored ];
+		float evenRe = (zr + cr) * 0.5f, evenIm = (zi + ci) * 0.5f;
+		float oddRe = (zi - ci) * 0.5f, oddIm = -(zr - cr) * 0.5f;
+		float wr = _cos[k], wi = -_sin[k];
+		float xr = evenRe + wr * oddRe - wi * oddIm;
+		float xi = evenIm + wr * oddIm + wi * oddRe;
+		_magnitudes[k] = std::sqrt( xr * xr + xi * xi );
+	}
+}
+
+// maps a power relative to the full scale to 0.0 .. 1.0 between the floor and 0 dB
+static inline float powerToLevel( float power, float floor ) noexcept
+{
+	float dB = 10.0f * std::log10( std::max( power, 1e-12f ) );
+	return std::min( std::max( 1.0f - dB / floor, 0.0f ), 1.0f );
+}
+
+static inline float smooth( float current, float target, float attack, float decay ) noexcept
+{
+	return current + (target - current) * (target > current ? attack : decay);
+}
+
+void SpectrumAnalyzer::process( const float * samples, size_t count ) noexcept
+{
+	const size_t historySize = _history.size();
+	if (historySize == 0)
+	{
+		return;
+	}
+
+	if (count >= historySize)
+	{
+		std::copy( samples + count - historySize, samples + count, _history.begin() );
+	}
+	else
+	{
+		std::copy( _history.begin() + ptrdiff_t( count ), _history.end(), _history.begin() );
+		std::copy( samples, samples + count, _history.end() - ptrdiff_t( count ) );
+	}
+
+	transform();
+
+	for (size_t band = 0; band < _levels.size(); ++band)
+	{
+		float power = 0.0f;
+		for (uint32_t bin = _bandBins[ band ].first; bin < _bandBins[ band ].second; ++bin)
+			power += _magnitudes[ bin ] * _magnitudes[ bin ];
+		_levels[ band ] = smooth( _levels[ band ], powerToLevel( power, _config.floor ), _config.attack, _config.decay );
+	}
+
+	// mean square of the new samples, doubled so that a full-scale sine gives 0 dB like in the bands
+	float sumOfSquares = 0.0f;
+	for (size_t i = 0; i < count; ++i)
+		sumOfSquares += samples[i] * samples[i];
+	float power = count > 0 ? 2.0f * sumOfSquares / float( count ) : 0.0f;
+	_loudness = smooth( _loudness, powerToLevel( power, _config.floor ), _config.attack, _config.decay );
+}
+
+float SpectrumAnalyzer::levelAt( float position ) const noexcept
+{
+	if (_levels.empty())
+	{
+		return 0.0f;
+	}
+
+	// the levels are at the centers of the bands
+	float x = std::min( std::max( position * float( _levels.size() ) - 0.5f, 0.0f ), float( _levels.size() - 1 ) );
+	size_t lower = size_t( x );
+	size_t upper = std::min( lower + 1, _levels.size() - 1 );
+	float fraction = x - float( lower );
+	return _levels[ lower ] + (_levels[ upper ] - _levels[ lower ]) * fraction;
+}
+
+
+//======================================================================================================================
+//  SpectrumLayer
+
+void SpectrumLayer::reset( LayerCanvas & canvas )
+{
+	const DeviceList & devices = canvas.devices();
+	_placements.resize( devices.size() );
+
+	for (size_t deviceIdx = 0; deviceIdx < devices.size(); ++deviceIdx)
+	{
+		const Device & device = devices[ deviceIdx ];
+		vector< Placement > & placements = _placements[ deviceIdx ];
+		placements.assign( device.leds.size(), Placement{ -1.0f, -1.0f } );
+
+		// a malformed zone may reach past the end of Device::leds, only the LEDs the device has are spread
+		auto spread = [&]( uint32_t firstLed, uint32_t ledCount )
+		{
+			if (firstLed >= placements.size())
+				return;
+			ledCount = uint32_t( std::min< size_t >( ledCount, placements.size() - firstLed ) );
+			for (uint32_t i = 0; i < ledCount; ++i)
+				placements[ firstLed + i ].band = (float( i ) + 0.5f) / float( ledCount );
+		};
+
+		if (device.zones.empty())
+		{
+			spread( 0, uint32_t( device.leds.size() ) );
+		}
+		for (const Zone & zone : device.zones)
+		{
+			if (zone.type == ZoneType::Matrix && zone.matrix_width > 0 && zone.matrix_height > 0
+			 && zone.matrix_leds.size() == size_t( zone.matrix_width ) * zone.matrix_height)
+			{
+				for (uint32_t row = 0; row < zone.matrix_height; ++row)
+				{
+					for (uint32_t col = 0; col < zone.matrix_width; ++col)
+					{
+						uint32_t ledIdx = zone.ledAt( row, col );
+						if (ledIdx == Zone::noLED || ledIdx >= placements.size())
+							continue;
+						placements[ ledIdx ].band = (float( col ) + 0.5f) / float( zone.matrix_width );
+						// the row 0 is at the top
+						placements[ ledIdx ].height = (float( zone.matrix_height - 1 - row ) + 0.5f) / float( zone.matrix_height );
+					}
+				}
+			}
+			else if (zone.type != ZoneType::Single)
+			{
+				spread( zone.startIdx, zone.leds_count );
+			}
+		}
+	}
+}
+
+void SpectrumLayer::renderPart( const RenderPart & part, Color * colors, double /*time*/ )
+{
+	const vector< Placement > & placements = _placements[ part.deviceIdx ];
+
+	for (uint32_t i = 0; i < part.ledCount; ++i)
+	{
+		const Placement & placement = placements[ part.firstLed + i ];
+		Color color;
+		if (placement.height >= 0.0f)
+		{
+			float level = _analyzer.levelAt( placement.band );
+			color = _palette.sample( placement.height );
+			color.padding = level > placement.height ? 255 : 0;
+		}
+		else if (placement.band >= 0.0f)
+		{
+			float level = _analyzer.levelAt( placement.band );
+			color = _palette.sample( placement.band );
+			color.padding = uint8_t( level * 255.0f + 0.5f );
+		}
+		else
+		{
+			float loudness = _analyzer.loudness();
+			color = _palette.sample( loudness );
+			color.padding = uint8_t( loudness * 255.0f + 0.5f );
+		}
+		colors[i] = color;
+	}
+}
+
+
+//======================================================================================================================
+//  latency
+
+void LatencyReport::add( const AudioLatency & latency ) noexcept
+{
+	_blockCount++;
+	if (latency.processing() > latency.block)
+		_overruns++;
+
+	_sum.block += latency.block;
+	_sum.analysis += latency.analysis;
+	_sum.render += latency.render;
+	_sum.send += latency.send;
+
+	_maximum.block = std::max( _maximum.block, latency.block );
+	_maximum.analysis = std::max( _maximum.analysis, latency.analysis );
+	_maximum.render = std::max( _maximum.render, latency.render );
+	_maximum.send = std::max( _maximum.send, latency.send );
+	_maximumTotal = std::max( _maximumTotal, latency.total() );
+}
+
+AudioLatency LatencyReport::average() const noexcept
+{
+	AudioLatency average;
+	if (_blockCount > 0)
+	{
+		auto count = microseconds::rep( _blockCount );
+		average.block = _sum.block / count;
+		average.analysis = _sum.analysis / count;
+		average.render = _sum.render / count;
+		average.send = _sum.send / count;
+	}
+	return average;
+}
+
+static void printStage( const char * name, microseconds average, microseconds maximum, microseconds budget )
+{
+	printf( "  %-10s %10.2f ms %10.2f ms", name, double( average.count() ) / 1000.0, double( maximum.count() ) / 1000.0 );
+	if (budget.count() > 0)
+		printf( " %8.1f %%", 100.0 * double( average.count() ) / double( budget.count() ) );
+	printf( "\n" );
+}
+
+void print( const LatencyReport & report )
+{
+	AudioLatency average = report.average();
+	const AudioLatency & maximum = report.maximum();
+
+	printf( "audio latency of %zu blocks, %zu of them processed slower than real time\n", report.blockCount(), report.overruns() );
+	printf( "  %-10s %13s %13s %10s\n", "stage", "average", "maximum", "budget" );
+	printStage( "block", average.block, maximum.block, microseconds( 0 ) );
+	printStage( "analysis", average.analysis, maximum.analysis, average.block );
+	printStage( "render", average.render, maximum.render, average.block );
+	printStage( "send", average.send, maximum.send, average.block );
+	printStage( "total", average.total(), report.maximumTotal(), microseconds( 0 ) );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
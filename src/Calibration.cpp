@@ -0,0 +1,105 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: correction of colors for the specifics of a device
+//======================================================================================================================
+
+#include "OpenRGB/Calibration.hpp"
+
+#include "Essential.hpp"
+
+#include <cstring>
+#include <cmath>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+Calibration::Calibration() noexcept
+{
+	for (size_t row = 0; row < 3; ++row)
+		for (size_t column = 0; column < 3; ++column)
+			_matrix[ row ][ column ] = row == column ? 1.0f : 0.0f;
+	_whitePoint = Color::White;
+	setGamma( 1.0f );
+	updateMatrix();
+}
+
+bool Calibration::setMatrix( const float (& matrix) [3][3] ) noexcept
+{
+	for (size_t row = 0; row < 3; ++row)
+		for (size_t column = 0; column < 3; ++column)
+			if (!std::isfinite( matrix[ row ][ column ] ))
+				return false;
+
+	memcpy( _matrix, matrix, sizeof( _matrix ) );
+	updateMatrix();
+	return true;
+}
+
+void Calibration::setWhitePoint( Color whitePoint ) noexcept
+{
+	_whitePoint = whitePoint;
+	updateMatrix();
+}
+
+bool Calibration::setGamma( float red, float green, float blue ) noexcept
+{
+	if (!(red > 0.0f && green > 0.0f && blue > 0.0f))
+	{
+		return false;
+	}
+
+	_gamma[0] = red;
+	_gamma[1] = green;
+	_gamma[2] = blue;
+	for (size_t channel = 0; channel < 3; ++channel)
+		_gammaLUTs[ channel ] = colorops::ChannelLUT::gamma( _gamma[ channel ] );
+	_isIdentityGamma = _gamma[0] == 1.0f && _gamma[1] == 1.0f && _gamma[2] == 1.0f;
+	return true;
+}
+
+void Calibration::updateMatrix() noexcept
+{
+	const uint8_t white [3] = { _whitePoint.r, _whitePoint.g, _whitePoint.b };
+	float scaled [3][3];
+	for (size_t row = 0; row < 3; ++row)
+		for (size_t column = 0; column < 3; ++column)
+			scaled[ row ][ column ] = _matrix[ row ][ column ] * (float( white[ row ] ) / 255.0f);
+	_fixedMatrix = colorops::ColorMatrix::fromFloats( scaled );
+
+	const colorops::ColorMatrix identity = colorops::ColorMatrix::identity();
+	_isIdentityMatrix = memcmp( _fixedMatrix.values, identity.values, sizeof( identity.values ) ) == 0;
+}
+
+void Calibration::apply( Color * dst, const Color * src, size_t count ) const noexcept
+{
+	if (_isIdentityMatrix && _isIdentityGamma)
+	{
+		if (dst != src)
+			memmove( dst, src, count * sizeof( Color ) );
+	}
+	else if (_isIdentityMatrix)
+	{
+		colorops::applyLUT( dst, src, count, _gammaLUTs[0], _gammaLUTs[1], _gammaLUTs[2] );
+	}
+	else
+	{
+		colorops::transform( dst, src, count, _fixedMatrix, _gammaLUTs[0], _gammaLUTs[1], _gammaLUTs[2] );
+	}
+}
+
+Color Calibration::apply( Color color ) const noexcept
+{
+	apply( &color, &color, 1 );
+	return color;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -26,6 +26,8 @@ using fut::make_unique;
 using own::span;
 using own::make_span;
 #include "CriticalError.hpp"
+#include "MiscUtils.hpp"
+#include "DeviceIdentity.hpp"
 
 #include <string>
 using std::string;
@@ -33,8 +35,11 @@ using std::string;
 using std::vector;
 #include <array>
 using std::array;
+#include <memory>
+using std::unique_ptr;
 #include <chrono>
 using std::chrono::milliseconds;
+#include <algorithm>  // sort
 
 
 namespace orgb {
@@ -128,6 +133,9 @@ Client::Client( const std::string & clientName ) noexcept
 	_clientName( clientName ),
 	_socket( new TcpSocket ),
 	_negotiatedProtocolVersion( 0 ),
+	_port( 0 ),
+	_stringTable( std::make_shared< StringTable >() ),
+	_snapshotNameCount( 0 ),
 	_isDeviceListOutOfDate( true )
 {}
 
@@ -201,6 +209,9 @@ ConnectStatus Client::_connect( const std::string & host, uint16_t port )
 	// }
 	_isDeviceListOutOfDate = true;
 
+	_host = host;
+	_port = port;
+
 	return ConnectStatus::Success;
 }
 
@@ -230,7 +241,18 @@ bool Client::_setTimeout( std::chrono::milliseconds timeout ) noexcept
 	return _socket->setTimeout( timeout );
 }
 
-DeviceListResult Client::_requestDeviceList()
+DeviceListResult Client::_requestDeviceList( const DeviceListOptions & options )
+{
+	DeviceListResult result = _downloadDeviceList( options );
+	if (result.status == RequestStatus::Success)
+	{
+		if (std::shared_ptr< const DeviceList > sharedCopy = copyIfShared( result.devices._list ))
+			std::atomic_store( &_sharedDeviceList, move( sharedCopy ) );
+	}
+	return result;
+}
+
+DeviceListResult Client::_downloadDeviceList( const DeviceListOptions & options )
 {
 	if (!_socket->isConnected())
 	{
@@ -267,7 +289,7 @@ DeviceListResult Client::_requestDeviceList()
 				return result;
 			}
 
-			auto deviceDataResult = awaitMessage< ReplyControllerData >();
+			auto deviceDataResult = awaitDeviceData( options );
 			if (deviceDataResult.status != RequestStatus::Success)
 			{
 				result.status = deviceDataResult.status;
@@ -284,6 +306,501 @@ DeviceListResult Client::_requestDeviceList()
 	return result;
 }
 
+RequestStatus Client::_requestDeviceList( DeviceList & devices, const DeviceListOptions & options )
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+
+	// The devices are parsed into the spare list, so that the caller's list stays intact when the request fails
+	// and nobody sees a device that is half-overwritten.
+	DeviceList & spare = _spareDeviceList;
+	spare._index.reset();
+	uint32_t deviceCount = 0;
+
+	do
+	{
+		_isDeviceListOutOfDate = false;
+
+		bool sent = sendMessage< RequestControllerCount >();
+		if (!sent)
+		{
+			return RequestStatus::SendRequestFailed;
+		}
+
+		auto deviceCountResult = awaitMessage< ReplyControllerCount >();
+		if (deviceCountResult.status != RequestStatus::Success)
+		{
+			return deviceCountResult.status;
+		}
+		deviceCount = deviceCountResult.message.count;
+
+		// the extra devices may still be re-used next time
+		spare._list.reserve( deviceCount );
+		while (spare._list.size() < deviceCount)
+			spare._list.emplace_back( new Device );
+
+		for (uint32_t deviceIdx = 0; deviceIdx < deviceCount; ++deviceIdx)
+		{
+			sent = sendMessage< RequestControllerData >( deviceIdx, _negotiatedProtocolVersion );
+			if (!sent)
+			{
+				return RequestStatus::SendRequestFailed;
+			}
+
+			Header header;
+			RequestStatus bodyStatus = awaitMessageBody( ReplyControllerData::thisType, header, _bodyBuffer );
+			if (bodyStatus != RequestStatus::Success)
+			{
+				return bodyStatus;
+			}
+
+			// parse the reply directly into the spare device
+			Device & device = *spare._list[ deviceIdx ];
+			BinaryInputStream stream( _bodyBuffer );
+			uint32_t data_size;
+			stream >> data_size;
+			if (!device.deserialize( stream, _negotiatedProtocolVersion, deviceIdx, options ))
+			{
+				return RequestStatus::InvalidReply;
+			}
+			device.hashReply( _bodyBuffer, _negotiatedProtocolVersion );
+		}
+
+	}
+	// In the middle of the update we might receive DeviceListUpdated message. In that case we need to start again.
+	while (_isDeviceListOutOfDate);
+
+	// The received devices go to the caller and the caller's previous devices become the spare ones for the next call,
+	// together with the spare ones that weren't needed this time. Allocate first, so that nothing can throw midway.
+	DeviceList::DeviceListType nextSpare;
+	nextSpare.reserve( devices._list.size() + (spare._list.size() - deviceCount) );
+	for (unique_ptr< Device > & device : devices._list)
+		nextSpare.push_back( move( device ) );
+	for (size_t deviceIdx = deviceCount; deviceIdx < spare._list.size(); ++deviceIdx)
+		nextSpare.push_back( move( spare._list[ deviceIdx ] ) );
+	spare._list.resize( deviceCount );
+	std::shared_ptr< const DeviceList > sharedCopy = copyIfShared( spare._list );
+
+	devices._list.swap( spare._list );
+	devices._index.reset();
+	spare._list = move( nextSpare );
+	if (sharedCopy)
+		std::atomic_store( &_sharedDeviceList, move( sharedCopy ) );
+
+	return RequestStatus::Success;
+}
+
+SharedDeviceListResult Client::_requestSharedDeviceList( const DeviceListOptions & options )
+{
+	DeviceListResult listResult = _downloadDeviceList( options );
+	if (listResult.status != RequestStatus::Success)
+	{
+		return { listResult.status, nullptr };
+	}
+
+	// so that the readers don't have to wait for the indexes on their first search
+	listResult.devices.buildIndexes();
+
+	std::shared_ptr< const DeviceList > devices = std::make_shared< DeviceList >( move( listResult.devices ) );
+	std::atomic_store( &_sharedDeviceList, devices );
+
+	return { RequestStatus::Success, move( devices ) };
+}
+
+std::shared_ptr< const DeviceList > Client::currentDeviceList() const noexcept
+{
+	return std::atomic_load( &_sharedDeviceList );
+}
+
+// Only once a list has been published, see currentDeviceList(). The copy is made before the caller's list is changed,
+// so that when it throws, the caller's list stays intact. The devices are given in their new order as any kind
+// of pointers, and their indexes are set to their new positions.
+template< typename DevicePointers >
+std::shared_ptr< const DeviceList > Client::copyIfShared( const DevicePointers & devices ) const
+{
+	// only this thread publishes, so it can't become shared in the meantime
+	if (!std::atomic_load( &_sharedDeviceList ))
+		return nullptr;
+
+	std::shared_ptr< DeviceList > copy = std::make_shared< DeviceList >();
+	copy->reserve( devices.size() );
+	for (const auto & device : devices)
+	{
+		copy->_list.emplace_back( new Device( *device ) );
+		if (copy->_list.back()->idx != copy->_list.size() - 1)
+			copy->_list.back()->setIdx( uint32_t( copy->_list.size() - 1 ) );
+	}
+
+	// so that the readers don't have to wait for the indexes on their first search
+	copy->buildIndexes();
+
+	return copy;
+}
+
+DeviceListResult Client::_requestDeviceListCached( const std::string & cacheFilePath, const DeviceListOptions & options )
+{
+	if (!_socket->isConnected())
+	{
+		return { RequestStatus::NotConnected, {} };
+	}
+
+	DeviceCountResult countResult = _requestDeviceCount();
+	if (countResult.status != RequestStatus::Success)
+	{
+		return { countResult.status, {} };
+	}
+
+	string filePath = !cacheFilePath.empty() ? cacheFilePath : DeviceListCache::defaultFilePath( _host, _port );
+	string endpoint = _host + ':' + std::to_string( _port );
+	if (filePath.empty())
+	{
+		return _requestDeviceList( options );
+	}
+
+	CachedDeviceListResult cacheResult = DeviceListCache::load( filePath, endpoint, countResult.count, options );
+	if (cacheResult.status == CacheStatus::Success)
+	{
+		if (std::shared_ptr< const DeviceList > sharedCopy = copyIfShared( cacheResult.devices._list ))
+			std::atomic_store( &_sharedDeviceList, move( sharedCopy ) );
+		_isDeviceListOutOfDate = false;
+		return { RequestStatus::Success, move( cacheResult.devices ) };
+	}
+
+	DeviceListResult listResult = _requestDeviceList( options );
+	if (listResult.status == RequestStatus::Success)
+	{
+		// the cache is only an optimization, if it can't be written, the next call will simply download the list again
+		DeviceListCache::save( filePath, endpoint, listResult.devices );
+	}
+	return listResult;
+}
+
+RequestStatus Client::_verifyCachedDevice(
+	DeviceList & devices, uint32_t deviceIdx, const std::string & cacheFilePath, const DeviceListOptions & options
+)
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+
+	if (deviceIdx < devices.size())
+	{
+		DeviceInfoResult infoResult = _requestDeviceInfo( deviceIdx, options );
+		if (infoResult.status != RequestStatus::Success)
+		{
+			return infoResult.status;
+		}
+		if (DeviceListCache::fingerprint( *infoResult.device ) == DeviceListCache::fingerprint( devices[ deviceIdx ] ))
+		{
+			return RequestStatus::Success;
+		}
+	}
+
+	// The cached device is a different one, so the whole cache is out of date.
+	DeviceListResult listResult = _requestDeviceList( options );
+	if (listResult.status != RequestStatus::Success)
+	{
+		return listResult.status;
+	}
+
+	string filePath = !cacheFilePath.empty() ? cacheFilePath : DeviceListCache::defaultFilePath( _host, _port );
+	if (!filePath.empty())
+	{
+		DeviceListCache::save( filePath, _host + ':' + std::to_string( _port ), listResult.devices );
+	}
+
+	devices = move( listResult.devices );
+	return RequestStatus::Success;
+}
+
+DeviceListRefreshResult Client::_refreshDeviceList( DeviceList & devices, const DeviceListOptions & options )
+{
+	if (!_socket->isConnected())
+	{
+		return { RequestStatus::NotConnected, {} };
+	}
+
+	DeviceMatcher matcher( devices );
+
+	DeviceListRefreshResult result;
+
+	// The original list must stay untouched until all the devices are received, because the request may fail
+	// or it may have to start again, so for now just remember which original devices to keep.
+	const uint32_t newDevice = UINT32_MAX;
+	vector< uint32_t > keptFrom;                  // original index of each kept device, or newDevice
+	vector< unique_ptr< Device > > parsedDevices;  // only the new and modified ones
+
+	do
+	{
+		result.changes = {};
+		keptFrom.clear();
+		parsedDevices.clear();
+		_isDeviceListOutOfDate = false;
+
+		matcher.reset();
+		vector< std::pair< uint32_t, string > > unmatchedKeys;  // new devices that may have been renamed
+		string key;
+
+		bool sent = sendMessage< RequestControllerCount >();
+		if (!sent)
+		{
+			result.status = RequestStatus::SendRequestFailed;
+			return result;
+		}
+
+		auto deviceCountResult = awaitMessage< ReplyControllerCount >();
+		if (deviceCountResult.status != RequestStatus::Success)
+		{
+			result.status = deviceCountResult.status;
+			return result;
+		}
+
+		keptFrom.reserve( deviceCountResult.message.count );
+
+		for (uint32_t deviceIdx = 0; deviceIdx < deviceCountResult.message.count; ++deviceIdx)
+		{
+			sent = sendMessage< RequestControllerData >( deviceIdx, _negotiatedProtocolVersion );
+			if (!sent)
+			{
+				result.status = RequestStatus::SendRequestFailed;
+				return result;
+			}
+
+			Header header;
+			RequestStatus bodyStatus = awaitMessageBody( ReplyControllerData::thisType, header, _bodyBuffer );
+			if (bodyStatus != RequestStatus::Success)
+			{
+				result.status = bodyStatus;
+				return result;
+			}
+
+			if (!identityKey( _bodyBuffer, key ))
+			{
+				result.status = RequestStatus::InvalidReply;
+				return result;
+			}
+
+			uint32_t originalIdx = matcher.matchExactly( key );
+			if (originalIdx != DeviceMatcher::noMatch
+			 && devices[ originalIdx ]._contentHash == hashBytes( _bodyBuffer.data(), _bodyBuffer.size() ))
+			{
+				keptFrom.push_back( originalIdx );
+				continue;
+			}
+
+			ReplyControllerData reply;
+			reply.header = header;
+			BinaryInputStream stream( _bodyBuffer );
+			if (!reply.deserializeBody( stream, _negotiatedProtocolVersion, options ))
+			{
+				result.status = RequestStatus::InvalidReply;
+				return result;
+			}
+			reply.device_desc.hashReply( _bodyBuffer, _negotiatedProtocolVersion );
+
+			// a device whose only change is its current colors or mode is re-parsed, but its description is the same
+			if (originalIdx == DeviceMatcher::noMatch)
+				unmatchedKeys.emplace_back( deviceIdx, move( key ) );
+			else if (devices[ originalIdx ]._descriptionHash != reply.device_desc._descriptionHash
+			      || reply.device_desc._descriptionHash == 0)
+				result.changes.modified.push_back( deviceIdx );
+
+			keptFrom.push_back( newDevice );
+			parsedDevices.emplace_back( new Device( move( reply.device_desc ) ) );
+		}
+
+		// only now, so that a renamed device can't take the original of a device that is still there
+		for (const auto & unmatched : unmatchedKeys)
+		{
+			if (matcher.matchRenamed( unmatched.second ) != DeviceMatcher::noMatch)
+				result.changes.modified.push_back( unmatched.first );
+			else
+				result.changes.added.push_back( unmatched.first );
+		}
+		std::sort( result.changes.modified.begin(), result.changes.modified.end() );
+
+		for (uint32_t originalIdx = 0; originalIdx < matcher.oldCount(); ++originalIdx)
+		{
+			if (!matcher.isMatched( originalIdx ))
+				result.changes.removed.push_back( originalIdx );
+		}
+	}
+	// In the middle of the update we might receive DeviceListUpdated message. In that case we need to start again.
+	while (_isDeviceListOutOfDate);
+
+	// now that everything is received, assemble the updated list from the kept and the newly parsed devices
+	vector< const Device * > updatedDevices;
+	updatedDevices.reserve( keptFrom.size() );
+	for (uint32_t deviceIdx = 0, parsedIdx = 0; deviceIdx < keptFrom.size(); ++deviceIdx)
+	{
+		if (keptFrom[ deviceIdx ] != newDevice)
+			updatedDevices.push_back( devices._list[ keptFrom[ deviceIdx ] ].get() );
+		else
+			updatedDevices.push_back( parsedDevices[ parsedIdx++ ].get() );
+	}
+	std::shared_ptr< const DeviceList > sharedCopy = copyIfShared( updatedDevices );
+
+	DeviceList::DeviceListType updatedList;
+	updatedList.reserve( keptFrom.size() );
+	auto parsedIter = parsedDevices.begin();
+	for (uint32_t deviceIdx = 0; deviceIdx < keptFrom.size(); ++deviceIdx)
+	{
+		if (keptFrom[ deviceIdx ] != newDevice)
+		{
+			updatedList.push_back( move( devices._list[ keptFrom[ deviceIdx ] ] ) );
+			if (updatedList.back()->idx != deviceIdx)
+				updatedList.back()->setIdx( deviceIdx );
+		}
+		else
+		{
+			updatedList.push_back( move( *parsedIter++ ) );
+		}
+	}
+	devices._list = move( updatedList );
+	devices._index.reset();
+	if (sharedCopy)
+		std::atomic_store( &_sharedDeviceList, move( sharedCopy ) );
+
+	result.status = RequestStatus::Success;
+	return result;
+}
+
+RequestStatus Client::_requestDeviceSnapshot( DeviceSnapshot & snapshot )
+{
+	if (!_socket->isConnected())
+	{
+		snapshot.clear();
+		return RequestStatus::NotConnected;
+	}
+
+	// All snapshots of this client share one string table, so the names repeating between devices
+	// and between refreshes are stored only once. The table never forgets a name, so when the devices have changed
+	// a lot, a new one is started, the older snapshots keep the old table alive for as long as they need it.
+	if (_stringTable->isOversized( _snapshotNameCount ))
+		_stringTable = std::make_shared< StringTable >();
+	snapshot.setStringTable( _stringTable );
+
+	// on failure leave the snapshot empty rather than half-filled
+	auto failWith = [ &snapshot ]( RequestStatus status )
+	{
+		snapshot.clear();
+		return status;
+	};
+
+	do
+	{
+		snapshot.clear();
+		_isDeviceListOutOfDate = false;
+
+		bool sent = sendMessage< RequestControllerCount >();
+		if (!sent)
+		{
+			return failWith( RequestStatus::SendRequestFailed );
+		}
+
+		auto deviceCountResult = awaitMessage< ReplyControllerCount >();
+		if (deviceCountResult.status != RequestStatus::Success)
+		{
+			return failWith( deviceCountResult.status );
+		}
+
+		snapshot.reserve( deviceCountResult.message.count );
+
+		for (uint32_t deviceIdx = 0; deviceIdx < deviceCountResult.message.count; ++deviceIdx)
+		{
+			sent = sendMessage< RequestControllerData >( deviceIdx, _negotiatedProtocolVersion );
+			if (!sent)
+			{
+				return failWith( RequestStatus::SendRequestFailed );
+			}
+
+			Header header;
+			RequestStatus bodyStatus = awaitMessageBody( ReplyControllerData::thisType, header, _bodyBuffer );
+			if (bodyStatus != RequestStatus::Success)
+			{
+				return failWith( bodyStatus );
+			}
+
+			// parse the device directly into the snapshot arrays, without constructing the Device object
+			BinaryInputStream stream( _bodyBuffer );
+			uint32_t data_size;
+			stream >> data_size;
+			if (!snapshot.appendDevice( stream, _negotiatedProtocolVersion ))
+			{
+				return failWith( RequestStatus::InvalidReply );
+			}
+		}
+	}
+	// In the middle of the update we might receive DeviceListUpdated message. In that case we need to start again.
+	while (_isDeviceListOutOfDate);
+
+	_snapshotNameCount = snapshot.nameCount();
+
+	return RequestStatus::Success;
+}
+
+DeviceViewListResult Client::_requestDeviceViewList()
+{
+	if (!_socket->isConnected())
+	{
+		return { RequestStatus::NotConnected, {} };
+	}
+
+	DeviceViewListResult result;
+
+	do
+	{
+		result.devices.clear();
+		_isDeviceListOutOfDate = false;
+
+		bool sent = sendMessage< RequestControllerCount >();
+		if (!sent)
+		{
+			result.status = RequestStatus::SendRequestFailed;
+			return result;
+		}
+
+		auto deviceCountResult = awaitMessage< ReplyControllerCount >();
+		if (deviceCountResult.status != RequestStatus::Success)
+		{
+			result.status = deviceCountResult.status;
+			return result;
+		}
+
+		result.devices.reserve( deviceCountResult.message.count );
+
+		for (uint32_t deviceIdx = 0; deviceIdx < deviceCountResult.message.count; ++deviceIdx)
+		{
+			sent = sendMessage< RequestControllerData >( deviceIdx, _negotiatedProtocolVersion );
+			if (!sent)
+			{
+				result.status = RequestStatus::SendRequestFailed;
+				return result;
+			}
+
+			// the view takes over the buffer, so it can't be the re-used one
+			Header header;
+			vector< uint8_t > bodyBuffer;
+			RequestStatus bodyStatus = awaitMessageBody( ReplyControllerData::thisType, header, bodyBuffer );
+			if (bodyStatus != RequestStatus::Success)
+			{
+				result.status = bodyStatus;
+				return result;
+			}
+
+			result.devices.push_back( DeviceView( deviceIdx, _negotiatedProtocolVersion, move( bodyBuffer ) ) );
+		}
+	}
+	// In the middle of the update we might receive DeviceListUpdated message. In that case we need to start again.
+	while (_isDeviceListOutOfDate);
+
+	result.status = RequestStatus::Success;
+	return result;
+}
+
 DeviceCountResult Client::_requestDeviceCount()
 {
 	if (!_socket->isConnected())
@@ -312,7 +829,7 @@ DeviceCountResult Client::_requestDeviceCount()
 	return result;
 }
 
-DeviceInfoResult Client::_requestDeviceInfo( uint32_t deviceIdx )
+DeviceInfoResult Client::_requestDeviceInfo( uint32_t deviceIdx, const DeviceListOptions & options )
 {
 	if (!_socket->isConnected())
 	{
@@ -328,7 +845,7 @@ DeviceInfoResult Client::_requestDeviceInfo( uint32_t deviceIdx )
 		return result;
 	}
 
-	auto deviceDataResult = awaitMessage< ReplyControllerData >();
+	auto deviceDataResult = awaitDeviceData( options );
 	if (deviceDataResult.status != RequestStatus::Success)
 	{
 		result.status = deviceDataResult.status;
@@ -412,6 +929,11 @@ RequestStatus Client::_setDeviceColor( const Device & device, Color color )
 		return RequestStatus::NotConnected;
 	}
 
+	if (const Calibration * calibration = calibrationOf( device.idx ))
+	{
+		color = calibration->apply( color );
+	}
+
 	std::vector< Color > allColorsInDevice( device.leds.size(), color );
 	if (!sendMessage< UpdateLEDs >( device.idx, allColorsInDevice ))
 	{
@@ -421,6 +943,28 @@ RequestStatus Client::_setDeviceColor( const Device & device, Color color )
 	return RequestStatus::Success;
 }
 
+RequestStatus Client::_setDeviceColors( const Device & device, const std::vector< Color > & colors )
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+
+	const Calibration * calibration = calibrationOf( device.idx );
+	if (calibration)
+	{
+		_calibratedColors.resize( colors.size() );
+		calibration->apply( _calibratedColors.data(), colors.data(), colors.size() );
+	}
+
+	if (!sendMessage< UpdateLEDs >( device.idx, calibration ? _calibratedColors : colors ))
+	{
+		return RequestStatus::SendRequestFailed;
+	}
+
+	return RequestStatus::Success;
+}
+
 RequestStatus Client::_setZoneColor( const Zone & zone, Color color )
 {
 	if (!_socket->isConnected())
@@ -428,6 +972,11 @@ RequestStatus Client::_setZoneColor( const Zone & zone, Color color )
 		return RequestStatus::NotConnected;
 	}
 
+	if (const Calibration * calibration = calibrationOf( zone.parentIdx ))
+	{
+		color = calibration->apply( color );
+	}
+
 	std::vector< Color > allColorsInZone( zone.leds_count, color );
 	if (!sendMessage< UpdateZoneLEDs >( zone.parentIdx, zone.idx, allColorsInZone ))
 	{
@@ -459,6 +1008,11 @@ RequestStatus Client::_setLEDColor( const LED & led, Color color )
 		return RequestStatus::NotConnected;
 	}
 
+	if (const Calibration * calibration = calibrationOf( led.parentIdx ))
+	{
+		color = calibration->apply( color );
+	}
+
 	if (!sendMessage< UpdateSingleLED >( led.parentIdx, led.idx, color ))
 	{
 		return RequestStatus::SendRequestFailed;
@@ -467,6 +1021,50 @@ RequestStatus Client::_setLEDColor( const LED & led, Color color )
 	return RequestStatus::Success;
 }
 
+constexpr uint32_t Client::noDevice;
+
+void Client::setDeviceCalibration( const Device & device, const Calibration & calibration )
+{
+	string identity = identityKey( device );
+	auto iter = std::find_if( _calibrations.begin(), _calibrations.end(), [ &identity ]( const DeviceCalibration & entry )
+	{
+		return entry.identity == identity;
+	});
+	const size_t entryIdx = size_t( iter - _calibrations.begin() );
+	if (iter == _calibrations.end())
+	{
+		_calibrations.push_back({ move( identity ), device.idx, calibration });
+	}
+	else
+	{
+		iter->deviceIdx = device.idx;
+		iter->calibration = calibration;
+	}
+
+	// the device is at this index now, whatever was bound to it before is not
+	for (size_t i = 0; i < _calibrations.size(); ++i)
+	{
+		if (i != entryIdx && _calibrations[i].deviceIdx == device.idx)
+			_calibrations[i].deviceIdx = noDevice;
+	}
+	updateCalibrationIndexes();
+}
+
+const Calibration * Client::deviceCalibration( const Device & device ) const noexcept
+{
+	return calibrationOf( device.idx );
+}
+
+void Client::resetDeviceCalibration( const Device & device )
+{
+	string identity = identityKey( device );
+	_calibrations.erase( std::remove_if( _calibrations.begin(), _calibrations.end(), [ &identity ]( const DeviceCalibration & entry )
+	{
+		return entry.identity == identity;
+	}), _calibrations.end() );
+	updateCalibrationIndexes();
+}
+
 ProfileListResult Client::_requestProfileList()
 {
 	if (!_socket->isConnected())
@@ -591,10 +1189,76 @@ bool Client::setTimeout( std::chrono::milliseconds timeout ) noexcept
 	return _setTimeout( timeout );
 }
 
-DeviceListResult Client::requestDeviceList() noexcept
+DeviceListResult Client::requestDeviceList( const DeviceListOptions & options ) noexcept
+{
+	try {
+		return _requestDeviceList( options );
+	} CATCH_ALL (
+		return { RequestStatus::UnexpectedError, {} };
+	)
+}
+
+RequestStatus Client::requestDeviceList( DeviceList & devices, const DeviceListOptions & options ) noexcept
+{
+	try {
+		return _requestDeviceList( devices, options );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
+SharedDeviceListResult Client::requestSharedDeviceList( const DeviceListOptions & options ) noexcept
+{
+	try {
+		return _requestSharedDeviceList( options );
+	} CATCH_ALL (
+		return { RequestStatus::UnexpectedError, nullptr };
+	)
+}
+
+DeviceListResult Client::requestDeviceListCached( const std::string & cacheFilePath, const DeviceListOptions & options ) noexcept
+{
+	try {
+		return _requestDeviceListCached( cacheFilePath, options );
+	} CATCH_ALL (
+		return { RequestStatus::UnexpectedError, {} };
+	)
+}
+
+RequestStatus Client::verifyCachedDevice(
+	DeviceList & devices, uint32_t deviceIdx, const std::string & cacheFilePath, const DeviceListOptions & options
+) noexcept
+{
+	try {
+		return _verifyCachedDevice( devices, deviceIdx, cacheFilePath, options );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
+DeviceListRefreshResult Client::refreshDeviceList( DeviceList & devices, const DeviceListOptions & options ) noexcept
+{
+	try {
+		return _refreshDeviceList( devices, options );
+	} CATCH_ALL (
+		return { RequestStatus::UnexpectedError, {} };
+	)
+}
+
+RequestStatus Client::requestDeviceSnapshot( DeviceSnapshot & snapshot ) noexcept
+{
+	try {
+		return _requestDeviceSnapshot( snapshot );
+	} CATCH_ALL (
+		snapshot.clear();
+		return RequestStatus::UnexpectedError;
+	)
+}
+
+DeviceViewListResult Client::requestDeviceViewList() noexcept
 {
 	try {
-		return _requestDeviceList();
+		return _requestDeviceViewList();
 	} CATCH_ALL (
 		return { RequestStatus::UnexpectedError, {} };
 	)
@@ -609,10 +1273,10 @@ DeviceCountResult Client::requestDeviceCount() noexcept
 	)
 }
 
-DeviceInfoResult Client::requestDeviceInfo( uint32_t deviceIdx ) noexcept
+DeviceInfoResult Client::requestDeviceInfo( uint32_t deviceIdx, const DeviceListOptions & options ) noexcept
 {
 	try {
-		return _requestDeviceInfo( deviceIdx );
+		return _requestDeviceInfo( deviceIdx, options );
 	} CATCH_ALL (
 		return { RequestStatus::UnexpectedError, {} };
 	)
@@ -659,6 +1323,15 @@ RequestStatus Client::setDeviceColor( const Device & device, Color color ) noexc
 	)
 }
 
+RequestStatus Client::setDeviceColors( const Device & device, const std::vector< Color > & colors ) noexcept
+{
+	try {
+		return _setDeviceColors( device, colors );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
 RequestStatus Client::setZoneColor( const Zone & zone, Color color ) noexcept
 {
 	try {
@@ -787,9 +1460,57 @@ void Client::setTimeoutX( std::chrono::milliseconds timeout )
 	}
 }
 
-DeviceList Client::requestDeviceListX()
+DeviceList Client::requestDeviceListX( const DeviceListOptions & options )
+{
+	DeviceListResult result = _requestDeviceList( options );
+	requestStatusToException( result.status );
+	return move( result.devices );
+}
+
+void Client::requestDeviceListX( DeviceList & devices, const DeviceListOptions & options )
+{
+	RequestStatus status = _requestDeviceList( devices, options );
+	requestStatusToException( status );
+}
+
+std::shared_ptr< const DeviceList > Client::requestSharedDeviceListX( const DeviceListOptions & options )
+{
+	SharedDeviceListResult result = _requestSharedDeviceList( options );
+	requestStatusToException( result.status );
+	return move( result.devices );
+}
+
+DeviceList Client::requestDeviceListCachedX( const std::string & cacheFilePath, const DeviceListOptions & options )
+{
+	DeviceListResult result = _requestDeviceListCached( cacheFilePath, options );
+	requestStatusToException( result.status );
+	return move( result.devices );
+}
+
+void Client::verifyCachedDeviceX(
+	DeviceList & devices, uint32_t deviceIdx, const std::string & cacheFilePath, const DeviceListOptions & options
+)
+{
+	RequestStatus status = _verifyCachedDevice( devices, deviceIdx, cacheFilePath, options );
+	requestStatusToException( status );
+}
+
+DeviceListChanges Client::refreshDeviceListX( DeviceList & devices, const DeviceListOptions & options )
+{
+	DeviceListRefreshResult result = _refreshDeviceList( devices, options );
+	requestStatusToException( result.status );
+	return move( result.changes );
+}
+
+void Client::requestDeviceSnapshotX( DeviceSnapshot & snapshot )
+{
+	RequestStatus status = _requestDeviceSnapshot( snapshot );
+	requestStatusToException( status );
+}
+
+std::vector< DeviceView > Client::requestDeviceViewListX()
 {
-	DeviceListResult result = _requestDeviceList();
+	DeviceViewListResult result = _requestDeviceViewList();
 	requestStatusToException( result.status );
 	return move( result.devices );
 }
@@ -801,9 +1522,9 @@ uint32_t Client::requestDeviceCountX()
 	return result.count;
 }
 
-std::unique_ptr< Device > Client::requestDeviceInfoX( uint32_t deviceIdx )
+std::unique_ptr< Device > Client::requestDeviceInfoX( uint32_t deviceIdx, const DeviceListOptions & options )
 {
-	DeviceInfoResult result = _requestDeviceInfo( deviceIdx );
+	DeviceInfoResult result = _requestDeviceInfo( deviceIdx, options );
 	requestStatusToException( result.status );
 	return move( result.device );
 }
@@ -849,6 +1570,12 @@ void Client::setDeviceColorX( const Device & device, Color color )
 	requestStatusToException( status );
 }
 
+void Client::setDeviceColorsX( const Device & device, const std::vector< Color > & colors )
+{
+	RequestStatus status = _setDeviceColors( device, colors );
+	requestStatusToException( status );
+}
+
 void Client::setZoneColorX( const Zone & zone, Color color )
 {
 	RequestStatus status = _setZoneColor( zone, color );
@@ -899,16 +1626,16 @@ void Client::deleteProfileX( const std::string & profileName )
 //  Client: helpers
 
 template< typename Message, typename ... ConstructorArgs >
-bool Client::sendMessage( ConstructorArgs ... args )
+bool Client::sendMessage( ConstructorArgs && ... args )
 {
-	Message message( args ... );
+	Message message( std::forward< ConstructorArgs >( args ) ... );
 
-	// allocate buffer and serialize (header.message_size is calculated in constructor)
-	std::vector< uint8_t > buffer( message.header.size() + message.header.message_size );
-	BinaryOutputStream stream( buffer );
+	// resize the buffer and serialize (header.message_size is calculated in constructor)
+	_sendBuffer.resize( message.header.size() + message.header.message_size );
+	BinaryOutputStream stream( _sendBuffer );
 	message.serialize( stream, _negotiatedProtocolVersion );
 
-	return _socket->send( buffer ) == SocketError::Success;
+	return _socket->send( _sendBuffer ) == SocketError::Success;
 }
 
 template< typename Message >
@@ -916,6 +1643,49 @@ Client::RecvResult< Message > Client::awaitMessage() noexcept
 {
 	RecvResult< Message > result;
 
+	// receive the header and the message body
+	vector< uint8_t > bodyBuffer;
+	result.status = awaitMessageBody( Message::thisType, result.message.header, bodyBuffer );
+	if (result.status != RequestStatus::Success)
+	{
+		return result;
+	}
+
+	// parse and validate the body
+	BinaryInputStream stream( bodyBuffer );
+	if (!result.message.deserializeBody( stream, _negotiatedProtocolVersion ))
+	{
+		result.status = RequestStatus::InvalidReply;
+	}
+
+	return result;
+}
+
+Client::RecvResult< ReplyControllerData > Client::awaitDeviceData( const DeviceListOptions & options ) noexcept
+{
+	RecvResult< ReplyControllerData > result;
+
+	result.status = awaitMessageBody( ReplyControllerData::thisType, result.message.header, _bodyBuffer );
+	if (result.status != RequestStatus::Success)
+	{
+		return result;
+	}
+
+	BinaryInputStream stream( _bodyBuffer );
+	if (!result.message.deserializeBody( stream, _negotiatedProtocolVersion, options ))
+	{
+		result.status = RequestStatus::InvalidReply;
+		return result;
+	}
+
+	// remember the hash of the raw data, so that refreshDeviceList() can tell whether the device has changed
+	result.message.device_desc.hashReply( _bodyBuffer, _negotiatedProtocolVersion );
+
+	return result;
+}
+
+RequestStatus Client::awaitMessageBody( MessageType expectedType, Header & header, std::vector< uint8_t > & bodyBuffer ) noexcept
+{
 	do
 	{
 		// receive header into buffer
@@ -924,64 +1694,54 @@ Client::RecvResult< Message > Client::awaitMessage() noexcept
 		if (headerStatus != SocketError::Success)
 		{
 			if (headerStatus == SocketError::ConnectionClosed)
-				result.status = RequestStatus::ConnectionClosed;
+				return RequestStatus::ConnectionClosed;
 			else if (headerStatus == SocketError::Timeout)
-				result.status = RequestStatus::NoReply;
+				return RequestStatus::NoReply;
 			else
-				result.status = RequestStatus::ReceiveError;
-			return result;
+				return RequestStatus::ReceiveError;
 		}
 
 		// parse and validate the header
 		BinaryInputStream stream( headerBuffer );
-		if (!result.message.header.deserialize( stream ))
+		if (!header.deserialize( stream ))
 		{
-			result.status = RequestStatus::InvalidReply;
-			return result;
+			return RequestStatus::InvalidReply;
 		}
 
 		// the server may have sent DeviceListUpdated messsage before it received our request
-		if (result.message.header.message_type == MessageType::DEVICE_LIST_UPDATED)
+		if (header.message_type == MessageType::DEVICE_LIST_UPDATED)
 		{
 			// in that case just set our "out of date" flag and skip it for now
 			_isDeviceListOutOfDate = true;
 		}
 	}
-	while (result.message.header.message_type == MessageType::DEVICE_LIST_UPDATED);
+	while (header.message_type == MessageType::DEVICE_LIST_UPDATED);
 
-	if (result.message.header.message_type != Message::thisType)
+	if (header.message_type != expectedType)
 	{
 		// the message is neither DeviceListUpdated, nor the type we expected
-		result.status = RequestStatus::InvalidReply;
-		return result;
+		return RequestStatus::InvalidReply;
 	}
 
 	// receive the message body
-	vector< uint8_t > bodyBuffer;
-	SocketError bodyStatus = _socket->receive( bodyBuffer, result.message.header.message_size );
+	SocketError bodyStatus = _socket->receive( bodyBuffer, header.message_size );
 	if (bodyStatus != SocketError::Success)
 	{
 		if (bodyStatus == SocketError::ConnectionClosed)
-			result.status = RequestStatus::ConnectionClosed;
+			return RequestStatus::ConnectionClosed;
 		else if (bodyStatus == SocketError::Timeout)
-			result.status = RequestStatus::NoReply;
+			return RequestStatus::NoReply;
 		else
-			result.status = RequestStatus::ReceiveError;
-		return result;
+			return RequestStatus::ReceiveError;
 	}
 
-	// parse and validate the body
-	BinaryInputStream stream( bodyBuffer );
-	if (!result.message.deserializeBody( stream, _negotiatedProtocolVersion ))
-	{
-		result.status = RequestStatus::InvalidReply;
-	}
-	else
+	// the device at this index may be a different one than when the calibrations were set
+	if (expectedType == ReplyControllerData::thisType && !_calibrations.empty())
 	{
-		result.status = RequestStatus::Success;
+		rebindCalibration( header.device_idx, bodyBuffer );
 	}
 
-	return result;
+	return RequestStatus::Success;
 }
 
 UpdateStatus Client::checkForUpdateMessageArrival() noexcept
@@ -1042,6 +1802,68 @@ UpdateStatus Client::checkForUpdateMessageArrival() noexcept
 	}
 }
 
+const Calibration * Client::calibrationOf( uint32_t deviceIdx ) const noexcept
+{
+	if (deviceIdx < _calibrationIndexes.size() && _calibrationIndexes[ deviceIdx ] != noDevice)
+	{
+		const Calibration & calibration = _calibrations[ _calibrationIndexes[ deviceIdx ] ].calibration;
+		if (!calibration.isIdentity())
+			return &calibration;
+	}
+	return nullptr;
+}
+
+void Client::rebindCalibration( uint32_t deviceIdx, const std::vector< uint8_t > & replyBody ) noexcept
+{
+	bool isKnown = false;
+	try
+	{
+		isKnown = identityKey( replyBody, _identityKey );
+	}
+	catch (const std::exception &)
+	{
+		// without the identity it's safer to send the colors uncorrected than with another device's correction
+	}
+
+	bool changed = false;
+	for (DeviceCalibration & entry : _calibrations)
+	{
+		uint32_t newIdx = entry.deviceIdx;
+		if (isKnown && entry.identity == _identityKey)
+			newIdx = deviceIdx;
+		else if (entry.deviceIdx == deviceIdx)
+			newIdx = noDevice;
+		changed |= newIdx != entry.deviceIdx;
+		entry.deviceIdx = newIdx;
+	}
+
+	if (changed)
+	{
+		try
+		{
+			updateCalibrationIndexes();
+		}
+		catch (const std::exception &)
+		{
+			_calibrationIndexes.clear();  // all the devices are sent uncorrected, rather than by stale indexes
+		}
+	}
+}
+
+void Client::updateCalibrationIndexes()
+{
+	_calibrationIndexes.clear();
+	for (uint32_t entryIdx = 0; entryIdx < _calibrations.size(); ++entryIdx)
+	{
+		uint32_t deviceIdx = _calibrations[ entryIdx ].deviceIdx;
+		if (deviceIdx == noDevice)
+			continue;
+		if (deviceIdx >= _calibrationIndexes.size())
+			_calibrationIndexes.resize( deviceIdx + 1, noDevice );
+		_calibrationIndexes[ deviceIdx ] = entryIdx;
+	}
+}
+
 
 //======================================================================================================================
 
@@ -10,17 +10,17 @@
 #include "Essential.hpp"
 
 #include "MiscUtils.hpp"
-#include "StringUtils.hpp"
 #include "BinaryStream.hpp"
 using own::BinaryOutputStream;
 using own::BinaryInputStream;
 
 #include <cstdio>
+#include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <ios>
 #include <iomanip>
 #include <string>
-#include <unordered_map>
 
 
 namespace orgb {
@@ -38,51 +38,308 @@ const Color Color::Yellow  (0xFF, 0xFF, 0x00);
 const Color Color::Magenta (0xFF, 0x00, 0xFF);
 const Color Color::Cyan    (0x00, 0xFF, 0xFF);
 
-static const std::unordered_map< std::string, Color > colorNames =
+// every name must be found in its own slot of the perfect hash table
+static constexpr size_t nameLength( const char * name ) noexcept
 {
-	{ "black", Color::Black },
-	{ "white", Color::White },
-	{ "red", Color::Red },
-	{ "green", Color::Green },
-	{ "blue", Color::Blue },
-	{ "yellow", Color::Yellow },
-	{ "magenta", Color::Magenta },
-	{ "cyan", Color::Cyan },
+	return *name != '\0' ? 1 + nameLength( name + 1 ) : 0;
+}
+static constexpr bool areAllNamesHashed( size_t idx = 0 ) noexcept
+{
+	return idx == impl::namedColorCount
+	    || (impl::findNamedColor( impl::ColorNames::namedColors[ idx ].name, nameLength( impl::ColorNames::namedColors[ idx ].name ) ) == idx
+	        && areAllNamesHashed( idx + 1 ));
+}
+static_assert( areAllNamesHashed(), "the perfect hash of the color names has collisions, search for new displacements" );
+
+// value of a hex digit, or 16 when the character is not a hex digit
+static inline uint32_t hexDigit( char c ) noexcept
+{
+	uint32_t digit = uint32_t( c - '0' );
+	if (digit < 10)
+		return digit;
+	uint32_t letter = uint32_t( (c | 0x20) - 'a' );
+	return letter < 6 ? letter + 10 : 16;
+}
+
+// converts a fixed number of hex digits, the validity is checked only once at the end
+static bool parseHex( const char * str, size_t digitCount, uint32_t & value ) noexcept
+{
+	uint32_t result = 0;
+	uint32_t invalid = 0;
+	for (size_t i = 0; i < digitCount; ++i)
+	{
+		uint32_t digit = hexDigit( str[i] );
+		invalid |= digit & 16;
+		result = (result << 4) | (digit & 15);
+	}
+	value = result;
+	return invalid == 0;
+}
+
+static inline bool isSpace( char c ) noexcept
+{
+	return c == ' ' || c == '\t';
+}
+
+static void skipSpaces( const char * & pos, const char * end ) noexcept
+{
+	while (pos != end && isSpace( *pos ))
+		++pos;
+}
+
+// decimal number with an optional sign and fractional part, as in the CSS functions
+static bool parseNumber( const char * & pos, const char * end, float & number ) noexcept
+{
+	bool negative = false;
+	if (pos != end && (*pos == '-' || *pos == '+'))
+		negative = *pos++ == '-';
+
+	uint32_t digitCount = 0;
+	float value = 0.0f;
+	for (; pos != end && uint32_t( *pos - '0' ) < 10; ++pos, ++digitCount)
+		value = value * 10.0f + float( *pos - '0' );
+	if (pos != end && *pos == '.')
+	{
+		float unit = 0.1f;
+		for (++pos; pos != end && uint32_t( *pos - '0' ) < 10; ++pos, ++digitCount, unit *= 0.1f)
+			value += float( *pos - '0' ) * unit;
+	}
+
+	number = negative ? -value : value;
+	return digitCount > 0;
+}
+
+enum class Unit : uint8_t
+{
+	None,
+	Percent,
+	Degrees,
+};
+
+struct Argument
+{
+	float value;
+	Unit unit;
 };
 
-bool Color::fromString( const std::string & str ) noexcept
+// 3 arguments of a CSS function and the closing parenthesis that must end the string,
+// the arguments are separated either by commas or by spaces, but all of them the same way
+static bool parseArguments( const char * pos, const char * end, Argument (& args) [3] ) noexcept
+{
+	bool usesCommas = false;
+	skipSpaces( pos, end );
+	for (size_t i = 0; i < 3; ++i)
+	{
+		if (i > 0)
+		{
+			const char * argEnd = pos;
+			skipSpaces( pos, end );
+			bool comma = pos != end && *pos == ',';
+			if (comma)
+			{
+				++pos;
+				skipSpaces( pos, end );
+			}
+			else if (pos == argEnd)
+			{
+				return false;  // the arguments are not separated at all
+			}
+			if (i == 1)
+				usesCommas = comma;
+			else if (comma != usesCommas)
+				return false;
+		}
+
+		if (!parseNumber( pos, end, args[i].value ))
+			return false;
+
+		args[i].unit = Unit::None;
+		if (pos != end && *pos == '%')
+		{
+			args[i].unit = Unit::Percent;
+			++pos;
+		}
+		else if (end - pos >= 3 && impl::equalsName( pos, 3, "deg" ))
+		{
+			args[i].unit = Unit::Degrees;
+			pos += 3;
+		}
+	}
+	skipSpaces( pos, end );
+	return pos != end && *pos == ')' && pos + 1 == end;
+}
+
+static inline float clamp( float value, float min, float max ) noexcept
+{
+	return value < min ? min : value > max ? max : value;
+}
+
+static inline uint8_t toChannel( float value ) noexcept
+{
+	return uint8_t( clamp( value, 0.0f, 255.0f ) + 0.5f );
+}
+
+static bool parseRGB( const char * pos, const char * end, Color & color ) noexcept
 {
-	if (str.empty())
+	Argument args [3];
+	if (!parseArguments( pos, end, args ))
 		return false;
 
-	uint red, green, blue;
-	if (str[0] == '#' && sscanf( str.c_str() + 1, "%02x%02x%02x", &red, &green, &blue ) == 3)
+	uint8_t channels [3];
+	for (size_t i = 0; i < 3; ++i)
 	{
-		r = uint8_t( red );
-		g = uint8_t( green );
-		b = uint8_t( blue );
+		if (args[i].unit == Unit::Degrees)
+			return false;
+		channels[i] = toChannel( args[i].unit == Unit::Percent ? args[i].value * 2.55f : args[i].value );
+	}
+	color = Color( channels[0], channels[1], channels[2] );
+	return true;
+}
+
+// one channel of the CSS conversion from the hue, saturation, lightness model
+static uint8_t hslChannel( float offset, float hue, float chroma, float lightness ) noexcept
+{
+	float k = std::fmod( offset + hue / 30.0f, 12.0f );
+	return toChannel( (lightness - chroma * clamp( std::min( k - 3.0f, 9.0f - k ), -1.0f, 1.0f )) * 255.0f );
+}
+
+static bool parseHSL( const char * pos, const char * end, Color & color ) noexcept
+{
+	Argument args [3];
+	if (!parseArguments( pos, end, args ))
+		return false;
+	if (args[0].unit == Unit::Percent || args[1].unit != Unit::Percent || args[2].unit != Unit::Percent)
+		return false;
+
+	float hue = std::fmod( args[0].value, 360.0f );
+	if (hue < 0.0f)
+		hue += 360.0f;
+	float saturation = clamp( args[1].value / 100.0f, 0.0f, 1.0f );
+	float lightness = clamp( args[2].value / 100.0f, 0.0f, 1.0f );
+	float chroma = saturation * std::min( lightness, 1.0f - lightness );
+
+	color = Color(
+		hslChannel( 0.0f, hue, chroma, lightness ),
+		hslChannel( 8.0f, hue, chroma, lightness ),
+		hslChannel( 4.0f, hue, chroma, lightness )
+	);
+	return true;
+}
+
+bool Color::fromString( StringView str ) noexcept
+{
+	const char * chars = str.data();
+	const size_t length = str.size();
+	uint32_t value;
+
+	if (length == 7 && chars[0] == '#' && parseHex( chars + 1, 6, value ))
+	{
+		*this = Color( uint8_t( value >> 16 ), uint8_t( value >> 8 ), uint8_t( value ) );
+		return true;
+	}
+	else if (length == 4 && chars[0] == '#' && parseHex( chars + 1, 3, value ))
+	{
+		*this = Color( uint8_t( (value >> 8) * 17 ), uint8_t( ((value >> 4) & 15) * 17 ), uint8_t( (value & 15) * 17 ) );
 		return true;
 	}
-	else if (sscanf( str.c_str(), "%02x%02x%02x", &red, &green, &blue ) == 3)
+	else if (length == 6 && parseHex( chars, 6, value ))
 	{
-		r = uint8_t( red );
-		g = uint8_t( green );
-		b = uint8_t( blue );
+		*this = Color( uint8_t( value >> 16 ), uint8_t( value >> 8 ), uint8_t( value ) );
 		return true;
 	}
+	else if (length > 4 && impl::equalsName( chars, 4, "rgb(" ))
+	{
+		return parseRGB( chars + 4, chars + length, *this );
+	}
+	else if (length > 4 && impl::equalsName( chars, 4, "hsl(" ))
+	{
+		return parseHSL( chars + 4, chars + length, *this );
+	}
 	else
 	{
-		std::string strLower = own::to_lower( str );
-		auto colorIter = colorNames.find( strLower );
-		if (colorIter != colorNames.end())
+		size_t nameIdx = impl::findNamedColor( chars, length );
+		if (nameIdx != impl::namedColorCount)
 		{
-			*this = colorIter->second;
+			*this = impl::ColorNames::namedColors[ nameIdx ].color;
 			return true;
 		}
 	}
 	return false;
 }
 
+Color impl::invalidColorLiteral( const char * ) noexcept
+{
+	return Color::Black;
+}
+
+// a * b / 255 rounded to the nearest integer, without a division
+static inline uint8_t mul255( uint32_t a, uint32_t b ) noexcept
+{
+	uint32_t product = a * b + 128;
+	return uint8_t( (product + (product >> 8)) >> 8 );
+}
+
+Color Color::fromHue( uint8_t hue ) noexcept
+{
+	// the circle is divided into 6 sectors, in each of them one component rises or falls and the others stay
+	uint32_t position = uint32_t( hue ) * 6;
+	uint8_t sector = uint8_t( position >> 8 );
+	uint8_t rising = uint8_t( position & 0xFF );
+	uint8_t falling = uint8_t( 255 - rising );
+
+	switch (sector)
+	{
+		case 0:  return Color( 255, rising, 0 );
+		case 1:  return Color( falling, 255, 0 );
+		case 2:  return Color( 0, 255, rising );
+		case 3:  return Color( 0, falling, 255 );
+		case 4:  return Color( rising, 0, 255 );
+		default: return Color( 255, 0, falling );
+	}
+}
+
+Color Color::fromHSV( HSV hsv ) noexcept
+{
+	// desaturate the pure hue towards white and then darken it towards black
+	Color pure = fromHue( hsv.h );
+	return Color(
+		mul255( hsv.v, 255 - mul255( hsv.s, 255 - pure.r ) ),
+		mul255( hsv.v, 255 - mul255( hsv.s, 255 - pure.g ) ),
+		mul255( hsv.v, 255 - mul255( hsv.s, 255 - pure.b ) )
+	);
+}
+
+HSV Color::toHSV() const noexcept
+{
+	uint8_t max = std::max( r, std::max( g, b ) );
+	uint8_t min = std::min( r, std::min( g, b ) );
+	int32_t delta = max - min;
+
+	HSV hsv;
+	hsv.v = max;
+	if (delta == 0)
+	{
+		hsv.h = 0;
+		hsv.s = 0;
+		return hsv;
+	}
+	hsv.s = uint8_t( (delta * 255 + max / 2) / max );
+
+	// position on the circle in units of delta, where a whole circle is 6 * delta
+	int32_t position;
+	if (max == r)
+		position = (g - b);
+	else if (max == g)
+		position = 2 * delta + (b - r);
+	else
+		position = 4 * delta + (r - g);
+
+	int32_t circle = 6 * delta;
+	position = (position + circle) % circle;
+	hsv.h = uint8_t( ((position * 256 + circle / 2) / circle) & 0xFF );
+	return hsv;
+}
+
 BinaryOutputStream & operator<<( BinaryOutputStream & stream, Color color )
 {
 	stream << color.r << color.g << color.b << color.padding;
@@ -0,0 +1,1277 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: bulk operations over whole frames of colors
+//======================================================================================================================
+
+#include "OpenRGB/ColorOps.hpp"
+
+#include "Essential.hpp"
+
+#include "LangUtils.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+// SSE2 is part of every x86-64 CPU, so it can be used without checking.
+// AVX2 is checked at runtime, its functions are compiled with a target attribute so that the rest of the library
+// doesn't require it. NEON is part of every 64-bit ARM CPU and it's enabled by a compiler flag on the 32-bit ones.
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define COLOROPS_SSE2
+	#include <immintrin.h>
+	#if defined(__GNUC__) || defined(__clang__)
+		#define COLOROPS_AVX2
+		#define COLOROPS_TARGET_AVX2 __attribute__(( target("avx2") ))
+	#elif defined(_MSC_VER)
+		#define COLOROPS_AVX2
+		#define COLOROPS_TARGET_AVX2
+		#include <intrin.h>
+	#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define COLOROPS_NEON
+	#include <arm_neon.h>
+#endif
+
+
+namespace orgb {
+namespace colorops {
+
+
+static_assert( sizeof( Color ) == 4, "the kernels expect Color to be exactly 4 bytes" );
+
+
+//======================================================================================================================
+//  scalar
+
+// Multiplying by (factor + factor/128) and dividing by 256 maps 255 exactly to 1.0 without a real division.
+static inline uint32_t toWeight( uint8_t factor ) noexcept
+{
+	return uint32_t( factor ) + (factor >> 7);
+}
+
+static inline uint8_t mix( uint8_t a, uint8_t b, uint32_t weightB ) noexcept
+{
+	return uint8_t( (a * (256 - weightB) + b * weightB) >> 8 );
+}
+
+static inline uint8_t addClamped( uint8_t a, uint8_t b ) noexcept
+{
+	uint32_t sum = uint32_t( a ) + b;
+	return uint8_t( sum > 255 ? 255 : sum );
+}
+
+// a * b / 255 rounded to the nearest integer, the same as in Color::fromHSV()
+static inline uint8_t mul255( uint32_t a, uint32_t b ) noexcept
+{
+	uint32_t product = a * b + 128;
+	return uint8_t( (product + (product >> 8)) >> 8 );
+}
+
+/// Pure colors of all the 256 hues, with zero padding, so that they can be loaded as 32-bit values.
+struct HueTable
+{
+	uint32_t colors [256];
+
+	HueTable() noexcept
+	{
+		for (uint32_t hue = 0; hue < 256; ++hue)
+		{
+			Color color = Color::fromHue( uint8_t( hue ) );
+			memcpy( &colors[ hue ], &color, sizeof( color ) );
+		}
+	}
+};
+
+static const uint32_t * hueColors() noexcept
+{
+	static const HueTable table;
+	return table.colors;
+}
+
+static void fillScalar( Color * dst, size_t count, Color color ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+		dst[i] = color;
+}
+
+static void scaleScalar( Color * dst, const Color * src, size_t count, Color factor ) noexcept
+{
+	const uint32_t wr = toWeight( factor.r ), wg = toWeight( factor.g ), wb = toWeight( factor.b );
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i].r = uint8_t( (src[i].r * wr) >> 8 );
+		dst[i].g = uint8_t( (src[i].g * wg) >> 8 );
+		dst[i].b = uint8_t( (src[i].b * wb) >> 8 );
+		dst[i].padding = src[i].padding;
+	}
+}
+
+static void addScalar( Color * dst, const Color * a, const Color * b, size_t count ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i].r = addClamped( a[i].r, b[i].r );
+		dst[i].g = addClamped( a[i].g, b[i].g );
+		dst[i].b = addClamped( a[i].b, b[i].b );
+		dst[i].padding = addClamped( a[i].padding, b[i].padding );
+	}
+}
+
+static void lerpScalar( Color * dst, const Color * a, const Color * b, size_t count, uint8_t amount ) noexcept
+{
+	const uint32_t w = toWeight( amount );
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i].r = mix( a[i].r, b[i].r, w );
+		dst[i].g = mix( a[i].g, b[i].g, w );
+		dst[i].b = mix( a[i].b, b[i].b, w );
+		dst[i].padding = mix( a[i].padding, b[i].padding, w );
+	}
+}
+
+
+static void fromHSVScalar( Color * dst, const HSV * src, size_t count ) noexcept
+{
+	const uint32_t * hues = hueColors();
+	for (size_t i = 0; i < count; ++i)
+	{
+		Color pure;
+		memcpy( &pure, &hues[ src[i].h ], sizeof( pure ) );
+		const uint8_t s = src[i].s, v = src[i].v;
+		dst[i].r = mul255( v, 255 - mul255( s, 255 - pure.r ) );
+		dst[i].g = mul255( v, 255 - mul255( s, 255 - pure.g ) );
+		dst[i].b = mul255( v, 255 - mul255( s, 255 - pure.b ) );
+		dst[i].padding = 0;
+	}
+}
+
+
+template< BlendMode mode >
+static inline uint8_t blendTarget( uint8_t d, uint8_t s ) noexcept
+{
+	switch (mode)  // resolved at compile time
+	{
+		case BlendMode::Add:       return addClamped( d, s );
+		case BlendMode::Multiply:  return mul255( d, s );
+		case BlendMode::Screen:    return uint8_t( d + s - mul255( d, s ) );
+		case BlendMode::Lighten:   return d > s ? d : s;
+		default:                   return s;
+	}
+}
+
+template< BlendMode mode >
+static void blendScalar( Color * dst, const Color * src, size_t count, uint8_t opacity ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t w = toWeight( mul255( src[i].padding, opacity ) );
+		dst[i].r = mix( dst[i].r, blendTarget< mode >( dst[i].r, src[i].r ), w );
+		dst[i].g = mix( dst[i].g, blendTarget< mode >( dst[i].g, src[i].g ), w );
+		dst[i].b = mix( dst[i].b, blendTarget< mode >( dst[i].b, src[i].b ), w );
+	}
+}
+
+// turns the runtime blend mode into a template argument of the kernel
+#define DISPATCH_BLEND_MODE( kernel, dst, src, count, mode, opacity ) \
+	switch (mode) \
+	{ \
+		case BlendMode::Add:       kernel< BlendMode::Add >( dst, src, count, opacity ); break; \
+		case BlendMode::Multiply:  kernel< BlendMode::Multiply >( dst, src, count, opacity ); break; \
+		case BlendMode::Screen:    kernel< BlendMode::Screen >( dst, src, count, opacity ); break; \
+		case BlendMode::Lighten:   kernel< BlendMode::Lighten >( dst, src, count, opacity ); break; \
+		default:                   kernel< BlendMode::Normal >( dst, src, count, opacity ); break; \
+	}
+
+static void blendScalar( Color * dst, const Color * src, size_t count, BlendMode mode, uint8_t opacity ) noexcept
+{
+	DISPATCH_BLEND_MODE( blendScalar, dst, src, count, mode, opacity )
+}
+
+static inline uint8_t clampToByte( int32_t value ) noexcept
+{
+	return uint8_t( value < 0 ? 0 : value > 255 ? 255 : value );
+}
+
+// the matrix row applied to the channels, rounded, the same as in the SIMD kernels
+static inline int32_t dotProduct( const int16_t * row, const Color & color ) noexcept
+{
+	return (row[0] * color.r + row[1] * color.g + row[2] * color.b + 128) >> 8;
+}
+
+static void transformScalar( Color * dst, const Color * src, size_t count, const ColorMatrix & matrix, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Color color = src[i];
+		dst[i].r = red.values[ clampToByte( dotProduct( matrix.values[0], color ) ) ];
+		dst[i].g = green.values[ clampToByte( dotProduct( matrix.values[1], color ) ) ];
+		dst[i].b = blue.values[ clampToByte( dotProduct( matrix.values[2], color ) ) ];
+		dst[i].padding = color.padding;
+	}
+}
+
+static void lookupScalar( Color * dst, const uint8_t * indexes, size_t count, const Color * table ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+		dst[i] = table[ indexes[i] ];
+}
+
+static void lookupInterpolatedScalar( Color * dst, const uint16_t * positions, size_t count, const Color * table ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Color & a = table[ positions[i] >> 8 ];
+		const Color & b = table[ (positions[i] >> 8) + 1 ];
+		const uint32_t w = positions[i] & 0xFF;
+		dst[i].r = mix( a.r, b.r, w );
+		dst[i].g = mix( a.g, b.g, w );
+		dst[i].b = mix( a.b, b.b, w );
+		dst[i].padding = mix( a.padding, b.padding, w );
+	}
+}
+
+static void sumPixelsScalar( const uint8_t * pixels, size_t count, uint32_t bytesPerPixel, uint32_t * sums ) noexcept
+{
+	if (bytesPerPixel == 3 || bytesPerPixel == 4)
+	{
+		// local sums let the compiler keep them in registers
+		uint32_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+		for (size_t i = 0; i < count; ++i, pixels += bytesPerPixel)
+		{
+			sum0 += pixels[0];
+			sum1 += pixels[1];
+			sum2 += pixels[2];
+			if (bytesPerPixel == 4)
+				sum3 += pixels[3];
+		}
+		sums[0] += sum0;
+		sums[1] += sum1;
+		sums[2] += sum2;
+		if (bytesPerPixel == 4)
+			sums[3] += sum3;
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+			for (uint32_t j = 0; j < bytesPerPixel; ++j)
+				sums[j] += *pixels++;
+	}
+}
+
+
+//======================================================================================================================
+//  SSE2
+
+#ifdef COLOROPS_SSE2
+
+static inline uint32_t toBits( Color color ) noexcept
+{
+	uint32_t bits;
+	memcpy( &bits, &color, sizeof( bits ) );
+	return bits;
+}
+
+// multiplies 16-bit lanes of unpacked colors by the weights and packs them back to 8 bits
+static inline __m128i scale16( __m128i lo, __m128i hi, __m128i weights ) noexcept
+{
+	lo = _mm_srli_epi16( _mm_mullo_epi16( lo, weights ), 8 );
+	hi = _mm_srli_epi16( _mm_mullo_epi16( hi, weights ), 8 );
+	return _mm_packus_epi16( lo, hi );
+}
+
+static void fillSSE2( Color * dst, size_t count, Color color ) noexcept
+{
+	const __m128i value = _mm_set1_epi32( int( toBits( color ) ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), value );
+	fillScalar( dst + i, count - i, color );
+}
+
+static void scaleSSE2( Color * dst, const Color * src, size_t count, Color factor ) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weights = _mm_set_epi16(
+		256, short( toWeight( factor.b ) ), short( toWeight( factor.g ) ), short( toWeight( factor.r ) ),
+		256, short( toWeight( factor.b ) ), short( toWeight( factor.g ) ), short( toWeight( factor.r ) )
+	);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128( reinterpret_cast< const __m128i * >( src + i ) );
+		__m128i result = scale16( _mm_unpacklo_epi8( pixels, zero ), _mm_unpackhi_epi8( pixels, zero ), weights );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), result );
+	}
+	scaleScalar( dst + i, src + i, count - i, factor );
+}
+
+static void addSSE2( Color * dst, const Color * a, const Color * b, size_t count ) noexcept
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pixelsA = _mm_loadu_si128( reinterpret_cast< const __m128i * >( a + i ) );
+		__m128i pixelsB = _mm_loadu_si128( reinterpret_cast< const __m128i * >( b + i ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), _mm_adds_epu8( pixelsA, pixelsB ) );
+	}
+	addScalar( dst + i, a + i, b + i, count - i );
+}
+
+static void lerpSSE2( Color * dst, const Color * a, const Color * b, size_t count, uint8_t amount ) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weightB = _mm_set1_epi16( short( toWeight( amount ) ) );
+	const __m128i weightA = _mm_set1_epi16( short( 256 - toWeight( amount ) ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pixelsA = _mm_loadu_si128( reinterpret_cast< const __m128i * >( a + i ) );
+		__m128i pixelsB = _mm_loadu_si128( reinterpret_cast< const __m128i * >( b + i ) );
+		// a * (256 - w) + b * w fits into 16 bits, so the wrap-around arithmetic gives the exact result
+		__m128i lo = _mm_add_epi16(
+			_mm_mullo_epi16( _mm_unpacklo_epi8( pixelsA, zero ), weightA ),
+			_mm_mullo_epi16( _mm_unpacklo_epi8( pixelsB, zero ), weightB )
+		);
+		__m128i hi = _mm_add_epi16(
+			_mm_mullo_epi16( _mm_unpackhi_epi8( pixelsA, zero ), weightA ),
+			_mm_mullo_epi16( _mm_unpackhi_epi8( pixelsB, zero ), weightB )
+		);
+		__m128i result = _mm_packus_epi16( _mm_srli_epi16( lo, 8 ), _mm_srli_epi16( hi, 8 ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), result );
+	}
+	lerpScalar( dst + i, a + i, b + i, count - i, amount );
+}
+
+// a * b / 255 rounded to the nearest integer in 16-bit lanes, the same as mul255()
+static inline __m128i mul255x8( __m128i a, __m128i b ) noexcept
+{
+	__m128i product = _mm_add_epi16( _mm_mullo_epi16( a, b ), _mm_set1_epi16( 128 ) );
+	return _mm_srli_epi16( _mm_add_epi16( product, _mm_srli_epi16( product, 8 ) ), 8 );
+}
+
+static void fromHSVSSE2( Color * dst, const HSV * src, size_t count ) noexcept
+{
+	const uint32_t * hues = hueColors();
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max8 = _mm_set1_epi8( char( 0xFF ) );
+	const __m128i max16 = _mm_set1_epi16( 255 );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// the table lookups can't be vectorized, but all the arithmetic after them can
+		__m128i pure = _mm_set_epi32(
+			int( hues[ src[i+3].h ] ), int( hues[ src[i+2].h ] ), int( hues[ src[i+1].h ] ), int( hues[ src[i].h ] )
+		);
+		// saturation and value replicated into the r, g, b bytes, zero in the padding gives zero padding on output
+		__m128i sat = _mm_set_epi32(
+			int( src[i+3].s * 0x010101u ), int( src[i+2].s * 0x010101u ), int( src[i+1].s * 0x010101u ), int( src[i].s * 0x010101u )
+		);
+		__m128i val = _mm_set_epi32(
+			int( src[i+3].v * 0x010101u ), int( src[i+2].v * 0x010101u ), int( src[i+1].v * 0x010101u ), int( src[i].v * 0x010101u )
+		);
+		__m128i inverted = _mm_sub_epi8( max8, pure );
+
+		__m128i lo = _mm_sub_epi16( max16, mul255x8( _mm_unpacklo_epi8( sat, zero ), _mm_unpacklo_epi8( inverted, zero ) ) );
+		__m128i hi = _mm_sub_epi16( max16, mul255x8( _mm_unpackhi_epi8( sat, zero ), _mm_unpackhi_epi8( inverted, zero ) ) );
+		lo = mul255x8( _mm_unpacklo_epi8( val, zero ), lo );
+		hi = mul255x8( _mm_unpackhi_epi8( val, zero ), hi );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), _mm_packus_epi16( lo, hi ) );
+	}
+	fromHSVScalar( dst + i, src + i, count - i );
+}
+
+// target of the blend mode in 16-bit lanes, the same as blendTarget()
+template< BlendMode mode >
+static inline __m128i blendTargetx8( __m128i d, __m128i s ) noexcept
+{
+	switch (mode)  // resolved at compile time
+	{
+		case BlendMode::Add:       return _mm_min_epi16( _mm_add_epi16( d, s ), _mm_set1_epi16( 255 ) );
+		case BlendMode::Multiply:  return mul255x8( d, s );
+		case BlendMode::Screen:    return _mm_sub_epi16( _mm_add_epi16( d, s ), mul255x8( d, s ) );
+		case BlendMode::Lighten:   return _mm_max_epi16( d, s );
+		default:                   return s;
+	}
+}
+
+// blends 2 pixels unpacked into 16-bit lanes
+template< BlendMode mode >
+static inline __m128i blendx8( __m128i d, __m128i s, __m128i opacity ) noexcept
+{
+	// the alpha of each pixel copied into all 4 of its lanes
+	__m128i alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( s, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) );
+	alpha = mul255x8( alpha, opacity );
+	__m128i weight = _mm_add_epi16( alpha, _mm_srli_epi16( alpha, 7 ) );
+	__m128i mixed = _mm_add_epi16(
+		_mm_mullo_epi16( d, _mm_sub_epi16( _mm_set1_epi16( 256 ), weight ) ),
+		_mm_mullo_epi16( blendTargetx8< mode >( d, s ), weight )
+	);
+	return _mm_srli_epi16( mixed, 8 );
+}
+
+template< BlendMode mode >
+static void blendSSE2( Color * dst, const Color * src, size_t count, uint8_t opacity ) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opacity16 = _mm_set1_epi16( opacity );
+	const __m128i paddingMask = _mm_set1_epi32( int( 0xFF000000u ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i d = _mm_loadu_si128( reinterpret_cast< const __m128i * >( dst + i ) );
+		__m128i s = _mm_loadu_si128( reinterpret_cast< const __m128i * >( src + i ) );
+		__m128i lo = blendx8< mode >( _mm_unpacklo_epi8( d, zero ), _mm_unpacklo_epi8( s, zero ), opacity16 );
+		__m128i hi = blendx8< mode >( _mm_unpackhi_epi8( d, zero ), _mm_unpackhi_epi8( s, zero ), opacity16 );
+		// keep the original padding of the destination
+		__m128i result = _mm_or_si128( _mm_andnot_si128( paddingMask, _mm_packus_epi16( lo, hi ) ), _mm_and_si128( paddingMask, d ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), result );
+	}
+	blendScalar< mode >( dst + i, src + i, count - i, opacity );
+}
+
+static void blendSSE2( Color * dst, const Color * src, size_t count, BlendMode mode, uint8_t opacity ) noexcept
+{
+	DISPATCH_BLEND_MODE( blendSSE2, dst, src, count, mode, opacity )
+}
+
+// Row of the matrix for _mm_madd_epi16 on 2 pixels unpacked into 16-bit lanes, whose padding was replaced by 1,
+// so that the last coefficient adds the rounding constant.
+static inline __m128i matrixRow( const int16_t * row ) noexcept
+{
+	return _mm_set_epi16( 128, row[2], row[1], row[0], 128, row[2], row[1], row[0] );
+}
+
+// dot products of 4 pixels with a matrix row, the same as dotProduct()
+static inline __m128i dotProductsx4( __m128i lo, __m128i hi, __m128i row ) noexcept
+{
+	// [r0*m0 + g0*m1, b0*m2 + 128, r1*m0 + g1*m1, b1*m2 + 128], reordered so that the two halves of each sum
+	// are in different 64-bit halves of the register
+	__m128i productsLo = _mm_shuffle_epi32( _mm_madd_epi16( lo, row ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	__m128i productsHi = _mm_shuffle_epi32( _mm_madd_epi16( hi, row ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	__m128i sums = _mm_add_epi32( _mm_unpacklo_epi64( productsLo, productsHi ), _mm_unpackhi_epi64( productsLo, productsHi ) );
+	return _mm_srai_epi32( sums, 8 );
+}
+
+// The matrix is applied with vector instructions, the table lookups can't be vectorized, but they are done
+// in the same loop while the pixels are still in the L1 cache.
+static void transformSSE2( Color * dst, const Color * src, size_t count, const ColorMatrix & matrix, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i channelMask = _mm_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1 );
+	const __m128i paddingOne = _mm_set_epi16( 1, 0, 0, 0, 1, 0, 0, 0 );
+	const __m128i row0 = matrixRow( matrix.values[0] );
+	const __m128i row1 = matrixRow( matrix.values[1] );
+	const __m128i row2 = matrixRow( matrix.values[2] );
+	alignas( 16 ) Color transformed [4];
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128( reinterpret_cast< const __m128i * >( src + i ) );
+		__m128i lo = _mm_or_si128( _mm_and_si128( _mm_unpacklo_epi8( pixels, zero ), channelMask ), paddingOne );
+		__m128i hi = _mm_or_si128( _mm_and_si128( _mm_unpackhi_epi8( pixels, zero ), channelMask ), paddingOne );
+		__m128i reds = dotProductsx4( lo, hi, row0 );
+		__m128i greens = dotProductsx4( lo, hi, row1 );
+		__m128i blues = dotProductsx4( lo, hi, row2 );
+		__m128i paddings = _mm_srli_epi32( pixels, 24 );
+		// the saturating packs clamp the channels to 0..255, the bytes are ordered r0 r1 r2 r3 g0 g1 ...
+		__m128i planar = _mm_packus_epi16( _mm_packs_epi32( reds, greens ), _mm_packs_epi32( blues, paddings ) );
+		__m128i redGreen = _mm_unpacklo_epi8( planar, _mm_srli_si128( planar, 4 ) );
+		__m128i bluePadding = _mm_unpacklo_epi8( _mm_srli_si128( planar, 8 ), _mm_srli_si128( planar, 12 ) );
+		_mm_store_si128( reinterpret_cast< __m128i * >( transformed ), _mm_unpacklo_epi16( redGreen, bluePadding ) );
+
+		for (size_t j = 0; j < 4; ++j)
+		{
+			dst[i+j].r = red.values[ transformed[j].r ];
+			dst[i+j].g = green.values[ transformed[j].g ];
+			dst[i+j].b = blue.values[ transformed[j].b ];
+			dst[i+j].padding = transformed[j].padding;
+		}
+	}
+	transformScalar( dst + i, src + i, count - i, matrix, red, green, blue );
+}
+
+// There is no gather instruction in SSE2, so the table entries are loaded one by one,
+// but the interpolation of 4 pixels at once still pays off.
+static void lookupInterpolatedSSE2( Color * dst, const uint16_t * positions, size_t count, const Color * table ) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16( 256 );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const uint32_t p0 = positions[i], p1 = positions[i+1], p2 = positions[i+2], p3 = positions[i+3];
+		__m128i pixelsA = _mm_set_epi32(
+			int( toBits( table[ p3 >> 8 ] ) ), int( toBits( table[ p2 >> 8 ] ) ),
+			int( toBits( table[ p1 >> 8 ] ) ), int( toBits( table[ p0 >> 8 ] ) )
+		);
+		__m128i pixelsB = _mm_set_epi32(
+			int( toBits( table[ (p3 >> 8) + 1 ] ) ), int( toBits( table[ (p2 >> 8) + 1 ] ) ),
+			int( toBits( table[ (p1 >> 8) + 1 ] ) ), int( toBits( table[ (p0 >> 8) + 1 ] ) )
+		);
+		// the weight of every pixel in both 16-bit halves of its 32-bit lane
+		__m128i weights = _mm_set_epi32(
+			int( (p3 & 0xFF) * 0x10001 ), int( (p2 & 0xFF) * 0x10001 ),
+			int( (p1 & 0xFF) * 0x10001 ), int( (p0 & 0xFF) * 0x10001 )
+		);
+		__m128i weightsLo = _mm_unpacklo_epi32( weights, weights );
+		__m128i weightsHi = _mm_unpackhi_epi32( weights, weights );
+		__m128i lo = _mm_add_epi16(
+			_mm_mullo_epi16( _mm_unpacklo_epi8( pixelsA, zero ), _mm_sub_epi16( full, weightsLo ) ),
+			_mm_mullo_epi16( _mm_unpacklo_epi8( pixelsB, zero ), weightsLo )
+		);
+		__m128i hi = _mm_add_epi16(
+			_mm_mullo_epi16( _mm_unpackhi_epi8( pixelsA, zero ), _mm_sub_epi16( full, weightsHi ) ),
+			_mm_mullo_epi16( _mm_unpackhi_epi8( pixelsB, zero ), weightsHi )
+		);
+		__m128i result = _mm_packus_epi16( _mm_srli_epi16( lo, 8 ), _mm_srli_epi16( hi, 8 ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), result );
+	}
+	lookupInterpolatedScalar( dst + i, positions + i, count - i, table );
+}
+
+// a vector holds 4 pixels of 4 bytes with the channels always in the same lanes, both its halves are widened to 16 bits
+// and added into one accumulator, 2 bytes per lane, so 128 vectors fit into 16 bits before they have to be widened to 32
+static void sumPixels4SSE2( const uint8_t * pixels, size_t count, uint32_t * sums ) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sums32 = zero;
+	size_t i = 0;
+	while (i + 4 <= count)
+	{
+		const size_t batchEnd = i + std::min( (count - i) & ~size_t(3), size_t(128 * 4) );
+		__m128i sums16 = zero;
+		for (; i < batchEnd; i += 4)
+		{
+			__m128i block = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pixels + i * 4 ) );
+			sums16 = _mm_add_epi16( sums16, _mm_unpacklo_epi8( block, zero ) );
+			sums16 = _mm_add_epi16( sums16, _mm_unpackhi_epi8( block, zero ) );
+		}
+		sums32 = _mm_add_epi32( sums32, _mm_unpacklo_epi16( sums16, zero ) );
+		sums32 = _mm_add_epi32( sums32, _mm_unpackhi_epi16( sums16, zero ) );
+	}
+	alignas(16) uint32_t lanes [4];
+	_mm_store_si128( reinterpret_cast< __m128i * >( lanes ), sums32 );
+	for (uint32_t j = 0; j < 4; ++j)
+		sums[j] += lanes[j];
+	sumPixelsScalar( pixels + i * 4, count - i, 4, sums );
+}
+
+// 16 pixels of 3 bytes are 3 vectors whose bytes of one channel are every 3rd, starting at a different position
+// in each of them, so after masking them the bytes of a channel from all 3 vectors fill distinct positions of one
+// vector, and they are summed into 64-bit lanes, which can't overflow
+static void sumPixels3SSE2( const uint8_t * pixels, size_t count, uint32_t * sums ) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i first = _mm_setr_epi8( -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1 );
+	const __m128i second = _mm_slli_si128( first, 1 );
+	const __m128i third = _mm_slli_si128( first, 2 );
+	__m128i red = zero, green = zero, blue = zero;
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i * blocks = reinterpret_cast< const __m128i * >( pixels + i * 3 );
+		__m128i a = _mm_loadu_si128( blocks );
+		__m128i b = _mm_loadu_si128( blocks + 1 );
+		__m128i c = _mm_loadu_si128( blocks + 2 );
+		__m128i redBytes = _mm_or_si128( _mm_or_si128( _mm_and_si128( a, first ), _mm_and_si128( b, third ) ), _mm_and_si128( c, second ) );
+		__m128i greenBytes = _mm_or_si128( _mm_or_si128( _mm_and_si128( a, second ), _mm_and_si128( b, first ) ), _mm_and_si128( c, third ) );
+		__m128i blueBytes = _mm_or_si128( _mm_or_si128( _mm_and_si128( a, third ), _mm_and_si128( b, second ) ), _mm_and_si128( c, first ) );
+		red = _mm_add_epi64( red, _mm_sad_epu8( redBytes, zero ) );
+		green = _mm_add_epi64( green, _mm_sad_epu8( greenBytes, zero ) );
+		blue = _mm_add_epi64( blue, _mm_sad_epu8( blueBytes, zero ) );
+	}
+	sums[0] += uint32_t( _mm_cvtsi128_si32( _mm_add_epi64( red, _mm_srli_si128( red, 8 ) ) ) );
+	sums[1] += uint32_t( _mm_cvtsi128_si32( _mm_add_epi64( green, _mm_srli_si128( green, 8 ) ) ) );
+	sums[2] += uint32_t( _mm_cvtsi128_si32( _mm_add_epi64( blue, _mm_srli_si128( blue, 8 ) ) ) );
+	sumPixelsScalar( pixels + i * 3, count - i, 3, sums );
+}
+
+static void sumPixelsSSE2( const uint8_t * pixels, size_t count, uint32_t bytesPerPixel, uint32_t * sums ) noexcept
+{
+	if (bytesPerPixel == 4)
+		sumPixels4SSE2( pixels, count, sums );
+	else if (bytesPerPixel == 3)
+		sumPixels3SSE2( pixels, count, sums );
+	else
+		sumPixelsScalar( pixels, count, bytesPerPixel, sums );
+}
+
+#endif // COLOROPS_SSE2
+
+
+//======================================================================================================================
+//  AVX2
+
+#ifdef COLOROPS_AVX2
+
+// The unpack and pack instructions work within each 128-bit half, so they restore the original order of the pixels.
+
+COLOROPS_TARGET_AVX2
+static void fillAVX2( Color * dst, size_t count, Color color ) noexcept
+{
+	const __m256i value = _mm256_set1_epi32( int( toBits( color ) ) );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), value );
+	fillScalar( dst + i, count - i, color );
+}
+
+COLOROPS_TARGET_AVX2
+static void scaleAVX2( Color * dst, const Color * src, size_t count, Color factor ) noexcept
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const short wr = short( toWeight( factor.r ) ), wg = short( toWeight( factor.g ) ), wb = short( toWeight( factor.b ) );
+	const __m256i weights = _mm256_set_epi16(
+		256, wb, wg, wr, 256, wb, wg, wr,
+		256, wb, wg, wr, 256, wb, wg, wr
+	);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i pixels = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( src + i ) );
+		__m256i lo = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_unpacklo_epi8( pixels, zero ), weights ), 8 );
+		__m256i hi = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_unpackhi_epi8( pixels, zero ), weights ), 8 );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), _mm256_packus_epi16( lo, hi ) );
+	}
+	scaleSSE2( dst + i, src + i, count - i, factor );
+}
+
+COLOROPS_TARGET_AVX2
+static void addAVX2( Color * dst, const Color * a, const Color * b, size_t count ) noexcept
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i pixelsA = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( a + i ) );
+		__m256i pixelsB = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( b + i ) );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), _mm256_adds_epu8( pixelsA, pixelsB ) );
+	}
+	addSSE2( dst + i, a + i, b + i, count - i );
+}
+
+COLOROPS_TARGET_AVX2
+static void lerpAVX2( Color * dst, const Color * a, const Color * b, size_t count, uint8_t amount ) noexcept
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i weightB = _mm256_set1_epi16( short( toWeight( amount ) ) );
+	const __m256i weightA = _mm256_set1_epi16( short( 256 - toWeight( amount ) ) );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i pixelsA = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( a + i ) );
+		__m256i pixelsB = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( b + i ) );
+		__m256i lo = _mm256_add_epi16(
+			_mm256_mullo_epi16( _mm256_unpacklo_epi8( pixelsA, zero ), weightA ),
+			_mm256_mullo_epi16( _mm256_unpacklo_epi8( pixelsB, zero ), weightB )
+		);
+		__m256i hi = _mm256_add_epi16(
+			_mm256_mullo_epi16( _mm256_unpackhi_epi8( pixelsA, zero ), weightA ),
+			_mm256_mullo_epi16( _mm256_unpackhi_epi8( pixelsB, zero ), weightB )
+		);
+		__m256i result = _mm256_packus_epi16( _mm256_srli_epi16( lo, 8 ), _mm256_srli_epi16( hi, 8 ) );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), result );
+	}
+	lerpSSE2( dst + i, a + i, b + i, count - i, amount );
+}
+
+COLOROPS_TARGET_AVX2
+static void lookupAVX2( Color * dst, const uint8_t * indexes, size_t count, const Color * table ) noexcept
+{
+	const int * entries = reinterpret_cast< const int * >( table );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i idx = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast< const __m128i * >( indexes + i ) ) );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), _mm256_i32gather_epi32( entries, idx, 4 ) );
+	}
+	lookupScalar( dst + i, indexes + i, count - i, table );
+}
+
+COLOROPS_TARGET_AVX2
+static void lookupInterpolatedAVX2( Color * dst, const uint16_t * positions, size_t count, const Color * table ) noexcept
+{
+	const int * entries = reinterpret_cast< const int * >( table );
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i full = _mm256_set1_epi16( 256 );
+	const __m256i lowByte = _mm256_set1_epi32( 0xFF );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i pos = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast< const __m128i * >( positions + i ) ) );
+		__m256i idx = _mm256_srli_epi32( pos, 8 );
+		__m256i pixelsA = _mm256_i32gather_epi32( entries, idx, 4 );
+		__m256i pixelsB = _mm256_i32gather_epi32( entries + 1, idx, 4 );
+		// the weight of every pixel in both 16-bit halves of its 32-bit lane
+		__m256i weights = _mm256_and_si256( pos, lowByte );
+		weights = _mm256_or_si256( weights, _mm256_slli_epi32( weights, 16 ) );
+		__m256i weightsLo = _mm256_unpacklo_epi32( weights, weights );
+		__m256i weightsHi = _mm256_unpackhi_epi32( weights, weights );
+		__m256i lo = _mm256_add_epi16(
+			_mm256_mullo_epi16( _mm256_unpacklo_epi8( pixelsA, zero ), _mm256_sub_epi16( full, weightsLo ) ),
+			_mm256_mullo_epi16( _mm256_unpacklo_epi8( pixelsB, zero ), weightsLo )
+		);
+		__m256i hi = _mm256_add_epi16(
+			_mm256_mullo_epi16( _mm256_unpackhi_epi8( pixelsA, zero ), _mm256_sub_epi16( full, weightsHi ) ),
+			_mm256_mullo_epi16( _mm256_unpackhi_epi8( pixelsB, zero ), weightsHi )
+		);
+		__m256i result = _mm256_packus_epi16( _mm256_srli_epi16( lo, 8 ), _mm256_srli_epi16( hi, 8 ) );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), result );
+	}
+	lookupInterpolatedSSE2( dst + i, positions + i, count - i, table );
+}
+
+static bool cpuHasAVX2() noexcept
+{
+ #if defined(__GNUC__) || defined(__clang__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" );
+ #else
+	int info [4];
+	__cpuid( info, 1 );
+	bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv( 0 ) & 0x6) == 0x6;
+	if (!osSavesYmm)
+		return false;
+	__cpuidex( info, 7, 0 );
+	return (info[1] & (1 << 5)) != 0;
+ #endif
+}
+
+#endif // COLOROPS_AVX2
+
+
+//======================================================================================================================
+//  NEON
+
+#ifdef COLOROPS_NEON
+
+static void fillNEON( Color * dst, size_t count, Color color ) noexcept
+{
+	uint32_t bits;
+	memcpy( &bits, &color, sizeof( bits ) );
+	const uint8x16_t value = vreinterpretq_u8_u32( vdupq_n_u32( bits ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		vst1q_u8( reinterpret_cast< uint8_t * >( dst + i ), value );
+	fillScalar( dst + i, count - i, color );
+}
+
+static void scaleNEON( Color * dst, const Color * src, size_t count, Color factor ) noexcept
+{
+	const uint16_t weightArray [8] = {
+		uint16_t( toWeight( factor.r ) ), uint16_t( toWeight( factor.g ) ), uint16_t( toWeight( factor.b ) ), 256,
+		uint16_t( toWeight( factor.r ) ), uint16_t( toWeight( factor.g ) ), uint16_t( toWeight( factor.b ) ), 256,
+	};
+	const uint16x8_t weights = vld1q_u16( weightArray );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t pixels = vld1q_u8( reinterpret_cast< const uint8_t * >( src + i ) );
+		uint8x8_t lo = vshrn_n_u16( vmulq_u16( vmovl_u8( vget_low_u8( pixels ) ), weights ), 8 );
+		uint8x8_t hi = vshrn_n_u16( vmulq_u16( vmovl_u8( vget_high_u8( pixels ) ), weights ), 8 );
+		vst1q_u8( reinterpret_cast< uint8_t * >( dst + i ), vcombine_u8( lo, hi ) );
+	}
+	scaleScalar( dst + i, src + i, count - i, factor );
+}
+
+static void addNEON( Color * dst, const Color * a, const Color * b, size_t count ) noexcept
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t pixelsA = vld1q_u8( reinterpret_cast< const uint8_t * >( a + i ) );
+		uint8x16_t pixelsB = vld1q_u8( reinterpret_cast< const uint8_t * >( b + i ) );
+		vst1q_u8( reinterpret_cast< uint8_t * >( dst + i ), vqaddq_u8( pixelsA, pixelsB ) );
+	}
+	addScalar( dst + i, a + i, b + i, count - i );
+}
+
+static void lerpNEON( Color * dst, const Color * a, const Color * b, size_t count, uint8_t amount ) noexcept
+{
+	const uint16x8_t weightB = vdupq_n_u16( uint16_t( toWeight( amount ) ) );
+	const uint16x8_t weightA = vdupq_n_u16( uint16_t( 256 - toWeight( amount ) ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t pixelsA = vld1q_u8( reinterpret_cast< const uint8_t * >( a + i ) );
+		uint8x16_t pixelsB = vld1q_u8( reinterpret_cast< const uint8_t * >( b + i ) );
+		uint16x8_t lo = vmlaq_u16( vmulq_u16( vmovl_u8( vget_low_u8( pixelsA ) ), weightA ), vmovl_u8( vget_low_u8( pixelsB ) ), weightB );
+		uint16x8_t hi = vmlaq_u16( vmulq_u16( vmovl_u8( vget_high_u8( pixelsA ) ), weightA ), vmovl_u8( vget_high_u8( pixelsB ) ), weightB );
+		vst1q_u8( reinterpret_cast< uint8_t * >( dst + i ), vcombine_u8( vshrn_n_u16( lo, 8 ), vshrn_n_u16( hi, 8 ) ) );
+	}
+	lerpScalar( dst + i, a + i, b + i, count - i, amount );
+}
+
+// a * b / 255 rounded to the nearest integer, the same as mul255()
+static inline uint8x8_t mul255x8( uint8x8_t a, uint8x8_t b ) noexcept
+{
+	uint16x8_t product = vaddq_u16( vmull_u8( a, b ), vdupq_n_u16( 128 ) );
+	return vshrn_n_u16( vsraq_n_u16( product, product, 8 ), 8 );
+}
+
+static void fromHSVNEON( Color * dst, const HSV * src, size_t count ) noexcept
+{
+	const uint32_t * hues = hueColors();
+	const uint8x8_t max8 = vdup_n_u8( 255 );
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		// the table lookups can't be vectorized, but all the arithmetic after them can
+		const uint32_t pureArray [2] = { hues[ src[i].h ], hues[ src[i+1].h ] };
+		const uint32_t satArray [2] = { src[i].s * 0x010101u, src[i+1].s * 0x010101u };
+		const uint32_t valArray [2] = { src[i].v * 0x010101u, src[i+1].v * 0x010101u };
+		uint8x8_t pure = vreinterpret_u8_u32( vld1_u32( pureArray ) );
+		uint8x8_t sat = vreinterpret_u8_u32( vld1_u32( satArray ) );
+		uint8x8_t val = vreinterpret_u8_u32( vld1_u32( valArray ) );
+
+		uint8x8_t result = mul255x8( val, vsub_u8( max8, mul255x8( sat, vsub_u8( max8, pure ) ) ) );
+		vst1_u8( reinterpret_cast< uint8_t * >( dst + i ), result );
+	}
+	fromHSVScalar( dst + i, src + i, count - i );
+}
+
+// target of the blend mode for 8 values of a channel, the same as blendTarget()
+template< BlendMode mode >
+static inline uint8x8_t blendTargetx8( uint8x8_t d, uint8x8_t s ) noexcept
+{
+	switch (mode)  // resolved at compile time
+	{
+		case BlendMode::Add:       return vqadd_u8( d, s );
+		case BlendMode::Multiply:  return mul255x8( d, s );
+		case BlendMode::Screen:    return vsub_u8( vadd_u8( d, s ), mul255x8( d, s ) );  // the wrap-arounds cancel out
+		case BlendMode::Lighten:   return vmax_u8( d, s );
+		default:                   return s;
+	}
+}
+
+template< BlendMode mode >
+static void blendNEON( Color * dst, const Color * src, size_t count, uint8_t opacity ) noexcept
+{
+	const uint8x8_t opacity8 = vdup_n_u8( opacity );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		// de-interleaved into separate r, g, b and padding planes
+		uint8x8x4_t d = vld4_u8( reinterpret_cast< const uint8_t * >( dst + i ) );
+		uint8x8x4_t s = vld4_u8( reinterpret_cast< const uint8_t * >( src + i ) );
+		uint8x8_t alpha = mul255x8( s.val[3], opacity8 );
+		uint16x8_t weight = vaddw_u8( vmovl_u8( alpha ), vshr_n_u8( alpha, 7 ) );
+		uint16x8_t inverseWeight = vsubq_u16( vdupq_n_u16( 256 ), weight );
+		for (int c = 0; c < 3; ++c)
+		{
+			uint16x8_t mixed = vmlaq_u16( vmulq_u16( vmovl_u8( d.val[c] ), inverseWeight ), vmovl_u8( blendTargetx8< mode >( d.val[c], s.val[c] ) ), weight );
+			d.val[c] = vshrn_n_u16( mixed, 8 );
+		}
+		vst4_u8( reinterpret_cast< uint8_t * >( dst + i ), d );
+	}
+	blendScalar< mode >( dst + i, src + i, count - i, opacity );
+}
+
+static void blendNEON( Color * dst, const Color * src, size_t count, BlendMode mode, uint8_t opacity ) noexcept
+{
+	DISPATCH_BLEND_MODE( blendNEON, dst, src, count, mode, opacity )
+}
+
+// one channel of 8 pixels from a matrix row, rounded and clamped to 0..255, the same as in transformScalar()
+static inline uint8x8_t dotProductsx8( const int16_t * row, int16x8_t r, int16x8_t g, int16x8_t b ) noexcept
+{
+	int32x4_t lo = vdupq_n_s32( 128 );
+	lo = vmlal_n_s16( lo, vget_low_s16( r ), row[0] );
+	lo = vmlal_n_s16( lo, vget_low_s16( g ), row[1] );
+	lo = vmlal_n_s16( lo, vget_low_s16( b ), row[2] );
+	int32x4_t hi = vdupq_n_s32( 128 );
+	hi = vmlal_n_s16( hi, vget_high_s16( r ), row[0] );
+	hi = vmlal_n_s16( hi, vget_high_s16( g ), row[1] );
+	hi = vmlal_n_s16( hi, vget_high_s16( b ), row[2] );
+	// the saturating narrowing clamps the sums first to 16 bits and then to 0..255
+	return vqmovun_s16( vcombine_s16( vqshrn_n_s32( lo, 8 ), vqshrn_n_s32( hi, 8 ) ) );
+}
+
+static void transformNEON( Color * dst, const Color * src, size_t count, const ColorMatrix & matrix, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept
+{
+	uint8_t transformed [3][8];
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		uint8x8x4_t pixels = vld4_u8( reinterpret_cast< const uint8_t * >( src + i ) );
+		int16x8_t r = vreinterpretq_s16_u16( vmovl_u8( pixels.val[0] ) );
+		int16x8_t g = vreinterpretq_s16_u16( vmovl_u8( pixels.val[1] ) );
+		int16x8_t b = vreinterpretq_s16_u16( vmovl_u8( pixels.val[2] ) );
+		vst1_u8( transformed[0], dotProductsx8( matrix.values[0], r, g, b ) );
+		vst1_u8( transformed[1], dotProductsx8( matrix.values[1], r, g, b ) );
+		vst1_u8( transformed[2], dotProductsx8( matrix.values[2], r, g, b ) );
+
+		// the padding stays in pixels.val[3]
+		for (size_t j = 0; j < 8; ++j)
+		{
+			transformed[0][j] = red.values[ transformed[0][j] ];
+			transformed[1][j] = green.values[ transformed[1][j] ];
+			transformed[2][j] = blue.values[ transformed[2][j] ];
+		}
+		pixels.val[0] = vld1_u8( transformed[0] );
+		pixels.val[1] = vld1_u8( transformed[1] );
+		pixels.val[2] = vld1_u8( transformed[2] );
+		vst4_u8( reinterpret_cast< uint8_t * >( dst + i ), pixels );
+	}
+	transformScalar( dst + i, src + i, count - i, matrix, red, green, blue );
+}
+
+static inline uint32_t horizontalSum( uint32x4_t values ) noexcept
+{
+	uint32x2_t pairs = vadd_u32( vget_low_u32( values ), vget_high_u32( values ) );
+	return vget_lane_u32( vpadd_u32( pairs, pairs ), 0 );
+}
+
+// the de-interleaving loads put every channel into its own vector, pairs of its bytes are added into 16-bit lanes,
+// which takes 128 blocks before they can overflow, and then into 32-bit lanes
+static void sumPixelsNEON( const uint8_t * pixels, size_t count, uint32_t bytesPerPixel, uint32_t * sums ) noexcept
+{
+	if (bytesPerPixel != 3 && bytesPerPixel != 4)
+	{
+		sumPixelsScalar( pixels, count, bytesPerPixel, sums );
+		return;
+	}
+
+	uint32x4_t sums32 [4] = { vdupq_n_u32( 0 ), vdupq_n_u32( 0 ), vdupq_n_u32( 0 ), vdupq_n_u32( 0 ) };
+	size_t i = 0;
+	while (i + 16 <= count)
+	{
+		const size_t batchEnd = i + std::min( (count - i) & ~size_t(15), size_t(128 * 16) );
+		uint16x8_t sums16 [4] = { vdupq_n_u16( 0 ), vdupq_n_u16( 0 ), vdupq_n_u16( 0 ), vdupq_n_u16( 0 ) };
+		if (bytesPerPixel == 4)
+		{
+			for (; i < batchEnd; i += 16)
+			{
+				uint8x16x4_t block = vld4q_u8( pixels + i * 4 );
+				for (size_t j = 0; j < 4; ++j)
+					sums16[j] = vpadalq_u8( sums16[j], block.val[j] );
+			}
+		}
+		else
+		{
+			for (; i < batchEnd; i += 16)
+			{
+				uint8x16x3_t block = vld3q_u8( pixels + i * 3 );
+				for (size_t j = 0; j < 3; ++j)
+					sums16[j] = vpadalq_u8( sums16[j], block.val[j] );
+			}
+		}
+		for (size_t j = 0; j < 4; ++j)
+			sums32[j] = vpadalq_u16( sums32[j], sums16[j] );
+	}
+	for (uint32_t j = 0; j < bytesPerPixel; ++j)
+		sums[j] += horizontalSum( sums32[j] );
+	sumPixelsScalar( pixels + i * bytesPerPixel, count - i, bytesPerPixel, sums );
+}
+
+#endif // COLOROPS_NEON
+
+
+//======================================================================================================================
+//  dispatch
+
+struct Kernels
+{
+	SimdLevel level;
+	void (* fill)( Color * dst, size_t count, Color color ) noexcept;
+	void (* scale)( Color * dst, const Color * src, size_t count, Color factor ) noexcept;
+	void (* add)( Color * dst, const Color * a, const Color * b, size_t count ) noexcept;
+	void (* lerp)( Color * dst, const Color * a, const Color * b, size_t count, uint8_t amount ) noexcept;
+	void (* fromHSV)( Color * dst, const HSV * src, size_t count ) noexcept;
+	void (* blend)( Color * dst, const Color * src, size_t count, BlendMode mode, uint8_t opacity ) noexcept;
+	void (* lookup)( Color * dst, const uint8_t * indexes, size_t count, const Color * table ) noexcept;
+	void (* lookupInterpolated)( Color * dst, const uint16_t * positions, size_t count, const Color * table ) noexcept;
+	void (* transform)( Color * dst, const Color * src, size_t count, const ColorMatrix & matrix, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept;
+	void (* sumPixels)( const uint8_t * pixels, size_t count, uint32_t bytesPerPixel, uint32_t * sums ) noexcept;
+};
+
+static const Kernels scalarKernels = {
+	SimdLevel::Scalar, fillScalar, scaleScalar, addScalar, lerpScalar, fromHSVScalar, blendScalar,
+	lookupScalar, lookupInterpolatedScalar, transformScalar, sumPixelsScalar
+};
+#ifdef COLOROPS_SSE2
+// SSE2 has no gather, the plain table lookup can't be done better than by the scalar loop
+static const Kernels sse2Kernels = {
+	SimdLevel::SSE2, fillSSE2, scaleSSE2, addSSE2, lerpSSE2, fromHSVSSE2, blendSSE2,
+	lookupScalar, lookupInterpolatedSSE2, transformSSE2, sumPixelsSSE2
+};
+#endif
+#ifdef COLOROPS_AVX2
+// there are no AVX2 variants of fromHSV, blend and transform yet, the SSE2 ones are used,
+// sumPixels is limited by the memory bandwidth, so the wider vectors wouldn't help it
+static const Kernels avx2Kernels = {
+	SimdLevel::AVX2, fillAVX2, scaleAVX2, addAVX2, lerpAVX2, fromHSVSSE2, blendSSE2,
+	lookupAVX2, lookupInterpolatedAVX2, transformSSE2, sumPixelsSSE2
+};
+#endif
+#ifdef COLOROPS_NEON
+// NEON has no gather either, the table lookups use the scalar loops
+static const Kernels neonKernels = {
+	SimdLevel::NEON, fillNEON, scaleNEON, addNEON, lerpNEON, fromHSVNEON, blendNEON,
+	lookupScalar, lookupInterpolatedScalar, transformNEON, sumPixelsNEON
+};
+#endif
+
+static const Kernels * kernelsFor( SimdLevel level ) noexcept
+{
+	switch (level)
+	{
+		case SimdLevel::Scalar:
+			return &scalarKernels;
+	 #ifdef COLOROPS_SSE2
+		case SimdLevel::SSE2:
+			return &sse2Kernels;
+	 #endif
+	 #ifdef COLOROPS_AVX2
+		case SimdLevel::AVX2:
+			return cpuHasAVX2() ? &avx2Kernels : nullptr;
+	 #endif
+	 #ifdef COLOROPS_NEON
+		case SimdLevel::NEON:
+			return &neonKernels;
+	 #endif
+		default:
+			return nullptr;
+	}
+}
+
+static const Kernels * bestKernels() noexcept
+{
+	const SimdLevel levels [] = { SimdLevel::AVX2, SimdLevel::SSE2, SimdLevel::NEON };
+	for (SimdLevel level : levels)
+		if (const Kernels * kernels = kernelsFor( level ))
+			return kernels;
+	return &scalarKernels;
+}
+
+static std::atomic< const Kernels * > currentKernels( nullptr );
+
+// the selection is idempotent, so it doesn't matter when more threads do it at the same time
+static const Kernels & kernels() noexcept
+{
+	const Kernels * selected = currentKernels.load( std::memory_order_acquire );
+	if (!selected)
+	{
+		selected = bestKernels();
+		currentKernels.store( selected, std::memory_order_release );
+	}
+	return *selected;
+}
+
+const char * enumString( SimdLevel level ) noexcept
+{
+	static const char * const SimdLevelStr [] =
+	{
+		"Scalar",
+		"SSE2",
+		"AVX2",
+		"NEON",
+	};
+	static_assert( size_t(SimdLevel::NEON) + 1 == fut::size(SimdLevelStr), "update the SimdLevelStr" );
+
+	if (size_t(level) < fut::size(SimdLevelStr))
+	{
+		return SimdLevelStr[ size_t(level) ];
+	}
+	else
+	{
+		return "<invalid>";
+	}
+}
+
+SimdLevel simdLevel() noexcept
+{
+	return kernels().level;
+}
+
+bool isSupported( SimdLevel level ) noexcept
+{
+	return kernelsFor( level ) != nullptr;
+}
+
+bool setSimdLevel( SimdLevel level ) noexcept
+{
+	const Kernels * selected = kernelsFor( level );
+	if (!selected)
+		return false;
+
+	currentKernels.store( selected, std::memory_order_release );
+	return true;
+}
+
+
+//======================================================================================================================
+//  operations
+
+void fill( Color * dst, size_t count, Color color ) noexcept
+{
+	kernels().fill( dst, count, color );
+}
+
+void scale( Color * dst, const Color * src, size_t count, Color factor ) noexcept
+{
+	kernels().scale( dst, src, count, factor );
+}
+
+void addSaturated( Color * dst, const Color * a, const Color * b, size_t count ) noexcept
+{
+	kernels().add( dst, a, b, count );
+}
+
+void lerp( Color * dst, const Color * a, const Color * b, size_t count, uint8_t amount ) noexcept
+{
+	kernels().lerp( dst, a, b, count, amount );
+}
+
+
+//======================================================================================================================
+//  compositing
+
+const char * enumString( BlendMode mode ) noexcept
+{
+	static const char * const BlendModeStr [] =
+	{
+		"Normal",
+		"Add",
+		"Multiply",
+		"Screen",
+		"Lighten",
+	};
+	static_assert( size_t(BlendMode::Lighten) + 1 == fut::size(BlendModeStr), "update the BlendModeStr" );
+
+	if (size_t(mode) < fut::size(BlendModeStr))
+	{
+		return BlendModeStr[ size_t(mode) ];
+	}
+	else
+	{
+		return "<invalid>";
+	}
+}
+
+void blend( Color * dst, const Color * src, size_t count, BlendMode mode, uint8_t opacity ) noexcept
+{
+	kernels().blend( dst, src, count, mode, opacity );
+}
+
+
+//======================================================================================================================
+//  color models
+
+void fromHSV( Color * dst, const HSV * src, size_t count ) noexcept
+{
+	kernels().fromHSV( dst, src, count );
+}
+
+void toHSV( HSV * dst, const Color * src, size_t count ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+		dst[i] = src[i].toHSV();
+}
+
+
+//======================================================================================================================
+//  lookup tables
+
+ChannelLUT ChannelLUT::identity() noexcept
+{
+	ChannelLUT lut;
+	for (uint32_t i = 0; i < 256; ++i)
+		lut.values[i] = uint8_t( i );
+	return lut;
+}
+
+ChannelLUT ChannelLUT::gamma( float gamma ) noexcept
+{
+	// pow( 0, gamma ) would be infinite or NaN and converting that to an integer is undefined
+	if (!(gamma > 0.0f))
+	{
+		return identity();
+	}
+
+	ChannelLUT lut;
+	for (uint32_t i = 0; i < 256; ++i)
+		lut.values[i] = uint8_t( std::pow( float( i ) / 255.0f, gamma ) * 255.0f + 0.5f );
+	return lut;
+}
+
+void lookup( Color * dst, const uint8_t * indexes, size_t count, const Color * table ) noexcept
+{
+	kernels().lookup( dst, indexes, count, table );
+}
+
+void lookupInterpolated( Color * dst, const uint16_t * positions, size_t count, const Color * table ) noexcept
+{
+	kernels().lookupInterpolated( dst, positions, count, table );
+}
+
+void applyLUT( Color * dst, const Color * src, size_t count, const ChannelLUT & lut ) noexcept
+{
+	applyLUT( dst, src, count, lut, lut, lut );
+}
+
+void applyLUT( Color * dst, const Color * src, size_t count, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i].r = red.values[ src[i].r ];
+		dst[i].g = green.values[ src[i].g ];
+		dst[i].b = blue.values[ src[i].b ];
+		dst[i].padding = src[i].padding;
+	}
+}
+
+
+//======================================================================================================================
+//  color correction
+
+ColorMatrix ColorMatrix::identity() noexcept
+{
+	ColorMatrix matrix;
+	for (size_t row = 0; row < 3; ++row)
+		for (size_t column = 0; column < 3; ++column)
+			matrix.values[ row ][ column ] = int16_t( row == column ? 256 : 0 );
+	return matrix;
+}
+
+ColorMatrix ColorMatrix::fromFloats( const float (& values) [3][3] ) noexcept
+{
+	ColorMatrix matrix;
+	for (size_t row = 0; row < 3; ++row)
+	{
+		for (size_t column = 0; column < 3; ++column)
+		{
+			// converting NaN or a float outside of the range of int16_t is undefined behaviour
+			float fixed = std::round( values[ row ][ column ] * 256.0f );
+			if (std::isnan( fixed ))
+				matrix.values[ row ][ column ] = 0;
+			else
+				matrix.values[ row ][ column ] = int16_t( fixed < -32768.0f ? -32768.0f : fixed > 32767.0f ? 32767.0f : fixed );
+		}
+	}
+	return matrix;
+}
+
+void transform( Color * dst, const Color * src, size_t count, const ColorMatrix & matrix, const ChannelLUT & red, const ChannelLUT & green, const ChannelLUT & blue ) noexcept
+{
+	kernels().transform( dst, src, count, matrix, red, green, blue );
+}
+
+
+//======================================================================================================================
+//  images
+
+void sumPixels( const uint8_t * pixels, size_t pixelCount, uint32_t bytesPerPixel, uint32_t * sums ) noexcept
+{
+	kernels().sumPixels( pixels, pixelCount, bytesPerPixel, sums );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace colorops
+} // namespace orgb
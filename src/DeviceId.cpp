@@ -0,0 +1,137 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: stable identifiers of devices, zones and LEDs that survive device list updates
+//======================================================================================================================
+
+#include "OpenRGB/DeviceId.hpp"
+
+#include "Essential.hpp"
+
+#include "DeviceIdentity.hpp"
+#include "MiscUtils.hpp"  // hashBytes
+
+#include <string>
+using std::string;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+constexpr uint32_t IdResolver::npos;
+
+void IdResolver::update( const DeviceList & devices )
+{
+	_devices = &devices;
+	_ids.clear();
+	_positions.clear();
+
+	_ids.reserve( devices.size() );
+	_positions.reserve( devices.size() );
+
+	for (const Device & device : devices)
+	{
+		string key = identityKey( device );
+		uint64_t baseValue = hashBytes( reinterpret_cast< const uint8_t * >( key.data() ), key.size() );
+
+		// devices with the same identity get the next value in their order, so that the same ones get it next time
+		uint64_t value = baseValue;
+		for (uint64_t ordinal = 1; value == 0 || _positions.count( value ) != 0; ++ordinal)
+		{
+			value = baseValue + ordinal * 0x9E3779B97F4A7C15ull;
+		}
+
+		_positions.emplace( value, uint32_t( _ids.size() ) );
+		_ids.push_back( DeviceId( value ) );
+	}
+}
+
+uint32_t IdResolver::positionOf( const Device & device ) const noexcept
+{
+	if (!_devices)
+		return npos;
+
+	// the index is the position, unless the list has been assembled from devices of different lists
+	if (device.idx < _devices->size() && &(*_devices)[ device.idx ] == &device)
+		return device.idx;
+
+	for (uint32_t position = 0; position < _devices->size(); ++position)
+		if (&(*_devices)[ position ] == &device)
+			return position;
+	return npos;
+}
+
+template< typename Object >
+uint32_t IdResolver::positionOf( const Object & object, const std::vector< Object > Device::* objects ) const noexcept
+{
+	if (!_devices)
+		return npos;
+
+	auto isIn = [ &object, objects ]( const Device & device )
+	{
+		const std::vector< Object > & deviceObjects = device.*objects;
+		return !deviceObjects.empty() && &object >= &deviceObjects.front() && &object <= &deviceObjects.back();
+	};
+
+	if (object.parentIdx < _devices->size() && isIn( (*_devices)[ object.parentIdx ] ))
+		return object.parentIdx;
+
+	for (uint32_t position = 0; position < _devices->size(); ++position)
+		if (isIn( (*_devices)[ position ] ))
+			return position;
+	return npos;
+}
+
+DeviceId IdResolver::deviceId( const Device & device ) const noexcept
+{
+	uint32_t position = positionOf( device );
+	return position != npos ? _ids[ position ] : DeviceId();
+}
+
+ZoneId IdResolver::zoneId( const Zone & zone ) const noexcept
+{
+	uint32_t position = positionOf( zone, &Device::zones );
+	return position != npos ? ZoneId( _ids[ position ], zone.idx ) : ZoneId();
+}
+
+LedId IdResolver::ledId( const LED & led ) const noexcept
+{
+	uint32_t position = positionOf( led, &Device::leds );
+	return position != npos ? LedId( _ids[ position ], led.idx ) : LedId();
+}
+
+const Device * IdResolver::resolve( DeviceId id ) const noexcept
+{
+	auto iter = _positions.find( id.value );
+	if (iter == _positions.end())
+		return nullptr;
+
+	return &(*_devices)[ iter->second ];
+}
+
+const Zone * IdResolver::resolve( ZoneId id ) const noexcept
+{
+	const Device * device = resolve( id.device );
+	if (!device || id.zoneIdx >= device->zones.size())
+		return nullptr;
+
+	return &device->zones[ id.zoneIdx ];
+}
+
+const LED * IdResolver::resolve( LedId id ) const noexcept
+{
+	const Device * device = resolve( id.device );
+	if (!device || id.ledIdx >= device->leds.size())
+		return nullptr;
+
+	return &device->leds[ id.ledIdx ];
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
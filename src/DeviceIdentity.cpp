@@ -0,0 +1,181 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: identification of the same physical device across device list updates
+//======================================================================================================================
+
+#include "DeviceIdentity.hpp"
+
+#include "OpenRGB/DeviceInfo.hpp"
+#include "ProtocolCommon.hpp"
+#include "RawWalker.hpp"
+#include "MiscUtils.hpp"  // hashBytes
+#include "BinaryStream.hpp"
+using own::BinaryInputStream;
+
+#include <string>
+using std::string;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+static string makeKey( const string & serial, const string & location, const string & name )
+{
+	string key;
+	key.reserve( serial.size() + location.size() + name.size() + 2 );
+	// the strings can't contain '\0', because the protocol uses it as terminator
+	key += serial;
+	key += '\0';
+	key += location;
+	key += '\0';
+	key += name;
+	return key;
+}
+
+// The key starts with the serial and the location, followed by the name.
+static string placeKey( const string & key )
+{
+	size_t locationEnd = key.find( '\0', key.find( '\0' ) + 1 );
+	return key.substr( 0, locationEnd );
+}
+
+string identityKey( const Device & device )
+{
+	return makeKey( device.serial, device.location, device.name );
+}
+
+bool identityKey( const std::vector< uint8_t > & replyBody, string & key )
+{
+	// This must be kept in sync with Device::deserialize().
+	BinaryInputStream stream( replyBody );
+	uint32_t data_size, type;
+	string name, vendor, description, version, serial, location;
+	stream >> data_size;
+	stream >> type;
+	protocol::readString( stream, name );
+	protocol::readString( stream, vendor );
+	protocol::readString( stream, description );
+	protocol::readString( stream, version );
+	protocol::readString( stream, serial );
+	protocol::readString( stream, location );
+	if (stream.failed())
+		return false;
+
+	key = makeKey( serial, location, name );
+	return true;
+}
+
+bool descriptionHash( const std::vector< uint8_t > & replyBody, uint32_t protocolVersion, uint64_t & hash )
+{
+	// This must be kept in sync with Device::deserialize() and the deserialize methods of its sub-objects.
+	RawWalker walker( replyBody, 0 );
+	walker.u32();  // data_size
+
+	const size_t descriptionStart = walker.pos();
+	walker.u32();  // type
+	for (int i = 0; i < 6; ++i)  // name, vendor, description, version, serial, location
+		walker.skipString();
+	uint16_t num_modes = walker.u16();
+	const size_t activeModePos = walker.pos();
+	walker.u32();
+	for (uint16_t modeIdx = 0; modeIdx < num_modes; ++modeIdx)
+	{
+		walker.skipString();
+		walker.skip( protocolVersion >= 3 ? 12 * 4 : 9 * 4 );
+		uint16_t num_colors = walker.u16();
+		walker.skip( size_t( num_colors ) * 4 );
+	}
+	uint16_t num_zones = walker.u16();
+	for (uint16_t zoneIdx = 0; zoneIdx < num_zones; ++zoneIdx)
+	{
+		walker.skipString();
+		walker.skip( 4 * 4 );  // type, leds_min, leds_max, leds_count
+		uint16_t matrix_length = walker.u16();
+		if (matrix_length > 0)
+		{
+			uint32_t matrix_height = walker.u32();
+			uint32_t matrix_width = walker.u32();
+			walker.skip( size_t( matrix_height ) * matrix_width * 4 );
+		}
+	}
+	uint16_t num_leds = walker.u16();
+	for (uint16_t ledIdx = 0; ledIdx < num_leds; ++ledIdx)
+	{
+		walker.skipString();
+		walker.skip( 4 );  // value
+	}
+	const size_t colorsPos = walker.pos();
+	uint16_t num_colors = walker.u16();
+	walker.skip( size_t( num_colors ) * 4 );
+	if (walker.failed())
+		return false;
+
+	// everything except the active mode and the colors at the end
+	const uint8_t * data = replyBody.data();
+	hash = hashBytes( data + descriptionStart, activeModePos - descriptionStart );
+	hash = hashBytes( data + activeModePos + 4, colorsPos - (activeModePos + 4), hash );
+	return true;
+}
+
+
+//======================================================================================================================
+//  DeviceMatcher
+
+constexpr uint32_t DeviceMatcher::noMatch;
+
+DeviceMatcher::DeviceMatcher( const DeviceList & oldList )
+{
+	// in case there are more devices of the same identity, keep their order
+	_exactIndexes.reserve( oldList.size() );
+	for (uint32_t oldIdx = 0; oldIdx < oldList.size(); ++oldIdx)
+	{
+		string key = identityKey( oldList[ oldIdx ] );
+		string place = placeKey( key );
+		if (place.size() > 1)  // not just the separator of empty serial and location
+			_placeIndexes[ place ].push_back( oldIdx );
+		_exactIndexes[ move( key ) ].push_back( oldIdx );
+	}
+	_isMatched.resize( oldList.size(), false );
+}
+
+void DeviceMatcher::reset()
+{
+	_isMatched.assign( _isMatched.size(), false );
+}
+
+uint32_t DeviceMatcher::matchFirstFree( const std::unordered_map< string, std::vector< uint32_t > > & indexes, const string & key )
+{
+	auto iter = indexes.find( key );
+	if (iter == indexes.end())
+		return noMatch;
+
+	for (uint32_t candidateIdx : iter->second)
+	{
+		if (!_isMatched[ candidateIdx ])
+		{
+			_isMatched[ candidateIdx ] = true;
+			return candidateIdx;
+		}
+	}
+	return noMatch;
+}
+
+uint32_t DeviceMatcher::matchExactly( const string & key )
+{
+	return matchFirstFree( _exactIndexes, key );
+}
+
+uint32_t DeviceMatcher::matchRenamed( const string & key )
+{
+	return matchFirstFree( _placeIndexes, placeKey( key ) );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
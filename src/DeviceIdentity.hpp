@@ -0,0 +1,95 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: identification of the same physical device across device list updates
+//======================================================================================================================
+
+#ifndef OPENRGB_DEVICE_IDENTITY_INCLUDED
+#define OPENRGB_DEVICE_IDENTITY_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+namespace orgb {
+
+
+class Device;
+class DeviceList;
+
+
+//======================================================================================================================
+// The index of a device changes when other devices are added or removed before it, so the device is identified
+// by its serial, location and name instead. None of them is unique on its own, serial is often empty
+// and two identical devices share the name, but the location is different for every connected device.
+
+/// Builds a key identifying a device, usable in hash maps.
+std::string identityKey( const Device & device );
+
+/// Builds the identity key directly from the raw body of ReplyControllerData without parsing the whole device.
+/** \returns false when the data are malformed. */
+bool identityKey( const std::vector< uint8_t > & replyBody, std::string & key );
+
+/// Hashes the description of a device in the raw body of ReplyControllerData, without the active mode and the colors.
+/** The current state of a device changes whenever someone sets its colors or mode, the rest only when the device
+  * itself changes, for example when its zone is resized or a firmware update adds modes.
+  * \returns false when the data are malformed. */
+bool descriptionHash( const std::vector< uint8_t > & replyBody, uint32_t protocolVersion, uint64_t & hash );
+
+
+//======================================================================================================================
+/// Pairs the devices of a new version of the device list with the devices of the old version.
+/** The new devices are first matched by the whole identity key, in their order, each to the first old device of the same
+  * key that hasn't been matched yet. When all the new devices have been through that, the ones that are still unmatched
+  * can be matched by only their serial and location, which pairs a device that has been renamed with its old version.
+  * That needs at least one of the two to be non-empty, otherwise any two devices would be taken for the same one. */
+
+class DeviceMatcher
+{
+
+ public:
+
+	static constexpr uint32_t noMatch = UINT32_MAX;
+
+	explicit DeviceMatcher( const DeviceList & oldList );
+
+	/// Forgets all the matches, so that a new list can be matched from the start.
+	void reset();
+
+	/// Finds the first unmatched old device of the same identity key and marks it as matched.
+	/** \returns index of the old device or noMatch */
+	uint32_t matchExactly( const std::string & key );
+
+	/// Finds the first unmatched old device of the same serial and location and marks it as matched.
+	/** Call this only after matchExactly() has been called for all the new devices.
+	  * \returns index of the old device or noMatch */
+	uint32_t matchRenamed( const std::string & key );
+
+	/// Whether an old device has been matched by any of the new devices.
+	bool isMatched( uint32_t oldIdx ) const  { return _isMatched[ oldIdx ]; }
+
+	size_t oldCount() const  { return _isMatched.size(); }
+
+ private:
+
+	uint32_t matchFirstFree( const std::unordered_map< std::string, std::vector< uint32_t > > & indexes, const std::string & key );
+
+	std::unordered_map< std::string, std::vector< uint32_t > > _exactIndexes;  ///< identity key -> old indexes in order
+	std::unordered_map< std::string, std::vector< uint32_t > > _placeIndexes;  ///< serial and location -> old indexes
+	std::vector< bool > _isMatched;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_DEVICE_IDENTITY_INCLUDED
@@ -16,11 +16,16 @@ using own::BinaryInputStream;
 #include "LangUtils.hpp"
 using own::unconst;
 #include "MiscUtils.hpp"
+#include "DeviceIdentity.hpp"
 
 #include <string>
 using std::string;
 #include <sstream>
 using std::ostringstream;  // flags to string
+#include <unordered_map>
+using std::unordered_map;
+#include <memory>  // atomic_load, atomic_compare_exchange_strong
+#include <new>     // bad_alloc
 
 
 namespace orgb {
@@ -147,58 +152,6 @@ const char * enumString( ZoneType type ) noexcept
 }
 
 
-//======================================================================================================================
-//  enum validation
-
-/*static bool isValidDeviceType( DeviceType type )
-{
-	return size_t( type ) <= size_t( DeviceType::Unknown );
-}*/
-
-static bool isValidDirection( Direction dir, uint32_t modeFlags )
-{
-	bool allowedDirections [ size_t( Direction::Vertical ) + 1 ] = {0};
-	bool hasAnyDirections = false;
-
-	if (modeFlags & ModeFlags::HasDirectionLR)
-	{
-		hasAnyDirections = true;
-		allowedDirections[ size_t( Direction::Left ) ] = true;
-		allowedDirections[ size_t( Direction::Right ) ] = true;
-	}
-	if (modeFlags & ModeFlags::HasDirectionUD)
-	{
-		hasAnyDirections = true;
-		allowedDirections[ size_t( Direction::Up ) ] = true;
-		allowedDirections[ size_t( Direction::Down ) ] = true;
-	}
-	if (modeFlags & ModeFlags::HasDirectionHV)
-	{
-		hasAnyDirections = true;
-		allowedDirections[ size_t( Direction::Horizontal ) ] = true;
-		allowedDirections[ size_t( Direction::Vertical ) ] = true;
-	}
-
-	// in case no direction flag is active, direction will be uninitialized value, so it can be anything
-	if (!hasAnyDirections)
-	{
-		return true;
-	}
-
-	return allowedDirections[ size_t( dir ) ] == true;
-}
-
-static bool isValidColorMode( ColorMode mode )
-{
-	return size_t( mode ) <= size_t( ColorMode::Random );
-}
-
-static bool isValidZoneType( ZoneType type )
-{
-	return size_t( type ) <= size_t( ZoneType::Matrix );
-}
-
-
 //======================================================================================================================
 //  LED
 
@@ -241,14 +194,25 @@ bool LED::deserialize( BinaryInputStream & stream, uint32_t /*protocolVersion*/,
 	return !stream.failed();
 }
 
+// the name is given separately, because with DeviceListOptions::lazyLedNames it's stored in the device
+static void printLED( const LED & led, StringView name, unsigned int indentLevel )
+{
+	indent( indentLevel ); printf( "[%u] = { name = \"%.*s\"; value = %u },\n", led.idx, int( name.size() ), name.data(), led.value );
+}
+
+static void printLED( std::ostream & os, const LED & led, StringView name, unsigned int indentLevel )
+{
+	indent( os, indentLevel ); os << "["<<led.idx<<"] = { name = \""<<name<<"\"; value = "<<led.value<<" },\n";
+}
+
 void print( const LED & led, unsigned int indentLevel )
 {
-	indent( indentLevel ); printf( "[%u] = { name = \"%s\"; value = %u },\n", led.idx, led.name.c_str(), led.value );
+	printLED( led, led.name, indentLevel );
 }
 
 void print( std::ostream & os, const LED & led, unsigned int indentLevel )
 {
-	indent( os, indentLevel ); os << "["<<led.idx<<"] = { name = \""<<led.name<<"\"; value = "<<led.value<<" },\n";
+	printLED( os, led, led.name, indentLevel );
 }
 
 
@@ -266,9 +230,13 @@ Zone::Zone()
 	leds_count(),
 	matrix_height(),
 	matrix_width(),
-	matrix_values()
+	matrix_values(),
+	startIdx(),
+	matrix_leds()
 {}
 
+constexpr uint32_t Zone::noLED;
+
 size_t Zone::calcSize( uint32_t /*protocolVersion*/ ) const noexcept
 {
 	size_t size = 0;
@@ -343,6 +311,12 @@ bool Zone::deserialize( BinaryInputStream & stream, uint32_t /*protocolVersion*/
 			stream >> unconst( matrix_values )[i];
 		}
 	}
+	else  // the object may be re-used from a previous device list
+	{
+		unconst( matrix_height ) = 0;
+		unconst( matrix_width ) = 0;
+		unconst( matrix_values ).clear();
+	}
 
 	if (!isValidZoneType( type ))
 		stream.setFailed();
@@ -471,6 +445,11 @@ bool Mode::deserialize( BinaryInputStream & stream, uint32_t protocolVersion, ui
 		stream >> unconst( brightness_min );
 		stream >> unconst( brightness_max );
 	}
+	else  // the object may be re-used from a previous device list
+	{
+		unconst( brightness_min ) = 0;
+		unconst( brightness_max ) = 0;
+	}
 	stream >> unconst( colors_min );
 	stream >> unconst( colors_max );
 	stream >> speed;
@@ -478,6 +457,10 @@ bool Mode::deserialize( BinaryInputStream & stream, uint32_t protocolVersion, ui
 	{
 		stream >> unconst( brightness );
 	}
+	else
+	{
+		brightness = 0;
+	}
 	stream >> direction;
 	stream >> unconst( color_mode );
 	protocol::readArray( stream, colors );
@@ -544,6 +527,13 @@ void print( std::ostream & os, const Mode & mode, unsigned int indentLevel )
 //======================================================================================================================
 //  Device
 
+/// Names of all LEDs of a device stored in a single buffer, see DeviceListOptions::lazyLedNames.
+struct LedNames
+{
+	std::vector< char > chars;        ///< all names one after another, without any terminators
+	std::vector< uint32_t > offsets;  ///< start of every name in #chars plus the end of the last one
+};
+
 Device::Device()
 :
 	idx(),
@@ -558,7 +548,11 @@ Device::Device()
 	modes(),
 	zones(),
 	leds(),
-	colors()
+	colors(),
+	_contentHash( 0 ),
+	_descriptionHash( 0 ),
+	_index(),
+	_ledNames()
 {}
 
 size_t Device::calcSize( uint32_t protocolVersion ) const noexcept
@@ -576,7 +570,10 @@ size_t Device::calcSize( uint32_t protocolVersion ) const noexcept
 	size += sizeof( active_mode );
 	size += protocol::sizeofArray( modes, protocolVersion );
 	size += protocol::sizeofArray( zones, protocolVersion );
-	size += protocol::sizeofArray( leds, protocolVersion );
+	if (_ledNames)
+		size += 2 + _ledNames->chars.size() + leds.size() * (2 + 1 + sizeof( uint32_t ));  // name size, '\0', value
+	else
+		size += protocol::sizeofArray( leds, protocolVersion );
 	size += protocol::sizeofArray( colors );
 
 	return size;
@@ -599,17 +596,32 @@ void Device::serialize( BinaryOutputStream & stream, uint32_t protocolVersion )
 		mode.serialize( stream, protocolVersion );
 	}
 	protocol::writeArray( stream, zones, protocolVersion );
-	protocol::writeArray( stream, leds, protocolVersion );
+	if (_ledNames)
+	{
+		stream << uint16_t( leds.size() );
+		for (const LED & led : leds)
+		{
+			protocol::writeString( stream, ledName( led.idx ).str() );
+			stream << led.value;
+		}
+	}
+	else
+	{
+		protocol::writeArray( stream, leds, protocolVersion );
+	}
 	protocol::writeArray( stream, colors );
 }
 
-bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion, uint32_t deviceIdx ) noexcept
+bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion, uint32_t deviceIdx, const DeviceListOptions & options ) noexcept
 {
 	// This hack with const casts allows us to restrict the user from changing attributes that are a static description
 	// and allow him to change only the parameters that are meant to be changed.
 
 	// fill in our metadata
 	unconst( idx ) = deviceIdx;
+	_contentHash = 0;
+	_descriptionHash = 0;
+	_index.reset();
 
 	stream >> unconst( type );
 	protocol::readString( stream, unconst( name ) );
@@ -622,18 +634,55 @@ bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion,
 	uint16_t num_modes;
 	stream >> num_modes;  // the size is not directly before the array, so it must be read manually
 	stream >> unconst( active_mode );
+	// like in protocol::readArray(), re-use the modes that are already there
+	while (modes.size() > num_modes)
+		unconst( modes ).pop_back();
 	unconst( modes ).reserve( num_modes );
 	for (uint32_t modeIdx = 0; modeIdx < num_modes; ++modeIdx)
 	{
-		Mode mode;
-		if (!mode.deserialize( stream, protocolVersion, modeIdx, deviceIdx ))
-			return false;
-		unconst( modes ).emplace_back( move(mode) );
+		if (modeIdx < modes.size())
+		{
+			if (!unconst( modes[ modeIdx ] ).deserialize( stream, protocolVersion, modeIdx, deviceIdx ))
+				return false;
+		}
+		else
+		{
+			Mode mode;
+			if (!mode.deserialize( stream, protocolVersion, modeIdx, deviceIdx ))
+				return false;
+			unconst( modes ).emplace_back( move(mode) );
+		}
 	}
 	protocol::readArray( stream, unconst( zones ), protocolVersion, deviceIdx );
-	protocol::readArray( stream, unconst( leds ), protocolVersion, deviceIdx );
+	if (options.lazyLedNames)
+	{
+		if (!deserializeLazyLeds( stream, deviceIdx ))
+			return false;
+	}
+	else
+	{
+		_ledNames.reset();
+		protocol::readArray( stream, unconst( leds ), protocolVersion, deviceIdx );
+	}
 	protocol::readArray( stream, unconst( colors ) );
 
+	// the zones don't know about each other, so their positions among the device's LEDs must be calculated here
+	uint32_t zoneStartIdx = 0;
+	for (const Zone & zone : zones)
+	{
+		unconst( zone.startIdx ) = zoneStartIdx;
+		unconst( zone.matrix_leds ).resize( zone.matrix_values.size() );
+		for (size_t i = 0; i < zone.matrix_values.size(); ++i)
+		{
+			uint32_t ledIdx = zone.matrix_values[i];
+			// don't trust the server, an invalid index would make the applications write out of bounds
+			bool isValid = ledIdx < zone.leds_count && size_t( zoneStartIdx ) + ledIdx < leds.size();
+			unconst( zone.matrix_leds )[i] = isValid ? zoneStartIdx + ledIdx : Zone::noLED;
+		}
+		// saturate, so that the zones after a bogus huge one don't wrap around to the start of the device
+		zoneStartIdx = zone.leds_count < UINT32_MAX - zoneStartIdx ? zoneStartIdx + zone.leds_count : UINT32_MAX;
+	}
+
 	// Let's tolerate invalid device classes in case the server adds some without increasing protocol version
 	//if (!isValidDeviceType( type ))
 	//	stream.setFailed();
@@ -641,6 +690,80 @@ bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion,
 	return !stream.failed();
 }
 
+void Device::hashReply( const std::vector< uint8_t > & replyBody, uint32_t protocolVersion ) noexcept
+{
+	_contentHash = hashBytes( replyBody.data(), replyBody.size() );
+	if (!descriptionHash( replyBody, protocolVersion, _descriptionHash ))
+		_descriptionHash = 0;
+}
+
+// This must be kept in sync with LED::deserialize().
+bool Device::deserializeLazyLeds( BinaryInputStream & stream, uint32_t deviceIdx ) noexcept
+{
+	// the copies of this device may still be reading the current names
+	if (!_ledNames || _ledNames.use_count() != 1)
+		_ledNames = std::make_shared< LedNames >();
+	LedNames & ledNames = *_ledNames;
+	ledNames.chars.clear();
+	ledNames.offsets.clear();
+
+	uint16_t num_leds = 0;
+	stream >> num_leds;
+	ledNames.offsets.reserve( num_leds + 1 );
+	// like in protocol::readArray(), re-use the LEDs that are already there
+	while (leds.size() > num_leds)
+		unconst( leds ).pop_back();
+	unconst( leds ).reserve( num_leds );
+
+	string nameBuffer;  // allocates once per device instead of once per LED
+	for (uint32_t ledIdx = 0; ledIdx < num_leds; ++ledIdx)
+	{
+		if (ledIdx == leds.size())
+			unconst( leds ).emplace_back( LED() );
+		const LED & led = leds[ ledIdx ];
+
+		unconst( led.idx ) = ledIdx;
+		unconst( led.parentIdx ) = deviceIdx;
+		unconst( led.name ).clear();
+
+		protocol::readString( stream, nameBuffer );
+		stream >> unconst( led.value );
+		if (stream.failed())
+			return false;
+
+		ledNames.offsets.push_back( uint32_t( ledNames.chars.size() ) );
+		ledNames.chars.insert( ledNames.chars.end(), nameBuffer.begin(), nameBuffer.end() );
+	}
+	ledNames.offsets.push_back( uint32_t( ledNames.chars.size() ) );
+
+	return !stream.failed();
+}
+
+StringView Device::ledName( uint32_t ledIdx ) const noexcept
+{
+	if (_ledNames)
+	{
+		uint32_t begin = _ledNames->offsets[ ledIdx ];
+		uint32_t end = _ledNames->offsets[ ledIdx + 1 ];
+		return StringView( _ledNames->chars.data() + begin, end - begin );
+	}
+	else
+	{
+		return StringView( leds[ ledIdx ].name );
+	}
+}
+
+void Device::setIdx( uint32_t deviceIdx ) noexcept
+{
+	unconst( idx ) = deviceIdx;
+	for (const Mode & mode : modes)
+		unconst( mode.parentIdx ) = deviceIdx;
+	for (const Zone & zone : zones)
+		unconst( zone.parentIdx ) = deviceIdx;
+	for (const LED & led : leds)
+		unconst( led.parentIdx ) = deviceIdx;
+}
+
 void print( const Device & device, unsigned int indentLevel )
 {
 	indent( indentLevel ); printf( "[%u] = {\n", device.idx );
@@ -667,7 +790,7 @@ void print( const Device & device, unsigned int indentLevel )
 	indent( indentLevel + 1 ); printf( "leds = {\n" );
 	for (const LED & led : device.leds)
 	{
-		print( led, indentLevel + 2 );
+		printLED( led, device.ledName( led.idx ), indentLevel + 2 );
 	}
 	indent( indentLevel + 1 ); printf( "};\n" );
 	indent( indentLevel + 1 ); printf( "colors = {\n" );
@@ -705,7 +828,7 @@ void print( std::ostream & os, const Device & device, unsigned int indentLevel )
 	indent( os, indentLevel + 1 ); os << "leds = {\n";
 	for (const LED & led : device.leds)
 	{
-		print( os, led, indentLevel + 2 );
+		printLED( os, led, device.ledName( led.idx ), indentLevel + 2 );
 	}
 	indent( os, indentLevel + 1 ); os << "};\n";
 	indent( os, indentLevel + 1 ); os << "colors = {\n";
@@ -718,6 +841,385 @@ void print( std::ostream & os, const Device & device, unsigned int indentLevel )
 }
 
 
+//======================================================================================================================
+//  search
+
+/// Search index of a single device.
+/** The maps contain only the first object of each name, so that the search results stay the same as when iterating
+  * through the vectors. Indexes are stored instead of pointers, so that the index is valid for any copy of the device. */
+struct DeviceIndex
+{
+	unordered_map< string, uint32_t > modes;
+	unordered_map< string, uint32_t > zones;
+	unordered_map< string, uint32_t > leds;
+};
+
+template< typename Object >
+static void indexByName( unordered_map< string, uint32_t > & map, const std::vector< Object > & objects )
+{
+	map.reserve( objects.size() );
+	for (uint32_t i = 0; i < objects.size(); ++i)
+		map.emplace( objects[i].name, i );  // does nothing if the name is already there
+}
+
+template< typename Object >
+static const Object * findByName(
+	const unordered_map< string, uint32_t > * map, const std::vector< Object > & objects, const string & name
+) noexcept {
+	if (!map)  // the index could not be built, search the slow way
+	{
+		for (const Object & object : objects)
+			if (object.name == name)
+				return &object;
+		return nullptr;
+	}
+	auto iter = map->find( name );
+	return iter != map->end() ? &objects[ iter->second ] : nullptr;
+}
+
+std::shared_ptr< const DeviceIndex > Device::buildIndex() const
+{
+	std::shared_ptr< DeviceIndex > newIndex = std::make_shared< DeviceIndex >();
+	indexByName( newIndex->modes, modes );
+	indexByName( newIndex->zones, zones );
+	if (_ledNames)
+	{
+		newIndex->leds.reserve( leds.size() );
+		for (uint32_t i = 0; i < leds.size(); ++i)
+			newIndex->leds.emplace( ledName( i ).str(), i );
+	}
+	else
+	{
+		indexByName( newIndex->leds, leds );
+	}
+	return newIndex;
+}
+
+// Threads searching at the same time may each build their own index. Only the first one gets published and the others
+// are dropped in favour of it, so that whatever a search returns points into the index that stays.
+template< typename Index >
+static std::shared_ptr< const Index > publishIndex(
+	std::shared_ptr< const Index > & published, std::shared_ptr< const Index > newIndex
+) noexcept {
+	std::shared_ptr< const Index > expected;
+	if (std::atomic_compare_exchange_strong( &published, &expected, newIndex ))
+		return newIndex;
+	return expected;
+}
+
+std::shared_ptr< const DeviceIndex > Device::index() const noexcept
+{
+	std::shared_ptr< const DeviceIndex > current = std::atomic_load( &_index );
+	if (!current)
+	{
+		try
+		{
+			current = buildIndex();
+		}
+		catch (const std::bad_alloc &)
+		{
+			return nullptr;
+		}
+		current = publishIndex( _index, std::move( current ) );
+	}
+	return current;
+}
+
+const Mode * Device::findMode( const std::string & name ) const noexcept
+{
+	std::shared_ptr< const DeviceIndex > index = this->index();
+	return findByName( index ? &index->modes : nullptr, modes, name );
+}
+
+const Zone * Device::findZone( const std::string & name ) const noexcept
+{
+	std::shared_ptr< const DeviceIndex > index = this->index();
+	return findByName( index ? &index->zones : nullptr, zones, name );
+}
+
+const LED * Device::findLED( const std::string & name ) const noexcept
+{
+	std::shared_ptr< const DeviceIndex > index = this->index();
+	if (!index && _ledNames)
+	{
+		for (uint32_t i = 0; i < leds.size(); ++i)
+			if (ledName( i ) == StringView( name ))
+				return &leds[i];
+		return nullptr;
+	}
+	return findByName( index ? &index->leds : nullptr, leds, name );
+}
+
+#ifndef NO_EXCEPTIONS
+
+const Mode & Device::findModeX( const std::string & name ) const
+{
+	if (const Mode * mode = findMode( name ))
+		return *mode;
+	throw NotFound( "Mode of such name was not found" );
+}
+
+const Zone & Device::findZoneX( const std::string & name ) const
+{
+	if (const Zone * zone = findZone( name ))
+		return *zone;
+	throw NotFound( "Zone of such name was not found" );
+}
+
+const LED & Device::findLEDX( const std::string & name ) const
+{
+	if (const LED * led = findLED( name ))
+		return *led;
+	throw NotFound( "LED of such name was not found" );
+}
+
+#endif // NO_EXCEPTIONS
+
+/// Search index of the device list.
+/** Like in DeviceIndex, the name map contains only the first device of each name and the per-type and per-vendor
+  * lists keep the devices in the original order. */
+struct DeviceListIndex
+{
+	unordered_map< string, uint32_t > byName;
+	unordered_map< uint32_t, std::vector< uint32_t > > byType;  // std::hash of enums is not guaranteed before C++14
+	unordered_map< string, std::vector< uint32_t > > byVendor;
+};
+
+std::shared_ptr< const DeviceListIndex > DeviceList::indexX() const
+{
+	std::shared_ptr< const DeviceListIndex > current = std::atomic_load( &_index );
+	if (!current)
+	{
+		std::shared_ptr< DeviceListIndex > newIndex = std::make_shared< DeviceListIndex >();
+		newIndex->byName.reserve( _list.size() );
+		for (uint32_t i = 0; i < _list.size(); ++i)
+		{
+			const Device & device = *_list[i];
+			newIndex->byName.emplace( device.name, i );
+			newIndex->byType[ uint32_t( device.type ) ].push_back( i );
+			newIndex->byVendor[ device.vendor ].push_back( i );
+		}
+		current = publishIndex( _index, std::shared_ptr< const DeviceListIndex >( std::move( newIndex ) ) );
+	}
+	return current;
+}
+
+std::shared_ptr< const DeviceListIndex > DeviceList::index() const noexcept
+{
+	try
+	{
+		return indexX();
+	}
+	catch (const std::bad_alloc &)
+	{
+		return nullptr;
+	}
+}
+
+void DeviceList::buildIndexes() const
+{
+	indexX();
+	for (const Device & device : *this)
+		if (!std::atomic_load( &device._index ))
+			publishIndex( device._index, device.buildIndex() );
+}
+
+// The returned pointers share the ownership of the whole index, so the vectors stay alive even when the index
+// is reset or replaced while the caller is still iterating.
+std::shared_ptr< const std::vector< uint32_t > > DeviceList::devicesOfType( DeviceType deviceType ) const
+{
+	std::shared_ptr< const DeviceListIndex > index = indexX();
+	auto iter = index->byType.find( uint32_t( deviceType ) );
+	if (iter == index->byType.end())
+		return nullptr;
+	return std::shared_ptr< const std::vector< uint32_t > >( std::move( index ), &iter->second );
+}
+
+std::shared_ptr< const std::vector< uint32_t > > DeviceList::devicesOfVendor( const std::string & vendor ) const
+{
+	std::shared_ptr< const DeviceListIndex > index = indexX();
+	auto iter = index->byVendor.find( vendor );
+	if (iter == index->byVendor.end())
+		return nullptr;
+	return std::shared_ptr< const std::vector< uint32_t > >( std::move( index ), &iter->second );
+}
+
+// devices of the first type are usually at the start of the list, so this doesn't need an index
+const Device * DeviceList::find( DeviceType deviceType ) const noexcept
+{
+	for (const std::unique_ptr< Device > & device : _list)
+		if (device->type == deviceType)
+			return device.get();
+	return nullptr;
+}
+
+const Device * DeviceList::find( const std::string & deviceName ) const noexcept
+{
+	std::shared_ptr< const DeviceListIndex > index = this->index();
+	if (!index)
+	{
+		for (const std::unique_ptr< Device > & device : _list)
+			if (device->name == deviceName)
+				return device.get();
+		return nullptr;
+	}
+	auto iter = index->byName.find( deviceName );
+	return iter != index->byName.end() ? _list[ iter->second ].get() : nullptr;
+}
+
+#ifndef NO_EXCEPTIONS
+
+const Device & DeviceList::findX( DeviceType deviceType ) const
+{
+	if (const Device * device = find( deviceType ))
+		return *device;
+	throw NotFound( "Device of such type was not found" );
+}
+
+const Device & DeviceList::findX( const std::string & deviceName ) const
+{
+	if (const Device * device = find( deviceName ))
+		return *device;
+	throw NotFound( "Device of such name was not found" );
+}
+
+#endif // NO_EXCEPTIONS
+
+
+//======================================================================================================================
+//  memory usage
+
+MemoryUsage::Breakdown & MemoryUsage::Breakdown::operator+=( const Breakdown & other ) noexcept
+{
+	objects += other.objects;
+	strings += other.strings;
+	vectors += other.vectors;
+	return *this;
+}
+
+MemoryUsage & MemoryUsage::operator+=( const MemoryUsage & other ) noexcept
+{
+	devices += other.devices;
+	modes += other.modes;
+	zones += other.zones;
+	leds += other.leds;
+	deviceCount += other.deviceCount;
+	modeCount += other.modeCount;
+	zoneCount += other.zoneCount;
+	ledCount += other.ledCount;
+	return *this;
+}
+
+static size_t heapSize( const string & str ) noexcept
+{
+	// short strings are stored inside the string object itself
+	uintptr_t data = reinterpret_cast< uintptr_t >( str.data() );
+	uintptr_t object = reinterpret_cast< uintptr_t >( &str );
+	if (data >= object && data < object + sizeof( str ))
+		return 0;
+	return str.capacity() + 1;
+}
+
+template< typename Type >
+static size_t heapSize( const std::vector< Type > & vec ) noexcept
+{
+	return vec.capacity() * sizeof( Type );
+}
+
+template< typename Type, size_t N >
+static size_t heapSize( const SmallVector< Type, N > & vec ) noexcept
+{
+	return vec.isInline() ? 0 : vec.capacity() * sizeof( Type );
+}
+
+MemoryUsage Device::memoryUsage() const noexcept
+{
+	MemoryUsage usage;
+	usage.deviceCount = 1;
+	usage.modeCount = modes.size();
+	usage.zoneCount = zones.size();
+	usage.ledCount = leds.size();
+
+	usage.devices.objects = sizeof( Device );
+	usage.devices.strings = heapSize( name ) + heapSize( vendor ) + heapSize( description )
+	                      + heapSize( version ) + heapSize( serial ) + heapSize( location );
+	usage.devices.vectors = heapSize( colors );
+
+	usage.modes.objects = heapSize( modes );
+	for (const Mode & mode : modes)
+	{
+		usage.modes.strings += heapSize( mode.name );
+		usage.modes.vectors += heapSize( mode.colors );
+	}
+
+	usage.zones.objects = heapSize( zones );
+	for (const Zone & zone : zones)
+	{
+		usage.zones.strings += heapSize( zone.name );
+		usage.zones.vectors += heapSize( zone.matrix_values ) + heapSize( zone.matrix_leds );
+	}
+
+	usage.leds.objects = heapSize( leds );
+	for (const LED & led : leds)
+	{
+		usage.leds.strings += heapSize( led.name );
+	}
+	if (_ledNames)
+	{
+		usage.leds.strings += sizeof( LedNames ) + heapSize( _ledNames->chars ) + heapSize( _ledNames->offsets );
+	}
+
+	return usage;
+}
+
+MemoryUsage memoryUsage( const DeviceList & devices ) noexcept
+{
+	MemoryUsage usage;
+	usage.devices.objects = heapSize( devices._list );  // the pointers
+	for (const Device & device : devices)
+	{
+		usage += device.memoryUsage();
+	}
+	return usage;
+}
+
+static void print( const char * name, size_t count, const MemoryUsage::Breakdown & usage, unsigned int indentLevel )
+{
+	indent( indentLevel ); printf(
+		"%s = { count = %zu; objects = %zu; strings = %zu; vectors = %zu; total = %zu },\n",
+		name, count, usage.objects, usage.strings, usage.vectors, usage.total()
+	);
+}
+
+static void print( std::ostream & os, const char * name, size_t count, const MemoryUsage::Breakdown & usage, unsigned int indentLevel )
+{
+	indent( os, indentLevel ); os << name<<" = { count = "<<count<<"; objects = "<<usage.objects<<"; strings = "<<usage.strings
+	                                   <<"; vectors = "<<usage.vectors<<"; total = "<<usage.total()<<" },\n";
+}
+
+void print( const MemoryUsage & usage, unsigned int indentLevel )
+{
+	indent( indentLevel ); printf( "memory usage = {\n" );
+	print( "devices", usage.deviceCount, usage.devices, indentLevel + 1 );
+	print( "modes", usage.modeCount, usage.modes, indentLevel + 1 );
+	print( "zones", usage.zoneCount, usage.zones, indentLevel + 1 );
+	print( "leds", usage.ledCount, usage.leds, indentLevel + 1 );
+	indent( indentLevel + 1 ); printf( "total = %zu;\n", usage.total() );
+	indent( indentLevel ); printf( "},\n" );
+}
+
+void print( std::ostream & os, const MemoryUsage & usage, unsigned int indentLevel )
+{
+	indent( os, indentLevel ); os << "memory usage = {\n";
+	print( os, "devices", usage.deviceCount, usage.devices, indentLevel + 1 );
+	print( os, "modes", usage.modeCount, usage.modes, indentLevel + 1 );
+	print( os, "zones", usage.zoneCount, usage.zones, indentLevel + 1 );
+	print( os, "leds", usage.ledCount, usage.leds, indentLevel + 1 );
+	indent( os, indentLevel + 1 ); os << "total = "<<usage.total()<<";\n";
+	indent( os, indentLevel ); os << "},\n";
+}
+
+
 //======================================================================================================================
 
 
@@ -0,0 +1,564 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: persistent on-disk cache of a device list
+//======================================================================================================================
+
+#include "OpenRGB/DeviceListCache.hpp"
+
+#include "Essential.hpp"
+
+#include "ProtocolCommon.hpp"
+#include "ProtocolMessages.hpp"  // implementedProtocolVersion
+#include "MiscUtils.hpp"
+#include "LangUtils.hpp"
+#include "MappedFile.hpp"
+#include "RawWalker.hpp"  // readU16
+#include "BinaryStream.hpp"
+using own::BinaryOutputStream;
+using own::BinaryInputStream;
+#include "ContainerUtils.hpp"
+using own::span;
+
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <memory>
+using std::unique_ptr;
+#include <cstdio>
+#include <cstdlib>  // getenv
+#include <cctype>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <io.h>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+#else
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  file format
+//
+//  All numbers are little endian, strings are in the protocol format (uint16 size, characters, '\0').
+//
+//  header:
+//      char[4]   magic "ORGC"
+//      uint32    version of this format
+//      uint32    protocol version the devices are serialized with
+//      string    endpoint of the server
+//      uint32    number of devices
+//  for every device:
+//      uint32    offset of the device data from the start of the file
+//      uint32    size of the device data
+//      uint64    fingerprint of the original server reply, see Device::_contentHash
+//      uint64    fingerprint of its description, see Device::_descriptionHash
+//      uint64    DeviceListCache::fingerprint() of the device
+//      uint64    checksum of the device data
+//  for every device:
+//      device data as in the body of ReplyControllerData without the data_size
+
+static const char cacheMagic [4] = { 'O', 'R', 'G', 'C' };
+static constexpr uint32_t cacheFormatVersion = 3;
+static constexpr size_t deviceEntrySize = 4 + 4 + 8 + 8 + 8 + 8;
+
+const char * enumString( CacheStatus status ) noexcept
+{
+	static const char * const CacheStatusStr [] =
+	{
+		"The operation was successful.",
+		"The cache file does not exist yet.",
+		"The cache file is corrupted or was written by an incompatible version of this library.",
+		"The cache file belongs to a different server or the number of devices has changed since.",
+		"The cache file is not a regular file owned by the current user, or other users can write into it.",
+		"The cache file could not be opened, read or written.",
+	};
+	static_assert( size_t(CacheStatus::SystemError) + 1 == fut::size(CacheStatusStr), "update the CacheStatusStr" );
+
+	if (size_t(status) < fut::size(CacheStatusStr))
+	{
+		return CacheStatusStr[ size_t(status) ];
+	}
+	else
+	{
+		return "<invalid status>";
+	}
+}
+
+
+//======================================================================================================================
+//  DeviceListCache
+
+#ifdef _WIN32
+static const char separator = '\\';
+#else
+static const char separator = '/';
+#endif
+
+string DeviceListCache::defaultFilePath( const std::string & host, uint16_t port )
+{
+	// Not the temporary directory, because anyone can create a file of a predictable name there before us.
+	string filePath;
+#ifdef _WIN32
+	const char * appDataDir = getenv( "LOCALAPPDATA" );
+	if (appDataDir && *appDataDir)
+		filePath = appDataDir;
+#else
+	const char * cacheDir = getenv( "XDG_CACHE_HOME" );
+	const char * homeDir = getenv( "HOME" );
+	if (cacheDir && cacheDir[0] == '/')  // relative paths are invalid according to the XDG specification
+	{
+		filePath = cacheDir;
+	}
+	else if (homeDir && homeDir[0] == '/')
+	{
+		filePath = homeDir;
+		if (filePath.back() != separator)
+			filePath += separator;
+		filePath += ".cache";
+	}
+#endif
+	if (filePath.empty())
+		return filePath;
+
+	if (filePath.back() != separator)
+		filePath += separator;
+	filePath += "openrgb-cppsdk";
+	filePath += separator;
+
+	filePath += "orgb-";
+	// the host may be an IPv6 address or contain other characters that are not allowed in file names
+	for (char c : host)
+		filePath += (isalnum( uint8_t(c) ) || c == '.' || c == '-') ? c : '_';
+	filePath += '-';
+	filePath += std::to_string( port );
+	filePath += ".cache";
+
+	return filePath;
+}
+
+uint64_t DeviceListCache::fingerprint( const Device & device ) noexcept
+{
+	uint32_t counts [3] = { uint32_t( device.type ), uint32_t( device.zones.size() ), uint32_t( device.leds.size() ) };
+	uint64_t hash = hashBytes( reinterpret_cast< const uint8_t * >( counts ), sizeof( counts ) );
+	return hashBytes( reinterpret_cast< const uint8_t * >( device.name.data() ), device.name.size(), hash );
+}
+
+// Creates the directories on the path to the file that don't exist yet, accessible only by the current user.
+static void createParentDirs( const string & filePath )
+{
+	// the errors don't matter, creating the file in a directory that couldn't be created will fail anyway
+	for (size_t sepPos = filePath.find( separator, 1 ); sepPos != string::npos; sepPos = filePath.find( separator, sepPos + 1 ))
+	{
+		string dirPath = filePath.substr( 0, sepPos );
+	 #ifdef _WIN32
+		if (dirPath.back() != ':')  // drive letter
+			CreateDirectoryA( dirPath.c_str(), nullptr );
+	 #else
+		mkdir( dirPath.c_str(), 0700 );
+	 #endif
+	}
+}
+
+// Writes the content into a newly created file that nobody else can have opened or prepared in advance,
+// and then atomically replaces the target file with it.
+static CacheStatus writeFileAtomically( const string & filePath, const vector< uint8_t > & content )
+{
+#ifdef _WIN32
+	// the directory of the current user is not accessible by others, so a unique name is enough
+	string tempFilePath = filePath + '.' + std::to_string( GetCurrentProcessId() ) + ".tmp";
+	int fd = _open( tempFilePath.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE );
+	if (fd < 0)
+	{
+		return CacheStatus::SystemError;
+	}
+	bool written = _write( fd, content.data(), unsigned( content.size() ) ) == int( content.size() );
+	written &= _close( fd ) == 0;
+	if (!written)
+	{
+		_unlink( tempFilePath.c_str() );
+		return CacheStatus::SystemError;
+	}
+	if (!MoveFileExA( tempFilePath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING ))
+	{
+		_unlink( tempFilePath.c_str() );
+		return CacheStatus::SystemError;
+	}
+#else
+	// mkstemp creates a file of a unique name with O_EXCL, so it can't be a symlink planted by someone else,
+	// and only the current user can read or write it
+	string tempFilePath = filePath + ".XXXXXX";
+	int fd = mkstemp( &tempFilePath[0] );
+	if (fd < 0)
+	{
+		return CacheStatus::SystemError;
+	}
+	bool written = true;
+	for (size_t writtenSize = 0; written && writtenSize < content.size(); )
+	{
+		ssize_t result = ::write( fd, content.data() + writtenSize, content.size() - writtenSize );
+		if (result > 0)
+			writtenSize += size_t( result );
+		else if (result < 0 && errno == EINTR)
+			continue;
+		else
+			written = false;
+	}
+	written &= ::close( fd ) == 0;
+	if (!written)
+	{
+		unlink( tempFilePath.c_str() );
+		return CacheStatus::SystemError;
+	}
+	// rename replaces the directory entry, it doesn't follow a symlink that may be there
+	if (rename( tempFilePath.c_str(), filePath.c_str() ) != 0)
+	{
+		unlink( tempFilePath.c_str() );
+		return CacheStatus::SystemError;
+	}
+#endif
+	return CacheStatus::Success;
+}
+
+// Maps the file, but only if it's a regular file of the current user that nobody else can write into,
+// otherwise someone else could make us use a device list of their choice, or crash us by truncating the mapped file.
+// This library itself never truncates the file, save() replaces it with a new one instead.
+static CacheStatus mapOwnFile( const string & filePath, MappedFile & file )
+{
+#ifdef _WIN32
+	// the directory of the current user is not accessible by others, so only check that it's a regular file
+	int fd = _open( filePath.c_str(), _O_RDONLY | _O_BINARY );
+	if (fd < 0)
+	{
+		return errno == ENOENT ? CacheStatus::NotFound : CacheStatus::SystemError;
+	}
+	struct _stat64 fileInfo;
+	if (_fstat64( fd, &fileInfo ) != 0)
+	{
+		_close( fd );
+		return CacheStatus::SystemError;
+	}
+	if ((fileInfo.st_mode & _S_IFMT) != _S_IFREG)
+	{
+		_close( fd );
+		return CacheStatus::Untrusted;
+	}
+	bool isMapped = file.map( fd, size_t( fileInfo.st_size ) );
+	_close( fd );
+#else
+	int fd = ::open( filePath.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC );
+	if (fd < 0)
+	{
+		return errno == ENOENT ? CacheStatus::NotFound : errno == ELOOP ? CacheStatus::Untrusted : CacheStatus::SystemError;
+	}
+	struct stat fileInfo;
+	if (fstat( fd, &fileInfo ) != 0)
+	{
+		::close( fd );
+		return CacheStatus::SystemError;
+	}
+	if (!S_ISREG( fileInfo.st_mode ) || fileInfo.st_uid != geteuid() || (fileInfo.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+	{
+		::close( fd );
+		return CacheStatus::Untrusted;
+	}
+	bool isMapped = file.map( fd, size_t( fileInfo.st_size ) );
+	::close( fd );
+#endif
+	return isMapped ? CacheStatus::Success : CacheStatus::SystemError;
+}
+
+CacheStatus DeviceListCache::save( const std::string & filePath, const std::string & endpoint, const DeviceList & devices ) noexcept
+{
+	const uint32_t protocolVersion = implementedProtocolVersion;
+
+	try
+	{
+		size_t headerSize = sizeof( cacheMagic ) + 4 + 4 + protocol::sizeofString( endpoint ) + 4;
+		size_t fileSize = headerSize + devices.size() * deviceEntrySize;
+		vector< size_t > deviceSizes;
+		deviceSizes.reserve( devices.size() );
+		for (const Device & device : devices)
+		{
+			deviceSizes.push_back( device.calcSize( protocolVersion ) );
+			fileSize += deviceSizes.back();
+		}
+
+		vector< uint8_t > buffer( fileSize );
+		BinaryOutputStream stream( buffer );
+
+		stream << cacheMagic;
+		stream << cacheFormatVersion;
+		stream << protocolVersion;
+		protocol::writeString( stream, endpoint );
+		stream << uint32_t( devices.size() );
+
+		// the device data are written after the table, so the checksums must be computed in a second pass
+		size_t tableOffset = headerSize;
+		size_t deviceOffset = tableOffset + devices.size() * deviceEntrySize;
+		for (uint32_t deviceIdx = 0; deviceIdx < devices.size(); ++deviceIdx)
+		{
+			stream << uint32_t( deviceOffset );
+			stream << uint32_t( deviceSizes[ deviceIdx ] );
+			stream << devices[ deviceIdx ]._contentHash;
+			stream << devices[ deviceIdx ]._descriptionHash;
+			stream << fingerprint( devices[ deviceIdx ] );
+			stream << uint64_t( 0 );  // checksum placeholder
+			deviceOffset += deviceSizes[ deviceIdx ];
+		}
+		for (const Device & device : devices)
+		{
+			device.serialize( stream, protocolVersion );
+		}
+
+		deviceOffset = tableOffset + devices.size() * deviceEntrySize;
+		for (uint32_t deviceIdx = 0; deviceIdx < devices.size(); ++deviceIdx)
+		{
+			uint64_t checksum = hashBytes( buffer.data() + deviceOffset, deviceSizes[ deviceIdx ] );
+			size_t checksumPos = tableOffset + deviceIdx * deviceEntrySize + 4 + 4 + 8 + 8 + 8;
+			for (size_t i = 0; i < 8; ++i)
+				buffer[ checksumPos + i ] = uint8_t( checksum >> (8 * i) );
+			deviceOffset += deviceSizes[ deviceIdx ];
+		}
+
+		// Write into a temporary file first and then replace the original one, so that other processes
+		// that may be loading the cache at the same time never see a half-written file.
+		createParentDirs( filePath );
+		return writeFileAtomically( filePath, buffer );
+	}
+	catch (const std::exception &)
+	{
+		return CacheStatus::SystemError;
+	}
+}
+
+CachedDeviceListResult DeviceListCache::load(
+	const std::string & filePath, const std::string & endpoint, uint32_t expectedDeviceCount,
+	const DeviceListOptions & options
+) noexcept
+{
+	CachedDeviceListResult result;
+
+	DeviceListCache cache;
+	result.status = cache.open( filePath, endpoint, expectedDeviceCount );
+	if (result.status != CacheStatus::Success)
+	{
+		return result;
+	}
+
+	try
+	{
+		result.devices.reserve( cache.deviceCount() );
+		for (uint32_t deviceIdx = 0; deviceIdx < cache.deviceCount(); ++deviceIdx)
+		{
+			unique_ptr< Device > device = cache.loadDevice( deviceIdx, options );
+			if (!device)
+			{
+				result.devices.clear();
+				result.status = CacheStatus::Invalid;
+				return result;
+			}
+			result.devices.append( move( device ) );
+		}
+	}
+	catch (const std::exception &)
+	{
+		result.devices.clear();
+		result.status = CacheStatus::SystemError;
+	}
+	return result;
+}
+
+
+//======================================================================================================================
+//  lazy access
+
+struct DeviceListCache::DeviceEntry
+{
+	uint32_t offset;
+	uint32_t size;
+	uint64_t contentFingerprint;
+	uint64_t descriptionFingerprint;
+	uint64_t deviceFingerprint;
+	uint64_t checksum;
+};
+
+DeviceListCache::DeviceListCache() noexcept
+:
+	_file(),
+	_protocolVersion( 0 ),
+	_deviceCount( 0 ),
+	_tableOffset( 0 )
+{}
+
+DeviceListCache::~DeviceListCache() noexcept = default;
+
+CacheStatus DeviceListCache::open(
+	const std::string & filePath, const std::string & endpoint, uint32_t expectedDeviceCount
+) noexcept
+{
+	close();
+
+	try
+	{
+		unique_ptr< MappedFile > file( new MappedFile );
+		CacheStatus mapStatus = mapOwnFile( filePath, *file );
+		if (mapStatus != CacheStatus::Success)
+		{
+			return mapStatus;
+		}
+
+		BinaryInputStream stream( span< const uint8_t >( file->data(), file->size() ) );
+
+		char magic [4] = {};
+		uint32_t formatVersion = 0, protocolVersion = 0;
+		string cachedEndpoint;
+		uint32_t deviceCount = 0;
+		stream >> magic;
+		stream >> formatVersion;
+		stream >> protocolVersion;
+		protocol::readString( stream, cachedEndpoint );
+		stream >> deviceCount;
+		if (stream.failed() || memcmp( magic, cacheMagic, sizeof( magic ) ) != 0
+		 || formatVersion != cacheFormatVersion || protocolVersion > implementedProtocolVersion)
+		{
+			return CacheStatus::Invalid;
+		}
+
+		// this is the cheap validation, the devices don't even need to be looked at when the cache is out of date
+		if (cachedEndpoint != endpoint || deviceCount != expectedDeviceCount)
+		{
+			return CacheStatus::OutOfDate;
+		}
+
+		size_t tableOffset = sizeof( cacheMagic ) + 4 + 4 + protocol::sizeofString( cachedEndpoint ) + 4;
+		if (deviceCount > (file->size() - tableOffset) / deviceEntrySize)
+		{
+			return CacheStatus::Invalid;
+		}
+
+		_file = move( file );
+		_protocolVersion = protocolVersion;
+		_deviceCount = deviceCount;
+		_tableOffset = tableOffset;
+
+		// check only that the device data are within the file, their checksums are verified when they are parsed
+		DeviceEntry entry;
+		for (uint32_t deviceIdx = 0; deviceIdx < deviceCount; ++deviceIdx)
+		{
+			if (!readDeviceEntry( deviceIdx, entry ))
+			{
+				close();
+				return CacheStatus::Invalid;
+			}
+		}
+
+		return CacheStatus::Success;
+	}
+	catch (const std::exception &)
+	{
+		close();
+		return CacheStatus::SystemError;
+	}
+}
+
+void DeviceListCache::close() noexcept
+{
+	_file.reset();
+	_protocolVersion = 0;
+	_deviceCount = 0;
+	_tableOffset = 0;
+}
+
+bool DeviceListCache::readDeviceEntry( uint32_t deviceIdx, DeviceEntry & entry ) const noexcept
+{
+	if (deviceIdx >= _deviceCount)
+	{
+		return false;
+	}
+
+	BinaryInputStream stream( span< const uint8_t >( _file->data() + _tableOffset + deviceIdx * deviceEntrySize, deviceEntrySize ) );
+	stream >> entry.offset;
+	stream >> entry.size;
+	stream >> entry.contentFingerprint;
+	stream >> entry.descriptionFingerprint;
+	stream >> entry.deviceFingerprint;
+	stream >> entry.checksum;
+
+	return !stream.failed() && entry.offset <= _file->size() && entry.size <= _file->size() - entry.offset;
+}
+
+StringView DeviceListCache::deviceName( uint32_t deviceIdx ) const noexcept
+{
+	DeviceEntry entry;
+	// the name is right after the device type, as in the protocol
+	if (!readDeviceEntry( deviceIdx, entry ) || entry.size < 4 + 2)
+	{
+		return StringView();
+	}
+	const uint8_t * nameData = _file->data() + entry.offset + 4;
+	uint16_t nameSize = readU16( nameData );
+	if (nameSize > entry.size - 4 - 2)
+	{
+		return StringView();
+	}
+	// the size counts the '\0' terminator, but don't rely on its presence
+	return StringView( reinterpret_cast< const char * >( nameData + 2 ), nameSize > 0 ? nameSize - 1 : 0 );
+}
+
+uint32_t DeviceListCache::findDevice( StringView name ) const noexcept
+{
+	for (uint32_t deviceIdx = 0; deviceIdx < _deviceCount; ++deviceIdx)
+		if (deviceName( deviceIdx ) == name)
+			return deviceIdx;
+	return UINT32_MAX;
+}
+
+unique_ptr< Device > DeviceListCache::loadDevice( uint32_t deviceIdx, const DeviceListOptions & options ) const noexcept
+{
+	DeviceEntry entry;
+	if (!readDeviceEntry( deviceIdx, entry ))
+	{
+		return nullptr;
+	}
+
+	const uint8_t * deviceData = _file->data() + entry.offset;
+	if (hashBytes( deviceData, entry.size ) != entry.checksum)
+	{
+		return nullptr;
+	}
+
+	try
+	{
+		unique_ptr< Device > device( new Device );
+		BinaryInputStream deviceStream( span< const uint8_t >( deviceData, entry.size ) );
+		if (!device->deserialize( deviceStream, _protocolVersion, deviceIdx, options ) || fingerprint( *device ) != entry.deviceFingerprint)
+		{
+			return nullptr;
+		}
+		device->_contentHash = entry.contentFingerprint;
+		device->_descriptionHash = entry.descriptionFingerprint;
+		return device;
+	}
+	catch (const std::exception &)
+	{
+		return nullptr;
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
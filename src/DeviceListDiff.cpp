@@ -0,0 +1,272 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: comparison of two versions of the device list
+//======================================================================================================================
+
+#include "OpenRGB/DeviceListDiff.hpp"
+
+#include "Essential.hpp"
+
+#include "DeviceIdentity.hpp"
+#include "ContainerUtils.hpp"
+#include "LangUtils.hpp"
+
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <sstream>
+using std::ostringstream;
+
+
+namespace orgb {
+
+
+constexpr uint32_t DeviceDiff::npos;
+
+
+//======================================================================================================================
+//  enums
+
+const char * enumString( DeviceDiffKind kind ) noexcept
+{
+	static const char * const DeviceDiffKindStr [] =
+	{
+		"Added",
+		"Removed",
+		"Moved",
+		"Modified",
+	};
+	static_assert( size_t(DeviceDiffKind::Modified) + 1 == fut::size(DeviceDiffKindStr), "update the DeviceDiffKindStr" );
+
+	if (size_t(kind) < fut::size(DeviceDiffKindStr))
+	{
+		return DeviceDiffKindStr[ size_t(kind) ];
+	}
+	else
+	{
+		return "<invalid>";
+	}
+}
+
+string deviceDiffFieldsToString( uint32_t fields )
+{
+	ostringstream oss;
+
+	bool isFirst = true;
+	auto addFlag = [ &isFirst, &oss ]( const char * flagStr )
+	{
+		if (isFirst) {
+			isFirst = false;
+		} else {
+			oss << " | ";
+		}
+		oss << flagStr;
+	};
+
+	if (fields & DeviceDiffFields::DescriptionChanged)
+		addFlag( "DescriptionChanged" );
+	if (fields & DeviceDiffFields::ModesChanged)
+		addFlag( "ModesChanged" );
+	if (fields & DeviceDiffFields::ActiveModeChanged)
+		addFlag( "ActiveModeChanged" );
+	if (fields & DeviceDiffFields::ZonesResized)
+		addFlag( "ZonesResized" );
+	if (fields & DeviceDiffFields::ZonesChanged)
+		addFlag( "ZonesChanged" );
+	if (fields & DeviceDiffFields::LedsChanged)
+		addFlag( "LedsChanged" );
+
+	return oss.str();
+}
+
+
+//======================================================================================================================
+//  comparison
+
+static bool equalModes( const Mode & a, const Mode & b ) noexcept
+{
+	return a.name == b.name
+		&& a.value == b.value
+		&& a.flags == b.flags
+		&& a.speed_min == b.speed_min
+		&& a.speed_max == b.speed_max
+		&& a.brightness_min == b.brightness_min
+		&& a.brightness_max == b.brightness_max
+		&& a.colors_min == b.colors_min
+		&& a.colors_max == b.colors_max
+		&& a.speed == b.speed
+		&& a.brightness == b.brightness
+		&& a.direction == b.direction
+		&& a.color_mode == b.color_mode
+		&& a.colors == b.colors;
+}
+
+// everything except the number of LEDs, that one is reported separately
+static bool equalZoneLayouts( const Zone & a, const Zone & b ) noexcept
+{
+	return a.name == b.name
+		&& a.type == b.type
+		&& a.leds_min == b.leds_min
+		&& a.leds_max == b.leds_max
+		&& a.matrix_height == b.matrix_height
+		&& a.matrix_width == b.matrix_width
+		&& a.matrix_values == b.matrix_values;
+}
+
+template< typename Type, typename EqualFunc >
+static bool equalVectors( const vector< Type > & a, const vector< Type > & b, EqualFunc equal ) noexcept
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i)
+		if (!equal( a[i], b[i] ))
+			return false;
+	return true;
+}
+
+static uint32_t compareDevices( const Device & oldDevice, const Device & newDevice, vector< uint32_t > & resizedZones )
+{
+	uint32_t fields = 0;
+
+	if (oldDevice.type != newDevice.type
+	 || oldDevice.name != newDevice.name
+	 || oldDevice.vendor != newDevice.vendor
+	 || oldDevice.description != newDevice.description
+	 || oldDevice.version != newDevice.version)
+	{
+		fields |= DeviceDiffFields::DescriptionChanged;
+	}
+
+	if (!equalVectors( oldDevice.modes, newDevice.modes, equalModes ))
+	{
+		fields |= DeviceDiffFields::ModesChanged;
+	}
+
+	if (oldDevice.active_mode != newDevice.active_mode)
+	{
+		fields |= DeviceDiffFields::ActiveModeChanged;
+	}
+
+	if (oldDevice.zones.size() != newDevice.zones.size())
+	{
+		// the zones can't be paired, so it makes no sense to tell which ones were resized
+		fields |= DeviceDiffFields::ZonesChanged;
+	}
+	else
+	{
+		for (uint32_t zoneIdx = 0; zoneIdx < newDevice.zones.size(); ++zoneIdx)
+		{
+			const Zone & oldZone = oldDevice.zones[ zoneIdx ];
+			const Zone & newZone = newDevice.zones[ zoneIdx ];
+			if (!equalZoneLayouts( oldZone, newZone ))
+			{
+				fields |= DeviceDiffFields::ZonesChanged;
+			}
+			if (oldZone.leds_count != newZone.leds_count)
+			{
+				fields |= DeviceDiffFields::ZonesResized;
+				resizedZones.push_back( zoneIdx );
+			}
+		}
+	}
+
+	if (oldDevice.leds.size() != newDevice.leds.size())
+	{
+		fields |= DeviceDiffFields::LedsChanged;
+	}
+	else
+	{
+		// the names may be stored lazily, see DeviceListOptions::lazyLedNames
+		for (uint32_t ledIdx = 0; ledIdx < newDevice.leds.size(); ++ledIdx)
+		{
+			if (oldDevice.leds[ ledIdx ].value != newDevice.leds[ ledIdx ].value
+			 || oldDevice.ledName( ledIdx ) != newDevice.ledName( ledIdx ))
+			{
+				fields |= DeviceDiffFields::LedsChanged;
+				break;
+			}
+		}
+	}
+
+	return fields;
+}
+
+
+//======================================================================================================================
+//  diff
+
+DeviceListDiff diff( const DeviceList & oldList, const DeviceList & newList )
+{
+	DeviceMatcher matcher( oldList );
+
+	vector< string > keys;
+	keys.reserve( newList.size() );
+	vector< uint32_t > oldIndexes;
+	oldIndexes.reserve( newList.size() );
+	for (const Device & newDevice : newList)
+	{
+		keys.push_back( identityKey( newDevice ) );
+		oldIndexes.push_back( matcher.matchExactly( keys.back() ) );
+	}
+	// only now, so that a renamed device can't take the old version of a device that is still there
+	for (uint32_t newIdx = 0; newIdx < newList.size(); ++newIdx)
+	{
+		if (oldIndexes[ newIdx ] == DeviceMatcher::noMatch)
+			oldIndexes[ newIdx ] = matcher.matchRenamed( keys[ newIdx ] );
+	}
+
+	DeviceListDiff result;
+
+	for (uint32_t newIdx = 0; newIdx < newList.size(); ++newIdx)
+	{
+		const Device & newDevice = newList[ newIdx ];
+		uint32_t oldIdx = oldIndexes[ newIdx ];
+
+		DeviceDiff deviceDiff;
+		deviceDiff.oldIdx = oldIdx;
+		deviceDiff.newIdx = newIdx;
+		deviceDiff.fields = 0;
+
+		if (oldIdx == DeviceMatcher::noMatch)
+		{
+			deviceDiff.oldIdx = DeviceDiff::npos;
+			deviceDiff.kind = DeviceDiffKind::Added;
+		}
+		else
+		{
+			deviceDiff.fields = compareDevices( oldList[ oldIdx ], newDevice, deviceDiff.resizedZones );
+			if (deviceDiff.fields != 0)
+				deviceDiff.kind = DeviceDiffKind::Modified;
+			else if (oldIdx != newIdx)
+				deviceDiff.kind = DeviceDiffKind::Moved;
+			else
+				continue;  // unchanged
+		}
+
+		result.devices.push_back( std::move( deviceDiff ) );
+	}
+
+	for (uint32_t oldIdx = 0; oldIdx < matcher.oldCount(); ++oldIdx)
+	{
+		if (!matcher.isMatched( oldIdx ))
+		{
+			DeviceDiff deviceDiff;
+			deviceDiff.kind = DeviceDiffKind::Removed;
+			deviceDiff.oldIdx = oldIdx;
+			deviceDiff.newIdx = DeviceDiff::npos;
+			deviceDiff.fields = 0;
+			result.devices.push_back( std::move( deviceDiff ) );
+		}
+	}
+
+	return result;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,441 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: flat structure-of-arrays representation of the device list
+//======================================================================================================================
+
+#include "OpenRGB/DeviceSnapshot.hpp"
+
+#include "Essential.hpp"
+
+#include "ProtocolCommon.hpp"
+#include "BinaryStream.hpp"
+using own::BinaryInputStream;
+
+#include <string>
+using std::string;
+#include <memory>
+#include <algorithm>
+
+
+namespace orgb {
+
+
+constexpr uint32_t DeviceSnapshot::npos;
+
+
+//======================================================================================================================
+//  building the snapshot
+
+void DeviceSnapshot::clear() noexcept
+{
+	_devices.type.clear();
+	_devices.name.clear();
+	_devices.vendor.clear();
+	_devices.description.clear();
+	_devices.version.clear();
+	_devices.serial.clear();
+	_devices.location.clear();
+	_devices.active_mode.clear();
+	_devices.modes.clear();
+	_devices.zones.clear();
+	_devices.leds.clear();
+	_devices.colors.clear();
+
+	_modes.device.clear();
+	_modes.name.clear();
+	_modes.value.clear();
+	_modes.flags.clear();
+	_modes.speed_min.clear();
+	_modes.speed_max.clear();
+	_modes.brightness_min.clear();
+	_modes.brightness_max.clear();
+	_modes.colors_min.clear();
+	_modes.colors_max.clear();
+	_modes.speed.clear();
+	_modes.brightness.clear();
+	_modes.direction.clear();
+	_modes.color_mode.clear();
+	_modes.colors.clear();
+	_modes.colorValues.clear();
+
+	_zones.device.clear();
+	_zones.name.clear();
+	_zones.type.clear();
+	_zones.leds_min.clear();
+	_zones.leds_max.clear();
+	_zones.leds_count.clear();
+	_zones.matrix_height.clear();
+	_zones.matrix_width.clear();
+	_zones.leds.clear();
+	_zones.matrix.clear();
+	_zones.matrixValues.clear();
+
+	_leds.device.clear();
+	_leds.name.clear();
+	_leds.value.clear();
+
+	_colors.clear();
+	// the string table stays, the next refill will mostly find its names already there
+}
+
+void DeviceSnapshot::reserve( size_t deviceCount )
+{
+	_devices.type.reserve( deviceCount );
+	_devices.name.reserve( deviceCount );
+	_devices.vendor.reserve( deviceCount );
+	_devices.description.reserve( deviceCount );
+	_devices.version.reserve( deviceCount );
+	_devices.serial.reserve( deviceCount );
+	_devices.location.reserve( deviceCount );
+	_devices.active_mode.reserve( deviceCount );
+	_devices.modes.reserve( deviceCount );
+	_devices.zones.reserve( deviceCount );
+	_devices.leds.reserve( deviceCount );
+	_devices.colors.reserve( deviceCount );
+}
+
+void DeviceSnapshot::assign( const DeviceList & deviceList )
+{
+	// the previous content is a good estimate of the names that will be needed again
+	if (_strings && _strings->isOversized( nameCount() ))
+		_strings.reset();
+	clear();
+	reserve( deviceList.size() );
+
+	for (const Device & device : deviceList)
+	{
+		appendDevice( device );
+	}
+}
+
+StringTable & DeviceSnapshot::strings()
+{
+	if (!_strings)
+		_strings = std::make_shared< StringTable >();
+	return *_strings;
+}
+
+NameRef DeviceSnapshot::addName( StringView str )
+{
+	return strings().intern( str );
+}
+
+bool DeviceSnapshot::readName( BinaryInputStream & stream, NameRef & name )
+{
+	protocol::readString( stream, strings(), _readBuffer, name );
+	return !stream.failed();
+}
+
+// saturates, so that the zones after a bogus huge one don't wrap around to the start of the device
+static inline uint32_t advanceZoneStart( uint32_t zoneStart, uint32_t ledCount ) noexcept
+{
+	return ledCount < UINT32_MAX - zoneStart ? zoneStart + ledCount : UINT32_MAX;
+}
+
+// The LED counts of the zones come from the server and may not match the LEDs of the device, which are known only
+// after all the zones, so the ranges are clamped afterwards, like LayoutMap clamps the zones of a Device.
+void DeviceSnapshot::clampZoneLeds( uint32_t deviceIdx ) noexcept
+{
+	const IndexRange deviceLeds = _devices.leds[ deviceIdx ];
+	const IndexRange deviceZones = _devices.zones[ deviceIdx ];
+	for (uint32_t zoneIdx = deviceZones.first; zoneIdx < deviceZones.first + deviceZones.count && zoneIdx < _zones.size(); ++zoneIdx)
+	{
+		IndexRange & zoneLeds = _zones.leds[ zoneIdx ];
+		zoneLeds.first = std::min( zoneLeds.first, deviceLeds.end() );
+		zoneLeds.count = std::min( zoneLeds.count, deviceLeds.end() - zoneLeds.first );
+	}
+}
+
+void DeviceSnapshot::appendDevice( const Device & device )
+{
+	uint32_t deviceIdx = uint32_t( _devices.size() );
+
+	_devices.type.push_back( device.type );
+	_devices.name.push_back( addName( device.name ) );
+	_devices.vendor.push_back( addName( device.vendor ) );
+	_devices.description.push_back( addName( device.description ) );
+	_devices.version.push_back( addName( device.version ) );
+	_devices.serial.push_back( addName( device.serial ) );
+	_devices.location.push_back( addName( device.location ) );
+	_devices.active_mode.push_back( device.active_mode );
+
+	_devices.modes.push_back({ uint32_t( _modes.size() ), uint32_t( device.modes.size() ) });
+	for (const Mode & mode : device.modes)
+	{
+		_modes.device.push_back( deviceIdx );
+		_modes.name.push_back( addName( mode.name ) );
+		_modes.value.push_back( mode.value );
+		_modes.flags.push_back( mode.flags );
+		_modes.speed_min.push_back( mode.speed_min );
+		_modes.speed_max.push_back( mode.speed_max );
+		_modes.brightness_min.push_back( mode.brightness_min );
+		_modes.brightness_max.push_back( mode.brightness_max );
+		_modes.colors_min.push_back( mode.colors_min );
+		_modes.colors_max.push_back( mode.colors_max );
+		_modes.speed.push_back( mode.speed );
+		_modes.brightness.push_back( mode.brightness );
+		_modes.direction.push_back( mode.direction );
+		_modes.color_mode.push_back( mode.color_mode );
+		_modes.colors.push_back({ uint32_t( _modes.colorValues.size() ), uint32_t( mode.colors.size() ) });
+		_modes.colorValues.insert( _modes.colorValues.end(), mode.colors.begin(), mode.colors.end() );
+	}
+
+	uint32_t ledsStart = uint32_t( _leds.size() );
+
+	_devices.zones.push_back({ uint32_t( _zones.size() ), uint32_t( device.zones.size() ) });
+	uint32_t zoneLedsStart = ledsStart;
+	for (const Zone & zone : device.zones)
+	{
+		_zones.device.push_back( deviceIdx );
+		_zones.name.push_back( addName( zone.name ) );
+		_zones.type.push_back( zone.type );
+		_zones.leds_min.push_back( zone.leds_min );
+		_zones.leds_max.push_back( zone.leds_max );
+		_zones.leds_count.push_back( zone.leds_count );
+		_zones.matrix_height.push_back( zone.matrix_height );
+		_zones.matrix_width.push_back( zone.matrix_width );
+		_zones.leds.push_back({ zoneLedsStart, zone.leds_count });
+		_zones.matrix.push_back({ uint32_t( _zones.matrixValues.size() ), uint32_t( zone.matrix_values.size() ) });
+		_zones.matrixValues.insert( _zones.matrixValues.end(), zone.matrix_values.begin(), zone.matrix_values.end() );
+		zoneLedsStart = advanceZoneStart( zoneLedsStart, zone.leds_count );
+	}
+
+	_devices.leds.push_back({ ledsStart, uint32_t( device.leds.size() ) });
+	for (const LED & led : device.leds)
+	{
+		_leds.device.push_back( deviceIdx );
+		_leds.name.push_back( addName( device.ledName( led.idx ) ) );
+		_leds.value.push_back( led.value );
+	}
+	clampZoneLeds( deviceIdx );
+
+	_devices.colors.push_back({ uint32_t( _colors.size() ), uint32_t( device.colors.size() ) });
+	_colors.insert( _colors.end(), device.colors.begin(), device.colors.end() );
+}
+
+// This must be kept in sync with Device::deserialize() and the deserialize methods of its sub-objects.
+bool DeviceSnapshot::appendDevice( BinaryInputStream & stream, uint32_t protocolVersion )
+{
+	uint32_t deviceIdx = uint32_t( _devices.size() );
+
+	DeviceType deviceType;
+	stream >> deviceType;
+	_devices.type.push_back( deviceType );
+
+	NameRef name;
+	readName( stream, name );  _devices.name.push_back( name );
+	readName( stream, name );  _devices.vendor.push_back( name );
+	readName( stream, name );  _devices.description.push_back( name );
+	readName( stream, name );  _devices.version.push_back( name );
+	readName( stream, name );  _devices.serial.push_back( name );
+	readName( stream, name );  _devices.location.push_back( name );
+
+	uint16_t num_modes = 0;
+	uint32_t active_mode = 0;
+	stream >> num_modes;  // the size is not directly before the array, so it must be read manually
+	stream >> active_mode;
+	_devices.active_mode.push_back( active_mode );
+
+	_devices.modes.push_back({ uint32_t( _modes.size() ), num_modes });
+	for (uint16_t i = 0; i < num_modes; ++i)
+	{
+		uint32_t value, flags, speed_min, speed_max, brightness_min = 0, brightness_max = 0, colors_min, colors_max;
+		uint32_t speed, brightness = 0;
+		Direction direction;
+		ColorMode color_mode;
+
+		readName( stream, name );
+		stream >> value;
+		stream >> flags;
+		stream >> speed_min;
+		stream >> speed_max;
+		if (protocolVersion >= 3)
+		{
+			stream >> brightness_min;
+			stream >> brightness_max;
+		}
+		stream >> colors_min;
+		stream >> colors_max;
+		stream >> speed;
+		if (protocolVersion >= 3)
+		{
+			stream >> brightness;
+		}
+		stream >> direction;
+		stream >> color_mode;
+
+		uint16_t num_colors = 0;
+		stream >> num_colors;
+		_modes.colors.push_back({ uint32_t( _modes.colorValues.size() ), num_colors });
+		for (uint16_t j = 0; j < num_colors; ++j)
+		{
+			Color color;
+			stream >> color;
+			_modes.colorValues.push_back( color );
+		}
+
+		if (stream.failed() || !isValidDirection( direction, flags ) || !isValidColorMode( color_mode ))
+			return false;
+
+		_modes.device.push_back( deviceIdx );
+		_modes.name.push_back( name );
+		_modes.value.push_back( value );
+		_modes.flags.push_back( flags );
+		_modes.speed_min.push_back( speed_min );
+		_modes.speed_max.push_back( speed_max );
+		_modes.brightness_min.push_back( brightness_min );
+		_modes.brightness_max.push_back( brightness_max );
+		_modes.colors_min.push_back( colors_min );
+		_modes.colors_max.push_back( colors_max );
+		_modes.speed.push_back( speed );
+		_modes.brightness.push_back( brightness );
+		_modes.direction.push_back( direction );
+		_modes.color_mode.push_back( color_mode );
+	}
+
+	uint32_t ledsStart = uint32_t( _leds.size() );
+
+	uint16_t num_zones = 0;
+	stream >> num_zones;
+	_devices.zones.push_back({ uint32_t( _zones.size() ), num_zones });
+	uint32_t zoneLedsStart = ledsStart;
+	for (uint16_t i = 0; i < num_zones; ++i)
+	{
+		ZoneType type;
+		uint32_t leds_min, leds_max, leds_count, matrix_height = 0, matrix_width = 0;
+
+		readName( stream, name );
+		stream >> type;
+		stream >> leds_min;
+		stream >> leds_max;
+		stream >> leds_count;
+
+		uint16_t matrix_length = 0;
+		stream >> matrix_length;
+		uint32_t matrixStart = uint32_t( _zones.matrixValues.size() );
+		if (matrix_length > 0)
+		{
+			stream >> matrix_height;
+			stream >> matrix_width;
+			size_t matrixSize = matrix_height * matrix_width;
+			for (size_t j = 0; j < matrixSize && !stream.failed(); ++j)
+			{
+				uint32_t matrixValue;
+				stream >> matrixValue;
+				_zones.matrixValues.push_back( matrixValue );
+			}
+		}
+
+		if (stream.failed() || !isValidZoneType( type ))
+			return false;
+
+		_zones.device.push_back( deviceIdx );
+		_zones.name.push_back( name );
+		_zones.type.push_back( type );
+		_zones.leds_min.push_back( leds_min );
+		_zones.leds_max.push_back( leds_max );
+		_zones.leds_count.push_back( leds_count );
+		_zones.matrix_height.push_back( matrix_height );
+		_zones.matrix_width.push_back( matrix_width );
+		_zones.leds.push_back({ zoneLedsStart, leds_count });
+		_zones.matrix.push_back({ matrixStart, uint32_t( _zones.matrixValues.size() ) - matrixStart });
+		zoneLedsStart = advanceZoneStart( zoneLedsStart, leds_count );
+	}
+
+	uint16_t num_leds = 0;
+	stream >> num_leds;
+	_devices.leds.push_back({ ledsStart, num_leds });
+	for (uint16_t i = 0; i < num_leds; ++i)
+	{
+		uint32_t value;
+
+		readName( stream, name );
+		stream >> value;
+
+		if (stream.failed())
+			return false;
+
+		_leds.device.push_back( deviceIdx );
+		_leds.name.push_back( name );
+		_leds.value.push_back( value );
+	}
+	clampZoneLeds( deviceIdx );
+
+	uint16_t num_colors = 0;
+	stream >> num_colors;
+	_devices.colors.push_back({ uint32_t( _colors.size() ), num_colors });
+	for (uint16_t i = 0; i < num_colors; ++i)
+	{
+		Color color;
+		stream >> color;
+		_colors.push_back( color );
+	}
+
+	return !stream.failed();
+}
+
+
+//======================================================================================================================
+//  searching
+
+bool DeviceSnapshot::findName( StringView str, NameRef & name ) const
+{
+	if (!_strings)
+		return false;
+	return _strings->find( str, name );
+}
+
+uint32_t DeviceSnapshot::findInRange( const std::vector< NameRef > & names, IndexRange range, const std::string & name ) const
+{
+	// resolve the string once, then the names can be compared by their handles
+	NameRef handle;
+	if (!findName( name, handle ))
+		return npos;
+
+	for (uint32_t i = range.first; i < range.end(); ++i)
+		if (names[i] == handle)
+			return i;
+	return npos;
+}
+
+uint32_t DeviceSnapshot::findDevice( const std::string & name ) const
+{
+	return findInRange( _devices.name, { 0, uint32_t( _devices.size() ) }, name );
+}
+
+uint32_t DeviceSnapshot::findDevice( DeviceType type ) const noexcept
+{
+	for (uint32_t i = 0; i < _devices.size(); ++i)
+		if (_devices.type[i] == type)
+			return i;
+	return npos;
+}
+
+uint32_t DeviceSnapshot::findMode( uint32_t deviceIdx, const std::string & name ) const
+{
+	if (deviceIdx >= _devices.size())
+		return npos;
+	return findInRange( _modes.name, _devices.modes[ deviceIdx ], name );
+}
+
+uint32_t DeviceSnapshot::findZone( uint32_t deviceIdx, const std::string & name ) const
+{
+	if (deviceIdx >= _devices.size())
+		return npos;
+	return findInRange( _zones.name, _devices.zones[ deviceIdx ], name );
+}
+
+uint32_t DeviceSnapshot::findLED( uint32_t deviceIdx, const std::string & name ) const
+{
+	if (deviceIdx >= _devices.size())
+		return npos;
+	return findInRange( _leds.name, _devices.leds[ deviceIdx ], name );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
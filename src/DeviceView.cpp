@@ -0,0 +1,354 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: read-only view of a device that is parsed lazily from the raw server reply
+//======================================================================================================================
+
+#include "OpenRGB/DeviceView.hpp"
+
+#include "Essential.hpp"
+
+#include "RawWalker.hpp"
+#include "ProtocolCommon.hpp"  // enum validation
+#include "BinaryStream.hpp"
+using own::BinaryInputStream;
+
+#include <algorithm>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  raw data access
+
+StringView DeviceView::stringAt( uint32_t offset ) const noexcept
+{
+	// the index has already validated that the whole string fits into the buffer
+	uint16_t size = readU16( _data.data() + offset );
+	const char * chars = reinterpret_cast< const char * >( _data.data() + offset + 2 );
+	// the size counts the '\0' terminator, but don't rely on its presence
+	size_t length = size > 0 ? size - 1 : 0;
+	return StringView( chars, length );
+}
+
+uint32_t DeviceView::uint32At( uint32_t offset ) const noexcept
+{
+	return readU32( _data.data() + offset );
+}
+
+static inline uint32_t afterString( const uint8_t * data, uint32_t offset ) noexcept
+{
+	return offset + 2 + readU16( data + offset );
+}
+
+
+//======================================================================================================================
+//  index
+
+// This must be kept in sync with Device::deserialize() and the deserialize methods of its sub-objects.
+bool DeviceView::buildIndex() const
+{
+	if (_index.state != Index::NotBuilt)
+		return _index.state == Index::Valid;
+
+	_index.state = Index::Invalid;
+
+	RawWalker walker( _data, 0 );
+	walker.u32();  // data_size
+
+	_index.type = uint32_t( walker.pos() );
+	walker.u32();
+	for (uint32_t & stringOffset : _index.strings)
+	{
+		stringOffset = uint32_t( walker.pos() );
+		walker.skipString();
+	}
+
+	uint16_t num_modes = walker.u16();
+	_index.activeMode = uint32_t( walker.pos() );
+	walker.u32();
+	_index.modes.resize( num_modes );
+	for (uint32_t & modeOffset : _index.modes)
+	{
+		modeOffset = uint32_t( walker.pos() );
+		walker.skipString();
+		walker.u32();  // value
+		uint32_t flags = walker.u32();
+		// speed_min, speed_max, [brightness_min, brightness_max], colors_min, colors_max, speed, [brightness]
+		walker.skip( _protocolVersion >= 3 ? 8 * 4 : 5 * 4 );
+		Direction direction = Direction( walker.u32() );
+		ColorMode color_mode = ColorMode( walker.u32() );
+		if (!isValidDirection( direction, flags ) || !isValidColorMode( color_mode ))
+			walker.setFailed();
+		uint16_t num_colors = walker.u16();
+		walker.skip( size_t( num_colors ) * 4 );
+	}
+
+	uint16_t num_zones = walker.u16();
+	_index.zones.resize( num_zones );
+	for (uint32_t & zoneOffset : _index.zones)
+	{
+		zoneOffset = uint32_t( walker.pos() );
+		walker.skipString();
+		ZoneType type = ZoneType( walker.u32() );
+		walker.skip( 3 * 4 );  // leds_min, leds_max, leds_count
+		if (!isValidZoneType( type ))
+			walker.setFailed();
+		uint16_t matrix_length = walker.u16();
+		if (matrix_length > 0)
+		{
+			uint32_t matrix_height = walker.u32();
+			uint32_t matrix_width = walker.u32();
+			walker.skip( size_t( matrix_height ) * matrix_width * 4 );
+		}
+	}
+
+	uint16_t num_leds = walker.u16();
+	_index.leds.resize( num_leds );
+	for (uint32_t & ledOffset : _index.leds)
+	{
+		ledOffset = uint32_t( walker.pos() );
+		walker.skipString();
+		walker.skip( 4 );  // value
+	}
+
+	uint16_t num_colors = walker.u16();
+	_index.colors = uint32_t( walker.pos() );
+	_index.colorCount = num_colors;
+	walker.skip( size_t( num_colors ) * 4 );
+
+	if (walker.failed())
+	{
+		_index.modes.clear();
+		_index.zones.clear();
+		_index.leds.clear();
+		_index.colorCount = 0;
+		return false;
+	}
+
+	_index.state = Index::Valid;
+	return true;
+}
+
+bool DeviceView::isValid() const
+{
+	return buildIndex();
+}
+
+
+//======================================================================================================================
+//  accessors
+
+DeviceType DeviceView::type() const
+{
+	return buildIndex() ? DeviceType( uint32At( _index.type ) ) : DeviceType::Unknown;
+}
+
+StringView DeviceView::name() const
+{
+	return buildIndex() ? stringAt( _index.strings[0] ) : StringView();
+}
+
+StringView DeviceView::vendor() const
+{
+	return buildIndex() ? stringAt( _index.strings[1] ) : StringView();
+}
+
+StringView DeviceView::description() const
+{
+	return buildIndex() ? stringAt( _index.strings[2] ) : StringView();
+}
+
+StringView DeviceView::version() const
+{
+	return buildIndex() ? stringAt( _index.strings[3] ) : StringView();
+}
+
+StringView DeviceView::serial() const
+{
+	return buildIndex() ? stringAt( _index.strings[4] ) : StringView();
+}
+
+StringView DeviceView::location() const
+{
+	return buildIndex() ? stringAt( _index.strings[5] ) : StringView();
+}
+
+uint32_t DeviceView::activeMode() const
+{
+	return buildIndex() ? uint32At( _index.activeMode ) : 0;
+}
+
+size_t DeviceView::modeCount() const
+{
+	buildIndex();
+	return _index.modes.size();
+}
+
+size_t DeviceView::zoneCount() const
+{
+	buildIndex();
+	return _index.zones.size();
+}
+
+size_t DeviceView::ledCount() const
+{
+	buildIndex();
+	return _index.leds.size();
+}
+
+size_t DeviceView::colorCount() const
+{
+	buildIndex();
+	return _index.colorCount;
+}
+
+StringView DeviceView::modeName( uint32_t modeIdx ) const
+{
+	if (!hasMode( modeIdx ))
+		return StringView();
+	return stringAt( _index.modes[ modeIdx ] );
+}
+
+uint32_t DeviceView::modeValue( uint32_t modeIdx ) const
+{
+	if (!hasMode( modeIdx ))
+		return 0;
+	return uint32At( afterString( _data.data(), _index.modes[ modeIdx ] ) );
+}
+
+uint32_t DeviceView::modeFlags( uint32_t modeIdx ) const
+{
+	if (!hasMode( modeIdx ))
+		return 0;
+	return uint32At( afterString( _data.data(), _index.modes[ modeIdx ] ) + 4 );
+}
+
+ColorMode DeviceView::modeColorMode( uint32_t modeIdx ) const
+{
+	if (!hasMode( modeIdx ))
+		return ColorMode::None;
+	// color_mode is the last of the fixed-size fields
+	uint32_t fieldsSize = _protocolVersion >= 3 ? 12 * 4 : 9 * 4;
+	return ColorMode( uint32At( afterString( _data.data(), _index.modes[ modeIdx ] ) + fieldsSize - 4 ) );
+}
+
+StringView DeviceView::zoneName( uint32_t zoneIdx ) const
+{
+	if (!hasZone( zoneIdx ))
+		return StringView();
+	return stringAt( _index.zones[ zoneIdx ] );
+}
+
+ZoneType DeviceView::zoneType( uint32_t zoneIdx ) const
+{
+	if (!hasZone( zoneIdx ))
+		return ZoneType::Single;
+	return ZoneType( uint32At( afterString( _data.data(), _index.zones[ zoneIdx ] ) ) );
+}
+
+uint32_t DeviceView::zoneLedsCount( uint32_t zoneIdx ) const
+{
+	if (!hasZone( zoneIdx ))
+		return 0;
+	return uint32At( afterString( _data.data(), _index.zones[ zoneIdx ] ) + 3 * 4 );
+}
+
+IndexRange DeviceView::zoneLeds( uint32_t zoneIdx ) const
+{
+	if (!hasZone( zoneIdx ))
+		return { 0, 0 };
+	// the LED counts come from the server and don't have to add up to the LEDs of the device,
+	// so clamp the range the same way LayoutMap does with the zones of a Device
+	uint32_t ledCount = uint32_t( _index.leds.size() );
+	uint32_t first = 0;
+	for (uint32_t i = 0; i < zoneIdx && first < ledCount; ++i)
+		first += std::min( zoneLedsCount( i ), ledCount - first );
+	return { first, std::min( zoneLedsCount( zoneIdx ), ledCount - first ) };
+}
+
+uint32_t DeviceView::zoneMatrixHeight( uint32_t zoneIdx ) const
+{
+	if (!hasZone( zoneIdx ))
+		return 0;
+	uint32_t matrixLengthOffset = afterString( _data.data(), _index.zones[ zoneIdx ] ) + 4 * 4;
+	return readU16( _data.data() + matrixLengthOffset ) > 0 ? uint32At( matrixLengthOffset + 2 ) : 0;
+}
+
+uint32_t DeviceView::zoneMatrixWidth( uint32_t zoneIdx ) const
+{
+	if (!hasZone( zoneIdx ))
+		return 0;
+	uint32_t matrixLengthOffset = afterString( _data.data(), _index.zones[ zoneIdx ] ) + 4 * 4;
+	return readU16( _data.data() + matrixLengthOffset ) > 0 ? uint32At( matrixLengthOffset + 6 ) : 0;
+}
+
+StringView DeviceView::ledName( uint32_t ledIdx ) const
+{
+	if (!hasLED( ledIdx ))
+		return StringView();
+	return stringAt( _index.leds[ ledIdx ] );
+}
+
+uint32_t DeviceView::ledValue( uint32_t ledIdx ) const
+{
+	if (!hasLED( ledIdx ))
+		return 0;
+	return uint32At( afterString( _data.data(), _index.leds[ ledIdx ] ) );
+}
+
+Color DeviceView::color( uint32_t ledIdx ) const
+{
+	if (!buildIndex() || ledIdx >= _index.colorCount)
+		return Color::Black;
+	const uint8_t * colorData = _data.data() + _index.colors + ledIdx * 4;
+	Color color( colorData[0], colorData[1], colorData[2] );
+	color.padding = colorData[3];
+	return color;
+}
+
+uint32_t DeviceView::findMode( StringView name ) const
+{
+	for (uint32_t i = 0; i < modeCount(); ++i)
+		if (modeName( i ) == name)
+			return i;
+	return UINT32_MAX;
+}
+
+uint32_t DeviceView::findZone( StringView name ) const
+{
+	for (uint32_t i = 0; i < zoneCount(); ++i)
+		if (zoneName( i ) == name)
+			return i;
+	return UINT32_MAX;
+}
+
+uint32_t DeviceView::findLED( StringView name ) const
+{
+	for (uint32_t i = 0; i < ledCount(); ++i)
+		if (ledName( i ) == name)
+			return i;
+	return UINT32_MAX;
+}
+
+std::unique_ptr< Device > DeviceView::toDevice( const DeviceListOptions & options ) const
+{
+	std::unique_ptr< Device > device( new Device );
+
+	BinaryInputStream stream( _data );
+	uint32_t data_size;
+	stream >> data_size;
+	if (!device->deserialize( stream, _protocolVersion, _idx, options ))
+		return nullptr;
+	device->hashReply( _data, _protocolVersion );
+
+	return device;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,324 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: stack of effect layers composited into the colors of the devices
+//======================================================================================================================
+
+#include "OpenRGB/EffectEngine.hpp"
+
+#include "Essential.hpp"
+
+#include "OpenRGB/Client.hpp"
+#include "OpenRGB/RenderExecutor.hpp"
+
+#include <vector>
+using std::vector;
+#include <memory>
+using std::unique_ptr;
+#include <algorithm>
+#include <cstring>
+
+
+namespace orgb {
+
+
+using colorops::BlendMode;
+
+
+//======================================================================================================================
+//  LayerCanvas
+
+void LayerCanvas::assign( const DeviceList & devices )
+{
+	_devices = &devices;
+	_frames.resize( devices.size() );
+	for (size_t deviceIdx = 0; deviceIdx < devices.size(); ++deviceIdx)
+	{
+		_frames[ deviceIdx ].assign( devices[ deviceIdx ].leds.size(), Color( 0, 0, 0 ) );
+	}
+	clear();
+}
+
+void LayerCanvas::clear() noexcept
+{
+	Color transparent( 0, 0, 0 );
+	for (vector< Color > & frame : _frames)
+	{
+		colorops::fill( frame.data(), frame.size(), transparent );
+	}
+	_changed.assign( _frames.size(), true );
+}
+
+void LayerCanvas::resetChanges() noexcept
+{
+	std::fill( _changed.begin(), _changed.end(), uint8_t( false ) );
+}
+
+
+//======================================================================================================================
+//  EffectEngine
+
+void EffectEngine::setDevices( const DeviceList & devices )
+{
+	_devices = &devices;
+
+	Color black( 0, 0, 0 );
+	_result.resize( devices.size() );
+	_next.resize( devices.size() );
+	for (size_t deviceIdx = 0; deviceIdx < devices.size(); ++deviceIdx)
+	{
+		_result[ deviceIdx ].assign( devices[ deviceIdx ].leds.size(), black );
+		_next[ deviceIdx ].assign( devices[ deviceIdx ].leds.size(), black );
+	}
+	_changed.assign( devices.size(), true );
+	_unsent.assign( devices.size(), true );
+	_compositeTasks.reserve( devices.size() );
+	splitIntoParts();
+
+	for (LayerEntry & entry : _layers)
+	{
+		entry.canvas.assign( devices );
+		entry.layer->reset( entry.canvas );
+	}
+	_recompositeAll = true;
+}
+
+void EffectEngine::setSplitThreshold( uint32_t ledCount )
+{
+	_splitThreshold = std::max( ledCount, 1u );
+	if (_devices)
+	{
+		splitIntoParts();
+	}
+}
+
+// the zone's LEDs that the device really has, a malformed zone may reach past the end of Device::leds
+static uint32_t zoneLedCount( const Zone & zone, uint32_t deviceLedCount ) noexcept
+{
+	return zone.startIdx < deviceLedCount ? std::min( zone.leds_count, deviceLedCount - zone.startIdx ) : 0;
+}
+
+void EffectEngine::splitIntoParts()
+{
+	_parts.clear();
+	for (uint32_t deviceIdx = 0; deviceIdx < _devices->size(); ++deviceIdx)
+	{
+		const Device & device = (*_devices)[ deviceIdx ];
+		const uint32_t deviceLedCount = uint32_t( device.leds.size() );
+		if (deviceLedCount == 0)
+			continue;
+
+		size_t ledsInZones = 0;
+		for (const Zone & zone : device.zones)
+			ledsInZones += zoneLedCount( zone, deviceLedCount );
+
+		if (deviceLedCount <= _splitThreshold || ledsInZones != deviceLedCount)
+		{
+			_parts.push_back({ &device, deviceIdx, nullptr, 0, deviceLedCount });
+			continue;
+		}
+
+		for (const Zone & zone : device.zones)
+		{
+			// ranges of equal size, so that no thread gets a tiny leftover
+			const uint32_t ledCount = zoneLedCount( zone, deviceLedCount );
+			const uint32_t rangeCount = ledCount / _splitThreshold + (ledCount % _splitThreshold != 0 ? 1 : 0);
+			for (uint32_t i = 0; i < rangeCount; ++i)
+			{
+				uint32_t begin = uint32_t( uint64_t( ledCount ) * i / rangeCount );
+				uint32_t end = uint32_t( uint64_t( ledCount ) * (i + 1) / rangeCount );
+				_parts.push_back({ &device, deviceIdx, &zone, zone.startIdx + begin, end - begin });
+			}
+		}
+	}
+}
+
+Layer & EffectEngine::addLayer( unique_ptr< Layer > layer )
+{
+	LayerEntry entry;
+	entry.layer = std::move( layer );
+	if (_devices)
+	{
+		entry.canvas.assign( *_devices );
+		entry.layer->reset( entry.canvas );
+	}
+	_layers.push_back( std::move( entry ) );
+	_recompositeAll = true;
+	return *_layers.back().layer;
+}
+
+void EffectEngine::removeLayer( const Layer & layer )
+{
+	auto iter = std::find_if( _layers.begin(), _layers.end(), [ &layer ]( const LayerEntry & entry )
+	{
+		return entry.layer.get() == &layer;
+	});
+	if (iter != _layers.end())
+	{
+		_layers.erase( iter );
+		_recompositeAll = true;
+	}
+}
+
+template< typename Task >
+void EffectEngine::runTasks( size_t taskCount, Task && task )
+{
+	if (_executor)
+	{
+		_executor->run( taskCount, task );
+	}
+	else
+	{
+		for (size_t taskIdx = 0; taskIdx < taskCount; ++taskIdx)
+			task( taskIdx, 0 );
+	}
+}
+
+void EffectEngine::renderPart( size_t taskIdx, unsigned threadIdx, double time ) noexcept
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	const RenderTask & task = _renderTasks[ taskIdx ];
+	const RenderPart & part = _parts[ task.partIdx ];
+	ParallelLayer & layer = static_cast< ParallelLayer & >( *task.entry->layer );
+	Color * colors = task.entry->canvas._frames[ part.deviceIdx ].data() + part.firstLed;
+	layer.renderPart( part, colors, time );
+
+	_timings[ taskIdx ] = { &layer, part.deviceIdx, part.firstLed, part.ledCount, uint32_t( threadIdx ),
+		std::chrono::steady_clock::now() - start };
+}
+
+void EffectEngine::composite( uint32_t deviceIdx ) noexcept
+{
+	vector< Color > & next = _next[ deviceIdx ];
+	vector< Color > & result = _result[ deviceIdx ];
+
+	Color black( 0, 0, 0 );
+	colorops::fill( next.data(), next.size(), black );
+
+	for (const LayerEntry & entry : _layers)
+	{
+		const Layer & layer = *entry.layer;
+		if (!layer.isEnabled() || layer.opacity() == 0)
+			continue;
+
+		colorops::blend( next.data(), entry.canvas.frame( deviceIdx ), next.size(), layer.blendMode(), layer.opacity() );
+	}
+
+	if (memcmp( next.data(), result.data(), result.size() * sizeof( Color ) ) != 0)
+	{
+		result.swap( next );
+		_changed[ deviceIdx ] = true;
+		_unsent[ deviceIdx ] = true;
+	}
+}
+
+const vector< uint8_t > & EffectEngine::render( double time )
+{
+	_stats = FrameStats();
+	_timings.clear();
+	std::fill( _changed.begin(), _changed.end(), uint8_t( false ) );
+	if (!_devices)
+	{
+		return _changed;
+	}
+
+	// sequential layers draw right away, parallel ones only prepare the frame and their parts become tasks
+	bool recompositeAll = _recompositeAll;
+	uint32_t visibleLayers = 0;
+	_renderTasks.clear();
+	for (LayerEntry & entry : _layers)
+	{
+		Layer & layer = *entry.layer;
+		if (layer.isEnabled())
+		{
+			layer.render( entry.canvas, time );
+			if (layer._isParallel)
+			{
+				for (uint32_t partIdx = 0; partIdx < _parts.size(); ++partIdx)
+					_renderTasks.push_back({ &entry, partIdx });
+				// marked here, because the flags are shared by the parts of a device
+				for (uint32_t deviceIdx = 0; deviceIdx < entry.canvas.deviceCount(); ++deviceIdx)
+					entry.canvas.draw( deviceIdx );
+			}
+			if (layer.opacity() > 0)
+				visibleLayers++;
+		}
+		recompositeAll |= layer._propertiesChanged;
+	}
+
+	_timings.resize( _renderTasks.size() );
+	runTasks( _renderTasks.size(), [ this, time ]( size_t taskIdx, unsigned threadIdx )
+	{
+		renderPart( taskIdx, threadIdx, time );
+	});
+
+	_compositeTasks.clear();
+	for (uint32_t deviceIdx = 0; deviceIdx < _result.size(); ++deviceIdx)
+	{
+		bool needsComposition = recompositeAll;
+		for (size_t i = 0; i < _layers.size() && !needsComposition; ++i)
+		{
+			needsComposition = _layers[i].layer->isEnabled() && _layers[i].canvas.isChanged( deviceIdx );
+		}
+		// otherwise none of the layers has changed this device, the result stays the same
+		if (needsComposition)
+		{
+			_compositeTasks.push_back( deviceIdx );
+			_stats.devicesComposited++;
+			_stats.ledsComposited += uint32_t( _result[ deviceIdx ].size() ) * visibleLayers;
+		}
+	}
+
+	const size_t firstCompositeTiming = _timings.size();
+	_timings.resize( firstCompositeTiming + _compositeTasks.size() );
+	runTasks( _compositeTasks.size(), [ this, firstCompositeTiming ]( size_t taskIdx, unsigned threadIdx )
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const uint32_t deviceIdx = _compositeTasks[ taskIdx ];
+		composite( deviceIdx );
+		_timings[ firstCompositeTiming + taskIdx ] = { nullptr, deviceIdx, 0, uint32_t( _result[ deviceIdx ].size() ),
+			uint32_t( threadIdx ), std::chrono::steady_clock::now() - start };
+	});
+
+	for (LayerEntry & entry : _layers)
+	{
+		entry.canvas.resetChanges();
+		entry.layer->_propertiesChanged = false;
+	}
+	_recompositeAll = false;
+
+	return _changed;
+}
+
+RequestStatus EffectEngine::update( Client & client, double time )
+{
+	render( time );
+	return send( client );
+}
+
+RequestStatus EffectEngine::send( Client & client )
+{
+	for (uint32_t deviceIdx = 0; deviceIdx < _unsent.size(); ++deviceIdx)
+	{
+		if (!_unsent[ deviceIdx ])
+			continue;
+
+		RequestStatus status = client.setDeviceColors( (*_devices)[ deviceIdx ], _result[ deviceIdx ] );
+		if (status != RequestStatus::Success)
+		{
+			return status;
+		}
+		_unsent[ deviceIdx ] = false;
+		_stats.devicesSent++;
+	}
+
+	return RequestStatus::Success;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,402 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: averaging areas of images or video frames into colors of LEDs for ambient lighting
+//======================================================================================================================
+
+#include "OpenRGB/FrameSampler.hpp"
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ColorOps.hpp"
+#include "LangUtils.hpp"
+
+#include <cstdio>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#ifdef _WIN32
+	#include <io.h>     // _setmode, _fileno
+	#include <fcntl.h>  // _O_BINARY
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  FrameSampler
+
+void FrameSampler::setDevices( const DeviceList & devices )
+{
+	_areas.clear();
+	_order.clear();
+	_active.clear();
+	_sums.clear();
+	_frames.clear();
+	_frames.resize( devices.size() );
+	for (size_t deviceIdx = 0; deviceIdx < devices.size(); ++deviceIdx)
+	{
+		_frames[ deviceIdx ].resize( devices[ deviceIdx ].leds.size() );
+	}
+	_imageWidth = 0;
+}
+
+void FrameSampler::resizeFrame( uint32_t deviceIdx, uint32_t ledCount )
+{
+	if (_frames.size() <= deviceIdx)
+	{
+		_frames.resize( deviceIdx + 1 );
+	}
+	if (_frames[ deviceIdx ].size() < ledCount)
+	{
+		_frames[ deviceIdx ].resize( ledCount );
+	}
+}
+
+void FrameSampler::addArea( uint32_t deviceIdx, uint32_t ledIdx, const ImageArea & area )
+{
+	resizeFrame( deviceIdx, ledIdx + 1 );
+
+	Area newArea;
+	newArea.deviceIdx = deviceIdx;
+	newArea.ledIdx = ledIdx;
+	newArea.relative = area;
+	newArea.left = newArea.top = newArea.width = newArea.height = 0;
+	_areas.push_back( newArea );
+	_order.push_back( uint32_t( _areas.size() - 1 ) );
+	_active.resize( _areas.size() );
+	_sums.resize( _areas.size() );
+
+	_imageWidth = 0;  // the new area needs its rectangle
+}
+
+void FrameSampler::addMatrix( const Zone & zone, const ImageArea & area )
+{
+	if (zone.matrix_leds.empty() || zone.matrix_width == 0 || zone.matrix_height == 0)
+	{
+		// not a matrix, so it's at least sampled as a single row
+		const float cellWidth = area.width / float( std::max( zone.leds_count, 1u ) );
+		for (uint32_t i = 0; i < zone.leds_count; ++i)
+		{
+			addArea( zone.parentIdx, zone.startIdx + i, ImageArea( area.x + float( i ) * cellWidth, area.y, cellWidth, area.height ) );
+		}
+		return;
+	}
+
+	const float cellWidth = area.width / float( zone.matrix_width );
+	const float cellHeight = area.height / float( zone.matrix_height );
+	for (uint32_t row = 0; row < zone.matrix_height; ++row)
+	{
+		for (uint32_t col = 0; col < zone.matrix_width; ++col)
+		{
+			uint32_t ledIdx = zone.ledAt( row, col );
+			if (ledIdx == Zone::noLED)
+				continue;
+			addArea( zone.parentIdx, ledIdx, ImageArea( area.x + float( col ) * cellWidth, area.y + float( row ) * cellHeight, cellWidth, cellHeight ) );
+		}
+	}
+}
+
+void FrameSampler::addStrip( uint32_t deviceIdx, uint32_t firstLed, uint32_t ledCount, Edge edge, float depth, float from, float to )
+{
+	const float step = (to - from) / float( std::max( ledCount, 1u ) );
+	for (uint32_t i = 0; i < ledCount; ++i)
+	{
+		// the start and the end of the LED's part of the edge, in the clockwise direction
+		const float start = from + float( i ) * step;
+		const float end = start + step;
+		ImageArea area;
+		switch (edge)
+		{
+			case Edge::Top:     area = ImageArea( start, 0.0f, end - start, depth );  break;
+			case Edge::Right:   area = ImageArea( 1.0f - depth, start, depth, end - start );  break;
+			case Edge::Bottom:  area = ImageArea( 1.0f - end, 1.0f - depth, end - start, depth );  break;
+			case Edge::Left:    area = ImageArea( 0.0f, 1.0f - end, depth, end - start );  break;
+		}
+		addArea( deviceIdx, firstLed + i, area );
+	}
+}
+
+void FrameSampler::clearAreas() noexcept
+{
+	_areas.clear();
+	_order.clear();
+	_active.clear();
+	_sums.clear();
+	for (vector< Color > & frame : _frames)
+	{
+		std::fill( frame.begin(), frame.end(), Color::Black );
+	}
+}
+
+// converts a relative range to pixels, an area smaller than a pixel still gets the nearest one
+static void toPixels( float start, float size, uint32_t imageSize, uint32_t & first, uint32_t & count ) noexcept
+{
+	float end = std::min( std::max( start + size, 0.0f ), 1.0f );
+	start = std::min( std::max( start, 0.0f ), 1.0f );
+	uint32_t firstPixel = uint32_t( std::lround( start * float( imageSize ) ) );
+	uint32_t endPixel = uint32_t( std::lround( end * float( imageSize ) ) );
+	if (endPixel <= firstPixel)
+	{
+		endPixel = std::min( firstPixel + 1, imageSize );
+		firstPixel = endPixel - 1;
+	}
+	first = firstPixel;
+	count = endPixel - firstPixel;
+}
+
+void FrameSampler::computeRectangles( uint32_t imageWidth, uint32_t imageHeight ) noexcept
+{
+	for (Area & area : _areas)
+	{
+		toPixels( area.relative.x, area.relative.width, imageWidth, area.left, area.width );
+		toPixels( area.relative.y, area.relative.height, imageHeight, area.top, area.height );
+	}
+	// the image is then read row by row from the top, each row once for all the areas it crosses
+	std::sort( _order.begin(), _order.end(), [this]( uint32_t a, uint32_t b )
+	{
+		return _areas[a].top != _areas[b].top ? _areas[a].top < _areas[b].top : _areas[a].left < _areas[b].left;
+	});
+	_imageWidth = imageWidth;
+	_imageHeight = imageHeight;
+}
+
+void FrameSampler::sample( const ImageView & image ) noexcept
+{
+	if (image.width == 0 || image.height == 0 || !image.pixels)
+	{
+		return;
+	}
+	if (image.width != _imageWidth || image.height != _imageHeight)
+	{
+		computeRectangles( image.width, image.height );
+	}
+
+	const uint32_t pixelSize = bytesPerPixel( image.format );
+	const bool isBGR = image.format == PixelFormat::BGR24 || image.format == PixelFormat::BGRA32;
+	const uint32_t redIdx = isBGR ? 2 : 0;
+	const uint32_t blueIdx = isBGR ? 0 : 2;
+
+	// Going through the image from the top to the bottom reads the memory sequentially, which the CPU prefetches,
+	// and the cache lines on the borders of neighbouring areas are loaded only once.
+	std::fill( _sums.begin(), _sums.end(), Sums() );
+	size_t activeCount = 0;
+	size_t nextArea = 0;
+	uint32_t y = 0;
+	while (nextArea < _order.size() || activeCount > 0)
+	{
+		if (activeCount == 0)
+		{
+			y = _areas[ _order[ nextArea ] ].top;  // skip the rows without any area
+		}
+		while (nextArea < _order.size() && _areas[ _order[ nextArea ] ].top == y)
+		{
+			_active[ activeCount ].areaIdx = _order[ nextArea++ ];
+			_active[ activeCount ].nextRow = y;
+			++activeCount;
+		}
+
+		// the next row to sum is where a new area starts or the next row of an active area by the row step
+		uint32_t nextY = nextArea < _order.size() ? _areas[ _order[ nextArea ] ].top : UINT32_MAX;
+		const uint8_t * row = image.pixels + y * image.stride;
+		size_t keptCount = 0;
+		for (size_t i = 0; i < activeCount; ++i)
+		{
+			ActiveArea active = _active[i];
+			if (active.nextRow == y)
+			{
+				const Area & area = _areas[ active.areaIdx ];
+				colorops::sumPixels( row + area.left * pixelSize, area.width, pixelSize, _sums[ active.areaIdx ].channels );
+				if (area.top + area.height - y <= _rowStep)
+					continue;  // that was its last row
+				active.nextRow = y + _rowStep;
+			}
+			_active[ keptCount++ ] = active;
+			nextY = std::min( nextY, active.nextRow );
+		}
+		activeCount = keptCount;
+		y = nextY;
+	}
+
+	for (size_t areaIdx = 0; areaIdx < _areas.size(); ++areaIdx)
+	{
+		const Area & area = _areas[ areaIdx ];
+		const uint32_t * sums = _sums[ areaIdx ].channels;
+		const uint32_t rowCount = (area.height + _rowStep - 1) / _rowStep;
+		const uint32_t pixelCount = rowCount * area.width;
+		const uint32_t rounding = pixelCount / 2;
+		_frames[ area.deviceIdx ][ area.ledIdx ] = Color(
+			uint8_t( (sums[ redIdx ] + rounding) / pixelCount ),
+			uint8_t( (sums[1] + rounding) / pixelCount ),
+			uint8_t( (sums[ blueIdx ] + rounding) / pixelCount )
+		);
+	}
+}
+
+
+//======================================================================================================================
+//  RawFrameReader
+
+const char * enumString( FrameStatus status ) noexcept
+{
+	static const char * const FrameStatusStr [] =
+	{
+		"The operation was successful.",
+		"All the frames of the stream have been read.",
+		"The file could not be opened.",
+		"The shared memory is smaller than one frame.",
+		"Reading the stream has failed.",
+	};
+	static_assert( size_t(FrameStatus::ReadError) + 1 == fut::size(FrameStatusStr), "update the FrameStatusStr" );
+
+	if (size_t(status) < fut::size(FrameStatusStr))
+	{
+		return FrameStatusStr[ size_t(status) ];
+	}
+	else
+	{
+		return "<invalid status>";
+	}
+}
+
+RawFrameReader::RawFrameReader() noexcept
+	: _file( nullptr ), _ownsFile( false ), _isShared( false ), _sharedOffset( 0 ), _lastSystemError( 0 )
+{}
+
+RawFrameReader::~RawFrameReader() noexcept
+{
+	close();
+}
+
+FrameStatus RawFrameReader::open( const string & path, uint32_t width, uint32_t height, PixelFormat format )
+{
+	close();
+
+	if (path == "-")
+	{
+	 #ifdef _WIN32
+		_setmode( _fileno( stdin ), _O_BINARY );  // otherwise the bytes of CR LF would be merged
+	 #endif
+		_file = stdin;
+		_ownsFile = false;
+	}
+	else
+	{
+		_file = fopen( path.c_str(), "rb" );
+		if (!_file)
+		{
+			_lastSystemError = system_error_t( errno );
+			return FrameStatus::CannotOpen;
+		}
+		_ownsFile = true;
+	}
+
+	_frame = ImageView( nullptr, width, height, format );
+	_buffer.resize( _frame.byteCount() );
+	_frame.pixels = _buffer.data();
+	return FrameStatus::Success;
+}
+
+FrameStatus RawFrameReader::openShared( const string & path, uint32_t width, uint32_t height, PixelFormat format, size_t offset )
+{
+	close();
+
+	FILE * file = fopen( path.c_str(), "rb" );
+	if (!file)
+	{
+		_lastSystemError = system_error_t( errno );
+		return FrameStatus::CannotOpen;
+	}
+	// every read() seeks back to the frame, a stdio buffer would only be an extra copy
+	setvbuf( file, nullptr, _IONBF, 0 );
+
+	_frame = ImageView( nullptr, width, height, format );
+	long fileSize = fseek( file, 0, SEEK_END ) == 0 ? ftell( file ) : -1;
+	if (fileSize < 0 || offset > size_t( LONG_MAX ) || size_t( fileSize ) < offset || size_t( fileSize ) - offset < _frame.byteCount())
+	{
+		fclose( file );
+		_frame = ImageView();
+		return FrameStatus::TooSmall;
+	}
+
+	_file = file;
+	_ownsFile = true;
+	_isShared = true;
+	_sharedOffset = offset;
+	_buffer.resize( _frame.byteCount() );
+	_frame.pixels = _buffer.data();
+	return FrameStatus::Success;
+}
+
+void RawFrameReader::close() noexcept
+{
+	if (_file && _ownsFile)
+	{
+		fclose( _file );
+	}
+	_file = nullptr;
+	_ownsFile = false;
+	_isShared = false;
+	_sharedOffset = 0;
+	_frame = ImageView();
+}
+
+FrameStatus RawFrameReader::read( ImageView & image )
+{
+	if (!_file)
+	{
+		return FrameStatus::ReadError;
+	}
+
+	// The shared memory is read again instead of being mapped, because when the producer truncates it,
+	// accessing the pages of a mapping beyond the new end kills the process by SIGBUS.
+	if (_isShared)
+	{
+		if (fseek( _file, long( _sharedOffset ), SEEK_SET ) != 0)
+		{
+			_lastSystemError = system_error_t( errno );
+			return FrameStatus::ReadError;
+		}
+		size_t bytesRead = fread( _buffer.data(), 1, _buffer.size(), _file );
+		if (bytesRead < _buffer.size())
+		{
+			if (ferror( _file ))
+			{
+				_lastSystemError = system_error_t( errno );
+				clearerr( _file );
+				return FrameStatus::ReadError;
+			}
+			return FrameStatus::TooSmall;  // the producer may be just rewriting it, the next read can succeed
+		}
+		image = _frame;
+		return FrameStatus::Success;
+	}
+
+	size_t bytesRead = fread( _buffer.data(), 1, _buffer.size(), _file );
+	if (bytesRead < _buffer.size())
+	{
+		if (ferror( _file ))
+		{
+			_lastSystemError = system_error_t( errno );
+			return FrameStatus::ReadError;
+		}
+		return FrameStatus::EndOfStream;  // an incomplete frame can only be at the end of the stream
+	}
+
+	image = _frame;
+	return FrameStatus::Success;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,156 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: spatial layout of the LEDs for position-based effects
+//======================================================================================================================
+
+#include "OpenRGB/LayoutMap.hpp"
+
+#include "Essential.hpp"
+
+#include <algorithm>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+void LayoutMap::clear() noexcept
+{
+	_placements.clear();
+	_deviceLeds.clear();
+	_localX.clear();
+	_localY.clear();
+	_linear.clear();
+	_x.clear();
+	_y.clear();
+	_width = 0.0f;
+	_height = 0.0f;
+}
+
+void LayoutMap::assign( const DeviceList & devices )
+{
+	clear();
+
+	size_t totalLeds = 0;
+	for (const Device & device : devices)
+		totalLeds += device.leds.size();
+
+	_placements.reserve( devices.size() );
+	_deviceLeds.reserve( devices.size() );
+	_localX.resize( totalLeds, 0.5f );
+	_localY.resize( totalLeds, 0.5f );
+	_linear.resize( totalLeds, 0.5f );
+
+	uint32_t firstLed = 0;
+	for (const Device & device : devices)
+	{
+		_placements.push_back({ 0.0f, float( _placements.size() ), 1.0f, 1.0f });
+		_deviceLeds.push_back({ firstLed, uint32_t( device.leds.size() ) });
+
+		// each zone gets as many rows as it needs and all of them together fill the height of the device
+		uint32_t totalRows = 0;
+		for (const Zone & zone : device.zones)
+			totalRows += zone.type == ZoneType::Matrix && zone.matrix_height > 0 ? zone.matrix_height : 1;
+
+		float * localX = _localX.data() + firstLed;
+		float * localY = _localY.data() + firstLed;
+		float * linear = _linear.data() + firstLed;
+		uint32_t zoneRow = 0;
+		for (const Zone & zone : device.zones)
+		{
+			uint32_t zoneRows = zone.type == ZoneType::Matrix && zone.matrix_height > 0 ? zone.matrix_height : 1;
+			float rowHeight = 1.0f / float( totalRows );
+			float zoneTop = float( zoneRow ) * rowHeight;
+			zoneRow += zoneRows;
+
+			// the server may report more LEDs in the zones than the device has, even so many that the sum overflows
+			uint32_t deviceLedCount = uint32_t( device.leds.size() );
+			uint32_t zoneLedCount = zone.startIdx < deviceLedCount ? std::min( zone.leds_count, deviceLedCount - zone.startIdx ) : 0;
+
+			// by default spread the LEDs evenly in a line through the middle of the zone
+			for (uint32_t i = 0; i < zoneLedCount; ++i)
+			{
+				float pos = (float( i ) + 0.5f) / float( zoneLedCount );
+				localX[ zone.startIdx + i ] = zone.type == ZoneType::Single ? 0.5f : pos;
+				localY[ zone.startIdx + i ] = zoneTop + 0.5f * float( zoneRows ) * rowHeight;
+				linear[ zone.startIdx + i ] = pos;
+			}
+
+			// and then move those that have a position in the matrix
+			for (uint32_t row = 0; row < zone.matrix_height && !zone.matrix_leds.empty(); ++row)
+			{
+				for (uint32_t col = 0; col < zone.matrix_width; ++col)
+				{
+					uint32_t ledIdx = zone.ledAt( row, col );
+					if (ledIdx == Zone::noLED)
+						continue;
+					localX[ ledIdx ] = (float( col ) + 0.5f) / float( zone.matrix_width );
+					localY[ ledIdx ] = zoneTop + (float( row ) + 0.5f) * rowHeight;
+				}
+			}
+		}
+
+		firstLed += uint32_t( device.leds.size() );
+	}
+
+	_x.resize( totalLeds );
+	_y.resize( totalLeds );
+	updatePlaneCoords();
+}
+
+void LayoutMap::placeDevice( uint32_t deviceIdx, const DevicePlacement & placement )
+{
+	_placements[ deviceIdx ] = placement;
+	updatePlaneCoords();
+}
+
+void LayoutMap::updatePlaneCoords() noexcept
+{
+	if (_placements.empty())
+	{
+		_width = _height = 0.0f;
+		return;
+	}
+
+	float minX = _placements[0].x, maxX = _placements[0].x + _placements[0].width;
+	float minY = _placements[0].y, maxY = _placements[0].y + _placements[0].height;
+	for (const DevicePlacement & placement : _placements)
+	{
+		minX = std::min( minX, placement.x );
+		minY = std::min( minY, placement.y );
+		maxX = std::max( maxX, placement.x + placement.width );
+		maxY = std::max( maxY, placement.y + placement.height );
+	}
+
+	// scale both axes by the same factor to keep the proportions
+	float scale = std::max( maxX - minX, maxY - minY );
+	if (scale <= 0.0f)
+		scale = 1.0f;
+	_width = (maxX - minX) / scale;
+	_height = (maxY - minY) / scale;
+
+	for (uint32_t deviceIdx = 0; deviceIdx < _placements.size(); ++deviceIdx)
+	{
+		const DevicePlacement & placement = _placements[ deviceIdx ];
+		float offsetX = (placement.x - minX) / scale;
+		float offsetY = (placement.y - minY) / scale;
+		float scaleX = placement.width / scale;
+		float scaleY = placement.height / scale;
+
+		IndexRange leds = _deviceLeds[ deviceIdx ];
+		for (uint32_t i = leds.first; i < leds.end(); ++i)
+		{
+			_x[i] = offsetX + _localX[i] * scaleX;
+			_y[i] = offsetY + _localY[i] * scaleY;
+		}
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,134 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: read-only memory mapping of a file
+//======================================================================================================================
+
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <io.h>  // _get_osfhandle
+#else
+	#include <sys/mman.h>
+	#include <cerrno>
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+MappedFile::MappedFile() noexcept
+:
+	_isOpen( false ),
+	_data( nullptr ),
+	_size( 0 ),
+	_lastSystemError( 0 )
+#ifdef _WIN32
+	,_mappingHandle( nullptr )
+#endif
+{}
+
+MappedFile::~MappedFile() noexcept
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::map( int fd, size_t fileSize ) noexcept
+{
+	close();
+
+	// an empty file can't be mapped, but there is nothing to read from it anyway
+	if (fileSize > 0)
+	{
+		HANDLE file = reinterpret_cast< HANDLE >( _get_osfhandle( fd ) );
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			_lastSystemError = ERROR_INVALID_HANDLE;
+			return false;
+		}
+
+		// the mapping object keeps the file open after the descriptor is closed
+		HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+		if (!mapping)
+		{
+			_lastSystemError = GetLastError();
+			return false;
+		}
+
+		void * view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, fileSize );
+		if (!view)
+		{
+			_lastSystemError = GetLastError();
+			CloseHandle( mapping );
+			return false;
+		}
+
+		_mappingHandle = mapping;
+		_data = static_cast< const uint8_t * >( view );
+	}
+
+	_size = fileSize;
+	_isOpen = true;
+	return true;
+}
+
+void MappedFile::close() noexcept
+{
+	if (_data)
+		UnmapViewOfFile( _data );
+	if (_mappingHandle)
+		CloseHandle( _mappingHandle );
+
+	_isOpen = false;
+	_data = nullptr;
+	_size = 0;
+	_mappingHandle = nullptr;
+}
+
+#else // POSIX
+
+bool MappedFile::map( int fd, size_t fileSize ) noexcept
+{
+	close();
+
+	// an empty file can't be mapped, but there is nothing to read from it anyway
+	if (fileSize > 0)
+	{
+		void * mapping = mmap( nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0 );
+		if (mapping == MAP_FAILED)
+		{
+			_lastSystemError = errno;
+			return false;
+		}
+		_data = static_cast< const uint8_t * >( mapping );
+	}
+
+	// the mapping stays valid even after the file descriptor is closed
+	_size = fileSize;
+	_isOpen = true;
+	return true;
+}
+
+void MappedFile::close() noexcept
+{
+	if (_data)
+		munmap( const_cast< uint8_t * >( _data ), _size );
+
+	_isOpen = false;
+	_data = nullptr;
+	_size = 0;
+}
+
+#endif // _WIN32
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
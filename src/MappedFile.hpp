@@ -0,0 +1,74 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: read-only memory mapping of a file
+//======================================================================================================================
+
+#ifndef OPENRGB_MAPPED_FILE_INCLUDED
+#define OPENRGB_MAPPED_FILE_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "OpenRGB/SystemErrorType.hpp"
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Read-only memory mapping of a whole file.
+/** The content is loaded by the operating system on demand, so mapping even a large file is cheap.
+  * The file is given as an already opened file descriptor, so that the caller can check what file it is
+  * before anything is read from it. */
+
+class MappedFile
+{
+
+ public:
+
+	MappedFile() noexcept;
+	~MappedFile() noexcept;
+
+	MappedFile( const MappedFile & other ) = delete;
+	MappedFile & operator=( const MappedFile & other ) = delete;
+
+	/// Maps the whole content of an opened file into memory.
+	/** The file descriptor remains owned by the caller and can be closed right away, the mapping stays valid.
+	  * \param fd file descriptor opened for reading, on Windows the one returned by _open()
+	  * \param fileSize current size of the file
+	  * \returns false when the file can't be mapped, call lastSystemError() for more info. */
+	bool map( int fd, size_t fileSize ) noexcept;
+
+	void close() noexcept;
+
+	bool isOpen() const noexcept  { return _isOpen; }
+
+	/// Address of the mapped content, nullptr if the file is empty.
+	const uint8_t * data() const noexcept  { return _data; }
+	size_t size() const noexcept  { return _size; }
+
+	system_error_t lastSystemError() const noexcept  { return _lastSystemError; }
+
+ private:
+
+	bool _isOpen;
+	const uint8_t * _data;
+	size_t _size;
+	system_error_t _lastSystemError;
+
+#ifdef _WIN32
+	void * _mappingHandle;
+#endif
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_MAPPED_FILE_INCLUDED
@@ -26,5 +26,15 @@ void indent( std::ostream & os, unsigned int indentLevel )
 		os << '\t';
 }
 
+uint64_t hashBytes( const uint8_t * data, size_t size, uint64_t hash ) noexcept
+{
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001B3;
+	}
+	return hash;
+}
+
 
 } // namespace orgb
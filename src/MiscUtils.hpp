@@ -12,6 +12,8 @@
 #include "Essential.hpp"
 
 #include <iosfwd>
+#include <cstdint>
+#include <cstddef>
 
 
 namespace orgb {
@@ -21,6 +23,10 @@ void indent( unsigned int indentLevel );
 
 void indent( std::ostream & os, unsigned int indentLevel );
 
+/// 64-bit FNV-1a hash of a block of bytes, good enough for detecting changed content, not for security.
+/** \param hash result of hashing the previous block, when multiple blocks should be hashed as if they were one */
+uint64_t hashBytes( const uint8_t * data, size_t size, uint64_t hash = 0xCBF29CE484222325 ) noexcept;
+
 
 } // namespace orgb
 
@@ -0,0 +1,111 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: color gradients sampled through a precomputed table
+//======================================================================================================================
+
+#include "OpenRGB/Palette.hpp"
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ColorOps.hpp"
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+static Color stopColor( const PaletteStop & stop ) noexcept
+{
+	return Color( stop.r, stop.g, stop.b );
+}
+
+// value between a and b at the distance (index - start) / (end - start), rounded to the nearest integer
+static uint8_t interpolate( uint8_t a, uint8_t b, uint32_t index, uint32_t start, uint32_t end ) noexcept
+{
+	uint32_t length = end - start;
+	return uint8_t( (a * (end - index) + b * (index - start) + length / 2) / length );
+}
+
+Palette::Palette() noexcept
+{
+	Color black( 0, 0, 0 );
+	colorops::fill( _table, TableSize + 1, black );
+}
+
+Palette::Palette( const PaletteStop * stops, size_t stopCount ) noexcept
+{
+	if (stopCount == 0)
+	{
+		Color black( 0, 0, 0 );
+		colorops::fill( _table, TableSize + 1, black );
+		return;
+	}
+
+	size_t nextStop = 0;  // first stop whose position is above the index
+	for (uint32_t index = 0; index < TableSize; ++index)
+	{
+		while (nextStop < stopCount && stops[ nextStop ].position <= index)
+			++nextStop;
+
+		if (nextStop == 0)
+		{
+			_table[ index ] = stopColor( stops[0] );
+		}
+		else if (nextStop == stopCount)
+		{
+			_table[ index ] = stopColor( stops[ stopCount - 1 ] );
+		}
+		else
+		{
+			const PaletteStop & prev = stops[ nextStop - 1 ];
+			const PaletteStop & next = stops[ nextStop ];
+			Color & color = _table[ index ];
+			color.r = interpolate( prev.r, next.r, index, prev.position, next.position );
+			color.g = interpolate( prev.g, next.g, index, prev.position, next.position );
+			color.b = interpolate( prev.b, next.b, index, prev.position, next.position );
+			color.padding = 0;
+		}
+	}
+	_table[ TableSize ] = _table[ TableSize - 1 ];
+}
+
+Color Palette::sample( uint16_t position ) const noexcept
+{
+	const Color & a = _table[ position >> 8 ];
+	const Color & b = _table[ (position >> 8) + 1 ];
+	const uint32_t w = position & 0xFF;
+	Color color;
+	color.r = uint8_t( (a.r * (256 - w) + b.r * w) >> 8 );
+	color.g = uint8_t( (a.g * (256 - w) + b.g * w) >> 8 );
+	color.b = uint8_t( (a.b * (256 - w) + b.b * w) >> 8 );
+	color.padding = 0;
+	return color;
+}
+
+Color Palette::sample( float position ) const noexcept
+{
+	if (!(position > 0.0f))  // also catches NaN
+		return _table[0];
+	if (position >= 1.0f)
+		return _table[ TableSize - 1 ];
+	return sample( uint16_t( position * float( (TableSize - 1) << 8 ) + 0.5f ) );
+}
+
+void Palette::map( Color * dst, const uint8_t * indexes, size_t count ) const noexcept
+{
+	colorops::lookup( dst, indexes, count, _table );
+}
+
+void Palette::map( Color * dst, const uint16_t * positions, size_t count ) const noexcept
+{
+	colorops::lookupInterpolated( dst, positions, count, _table );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
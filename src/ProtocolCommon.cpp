@@ -7,9 +7,65 @@
 
 #include "ProtocolCommon.hpp"
 
+#include "OpenRGB/DeviceInfo.hpp"
+
 
 namespace orgb {
 
 
+//======================================================================================================================
+//  enum validation
+
+/*bool isValidDeviceType( DeviceType type )
+{
+	return size_t( type ) <= size_t( DeviceType::Unknown );
+}*/
+
+bool isValidDirection( Direction dir, uint32_t modeFlags )
+{
+	bool allowedDirections [ size_t( Direction::Vertical ) + 1 ] = {0};
+	bool hasAnyDirections = false;
+
+	if (modeFlags & ModeFlags::HasDirectionLR)
+	{
+		hasAnyDirections = true;
+		allowedDirections[ size_t( Direction::Left ) ] = true;
+		allowedDirections[ size_t( Direction::Right ) ] = true;
+	}
+	if (modeFlags & ModeFlags::HasDirectionUD)
+	{
+		hasAnyDirections = true;
+		allowedDirections[ size_t( Direction::Up ) ] = true;
+		allowedDirections[ size_t( Direction::Down ) ] = true;
+	}
+	if (modeFlags & ModeFlags::HasDirectionHV)
+	{
+		hasAnyDirections = true;
+		allowedDirections[ size_t( Direction::Horizontal ) ] = true;
+		allowedDirections[ size_t( Direction::Vertical ) ] = true;
+	}
+
+	// in case no direction flag is active, direction will be uninitialized value, so it can be anything
+	if (!hasAnyDirections)
+	{
+		return true;
+	}
+
+	return allowedDirections[ size_t( dir ) ] == true;
+}
+
+bool isValidColorMode( ColorMode mode )
+{
+	return size_t( mode ) <= size_t( ColorMode::Random );
+}
+
+bool isValidZoneType( ZoneType type )
+{
+	return size_t( type ) <= size_t( ZoneType::Matrix );
+}
+
+
+//======================================================================================================================
+
 
 } // namespace orgb
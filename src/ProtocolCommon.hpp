@@ -13,6 +13,9 @@
 #include "BinaryStream.hpp"
 MAKE_LITTLE_ENDIAN_DEFAULT
 
+#include "OpenRGB/StringTable.hpp"
+#include "OpenRGB/SmallVector.hpp"
+
 #include <cstring>
 #include <string>
 #include <vector>
@@ -21,6 +24,19 @@ MAKE_LITTLE_ENDIAN_DEFAULT
 namespace orgb {
 
 
+enum class Direction : uint32_t;
+enum class ColorMode : uint32_t;
+enum class ZoneType : uint32_t;
+
+
+//======================================================================================================================
+//  enum validation
+
+bool isValidDirection( Direction dir, uint32_t modeFlags );
+bool isValidColorMode( ColorMode mode );
+bool isValidZoneType( ZoneType type );
+
+
 //======================================================================================================================
 // Putting these template functions into a struct allows us to collectively mark them as friend and allow them to access
 // methods of Mode, Zone, LED that should be private to the user of the library, but accessible to the library itself.
@@ -51,6 +67,16 @@ struct protocol
 		return !stream.failed() && strlen( str.c_str() ) + 1 == size;
 	}
 
+	/// Reads the string into \p buffer and then stores only a handle to its single copy in \p table.
+	/** Only DeviceSnapshot reads its names this way, Device reads them into its own strings. */
+	static bool readString( own::BinaryInputStream & stream, StringTable & table, std::string & buffer, InternedString & str )
+	{
+		if (!readString( stream, buffer ))
+			return false;
+		str = table.intern( buffer );
+		return true;
+	}
+
 
 	//-- OpenRGB arrays ------------------------------------------------------------------------------------------------
 
@@ -81,6 +107,12 @@ struct protocol
 		return 2 + own::sizeofVector( vec );
 	}
 
+	template< typename Type, size_t N >
+	static size_t sizeofArray( const SmallVector< Type, N > & vec ) noexcept
+	{
+		return 2 + vec.size() * sizeof( Type );
+	}
+
 	static size_t sizeofArray( const std::vector< std::string > & vec ) noexcept
 	{
 		return 2 + sizeofVectorOfStrings( vec );
@@ -102,6 +134,16 @@ struct protocol
 		}
 	}
 
+	template< typename Type, size_t N >
+	static void writeArray( own::BinaryOutputStream & stream, const SmallVector< Type, N > & vec )
+	{
+		stream << uint16_t(vec.size());
+		for (const auto & elem : vec)
+		{
+			stream << elem;
+		}
+	}
+
 	static void writeArray( own::BinaryOutputStream & stream, const std::vector< std::string > & vec )
 	{
 		stream << uint16_t(vec.size());
@@ -136,6 +178,21 @@ struct protocol
 		return !stream.failed();
 	}
 
+	template< typename Type, size_t N >
+	static bool readArray( own::BinaryInputStream & stream, SmallVector< Type, N > & vec ) noexcept
+	{
+		uint16_t size = 0;
+		stream >> size;
+		vec.resize( size );
+		for (uint16_t i = 0; i < size; ++i)
+		{
+			stream >> vec[i];
+			if (stream.failed())
+				return false;
+		}
+		return !stream.failed();
+	}
+
 	static bool readArray( own::BinaryInputStream & stream, std::vector< std::string > & vec ) noexcept
 	{
 		uint16_t size = 0;
@@ -150,18 +207,31 @@ struct protocol
 		return !stream.failed();
 	}
 
+	/// The objects already present in the vector are overwritten in place, so that their strings and vectors re-use
+	/// the memory they have allocated before.
 	template< typename Type, REQUIRES( !std::is_trivial<Type>::value ) >
 	static bool readArray( own::BinaryInputStream & stream, std::vector< Type > & vec, uint32_t protocolVersion, uint32_t parentIdx ) noexcept
 	{
 		uint16_t size = 0;
 		stream >> size;
+		// the objects have const members, so they can't be assigned, only constructed or destroyed at the end
+		while (vec.size() > size)
+			vec.pop_back();
 		vec.reserve( size );
 		for (uint16_t i = 0; i < size; ++i)
 		{
-			Type obj;
-			if (!obj.deserialize( stream, protocolVersion, i, parentIdx ))
-				return false;
-			vec.emplace_back( move(obj) );
+			if (i < vec.size())
+			{
+				if (!vec[i].deserialize( stream, protocolVersion, i, parentIdx ))
+					return false;
+			}
+			else
+			{
+				Type obj;
+				if (!obj.deserialize( stream, protocolVersion, i, parentIdx ))
+					return false;
+				vec.emplace_back( move(obj) );
+			}
 		}
 		return !stream.failed();
 	}
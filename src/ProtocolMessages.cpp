@@ -153,10 +153,10 @@ void ReplyControllerData::serialize( BinaryOutputStream & stream, uint32_t proto
 	device_desc.serialize( stream, protocolVersion );
 }
 
-bool ReplyControllerData::deserializeBody( BinaryInputStream & stream, uint32_t protocolVersion ) noexcept
+bool ReplyControllerData::deserializeBody( BinaryInputStream & stream, uint32_t protocolVersion, const DeviceListOptions & options ) noexcept
 {
 	stream >> data_size;
-	device_desc.deserialize( stream, protocolVersion, header.device_idx );
+	device_desc.deserialize( stream, protocolVersion, header.device_idx, options );
 
 	return !stream.failed();
 }
@@ -252,7 +252,7 @@ struct ReplyControllerData
 
 	uint32_t calcDataSize( uint32_t protocolVersion ) const noexcept;
 	void serialize( own::BinaryOutputStream & stream, uint32_t protocolVersion ) const;
-	bool deserializeBody( own::BinaryInputStream & stream, uint32_t protocolVersion ) noexcept;
+	bool deserializeBody( own::BinaryInputStream & stream, uint32_t protocolVersion, const DeviceListOptions & options = DeviceListOptions() ) noexcept;
 };
 
 /// Tells the server in what version of the protocol the client wants to communite in.
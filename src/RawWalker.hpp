@@ -0,0 +1,88 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: bounds-checked walking through raw protocol data without parsing them
+//======================================================================================================================
+
+#ifndef OPENRGB_RAW_WALKER_INCLUDED
+#define OPENRGB_RAW_WALKER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+// The raw data are in little endian regardless of the CPU, so compose the integers byte by byte.
+
+inline uint16_t readU16( const uint8_t * ptr ) noexcept
+{
+	return uint16_t( ptr[0] | (ptr[1] << 8) );
+}
+
+inline uint32_t readU32( const uint8_t * ptr ) noexcept
+{
+	return uint32_t( ptr[0] ) | (uint32_t( ptr[1] ) << 8) | (uint32_t( ptr[2] ) << 16) | (uint32_t( ptr[3] ) << 24);
+}
+
+/// Walks through the raw data and checks that every field fits into the buffer.
+class RawWalker
+{
+	const std::vector< uint8_t > & _data;
+	size_t _pos;
+	bool _failed;
+
+ public:
+
+	RawWalker( const std::vector< uint8_t > & data, size_t startPos ) : _data( data ), _pos( startPos ), _failed( false ) {}
+
+	size_t pos() const  { return _pos; }
+	bool failed() const  { return _failed; }
+	void setFailed()  { _failed = true; }
+
+	void skip( size_t numBytes )
+	{
+		if (_failed || numBytes > _data.size() - _pos)
+			_failed = true;
+		else
+			_pos += numBytes;
+	}
+
+	uint16_t u16()
+	{
+		if (_failed || _data.size() - _pos < 2)
+			{ _failed = true; return 0; }
+		uint16_t val = readU16( _data.data() + _pos );
+		_pos += 2;
+		return val;
+	}
+
+	uint32_t u32()
+	{
+		if (_failed || _data.size() - _pos < 4)
+			{ _failed = true; return 0; }
+		uint32_t val = readU32( _data.data() + _pos );
+		_pos += 4;
+		return val;
+	}
+
+	void skipString()
+	{
+		uint16_t size = u16();
+		skip( size );
+	}
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_RAW_WALKER_INCLUDED
@@ -0,0 +1,211 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: pool of threads that run the tasks of a frame in parallel
+//======================================================================================================================
+
+#include "OpenRGB/RenderExecutor.hpp"
+
+#include "Essential.hpp"
+
+#include <algorithm>
+#include <new>  // placement new
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+static inline uint64_t packRange( uint32_t begin, uint32_t end ) noexcept
+{
+	return uint64_t( begin ) | (uint64_t( end ) << 32);
+}
+
+static inline uint32_t rangeBegin( uint64_t range ) noexcept
+{
+	return uint32_t( range );
+}
+
+static inline uint32_t rangeEnd( uint64_t range ) noexcept
+{
+	return uint32_t( range >> 32 );
+}
+
+constexpr size_t RenderExecutor::cacheLineSize;
+
+RenderExecutor::RenderExecutor( unsigned threadCount )
+:
+	_threadCount( threadCount != 0 ? threadCount : std::max( std::thread::hardware_concurrency(), 1u ) ),
+	_queueBuffer( new unsigned char [ _threadCount * sizeof( Queue ) + cacheLineSize - 1 ] ),
+	_queues( nullptr ),
+	_invoker( nullptr ),
+	_task( nullptr ),
+	_stolenCount( 0 ),
+	_batchNumber( 0 ),
+	_busyThreads( 0 ),
+	_stopping( false )
+{
+	uintptr_t bufferAddress = reinterpret_cast< uintptr_t >( _queueBuffer.get() );
+	uintptr_t alignedAddress = (bufferAddress + cacheLineSize - 1) & ~uintptr_t( cacheLineSize - 1 );
+	_queues = reinterpret_cast< Queue * >( alignedAddress );
+	for (unsigned i = 0; i < _threadCount; ++i)
+	{
+		new (&_queues[i]) Queue;
+		_queues[i].range.store( 0, std::memory_order_relaxed );
+	}
+
+	_threads.reserve( _threadCount - 1 );
+	try
+	{
+		for (unsigned threadIdx = 1; threadIdx < _threadCount; ++threadIdx)
+		{
+			_threads.emplace_back( &RenderExecutor::threadLoop, this, threadIdx );
+		}
+	}
+	catch (...)
+	{
+		// the destructor won't be called, the threads that have started would otherwise terminate the program
+		stopThreads();
+		throw;
+	}
+}
+
+RenderExecutor::~RenderExecutor() noexcept
+{
+	stopThreads();
+}
+
+void RenderExecutor::stopThreads() noexcept
+{
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		_stopping = true;
+	}
+	_batchStarted.notify_all();
+
+	for (std::thread & thread : _threads)
+	{
+		thread.join();
+	}
+}
+
+void RenderExecutor::runBatch( size_t taskCount, Invoker invoker, void * task )
+{
+	_stolenCount.store( 0, std::memory_order_relaxed );
+
+	// not worth waking up the threads
+	if (_threads.empty() || taskCount <= 1)
+	{
+		for (size_t taskIdx = 0; taskIdx < taskCount; ++taskIdx)
+		{
+			invoker( task, taskIdx, 0 );
+		}
+		return;
+	}
+
+	for (unsigned threadIdx = 0; threadIdx < _threadCount; ++threadIdx)
+	{
+		uint32_t begin = uint32_t( taskCount * threadIdx / _threadCount );
+		uint32_t end = uint32_t( taskCount * (threadIdx + 1) / _threadCount );
+		_queues[ threadIdx ].range.store( packRange( begin, end ), std::memory_order_relaxed );
+	}
+	_invoker = invoker;
+	_task = task;
+
+	// the mutex publishes the queues and the task to the threads
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		_busyThreads = unsigned( _threads.size() );
+		++_batchNumber;
+	}
+	_batchStarted.notify_all();
+
+	work( 0 );
+
+	std::unique_lock< std::mutex > lock( _mutex );
+	_batchFinished.wait( lock, [ this ]() { return _busyThreads == 0; } );
+}
+
+void RenderExecutor::threadLoop( unsigned threadIdx ) noexcept
+{
+	uint64_t lastBatch = 0;
+	while (true)
+	{
+		{
+			std::unique_lock< std::mutex > lock( _mutex );
+			_batchStarted.wait( lock, [ this, lastBatch ]() { return _stopping || _batchNumber != lastBatch; } );
+			if (_stopping)
+			{
+				return;
+			}
+			lastBatch = _batchNumber;
+		}
+
+		work( threadIdx );
+
+		bool isLast;
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			isLast = --_busyThreads == 0;
+		}
+		if (isLast)
+		{
+			_batchFinished.notify_one();
+		}
+	}
+}
+
+void RenderExecutor::work( unsigned threadIdx ) noexcept
+{
+	size_t taskIdx;
+	while (popOwn( threadIdx, taskIdx ))
+	{
+		_invoker( _task, taskIdx, threadIdx );
+	}
+	while (steal( threadIdx, taskIdx ))
+	{
+		_invoker( _task, taskIdx, threadIdx );
+		_stolenCount.fetch_add( 1, std::memory_order_relaxed );
+	}
+}
+
+bool RenderExecutor::popOwn( unsigned threadIdx, size_t & taskIdx ) noexcept
+{
+	std::atomic< uint64_t > & range = _queues[ threadIdx ].range;
+	uint64_t current = range.load( std::memory_order_relaxed );
+	while (rangeBegin( current ) < rangeEnd( current ))
+	{
+		if (range.compare_exchange_weak( current, packRange( rangeBegin( current ) + 1, rangeEnd( current ) ), std::memory_order_relaxed ))
+		{
+			taskIdx = rangeBegin( current );
+			return true;
+		}
+	}
+	return false;
+}
+
+bool RenderExecutor::steal( unsigned threadIdx, size_t & taskIdx ) noexcept
+{
+	for (unsigned i = 1; i < _threadCount; ++i)
+	{
+		std::atomic< uint64_t > & range = _queues[ (threadIdx + i) % _threadCount ].range;
+		uint64_t current = range.load( std::memory_order_relaxed );
+		while (rangeBegin( current ) < rangeEnd( current ))
+		{
+			if (range.compare_exchange_weak( current, packRange( rangeBegin( current ), rangeEnd( current ) - 1 ), std::memory_order_relaxed ))
+			{
+				taskIdx = rangeEnd( current ) - 1;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
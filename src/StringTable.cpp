@@ -0,0 +1,93 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: table of unique strings shared by many objects
+//======================================================================================================================
+
+#include "OpenRGB/StringTable.hpp"
+
+#include "MiscUtils.hpp"  // hashBytes
+
+#include <ostream>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  InternedString
+
+static const std::string emptyString;
+
+const std::string & InternedString::str() const noexcept
+{
+	return _str ? *_str : emptyString;
+}
+
+std::ostream & operator<<( std::ostream & os, InternedString str )
+{
+	return os << str.view();
+}
+
+
+//======================================================================================================================
+//  StringTable
+
+size_t StringTable::Hash::operator()( StringView str ) const noexcept
+{
+	return size_t( hashBytes( reinterpret_cast< const uint8_t * >( str.data() ), str.size() ) );
+}
+
+InternedString StringTable::intern( StringView str )
+{
+	if (str.empty())
+		return InternedString();
+
+	std::lock_guard< std::mutex > lock( _mutex );
+
+	auto iter = _lookup.find( str );
+	if (iter != _lookup.end())
+		return InternedString( iter->second );
+
+	_storage.emplace_back( str.data(), str.size() );
+	const std::string * stored = &_storage.back();
+	_lookup.emplace( StringView( *stored ), stored );
+	return InternedString( stored );
+}
+
+bool StringTable::find( StringView str, InternedString & result ) const
+{
+	if (str.empty())
+	{
+		result = InternedString();
+		return true;
+	}
+
+	std::lock_guard< std::mutex > lock( _mutex );
+
+	auto iter = _lookup.find( str );
+	if (iter == _lookup.end())
+		return false;
+
+	result = InternedString( iter->second );
+	return true;
+}
+
+size_t StringTable::size() const
+{
+	std::lock_guard< std::mutex > lock( _mutex );
+	return _lookup.size();
+}
+
+bool StringTable::isOversized( size_t stringsInUse ) const
+{
+	// with some slack, so that small tables are not replaced needlessly
+	return size() > 2 * stringsInUse + 1024;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,28 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: non-owning reference to a string
+//======================================================================================================================
+
+#include "OpenRGB/StringView.hpp"
+
+#include <ostream>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+std::ostream & operator<<( std::ostream & os, StringView str )
+{
+	os.write( str.data(), std::streamsize( str.size() ) );
+	return os;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
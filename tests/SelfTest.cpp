@@ -0,0 +1,623 @@
+//======================================================================================================================
+//  checks the color operations and the analysis of audio and images against fixed expected values
+//======================================================================================================================
+
+/// \file
+
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <vector>
+
+#include "OpenRGB/Color.hpp"
+#include "OpenRGB/ColorOps.hpp"
+#include "OpenRGB/Palette.hpp"
+#include "OpenRGB/Calibration.hpp"
+#include "OpenRGB/AudioSpectrum.hpp"
+#include "OpenRGB/FrameSampler.hpp"
+using orgb::Color;
+using namespace orgb::literals;
+using orgb::HSV;
+using orgb::Palette;
+using orgb::PaletteStop;
+using orgb::Calibration;
+using orgb::SpectrumAnalyzer;
+using orgb::SpectrumConfig;
+using orgb::FrameSampler;
+using orgb::ImageView;
+using orgb::ImageArea;
+using orgb::PixelFormat;
+using orgb::Edge;
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  utils
+
+static size_t g_checks = 0;
+static size_t g_failures = 0;
+static const char * g_context = "";  ///< instruction set the checks currently run with, empty when it doesn't matter
+
+static bool check( bool passed, const char * what )
+{
+	++g_checks;
+	if (!passed)
+	{
+		++g_failures;
+		printf( "  %s%s%s failed\n", g_context, *g_context ? ": " : "", what );
+	}
+	return passed;
+}
+
+static bool checkNear( float actual, float expected, float tolerance, const char * what )
+{
+	++g_checks;
+	if (!(std::fabs( actual - expected ) <= tolerance))
+	{
+		++g_failures;
+		printf( "  %s%s%s: %f instead of %f\n", g_context, *g_context ? ": " : "", what, double( actual ), double( expected ) );
+		return false;
+	}
+	return true;
+}
+
+static bool checkColor( Color actual, Color expected, const char * what )
+{
+	++g_checks;
+	if (actual != expected)
+	{
+		++g_failures;
+		printf( "  %s%s%s: %u,%u,%u instead of %u,%u,%u\n", g_context, *g_context ? ": " : "", what,
+			unsigned( actual.r ), unsigned( actual.g ), unsigned( actual.b ),
+			unsigned( expected.r ), unsigned( expected.g ), unsigned( expected.b ) );
+		return false;
+	}
+	return true;
+}
+
+static bool checkHSV( HSV actual, HSV expected, const char * what )
+{
+	++g_checks;
+	if (actual.h != expected.h || actual.s != expected.s || actual.v != expected.v)
+	{
+		++g_failures;
+		printf( "  %s%s%s: %u,%u,%u instead of %u,%u,%u\n", g_context, *g_context ? ": " : "", what,
+			unsigned( actual.h ), unsigned( actual.s ), unsigned( actual.v ),
+			unsigned( expected.h ), unsigned( expected.s ), unsigned( expected.v ) );
+		return false;
+	}
+	return true;
+}
+
+/// Checks that all colors of a frame are the expected one, so that both the vector loop and its tail are covered.
+static bool checkFrame( const Color * actual, size_t count, Color expected, const char * what )
+{
+	size_t i = 0;
+	while (i + 1 < count && actual[i] == expected)
+		++i;
+	return checkColor( actual[i], expected, what );  // the first wrong one or the last one
+}
+
+/// Runs the checks with every instruction set the CPU supports, the results must be the same with all of them.
+static void forEverySimdLevel( void (* test)() )
+{
+	using namespace orgb::colorops;
+
+	const SimdLevel defaultLevel = simdLevel();
+	const SimdLevel levels [] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	for (SimdLevel level : levels)
+	{
+		if (!setSimdLevel( level ))
+			continue;
+		g_context = enumString( level );
+		test();
+	}
+	g_context = "";
+	setSimdLevel( defaultLevel );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  frame operations
+
+// longer than the widest vector, so that every kernel runs both its vector loop and its tail
+static const size_t frameSize = 19;
+
+static void testFrameOps()
+{
+	using namespace orgb::colorops;
+
+	Color a [frameSize], b [frameSize], dst [frameSize];
+	fill( a, frameSize, Color( 200, 100, 0 ) );
+	fill( b, frameSize, Color( 100, 200, 255 ) );
+	checkFrame( a, frameSize, Color( 200, 100, 0 ), "fill" );
+
+	scale( dst, a, frameSize, uint8_t( 255 ) );
+	checkFrame( dst, frameSize, Color( 200, 100, 0 ), "scale by 255" );
+	scale( dst, a, frameSize, uint8_t( 0 ) );
+	checkFrame( dst, frameSize, Color( 0, 0, 0 ), "scale by 0" );
+	scale( dst, a, frameSize, uint8_t( 128 ) );
+	checkFrame( dst, frameSize, Color( 100, 50, 0 ), "scale by 128" );
+	scale( dst, a, frameSize, Color( 255, 128, 0 ) );
+	checkFrame( dst, frameSize, Color( 200, 50, 0 ), "scale per channel" );
+
+	addSaturated( dst, a, b, frameSize );
+	checkFrame( dst, frameSize, Color( 255, 255, 255 ), "addSaturated" );
+
+	lerp( dst, a, b, frameSize, 0 );
+	checkFrame( dst, frameSize, Color( 200, 100, 0 ), "lerp by 0" );
+	lerp( dst, a, b, frameSize, 255 );
+	checkFrame( dst, frameSize, Color( 100, 200, 255 ), "lerp by 255" );
+	lerp( dst, a, b, frameSize, 128 );
+	checkFrame( dst, frameSize, Color( 149, 150, 128 ), "lerp by 128" );
+
+	// 3 pixels of RGB, then 3 pixels of RGBA
+	const uint8_t pixels [] = { 10, 20, 30,  40, 50, 60,  70, 80, 90,  1, 2, 3, 4,  5, 6, 7, 8,  9, 10, 11, 12 };
+	uint32_t sums [4] = { 1000, 1000, 1000, 1000 };
+	sumPixels( pixels, 3, 3, sums );
+	check( sums[0] == 1120 && sums[1] == 1150 && sums[2] == 1180 && sums[3] == 1000, "sumPixels of RGB" );
+	uint32_t sums4 [4] = { 0, 0, 0, 0 };
+	sumPixels( pixels + 9, 3, 4, sums4 );
+	check( sums4[0] == 15 && sums4[1] == 18 && sums4[2] == 21 && sums4[3] == 24, "sumPixels of RGBA" );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  compositing
+
+static void testBlending()
+{
+	using namespace orgb::colorops;
+
+	struct ModeResult
+	{
+		BlendMode mode;
+		Color result;
+	};
+	// the layer (100, 200, 255) fully opaque over (200, 100, 0)
+	const ModeResult modeResults [] =
+	{
+		{ BlendMode::Normal,   Color( 100, 200, 255 ) },
+		{ BlendMode::Add,      Color( 255, 255, 255 ) },
+		{ BlendMode::Multiply, Color(  78,  78,   0 ) },
+		{ BlendMode::Screen,   Color( 222, 222, 255 ) },
+		{ BlendMode::Lighten,  Color( 200, 200, 255 ) },
+	};
+
+	Color below = Color( 200, 100, 0 );
+	below.padding = 7;
+	Color layer = Color( 100, 200, 255 );
+	Color dst [frameSize], src [frameSize];
+
+	for (const ModeResult & modeResult : modeResults)
+	{
+		layer.padding = 255;
+		fill( src, frameSize, layer );
+		fill( dst, frameSize, below );
+		blend( dst, src, frameSize, modeResult.mode, 255 );
+		checkFrame( dst, frameSize, modeResult.result, enumString( modeResult.mode ) );
+		check( dst[0].padding == 7 && dst[ frameSize - 1 ].padding == 7, "blend keeps the padding" );
+
+		layer.padding = 0;
+		fill( src, frameSize, layer );
+		fill( dst, frameSize, below );
+		blend( dst, src, frameSize, modeResult.mode, 255 );
+		checkFrame( dst, frameSize, below, "blend with alpha 0" );
+	}
+
+	// half alpha and half opacity both give the half way between the colors, the same as lerp()
+	layer.padding = 128;
+	fill( src, frameSize, layer );
+	fill( dst, frameSize, below );
+	blend( dst, src, frameSize, BlendMode::Normal, 255 );
+	checkFrame( dst, frameSize, Color( 149, 150, 128 ), "blend with alpha 128" );
+
+	layer.padding = 255;
+	fill( src, frameSize, layer );
+	fill( dst, frameSize, below );
+	blend( dst, src, frameSize, BlendMode::Normal, 128 );
+	checkFrame( dst, frameSize, Color( 149, 150, 128 ), "blend with opacity 128" );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  color models
+
+struct HSVPair
+{
+	HSV hsv;
+	Color rgb;
+};
+
+// the hue has 256 steps per circle, so only 0 and 128 (180 degrees) fall exactly on a pure color
+static const HSVPair hsvPairs [] =
+{
+	{ HSV(   0, 255, 255 ), Color( 255,   0,   0 ) },  // red
+	{ HSV(  64, 255, 255 ), Color( 127, 255,   0 ) },  // 90 degrees, between yellow and green
+	{ HSV( 128, 255, 255 ), Color(   0, 255, 255 ) },  // cyan
+	{ HSV( 170, 255, 255 ), Color(   0,   3, 255 ) },  // just before blue
+	{ HSV( 171, 255, 255 ), Color(   2,   0, 255 ) },  // just after blue
+	{ HSV(   0, 128, 255 ), Color( 255, 127, 127 ) },  // half saturated red
+	{ HSV(   0, 255, 128 ), Color( 128,   0,   0 ) },  // half bright red
+	{ HSV(  99,   0, 200 ), Color( 200, 200, 200 ) },  // gray of any hue
+	{ HSV(  99, 255,   0 ), Color(   0,   0,   0 ) },  // black of any hue
+};
+
+struct RGBPair
+{
+	Color rgb;
+	HSV hsv;
+};
+
+static const RGBPair rgbPairs [] =
+{
+	{ Color( 255,   0,   0 ), HSV(   0, 255, 255 ) },
+	{ Color(   0, 255,   0 ), HSV(  85, 255, 255 ) },
+	{ Color(   0, 255, 255 ), HSV( 128, 255, 255 ) },
+	{ Color(   0,   0, 255 ), HSV( 171, 255, 255 ) },
+	{ Color( 255, 128, 128 ), HSV(   0, 127, 255 ) },
+	{ Color( 100, 100, 100 ), HSV(   0,   0, 100 ) },  // gray gets hue 0
+};
+
+static void testColorModels()
+{
+	using namespace orgb::colorops;
+
+	for (const HSVPair & pair : hsvPairs)
+	{
+		checkColor( Color::fromHSV( pair.hsv ), pair.rgb, "Color::fromHSV" );
+
+		HSV hsvFrame [frameSize];
+		Color dst [frameSize];
+		for (HSV & hsv : hsvFrame)
+			hsv = pair.hsv;
+		fromHSV( dst, hsvFrame, frameSize );
+		checkFrame( dst, frameSize, pair.rgb, "colorops::fromHSV" );
+	}
+	checkColor( Color::fromHue( 128 ), Color( 0, 255, 255 ), "Color::fromHue" );
+
+	for (const RGBPair & pair : rgbPairs)
+	{
+		checkHSV( pair.rgb.toHSV(), pair.hsv, "Color::toHSV" );
+
+		Color src [frameSize];
+		HSV dst [frameSize];
+		fill( src, frameSize, pair.rgb );
+		toHSV( dst, src, frameSize );
+		checkHSV( dst[0], pair.hsv, "colorops::toHSV" );
+		checkHSV( dst[ frameSize - 1 ], pair.hsv, "colorops::toHSV" );
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  parsing
+
+struct ParsedColor
+{
+	const char * str;
+	Color color;
+};
+
+static const ParsedColor validColors [] =
+{
+	{ "#FF8800",                  Color( 255, 136,   0 ) },
+	{ "ff8800",                   Color( 255, 136,   0 ) },
+	{ "#A3E",                     Color( 170,  51, 238 ) },
+	{ "red",                      Color( 255,   0,   0 ) },
+	{ "CornflowerBlue",           Color( 100, 149, 237 ) },
+	{ "rebeccapurple",            Color( 102,  51, 153 ) },
+	{ "grey",                     Color( 128, 128, 128 ) },
+	{ "rgb(255, 136, 0)",         Color( 255, 136,   0 ) },
+	{ "rgb(100% 50% 0%)",         Color( 255, 128,   0 ) },
+	{ "RGB( 300 , -5 , 10.4 )",   Color( 255,   0,  10 ) },  // clamped and rounded
+	{ "hsl(30, 100%, 50%)",       Color( 255, 128,   0 ) },
+	{ "hsl(120deg 100% 25%)",     Color(   0, 128,   0 ) },
+	{ "hsl(240, 100%, 50%)",      Color(   0,   0, 255 ) },
+	{ "hsl(-120, 100%, 50%)",     Color(   0,   0, 255 ) },  // the same hue as 240
+	{ "hsl(0, 0%, 50%)",          Color( 128, 128, 128 ) },
+	{ "hsl(0, 100%, 100%)",       Color( 255, 255, 255 ) },
+};
+
+static const char * const invalidColors [] =
+{
+	"", "#", "#FF880", "#GG0000", "FF88001", "notacolor", "redd",
+	"rgb(1, 2 3)",        // mixed separators
+	"rgb(1, 2, 3",        // not closed
+	"rgb(1, 2, 3) ",      // something after the end
+	"rgb(1, 2)",
+	"rgb(10deg, 2, 3)",
+	"hsl(30, 100, 50%)",  // saturation without percent
+	"hsl(30%, 100%, 50%)",
+};
+
+// the literal is parsed by the compiler
+static_assert( "#FF8800"_rgb == Color( 255, 136, 0 ), "hex literal" );
+static_assert( "cornflowerblue"_rgb == Color( 100, 149, 237 ), "named literal" );
+
+static void testParsing()
+{
+	for (const ParsedColor & parsed : validColors)
+	{
+		Color color = Color( 1, 2, 3 );
+		check( color.fromString( parsed.str ), parsed.str );
+		checkColor( color, parsed.color, parsed.str );
+	}
+
+	for (const char * str : invalidColors)
+	{
+		Color color = Color( 1, 2, 3 );
+		check( !color.fromString( str ), str );
+		checkColor( color, Color( 1, 2, 3 ), "invalid string keeps the color" );
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  palettes
+
+static void testPalette()
+{
+	// black to orange in 10 steps, then to blue in another 10 steps, then blue up to the end
+	const Palette palette = {
+		{  0,   0,   0,   0 },
+		{ 10, 200, 100,   0 },
+		{ 20,   0,   0, 255 },
+	};
+	checkColor( palette[0], Color( 0, 0, 0 ), "palette entry 0" );
+	checkColor( palette[5], Color( 100, 50, 0 ), "palette entry 5" );
+	checkColor( palette[6], Color( 120, 60, 0 ), "palette entry 6" );
+	checkColor( palette[10], Color( 200, 100, 0 ), "palette entry 10" );
+	checkColor( palette[15], Color( 100, 50, 128 ), "palette entry 15" );
+	checkColor( palette[255], Color( 0, 0, 255 ), "palette entry 255" );
+
+	checkColor( palette.sample( uint16_t( 0x0580 ) ), Color( 110, 55, 0 ), "sample between entries" );
+	checkColor( palette.sample( uint16_t( 0xFF00 ) ), Color( 0, 0, 255 ), "sample at the end" );
+	checkColor( palette.sample( uint16_t( 0xFFFF ) ), Color( 0, 0, 255 ), "sample past the end" );
+	checkColor( palette.sample( 15.0f / 255.0f ), Color( 100, 50, 128 ), "sample at float position" );
+	checkColor( palette.sample( -1.0f ), Color( 0, 0, 0 ), "sample below 0.0" );
+	checkColor( palette.sample( 2.0f ), Color( 0, 0, 255 ), "sample above 1.0" );
+
+	const uint8_t indexes [frameSize] = { 0, 5, 6, 10, 15, 255, 0, 5, 6, 10, 15, 255, 0, 5, 6, 10, 15, 255, 0 };
+	const Color indexColors [] = {
+		Color( 0, 0, 0 ), Color( 100, 50, 0 ), Color( 120, 60, 0 ), Color( 200, 100, 0 ), Color( 100, 50, 128 ),
+		Color( 0, 0, 255 ),
+	};
+	Color dst [frameSize];
+	palette.map( dst, indexes, frameSize );
+	for (size_t i = 0; i < frameSize; ++i)
+		if (!checkColor( dst[i], indexColors[ i % 6 ], "map of indexes" ))
+			break;
+
+	uint16_t positions [frameSize];
+	for (uint16_t & position : positions)
+		position = 0x0580;
+	palette.map( dst, positions, frameSize );
+	checkFrame( dst, frameSize, Color( 110, 55, 0 ), "map of positions" );
+
+	const PaletteStop single [] = { { 128, 10, 20, 30 } };
+	const Palette singleColor( single );
+	checkColor( singleColor[0], Color( 10, 20, 30 ), "palette of a single stop" );
+	checkColor( singleColor[255], Color( 10, 20, 30 ), "palette of a single stop" );
+	checkColor( Palette()[128], Color( 0, 0, 0 ), "empty palette" );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  calibration
+
+static void testCalibration()
+{
+	Calibration calibration;
+	check( calibration.isIdentity(), "default calibration is identity" );
+	checkColor( calibration.apply( Color( 12, 34, 56 ) ), Color( 12, 34, 56 ), "identity calibration" );
+
+	// 255 * (x / 255) ^ gamma, rounded
+	check( calibration.setGamma( 2.0f ), "setGamma( 2.0 )" );
+	checkColor( calibration.apply( Color( 128, 255, 64 ) ), Color( 64, 255, 16 ), "gamma 2.0" );
+	checkColor( calibration.apply( Color( 0, 1, 2 ) ), Color( 0, 0, 0 ), "gamma 2.0 of dark shades" );
+	check( !calibration.setGamma( 0.0f ) && !calibration.setGamma( NAN ) && !calibration.setGamma( -1.0f ),
+		"setGamma rejects zero, NaN and negative gamma" );
+	check( calibration.redGamma() == 2.0f, "rejected gamma keeps the previous one" );
+	check( calibration.setGamma( 0.5f, 1.0f, 2.0f ), "setGamma per channel" );
+	checkColor( calibration.apply( Color( 64, 64, 64 ) ), Color( 128, 64, 16 ), "gamma per channel" );
+	calibration.setGamma( 1.0f );
+	check( calibration.isIdentity(), "gamma 1.0 is identity" );
+
+	// white becomes the white point, the channels of other colors are scaled by the same ratio
+	calibration.setWhitePoint( Color( 255, 128, 0 ) );
+	check( !calibration.isIdentity(), "white point is not identity" );
+	checkColor( calibration.apply( Color::White ), Color( 255, 128, 0 ), "white point of white" );
+	checkColor( calibration.apply( Color( 100, 100, 100 ) ), Color( 100, 50, 0 ), "white point of gray" );
+	calibration.setWhitePoint( Color::White );
+
+	const float swapChannels [3][3] = {
+		{ 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f },
+		{ 1.0f, 0.0f, 0.0f },
+	};
+	check( calibration.setMatrix( swapChannels ), "setMatrix" );
+	checkColor( calibration.apply( Color( 10, 20, 30 ) ), Color( 20, 30, 10 ), "matrix swapping channels" );
+
+	// the results are clamped to 0..255
+	const float mixChannels [3][3] = {
+		{ 2.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, -0.5f },
+		{ -1.0f, 0.0f, 1.0f },
+	};
+	check( calibration.setMatrix( mixChannels ), "setMatrix" );
+	checkColor( calibration.apply( Color( 200, 100, 100 ) ), Color( 255, 50, 0 ), "matrix with clamping" );
+
+	float notFinite [3][3] = {
+		{ 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, INFINITY },
+	};
+	check( !calibration.setMatrix( notFinite ), "setMatrix rejects infinity" );
+	notFinite[2][2] = NAN;
+	check( !calibration.setMatrix( notFinite ), "setMatrix rejects NaN" );
+	checkColor( calibration.apply( Color( 200, 100, 100 ) ), Color( 255, 50, 0 ), "rejected matrix keeps the previous one" );
+
+	// the matrix and the gamma together in a whole frame, which is where the instruction sets differ
+	calibration.setMatrix( swapChannels );
+	calibration.setGamma( 2.0f );
+	Color src [frameSize], dst [frameSize];
+	Color color = Color( 64, 128, 255 );
+	color.padding = 7;
+	orgb::colorops::fill( src, frameSize, color );
+	calibration.apply( dst, src, frameSize );
+	checkFrame( dst, frameSize, Color( 64, 255, 16 ), "calibration of a frame" );
+	check( dst[0].padding == 7 && dst[ frameSize - 1 ].padding == 7, "calibration keeps the padding" );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  audio spectrum
+
+static const double Pi = 3.14159265358979;
+
+static void testSpectrum()
+{
+	// 1000 Hz falls exactly on bin 64, the bands are 40 Hz * 200 ^ (band / 16), so it's in band 9 (788 - 1098 Hz)
+	const uint32_t sampleRate = 16000;
+	SpectrumConfig config;
+	config.fftSize = 1024;
+	config.bandCount = 16;
+	config.minFrequency = 40.0f;
+	config.maxFrequency = 8000.0f;
+	config.floor = -60.0f;
+	config.attack = 1.0f;  // no smoothing
+	config.decay = 1.0f;
+
+	SpectrumAnalyzer analyzer;
+	if (!check( analyzer.setup( sampleRate, config ), "SpectrumAnalyzer::setup" ))
+		return;
+
+	config.minFrequency = NAN;
+	check( !analyzer.setup( sampleRate, config ), "setup rejects NaN frequency" );
+	config.minFrequency = 9000.0f;
+	check( !analyzer.setup( sampleRate, config ), "setup rejects minimum above maximum" );
+	check( analyzer.config().minFrequency == 40.0f, "rejected setup keeps the previous one" );
+
+	// a sine of amplitude 0.5, the Hann window spreads it over 3 bins with the halves of its magnitude on the sides
+	float samples [1024];
+	for (size_t i = 0; i < 1024; ++i)
+		samples[i] = 0.5f * float( std::sin( 2.0 * Pi * 1000.0 * double( i ) / double( sampleRate ) ) );
+	analyzer.process( samples, 1024 );
+
+	const float * magnitudes = analyzer.magnitudes();
+	checkNear( magnitudes[64], 0.5f, 0.005f, "magnitude of the sine's bin" );
+	checkNear( magnitudes[63], 0.25f, 0.005f, "magnitude of the bin below the sine" );
+	checkNear( magnitudes[65], 0.25f, 0.005f, "magnitude of the bin above the sine" );
+	checkNear( magnitudes[0], 0.0f, 0.001f, "magnitude of DC" );
+	checkNear( magnitudes[32], 0.0f, 0.001f, "magnitude far below the sine" );
+	checkNear( magnitudes[512], 0.0f, 0.001f, "magnitude at the Nyquist frequency" );
+
+	// the band sums the power 0.5^2 + 2 * 0.25^2 = 0.375, which is -4.26 dB, the loudness is 2 * 0.5^2 = -6.02 dB
+	checkNear( analyzer.bands()[9], 1.0f - 4.26f / 60.0f, 0.005f, "level of the band with the sine" );
+	checkNear( analyzer.bands()[5], 0.0f, 0.001f, "level of a band below the sine" );
+	checkNear( analyzer.bands()[14], 0.0f, 0.001f, "level of a band above the sine" );
+	checkNear( analyzer.loudness(), 1.0f - 6.02f / 60.0f, 0.005f, "loudness of the sine" );
+
+	float silence [1024] = {};
+	analyzer.process( silence, 1024 );
+	checkNear( analyzer.bands()[9], 0.0f, 0.001f, "level of silence" );
+	checkNear( analyzer.loudness(), 0.0f, 0.001f, "loudness of silence" );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  image sampling
+
+static const uint32_t imageWidth = 8;
+static const uint32_t imageHeight = 4;
+
+// the quadrants of the image, the top ones take 2 rows, the bottom ones the other 2
+static const Color topLeft     = Color( 200, 100,   0 );
+static const Color topRight    = Color(   0,  50, 251 );
+static const Color bottomLeft  = Color( 100, 100, 100 );
+static const Color bottomRight = Color(  10,  20,  30 );
+
+static Color pixelAt( uint32_t x, uint32_t y )
+{
+	bool left = x < imageWidth / 2;
+	bool top = y < imageHeight / 2;
+	return top ? (left ? topLeft : topRight) : (left ? bottomLeft : bottomRight);
+}
+
+/// Builds the test image in a pixel format with extra bytes at the end of every row.
+static ImageView makeImage( std::vector< uint8_t > & buffer, PixelFormat format, size_t padding )
+{
+	const uint32_t pixelSize = orgb::bytesPerPixel( format );
+	const size_t stride = imageWidth * pixelSize + padding;
+	buffer.assign( stride * imageHeight, 0xEE );
+	for (uint32_t y = 0; y < imageHeight; ++y)
+	{
+		for (uint32_t x = 0; x < imageWidth; ++x)
+		{
+			uint8_t * pixel = buffer.data() + y * stride + x * pixelSize;
+			Color color = pixelAt( x, y );
+			bool isBGR = format == PixelFormat::BGR24 || format == PixelFormat::BGRA32;
+			pixel[0] = isBGR ? color.b : color.r;
+			pixel[1] = color.g;
+			pixel[2] = isBGR ? color.r : color.b;
+		}
+	}
+	return ImageView( buffer.data(), imageWidth, imageHeight, format, stride );
+}
+
+static void testSampler()
+{
+	const PixelFormat formats [] = { PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32 };
+	std::vector< uint8_t > buffer;
+
+	for (PixelFormat format : formats)
+	{
+		for (uint32_t rowStep : { 1u, 2u })  // the rows repeat in pairs, so every 2nd row gives the same averages
+		{
+			FrameSampler sampler;
+			sampler.setRowStep( rowStep );
+			sampler.addArea( 0, 0, ImageArea() );                           // whole image
+			sampler.addArea( 0, 1, ImageArea( 0.0f, 0.0f, 0.5f, 1.0f ) );   // left half
+			sampler.addArea( 0, 2, ImageArea( 0.25f, 0.0f, 0.5f, 0.5f ) );  // middle of the top half
+			sampler.addStrip( 1, 0, 2, Edge::Top, 0.5f );
+			sampler.addStrip( 1, 2, 2, Edge::Bottom, 0.5f );
+			sampler.addArea( 2, 1, ImageArea( 0.5f, 0.5f, 0.5f, 0.5f ) );
+
+			sampler.sample( makeImage( buffer, format, format == PixelFormat::RGB24 ? 0 : 5 ) );
+
+			if (!check( sampler.deviceCount() == 3 && sampler.colors( 0 ).size() == 3 && sampler.colors( 1 ).size() == 4
+			         && sampler.colors( 2 ).size() == 2, "frames grow with the areas" ))
+				continue;
+			// whole image: red (200 + 100 + 10) * 8 / 32 = 77.5, green (100 + 50 + 100 + 20) * 8 / 32 = 67.5,
+			// blue (251 + 100 + 30) * 8 / 32 = 95.25, rounded to the nearest
+			checkColor( sampler.colors( 0 )[0], Color( 78, 68, 95 ), "average of the whole image" );
+			checkColor( sampler.colors( 0 )[1], Color( 150, 100, 50 ), "average of the left half" );
+			checkColor( sampler.colors( 0 )[2], Color( 100, 75, 126 ), "average across the middle" );
+			checkColor( sampler.colors( 1 )[0], topLeft, "top strip from the left" );
+			checkColor( sampler.colors( 1 )[1], topRight, "top strip to the right" );
+			checkColor( sampler.colors( 1 )[2], bottomRight, "bottom strip from the right" );
+			checkColor( sampler.colors( 1 )[3], bottomLeft, "bottom strip to the left" );
+			checkColor( sampler.colors( 2 )[0], Color( 0, 0, 0 ), "LED without an area" );
+			checkColor( sampler.colors( 2 )[1], bottomRight, "bottom right quadrant" );
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main( int /*argc*/, char * /*argv*/ [] )
+{
+	forEverySimdLevel( testFrameOps );
+	forEverySimdLevel( testBlending );
+	forEverySimdLevel( testColorModels );
+	testParsing();
+	forEverySimdLevel( testPalette );
+	forEverySimdLevel( testCalibration );
+	testSpectrum();
+	forEverySimdLevel( testSampler );
+
+	printf( "%zu checks, %zu failed\n", g_checks, g_failures );
+	return g_failures == 0 ? 0 : 1;
+}
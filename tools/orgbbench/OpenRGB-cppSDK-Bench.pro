@@ -0,0 +1,28 @@
+TARGET = orgbbench
+
+TEMPLATE = app
+CONFIG += console
+CONFIG += c++11
+CONFIG += static
+CONFIG -= app_bundle
+CONFIG -= qt
+
+QMAKE_CXXFLAGS += -Wno-old-style-cast
+
+INCLUDEPATH += ../../include
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../../shared/CppUtils-Essential
+INCLUDEPATH += ../../shared/CppUtils-Network
+
+LIBS += -L../../../build-windows64-release
+LIBS += -lorgbsdk
+LIBS += -lws2_32
+
+SOURCES += \
+	src/AllocCounter.cpp \
+	src/Fixtures.cpp \
+	src/main.cpp
+
+HEADERS += \
+	src/AllocCounter.hpp \
+	src/Fixtures.hpp
@@ -0,0 +1,43 @@
+//======================================================================================================================
+// counts the heap allocations made by the whole program
+//======================================================================================================================
+
+#include "AllocCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+static std::atomic< size_t > g_allocationCount( 0 );
+static std::atomic< size_t > g_allocatedBytes( 0 );
+
+size_t allocationCount() noexcept
+{
+	return g_allocationCount.load( std::memory_order_relaxed );
+}
+
+size_t allocatedBytes() noexcept
+{
+	return g_allocatedBytes.load( std::memory_order_relaxed );
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+// Replacing these two is enough, all the other forms of operator new and delete call them by default.
+
+void * operator new( size_t size )
+{
+	g_allocationCount.fetch_add( 1, std::memory_order_relaxed );
+	g_allocatedBytes.fetch_add( size, std::memory_order_relaxed );
+
+	void * ptr = std::malloc( size > 0 ? size : 1 );
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete( void * ptr ) noexcept
+{
+	std::free( ptr );
+}
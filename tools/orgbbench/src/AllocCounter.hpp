@@ -0,0 +1,33 @@
+//======================================================================================================================
+// counts the heap allocations made by the whole program
+//======================================================================================================================
+
+#ifndef ORGBBENCH_ALLOC_COUNTER_INCLUDED
+#define ORGBBENCH_ALLOC_COUNTER_INCLUDED
+
+
+#include <cstddef>
+
+
+/// Number of calls of the global operator new since the program started.
+size_t allocationCount() noexcept;
+
+/// Number of bytes requested from the global operator new since the program started.
+size_t allocatedBytes() noexcept;
+
+/// Measures the allocations made between its construction and the call of allocations().
+class AllocScope
+{
+	size_t _startCount;
+	size_t _startBytes;
+
+ public:
+
+	AllocScope() noexcept : _startCount( allocationCount() ), _startBytes( allocatedBytes() ) {}
+
+	size_t allocations() const noexcept  { return allocationCount() - _startCount; }
+	size_t bytes() const noexcept        { return allocatedBytes() - _startBytes; }
+};
+
+
+#endif // ORGBBENCH_ALLOC_COUNTER_INCLUDED
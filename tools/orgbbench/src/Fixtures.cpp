@@ -0,0 +1,192 @@
+//======================================================================================================================
+// synthetic server replies describing realistic RGB devices
+//======================================================================================================================
+
+#include "Fixtures.hpp"
+
+#include <string>
+#include <cstring>
+using namespace std;
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  device descriptions
+
+struct ZoneSpec
+{
+	const char * name;
+	uint32_t type;         // 0 = single, 1 = linear, 2 = matrix
+	uint32_t ledCount;
+	uint32_t matrixWidth;  // 0 when the zone is not a matrix
+};
+
+struct DeviceSpec
+{
+	uint32_t type;
+	const char * name;
+	const char * vendor;
+	const char * ledPrefix;
+	uint32_t modeCount;
+	vector< ZoneSpec > zones;
+};
+
+static const DeviceSpec typicalSetup [] =
+{
+	{  5, "Razer BlackWidow V3",             "Razer",     "Key: ",         12, {{ "Keyboard", 2, 104, 22 }} },
+	{  6, "Logitech G502 HERO",              "Logitech",  "Mouse LED ",     6, {{ "Logo", 0, 1, 0 }, { "Scroll Wheel", 0, 1, 0 }, { "Underglow", 1, 8, 0 }} },
+	{  1, "Corsair Vengeance RGB PRO",       "Corsair",   "DRAM LED ",     12, {{ "DRAM", 1, 10, 0 }} },
+	{  1, "Corsair Vengeance RGB PRO",       "Corsair",   "DRAM LED ",     12, {{ "DRAM", 1, 10, 0 }} },
+	{  1, "Corsair Vengeance RGB PRO",       "Corsair",   "DRAM LED ",     12, {{ "DRAM", 1, 10, 0 }} },
+	{  1, "Corsair Vengeance RGB PRO",       "Corsair",   "DRAM LED ",     12, {{ "DRAM", 1, 10, 0 }} },
+	{  2, "ASUS ROG STRIX RTX 3080",         "ASUS",      "GPU LED ",      10, {{ "GPU", 1, 22, 0 }} },
+	{  0, "ASUS ROG STRIX X570-E GAMING",    "ASUS",      "Aura LED ",     10, {{ "Aura Mainboard", 1, 5, 0 }, { "Aura Addressable 1", 1, 60, 0 },
+	                                                                             { "Aura Addressable 2", 1, 30, 0 }, { "Aura Addressable 3", 1, 0, 0 }} },
+	{  3, "Corsair Lighting Node Pro",       "Corsair",   "Fan LED ",       9, {{ "Fan 1", 1, 16, 0 }, { "Fan 2", 1, 16, 0 }, { "Fan 3", 1, 16, 0 }} },
+	{  3, "NZXT Kraken X63",                 "NZXT",      "Kraken LED ",    8, {{ "Logo", 0, 1, 0 }, { "Ring", 1, 8, 0 }} },
+	{  3, "Corsair Commander Pro",           "Corsair",   "Fan LED ",       9, {{ "Fan 1", 1, 34, 0 }, { "Fan 2", 1, 34, 0 }} },
+	{  4, "Philips Hue Play Gradient",       "Philips",   "Strip LED ",     4, {{ "Strip", 1, 120, 0 }} },
+	{  4, "Govee LED Strip",                 "Govee",     "Strip LED ",     5, {{ "Strip", 1, 150, 0 }} },
+	{  7, "SteelSeries QcK Prism",           "SteelSeries", "Mousemat LED ", 6, {{ "Mousemat", 1, 12, 0 }} },
+	{ 12, "Logitech G560",                   "Logitech",  "Speaker LED ",   6, {{ "Left", 1, 2, 0 }, { "Right", 1, 2, 0 }} },
+	{  9, "Corsair ST100",                   "Corsair",   "Stand LED ",     7, {{ "Stand", 1, 9, 0 }} },
+	{ 12, "Razer Nommo Chroma",              "Razer",     "Speaker LED ",   5, {{ "Base", 1, 2, 0 }} },
+	{  5, "Wooting Two HE",                  "Wooting",   "Key: ",          3, {{ "Keyboard", 2, 118, 21 }} },
+	{  2, "Gigabyte RTX 3070 AORUS",         "Gigabyte",  "GPU LED ",       8, {{ "Fan Ring", 1, 12, 0 }, { "Logo", 0, 1, 0 }} },
+	{ 11, "Elgato Light Strip",              "Elgato",    "Light LED ",     2, {{ "Strip", 1, 45, 0 }} },
+};
+static_assert( sizeof( typicalSetup ) / sizeof( typicalSetup[0] ) == typicalSetupSize, "update the typicalSetupSize" );
+
+static const char * const modeNames [] =
+{
+	"Direct", "Static", "Breathing", "Spectrum Cycle", "Rainbow Wave", "Reactive",
+	"Ripple", "Starlight", "Flashing", "Color Wave", "Comet", "Off",
+};
+
+// number of mode-specific colors of each mode, most modes have a few, some have many
+static const uint16_t modeColorCounts [] = { 0, 1, 2, 0, 0, 2, 1, 3, 1, 7, 1, 0 };
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  serialization
+
+class Writer
+{
+	vector< uint8_t > & _buf;
+
+ public:
+
+	Writer( vector< uint8_t > & buf ) : _buf( buf ) {}
+
+	void u16( uint16_t val )
+	{
+		_buf.push_back( uint8_t( val ) );
+		_buf.push_back( uint8_t( val >> 8 ) );
+	}
+
+	void u32( uint32_t val )
+	{
+		for (int i = 0; i < 4; ++i)
+			_buf.push_back( uint8_t( val >> (8 * i) ) );
+	}
+
+	void str( const string & s )
+	{
+		u16( uint16_t( s.size() + 1 ) );
+		_buf.insert( _buf.end(), s.begin(), s.end() );
+		_buf.push_back( '\0' );
+	}
+};
+
+static vector< uint8_t > makeDeviceReply( const DeviceSpec & spec, size_t instance, uint32_t protocolVersion )
+{
+	vector< uint8_t > body;
+	Writer w( body );
+
+	w.u32( 0 );  // data_size, filled at the end
+	w.u32( spec.type );
+	w.str( spec.name );
+	w.str( spec.vendor );
+	w.str( string( spec.vendor ) + " RGB device" );
+	w.str( "1.0." + to_string( instance % 10 ) );
+	w.str( "SN" + to_string( 100000 + instance ) );
+	w.str( "HID: /dev/hidraw" + to_string( instance ) );
+
+	w.u16( uint16_t( spec.modeCount ) );
+	w.u32( 0 );  // active_mode
+	for (uint32_t modeIdx = 0; modeIdx < spec.modeCount; ++modeIdx)
+	{
+		uint16_t colorCount = modeColorCounts[ modeIdx ];
+		w.str( modeNames[ modeIdx ] );
+		w.u32( modeIdx );                             // value
+		w.u32( colorCount > 0 ? 0x51 : 0x20 );        // flags: HasSpeed | HasBrightness | HasModeSpecificColor, or HasPerLedColor
+		w.u32( 0 );  w.u32( 100 );                    // speed_min, speed_max
+		if (protocolVersion >= 3)
+		{
+			w.u32( 0 );  w.u32( 100 );                // brightness_min, brightness_max
+		}
+		w.u32( colorCount );  w.u32( colorCount );    // colors_min, colors_max
+		w.u32( 50 );                                  // speed
+		if (protocolVersion >= 3)
+		{
+			w.u32( 100 );                             // brightness
+		}
+		w.u32( 0 );                                   // direction
+		w.u32( colorCount > 0 ? 2 : 1 );              // color_mode: ModeSpecific or PerLed
+		w.u16( colorCount );
+		for (uint16_t i = 0; i < colorCount; ++i)
+			w.u32( 0x00FF0000u >> (i % 3 * 8) );
+	}
+
+	uint32_t ledCount = 0;
+	w.u16( uint16_t( spec.zones.size() ) );
+	for (const ZoneSpec & zone : spec.zones)
+	{
+		w.str( zone.name );
+		w.u32( zone.type );
+		w.u32( zone.ledCount );  w.u32( zone.ledCount );  w.u32( zone.ledCount );  // leds_min, leds_max, leds_count
+		if (zone.matrixWidth > 0)
+		{
+			uint32_t height = (zone.ledCount + zone.matrixWidth - 1) / zone.matrixWidth;
+			w.u16( uint16_t( 8 + 4 * height * zone.matrixWidth ) );
+			w.u32( height );
+			w.u32( zone.matrixWidth );
+			for (uint32_t i = 0; i < height * zone.matrixWidth; ++i)
+				w.u32( i < zone.ledCount ? i : 0xFFFFFFFF );
+		}
+		else
+		{
+			w.u16( 0 );
+		}
+		ledCount += zone.ledCount;
+	}
+
+	w.u16( uint16_t( ledCount ) );
+	for (uint32_t i = 0; i < ledCount; ++i)
+	{
+		w.str( spec.ledPrefix + to_string( i ) );
+		w.u32( i );
+	}
+
+	w.u16( uint16_t( ledCount ) );
+	for (uint32_t i = 0; i < ledCount; ++i)
+		w.u32( 0x00202020 );
+
+	uint32_t data_size = uint32_t( body.size() );
+	body[0] = uint8_t( data_size );
+	body[1] = uint8_t( data_size >> 8 );
+	body[2] = uint8_t( data_size >> 16 );
+	body[3] = uint8_t( data_size >> 24 );
+
+	return body;
+}
+
+vector< vector< uint8_t > > makeDeviceReplies( size_t deviceCount, uint32_t protocolVersion )
+{
+	vector< vector< uint8_t > > replies;
+	replies.reserve( deviceCount );
+	for (size_t i = 0; i < deviceCount; ++i)
+	{
+		replies.push_back( makeDeviceReply( typicalSetup[ i % typicalSetupSize ], i, protocolVersion ) );
+	}
+	return replies;
+}
@@ -0,0 +1,24 @@
+//======================================================================================================================
+// synthetic server replies describing realistic RGB devices
+//======================================================================================================================
+
+#ifndef ORGBBENCH_FIXTURES_INCLUDED
+#define ORGBBENCH_FIXTURES_INCLUDED
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Number of different devices in a typical setup, the fixtures repeat them when more devices are requested.
+constexpr size_t typicalSetupSize = 20;
+
+/// Generates bodies of ReplyControllerData messages as the server would send them for a typical gaming PC setup:
+/// keyboard, mouse, 4 RAM sticks, GPU, motherboard with addressable headers, fans, LED strips and so on.
+/** Each body starts with the data_size field, like after the message header has been stripped.
+  * When \p deviceCount is bigger than typicalSetupSize, the devices repeat with different serials and locations. */
+std::vector< std::vector< uint8_t > > makeDeviceReplies( size_t deviceCount, uint32_t protocolVersion );
+
+
+#endif // ORGBBENCH_FIXTURES_INCLUDED
@@ -0,0 +1,1007 @@
+#include "Essential.hpp"
+
+#include "OpenRGB/DeviceInfo.hpp"
+#include "OpenRGB/ColorOps.hpp"
+#include "OpenRGB/Palette.hpp"
+#include "OpenRGB/Calibration.hpp"
+#include "OpenRGB/RenderExecutor.hpp"
+#include "OpenRGB/AudioSpectrum.hpp"
+#include "OpenRGB/FrameSampler.hpp"
+#include "ProtocolMessages.hpp"  // ReplyControllerData, implementedProtocolVersion
+#include "BinaryStream.hpp"
+#include "LangUtils.hpp"
+using namespace orgb;
+
+#include "AllocCounter.hpp"
+#include "Fixtures.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+using namespace std;
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define EXECUTABLE_NAME "orgbbench"
+#define USAGE EXECUTABLE_NAME " [<benchmark> | --verify]"
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  utils
+
+using Clock = chrono::steady_clock;
+
+static double microsecondsSince( Clock::time_point start )
+{
+	return chrono::duration< double, micro >( Clock::now() - start ).count();
+}
+
+/// Parses the replies the same way the Client does, but without the network.
+static bool parseDevices( const vector< vector< uint8_t > > & replies, uint32_t protocolVersion, vector< ReplyControllerData > & parsed )
+{
+	parsed.clear();
+	parsed.resize( replies.size() );
+	for (uint32_t deviceIdx = 0; deviceIdx < replies.size(); ++deviceIdx)
+	{
+		parsed[ deviceIdx ].header.device_idx = deviceIdx;
+		own::BinaryInputStream stream( replies[ deviceIdx ] );
+		if (!parsed[ deviceIdx ].deserializeBody( stream, protocolVersion ))
+			return false;
+	}
+	return true;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  benchmarks
+
+static bool benchDeserialize()
+{
+	const uint32_t protocolVersion = implementedProtocolVersion;
+	const int repetitions = 200;
+
+	vector< vector< uint8_t > > replies = makeDeviceReplies( typicalSetupSize, protocolVersion );
+
+	vector< ReplyControllerData > parsed;
+	AllocScope allocs;
+	if (!parseDevices( replies, protocolVersion, parsed ))
+	{
+		printf( "deserialize: the fixture could not be parsed\n" );
+		return false;
+	}
+	size_t allocations = allocs.allocations();
+	size_t bytes = allocs.bytes();
+
+	size_t modeCount = 0, ledCount = 0;
+	for (const ReplyControllerData & reply : parsed)
+	{
+		modeCount += reply.device_desc.modes.size();
+		ledCount += reply.device_desc.leds.size();
+	}
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < repetitions; ++i)
+	{
+		parseDevices( replies, protocolVersion, parsed );
+	}
+	double timePerList = microsecondsSince( start ) / repetitions;
+
+	printf( "deserialize: %zu devices, %zu modes, %zu LEDs\n", parsed.size(), modeCount, ledCount );
+	printf( "  allocations per list: %zu (%zu bytes)\n", allocations, bytes );
+	printf( "  time per list:        %.1f us\n", timePerList );
+	return true;
+}
+
+
+static bool benchMemory()
+{
+	const uint32_t protocolVersion = implementedProtocolVersion;
+	const size_t deviceCounts [] = { 10, 100, 1000 };
+
+	for (size_t deviceCount : deviceCounts)
+	{
+		vector< vector< uint8_t > > replies = makeDeviceReplies( deviceCount, protocolVersion );
+
+		vector< ReplyControllerData > parsed;
+		if (!parseDevices( replies, protocolVersion, parsed ))
+		{
+			printf( "memory: the fixture could not be parsed\n" );
+			return false;
+		}
+
+		// the same as memoryUsage( const DeviceList & ) without the array of pointers
+		MemoryUsage usage;
+		for (const ReplyControllerData & reply : parsed)
+		{
+			usage += reply.device_desc.memoryUsage();
+		}
+
+		printf( "memory: %zu devices, %zu bytes, %.1f bytes per LED\n",
+			deviceCount, usage.total(), double( usage.total() ) / double( usage.ledCount ) );
+		print( usage, 1 );
+	}
+	return true;
+}
+
+
+/// Runs the operation repeatedly for about the given time and returns how many LEDs per microsecond it processed.
+template< typename Operation >
+static double measureThroughput( size_t ledCount, Operation operation )
+{
+	const double minDuration = 50000.0;  // us
+
+	size_t repetitions = 0;
+	Clock::time_point start = Clock::now();
+	double elapsed = 0.0;
+	do
+	{
+		for (int i = 0; i < 100; ++i)
+			operation();
+		repetitions += 100;
+		elapsed = microsecondsSince( start );
+	}
+	while (elapsed < minDuration);
+
+	return double( ledCount ) * double( repetitions ) / elapsed;
+}
+
+static bool benchColorOps()
+{
+	using namespace colorops;
+
+	const size_t ledCounts [] = { 1000, 100000 };
+	const SimdLevel levels [] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	const SimdLevel defaultLevel = simdLevel();
+
+	for (size_t ledCount : ledCounts)
+	{
+		vector< Color > frameA( ledCount ), frameB( ledCount ), result( ledCount );
+		for (size_t i = 0; i < ledCount; ++i)
+		{
+			frameA[i] = Color( uint8_t( i ), uint8_t( i * 3 ), uint8_t( i * 7 ) );
+			frameB[i] = Color( uint8_t( i * 5 ), uint8_t( 255 - i ), uint8_t( i * 11 ) );
+		}
+		ChannelLUT gammaLUT = ChannelLUT::gamma( 2.2f );
+
+		printf( "colorops: frame of %zu LEDs, LEDs per us\n", ledCount );
+		printf( "  %-8s %10s %10s %10s %10s %10s\n", "", "fill", "scale", "add", "lerp", "gamma LUT" );
+		for (SimdLevel level : levels)
+		{
+			if (!setSimdLevel( level ))
+				continue;
+
+			double fillRate = measureThroughput( ledCount, [&]() {
+				fill( result.data(), ledCount, Color::Cyan );
+			});
+			double scaleRate = measureThroughput( ledCount, [&]() {
+				scale( result.data(), frameA.data(), ledCount, uint8_t( 100 ) );
+			});
+			double addRate = measureThroughput( ledCount, [&]() {
+				addSaturated( result.data(), frameA.data(), frameB.data(), ledCount );
+			});
+			double lerpRate = measureThroughput( ledCount, [&]() {
+				lerp( result.data(), frameA.data(), frameB.data(), ledCount, 64 );
+			});
+			double lutRate = measureThroughput( ledCount, [&]() {
+				applyLUT( result.data(), frameA.data(), ledCount, gammaLUT );
+			});
+
+			printf( "  %-8s %10.0f %10.0f %10.0f %10.0f %10.0f\n",
+				enumString( level ), fillRate, scaleRate, addRate, lerpRate, lutRate );
+		}
+	}
+
+	setSimdLevel( defaultLevel );
+	return true;
+}
+
+
+// what effects typically do per LED without a library function
+static Color hsvToColorFloat( float hue, float saturation, float value )
+{
+	float c = value * saturation;
+	float h = hue / 60.0f;
+	float x = c * (1.0f - std::fabs( std::fmod( h, 2.0f ) - 1.0f ));
+	float m = value - c;
+	float r = 0, g = 0, b = 0;
+	switch (int( h ) % 6)
+	{
+		case 0:  r = c; g = x; break;
+		case 1:  r = x; g = c; break;
+		case 2:  g = c; b = x; break;
+		case 3:  g = x; b = c; break;
+		case 4:  r = x; b = c; break;
+		default: r = c; b = x; break;
+	}
+	return Color( uint8_t( (r + m) * 255.0f + 0.5f ), uint8_t( (g + m) * 255.0f + 0.5f ), uint8_t( (b + m) * 255.0f + 0.5f ) );
+}
+
+static bool benchHSV()
+{
+	using namespace colorops;
+
+	const size_t ledCount = 10000;
+	const SimdLevel levels [] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	const SimdLevel defaultLevel = simdLevel();
+
+	// a rainbow with decreasing saturation and value
+	vector< HSV > hsvFrame( ledCount );
+	for (size_t i = 0; i < ledCount; ++i)
+		hsvFrame[i] = HSV( uint8_t( i ), uint8_t( 255 - i % 64 ), uint8_t( 255 - i % 128 ) );
+	vector< Color > result( ledCount );
+
+	printf( "hsv: frame of %zu LEDs, LEDs per us\n", ledCount );
+
+	double floatRate = measureThroughput( ledCount, [&]() {
+		for (size_t i = 0; i < ledCount; ++i)
+			result[i] = hsvToColorFloat( hsvFrame[i].h * (360.0f / 256.0f), hsvFrame[i].s / 255.0f, hsvFrame[i].v / 255.0f );
+	});
+	printf( "  %-24s %10.0f\n", "float per LED", floatRate );
+
+	double singleRate = measureThroughput( ledCount, [&]() {
+		for (size_t i = 0; i < ledCount; ++i)
+			result[i] = Color::fromHSV( hsvFrame[i] );
+	});
+	printf( "  %-24s %10.0f\n", "Color::fromHSV", singleRate );
+
+	for (SimdLevel level : levels)
+	{
+		if (!setSimdLevel( level ))
+			continue;
+
+		double frameRate = measureThroughput( ledCount, [&]() {
+			fromHSV( result.data(), hsvFrame.data(), ledCount );
+		});
+		printf( "  colorops::fromHSV %-6s %10.0f\n", enumString( level ), frameRate );
+	}
+
+	setSimdLevel( defaultLevel );
+	return true;
+}
+
+
+static bool benchBlend()
+{
+	using namespace colorops;
+
+	const size_t ledCount = 10000;
+	const SimdLevel levels [] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	const BlendMode modes [] = { BlendMode::Normal, BlendMode::Add, BlendMode::Multiply, BlendMode::Screen, BlendMode::Lighten };
+	const SimdLevel defaultLevel = simdLevel();
+
+	// a layer with varying alpha over a frame with varying colors
+	vector< Color > base( ledCount ), layer( ledCount ), result( ledCount );
+	for (size_t i = 0; i < ledCount; ++i)
+	{
+		base[i] = Color( uint8_t( i ), uint8_t( i * 3 ), uint8_t( i * 7 ) );
+		layer[i] = Color( uint8_t( i * 5 ), uint8_t( 255 - i ), uint8_t( i * 11 ) );
+		layer[i].padding = uint8_t( i * 13 );
+	}
+
+	printf( "blend: layer of %zu LEDs with opacity 200, LEDs per us\n", ledCount );
+	printf( "  %-8s", "" );
+	for (BlendMode mode : modes)
+		printf( " %10s", enumString( mode ) );
+	printf( "\n" );
+	for (SimdLevel level : levels)
+	{
+		if (!setSimdLevel( level ))
+			continue;
+
+		printf( "  %-8s", enumString( level ) );
+		for (BlendMode mode : modes)
+		{
+			// blending over the result of the previous repetition is the same work as over a fresh copy of the frame,
+			// so the copy is made only once and not measured
+			result = base;
+			double rate = measureThroughput( ledCount, [&]() {
+				blend( result.data(), layer.data(), ledCount, mode, 200 );
+			});
+			printf( " %10.0f", rate );
+		}
+		printf( "\n" );
+	}
+
+	setSimdLevel( defaultLevel );
+	return true;
+}
+
+
+static bool benchPalette()
+{
+	using namespace colorops;
+
+	const size_t ledCount = 10000;
+	const SimdLevel levels [] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	const SimdLevel defaultLevel = simdLevel();
+
+	// heat values of a fire effect
+	vector< uint8_t > indexes( ledCount );
+	vector< uint16_t > positions( ledCount );
+	vector< float > fractions( ledCount );
+	for (size_t i = 0; i < ledCount; ++i)
+	{
+		positions[i] = uint16_t( i * 2654435761u >> 16 );
+		indexes[i] = uint8_t( positions[i] >> 8 );
+		fractions[i] = float( positions[i] ) / 65535.0f;
+	}
+	vector< Color > result( ledCount );
+	const Palette fire( palettes::Fire );
+
+	printf( "palette: frame of %zu LEDs, LEDs per us\n", ledCount );
+
+	// what effects typically do per LED without a table, search the stops and interpolate them
+	double stopsRate = measureThroughput( ledCount, [&]() {
+		for (size_t i = 0; i < ledCount; ++i)
+		{
+			float position = fractions[i] * 255.0f;
+			size_t next = 1;
+			while (next + 1 < fut::size( palettes::Fire ) && palettes::Fire[ next ].position < position)
+				++next;
+			const PaletteStop & a = palettes::Fire[ next - 1 ];
+			const PaletteStop & b = palettes::Fire[ next ];
+			float t = (position - a.position) / float( b.position - a.position );
+			result[i] = Color( uint8_t( a.r + (b.r - a.r) * t ), uint8_t( a.g + (b.g - a.g) * t ), uint8_t( a.b + (b.b - a.b) * t ) );
+		}
+	});
+	printf( "  %-24s %10.0f\n", "stops per LED", stopsRate );
+
+	double sampleRate = measureThroughput( ledCount, [&]() {
+		for (size_t i = 0; i < ledCount; ++i)
+			result[i] = fire.sample( fractions[i] );
+	});
+	printf( "  %-24s %10.0f\n", "Palette::sample( float )", sampleRate );
+
+	printf( "  %-24s %10s %10s\n", "Palette::map", "8-bit", "16-bit" );
+	for (SimdLevel level : levels)
+	{
+		if (!setSimdLevel( level ))
+			continue;
+
+		double indexRate = measureThroughput( ledCount, [&]() {
+			fire.map( result.data(), indexes.data(), ledCount );
+		});
+		double positionRate = measureThroughput( ledCount, [&]() {
+			fire.map( result.data(), positions.data(), ledCount );
+		});
+		printf( "    %-22s %10.0f %10.0f\n", enumString( level ), indexRate, positionRate );
+	}
+
+	setSimdLevel( defaultLevel );
+	return true;
+}
+
+
+static bool benchCalibration()
+{
+	using namespace colorops;
+
+	const size_t ledCount = 10000;
+	const SimdLevel levels [] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	const SimdLevel defaultLevel = simdLevel();
+
+	const float matrix [3][3] = {
+		{ 0.90f, 0.10f, 0.00f },
+		{ 0.05f, 0.85f, 0.10f },
+		{ 0.00f, 0.05f, 0.95f },
+	};
+	Calibration calibration;
+	calibration.setMatrix( matrix );
+	calibration.setWhitePoint( Color( 255, 200, 160 ) );
+	calibration.setGamma( 2.2f );
+
+	vector< Color > frame( ledCount ), result( ledCount );
+	for (size_t i = 0; i < ledCount; ++i)
+		frame[i] = Color( uint8_t( i ), uint8_t( i * 3 ), uint8_t( i * 7 ) );
+
+	printf( "calibration: frame of %zu LEDs with matrix, white point and gamma, LEDs per us\n", ledCount );
+
+	// what applications typically do per LED without a prepared calibration
+	const float white [3] = { 1.0f, 200.0f / 255.0f, 160.0f / 255.0f };
+	double floatRate = measureThroughput( ledCount, [&]() {
+		for (size_t i = 0; i < ledCount; ++i)
+		{
+			const float in [3] = { frame[i].r / 255.0f, frame[i].g / 255.0f, frame[i].b / 255.0f };
+			uint8_t out [3];
+			for (size_t row = 0; row < 3; ++row)
+			{
+				float value = (matrix[row][0] * in[0] + matrix[row][1] * in[1] + matrix[row][2] * in[2]) * white[row];
+				value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+				out[row] = uint8_t( std::pow( value, 2.2f ) * 255.0f + 0.5f );
+			}
+			result[i] = Color( out[0], out[1], out[2] );
+		}
+	});
+	printf( "  %-24s %10.0f\n", "float per LED", floatRate );
+
+	for (SimdLevel level : levels)
+	{
+		if (!setSimdLevel( level ))
+			continue;
+
+		double rate = measureThroughput( ledCount, [&]() {
+			calibration.apply( result.data(), frame.data(), ledCount );
+		});
+		printf( "  Calibration::apply %-5s %10.0f\n", enumString( level ), rate );
+	}
+
+	setSimdLevel( defaultLevel );
+	return true;
+}
+
+
+// smooth 2D value noise, what a typical per-LED effect computes
+static float valueNoise( float x, float y )
+{
+	auto hash = []( int32_t ix, int32_t iy ) {
+		uint32_t h = uint32_t( ix ) * 374761393u + uint32_t( iy ) * 668265263u;
+		h = (h ^ (h >> 13)) * 1274126177u;
+		return float( h & 0xFFFF ) / 65535.0f;
+	};
+	int32_t ix = int32_t( std::floor( x ) ), iy = int32_t( std::floor( y ) );
+	float fx = x - float( ix ), fy = y - float( iy );
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fy = fy * fy * (3.0f - 2.0f * fy);
+	float top = hash( ix, iy ) + (hash( ix + 1, iy ) - hash( ix, iy )) * fx;
+	float bottom = hash( ix, iy + 1 ) + (hash( ix + 1, iy + 1 ) - hash( ix, iy + 1 )) * fx;
+	return top + (bottom - top) * fy;
+}
+
+static bool benchParallel()
+{
+	// 40 devices, a few large matrices among many small strips and sticks
+	const size_t deviceCount = 40;
+	vector< vector< Color > > frames( deviceCount );
+	size_t totalLeds = 0;
+	for (size_t deviceIdx = 0; deviceIdx < deviceCount; ++deviceIdx)
+	{
+		frames[ deviceIdx ].resize( deviceIdx % 8 == 0 ? 1024 : 60 + deviceIdx * 3 );
+		totalLeds += frames[ deviceIdx ].size();
+	}
+	const Palette ocean( palettes::Ocean );
+
+	// parts of at most 256 LEDs, like EffectEngine splits the large devices
+	struct Part { size_t deviceIdx; size_t firstLed; size_t ledCount; };
+	vector< Part > parts;
+	for (size_t deviceIdx = 0; deviceIdx < deviceCount; ++deviceIdx)
+		for (size_t firstLed = 0; firstLed < frames[ deviceIdx ].size(); firstLed += 256)
+			parts.push_back({ deviceIdx, firstLed, std::min< size_t >( 256, frames[ deviceIdx ].size() - firstLed ) });
+
+	float time = 0.0f;
+	auto renderPart = [&]( size_t partIdx, unsigned ) {
+		const Part & part = parts[ partIdx ];
+		Color * colors = frames[ part.deviceIdx ].data();
+		for (size_t led = part.firstLed; led < part.firstLed + part.ledCount; ++led)
+		{
+			float noise = 0.0f, scale = 0.1f, amplitude = 0.5f;
+			for (int octave = 0; octave < 4; ++octave, scale *= 2.0f, amplitude *= 0.5f)
+				noise += amplitude * valueNoise( float( led % 32 ) * scale + time, float( led / 32 + part.deviceIdx * 40 ) * scale );
+			colors[ led ] = ocean.sample( noise );
+		}
+	};
+
+	printf( "parallel: %zu devices, %zu LEDs, %zu parts, 4 octaves of value noise per LED\n", deviceCount, totalLeds, parts.size() );
+	printf( "  %-8s %12s %8s %8s\n", "threads", "frame [us]", "fps", "stolen" );
+
+	const unsigned maxThreads = std::max( std::thread::hardware_concurrency(), 1u );
+	for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		RenderExecutor executor( threadCount );
+		double framesPerUs = measureThroughput( 1, [&]() {
+			executor.run( parts.size(), renderPart );
+			time += 0.01f;
+		});
+		printf( "  %-8u %12.0f %8.0f %8u\n", threadCount, 1.0 / framesPerUs, framesPerUs * 1e6, executor.lastStolenCount() );
+		if (threadCount < maxThreads && threadCount * 2 > maxThreads)
+			threadCount = maxThreads / 2;  // measure the maximum too
+	}
+
+	return true;
+}
+
+
+// how Color::fromString() used to parse, with sscanf and a lower-case copy looked up in a map
+static bool fromStringScanf( const string & str, Color & color )
+{
+	static const unordered_map< string, Color > colorNames =
+	{
+		{ "black", Color::Black }, { "white", Color::White }, { "red", Color::Red }, { "green", Color::Green },
+		{ "blue", Color::Blue }, { "yellow", Color::Yellow }, { "magenta", Color::Magenta }, { "cyan", Color::Cyan },
+	};
+
+	unsigned int red, green, blue;
+	if (!str.empty() && (sscanf( str.c_str() + (str[0] == '#' ? 1 : 0), "%02x%02x%02x", &red, &green, &blue ) == 3))
+	{
+		color = Color( uint8_t( red ), uint8_t( green ), uint8_t( blue ) );
+		return true;
+	}
+	string lowerCase( str );
+	transform( lowerCase.begin(), lowerCase.end(), lowerCase.begin(), []( char c ) { return char( tolower( c ) ); } );
+	auto iter = colorNames.find( lowerCase );
+	if (iter == colorNames.end())
+		return false;
+	color = iter->second;
+	return true;
+}
+
+static bool benchParse()
+{
+	const size_t stringCount = 1000;
+
+	// the old parser knows only 8 names, give it those in mixed case
+	const char * const basicColors [] = { "black", "White", "red", "GREEN", "blue", "yellow", "Magenta", "cyan" };
+
+	vector< string > hex, basicNames, names, rgb, hsl;
+	char buffer [64];
+	for (size_t i = 0; i < stringCount; ++i)
+	{
+		const impl::NamedColor & named = impl::ColorNames::namedColors[ i % impl::namedColorCount ];
+		Color color = named.color;
+		snprintf( buffer, sizeof( buffer ), "#%02X%02X%02X", unsigned( color.r ), unsigned( color.g ), unsigned( color.b ) );
+		hex.push_back( buffer );
+		basicNames.push_back( basicColors[ i % fut::size( basicColors ) ] );
+		names.push_back( named.name );
+		snprintf( buffer, sizeof( buffer ), "rgb(%u, %u, %u)", unsigned( color.r ), unsigned( color.g ), unsigned( color.b ) );
+		rgb.push_back( buffer );
+		snprintf( buffer, sizeof( buffer ), "hsl(%zu, %zu%%, %zu%%)", i * 37 % 360, 40 + i % 61, 20 + i % 61 );
+		hsl.push_back( buffer );
+	}
+
+	struct Format
+	{
+		const char * name;
+		const vector< string > * strings;
+		bool oldSupported;
+	};
+	const Format formats [] =
+	{
+		{ "#RRGGBB",    &hex,        true },
+		{ "basic name", &basicNames, true },
+		{ "CSS name",   &names,      false },
+		{ "rgb()",      &rgb,        false },
+		{ "hsl()",      &hsl,        false },
+	};
+
+	printf( "parse: %zu strings per format, strings per us\n", stringCount );
+	printf( "  %-12s %12s %12s %12s\n", "", "sscanf+map", "fromString", "allocations" );
+	Color color;
+	for (const Format & format : formats)
+	{
+		const vector< string > & strings = *format.strings;
+
+		AllocScope allocs;
+		bool succeeded = true;
+		for (const string & str : strings)
+			succeeded &= color.fromString( str );
+		size_t allocations = allocs.allocations();
+		if (!succeeded)
+		{
+			printf( "parse: some of the %s strings could not be parsed\n", format.name );
+			return false;
+		}
+
+		printf( "  %-12s", format.name );
+		if (format.oldSupported)
+		{
+			double oldRate = measureThroughput( stringCount, [&]() {
+				for (const string & str : strings)
+					fromStringScanf( str, color );
+			});
+			printf( " %12.1f", oldRate );
+		}
+		else
+		{
+			printf( " %12s", "-" );
+		}
+		double rate = measureThroughput( stringCount, [&]() {
+			for (const string & str : strings)
+				color.fromString( str );
+		});
+		printf( " %12.1f %12zu\n", rate, allocations );
+	}
+	return true;
+}
+
+
+// 16-bit stereo WAV file with a few tones and noise, as an offline fixture of a captured stream
+static bool writeWavFixture( const char * filePath, uint32_t sampleRate, uint32_t frameCount )
+{
+	vector< uint8_t > bytes;
+	auto put16 = [&]( uint32_t value ) { bytes.push_back( uint8_t( value ) ); bytes.push_back( uint8_t( value >> 8 ) ); };
+	auto put32 = [&]( uint32_t value ) { put16( value & 0xFFFF ); put16( value >> 16 ); };
+	auto putTag = [&]( const char * tag ) { bytes.insert( bytes.end(), tag, tag + 4 ); };
+
+	const uint32_t dataSize = frameCount * 4;
+	putTag( "RIFF" ); put32( 36 + dataSize ); putTag( "WAVE" );
+	putTag( "fmt " ); put32( 16 ); put16( 1 ); put16( 2 ); put32( sampleRate ); put32( sampleRate * 4 ); put16( 4 ); put16( 16 );
+	putTag( "data" ); put32( dataSize );
+
+	uint32_t noise = 12345;
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		float t = float( i ) / float( sampleRate );
+		noise = noise * 1664525u + 1013904223u;
+		float sample = 0.3f * std::sin( 2.0f * 3.14159f * 60.0f * t ) + 0.2f * std::sin( 2.0f * 3.14159f * 440.0f * t )
+		             + 0.1f * std::sin( 2.0f * 3.14159f * 3000.0f * t ) + 0.05f * (float( noise >> 16 ) / 32768.0f - 1.0f);
+		put16( uint16_t( int16_t( sample * 32767.0f ) ) );
+		put16( uint16_t( int16_t( sample * 32767.0f ) ) );
+	}
+
+	FILE * file = fopen( filePath, "wb" );
+	if (!file)
+		return false;
+	bool written = fwrite( bytes.data(), 1, bytes.size(), file ) == bytes.size();
+	return fclose( file ) == 0 && written;
+}
+
+static bool benchSpectrum()
+{
+	const char * const filePath = "orgbbench_spectrum.wav";
+	const uint32_t sampleRate = 44100;
+	const uint32_t blockFrames = sampleRate / 60;
+	const uint32_t fftSizes [] = { 512, 1024, 2048, 4096 };
+
+	if (!writeWavFixture( filePath, sampleRate, sampleRate * 10 ))
+	{
+		printf( "spectrum: the fixture could not be written to %s\n", filePath );
+		return false;
+	}
+
+	// decode the whole file in blocks of one frame at 60 fps
+	vector< float > samples;
+	vector< float > block( blockFrames );
+	Clock::time_point start = Clock::now();
+	PcmReader reader;
+	AudioStatus status = reader.open( filePath );
+	size_t framesRead;
+	while (status == AudioStatus::Success && (status = reader.read( block.data(), blockFrames, framesRead )) == AudioStatus::Success)
+		samples.insert( samples.end(), block.begin(), block.begin() + ptrdiff_t( framesRead ) );
+	double readTime = microsecondsSince( start );
+	reader.close();
+	remove( filePath );
+	if (status != AudioStatus::EndOfStream)
+	{
+		printf( "spectrum: the fixture could not be read: %s\n", enumString( status ) );
+		return false;
+	}
+
+	const double blockBudget = 1e6 / 60.0;  // us
+	printf( "spectrum: %.1f s of 16-bit stereo audio at %u Hz, blocks of %u frames\n", double( samples.size() ) / sampleRate, sampleRate, blockFrames );
+	printf( "  %-16s %10.1f frames per us\n", "PcmReader::read", double( samples.size() ) / readTime );
+	printf( "  %-16s %12s %10s\n", "FFT size", "block [us]", "budget" );
+
+	for (uint32_t fftSize : fftSizes)
+	{
+		SpectrumConfig config;
+		config.fftSize = fftSize;
+		SpectrumAnalyzer analyzer;
+		analyzer.setup( sampleRate, config );
+
+		size_t offset = 0;
+		double blocksPerUs = measureThroughput( 1, [&]() {
+			analyzer.process( samples.data() + offset, blockFrames );
+			offset = (offset + blockFrames) % (samples.size() - blockFrames);
+		});
+		printf( "  %-16u %12.1f %8.2f %%\n", fftSize, 1.0 / blocksPerUs, 100.0 / blocksPerUs / blockBudget );
+	}
+	return true;
+}
+
+static bool benchSampler()
+{
+	using namespace colorops;
+
+	const uint32_t width = 1920, height = 1080;
+	const SimdLevel levels [] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	const SimdLevel defaultLevel = simdLevel();
+
+	// a gradient with noise, so that every area has a different color
+	vector< uint8_t > rgb( size_t( width ) * height * 3 ), bgra( size_t( width ) * height * 4 );
+	uint32_t noise = 12345;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			noise = noise * 1664525u + 1013904223u;
+			uint8_t r = uint8_t( x * 255 / width ), g = uint8_t( y * 255 / height ), b = uint8_t( noise >> 24 );
+			uint8_t * pixel = &rgb[ (size_t( y ) * width + x) * 3 ];
+			pixel[0] = r; pixel[1] = g; pixel[2] = b;
+			pixel = &bgra[ (size_t( y ) * width + x) * 4 ];
+			pixel[0] = b; pixel[1] = g; pixel[2] = r; pixel[3] = 255;
+		}
+	}
+	const ImageView images [] = {
+		ImageView( rgb.data(), width, height, PixelFormat::RGB24 ),
+		ImageView( bgra.data(), width, height, PixelFormat::BGRA32 ),
+	};
+
+	// LED strips behind a screen, 10 % of the image deep
+	FrameSampler ambilight;
+	ambilight.addStrip( 0, 0, 60, Edge::Top, 0.1f );
+	ambilight.addStrip( 0, 60, 34, Edge::Right, 0.1f );
+	ambilight.addStrip( 0, 94, 60, Edge::Bottom, 0.1f );
+	ambilight.addStrip( 0, 154, 34, Edge::Left, 0.1f );
+
+	// a keyboard-sized grid covering the whole image
+	FrameSampler grid;
+	for (uint32_t row = 0; row < 6; ++row)
+		for (uint32_t col = 0; col < 22; ++col)
+			grid.addArea( 0, row * 22 + col, ImageArea( float( col ) / 22.0f, float( row ) / 6.0f, 1.0f / 22.0f, 1.0f / 6.0f ) );
+
+	printf( "sampler: %ux%u image, microseconds per frame\n", width, height );
+	printf( "  %-8s %12s %12s %12s %12s %12s\n", "", "strips RGB", "strips BGRA", "grid RGB", "grid BGRA", "grid BGRA/4" );
+	for (SimdLevel level : levels)
+	{
+		if (!setSimdLevel( level ))
+			continue;
+
+		double times [5];
+		for (size_t i = 0; i < 2; ++i)
+		{
+			times[i] = 1.0 / measureThroughput( 1, [&]() { ambilight.sample( images[i] ); } );
+			times[2 + i] = 1.0 / measureThroughput( 1, [&]() { grid.sample( images[i] ); } );
+		}
+		grid.setRowStep( 4 );
+		times[4] = 1.0 / measureThroughput( 1, [&]() { grid.sample( images[1] ); } );
+		grid.setRowStep( 1 );
+
+		printf( "  %-8s %12.1f %12.1f %12.1f %12.1f %12.1f\n", enumString( level ), times[0], times[1], times[2], times[3], times[4] );
+	}
+	setSimdLevel( defaultLevel );
+
+	// a shared memory is copied by every read, the file stays in the page cache like one in /dev/shm
+	const char * const filePath = "orgbbench_frame.raw";
+	FILE * file = fopen( filePath, "wb" );
+	bool written = file && fwrite( rgb.data(), 1, rgb.size(), file ) == rgb.size();
+	if (!file || fclose( file ) != 0 || !written)
+	{
+		printf( "sampler: the frame could not be written to %s\n", filePath );
+		return false;
+	}
+	RawFrameReader reader;
+	FrameStatus status = reader.openShared( filePath, width, height, PixelFormat::RGB24 );
+	ImageView frame;
+	double readTime = 0.0;
+	if (status == FrameStatus::Success)
+		readTime = 1.0 / measureThroughput( 1, [&]() { status = reader.read( frame ); } );
+	reader.close();
+	remove( filePath );
+	if (status != FrameStatus::Success)
+	{
+		printf( "sampler: the shared frame could not be read: %s\n", enumString( status ) );
+		return false;
+	}
+	printf( "  %-21s %12.1f\n", "RawFrameReader RGB", readTime );
+
+	return true;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  verification of the SIMD kernels
+
+/// Pseudo-random bytes where every third one is 0 or 255, so that the saturating and clamping paths are hit too.
+static void fillRandom( void * buffer, size_t byteCount, uint32_t & seed )
+{
+	uint8_t * bytes = static_cast< uint8_t * >( buffer );
+	for (size_t i = 0; i < byteCount; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		uint8_t value = uint8_t( seed >> 24 );
+		bytes[i] = i % 3 != 0 ? value : (value & 1) ? 255 : 0;
+	}
+}
+
+/// Runs the operation with the scalar kernels and then with the given instruction set on copies of the same buffer
+/// and compares the whole buffers, so that also writes past the end of the output are detected.
+template< typename Output, typename Operation >
+static bool sameAsScalar(
+	colorops::SimdLevel level, const char * kernelName, size_t count, size_t offset,
+	const vector< Output > & initial, Operation operation
+){
+	using namespace colorops;
+
+	vector< Output > expected( initial ), actual( initial );
+	setSimdLevel( SimdLevel::Scalar );
+	operation( expected.data() + offset );
+	setSimdLevel( level );
+	operation( actual.data() + offset );
+
+	const size_t byteCount = initial.size() * sizeof( Output );
+	const uint8_t * expectedBytes = reinterpret_cast< const uint8_t * >( expected.data() );
+	const uint8_t * actualBytes = reinterpret_cast< const uint8_t * >( actual.data() );
+	for (size_t i = 0; i < byteCount; ++i)
+	{
+		if (expectedBytes[i] != actualBytes[i])
+		{
+			printf( "  %s %s: %zu elements at offset %zu differ in byte %zu, %u instead of %u\n",
+				enumString( level ), kernelName, count, offset, i, unsigned( actualBytes[i] ), unsigned( expectedBytes[i] ) );
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool verifyKernels()
+{
+	using namespace colorops;
+
+	// all the tail lengths of the vector loops, and a few longer frames with tails
+	vector< size_t > counts;
+	for (size_t count = 0; count <= 40; ++count)
+		counts.push_back( count );
+	const size_t longCounts [] = { 63, 64, 65, 255, 257, 1000, 1001 };
+	counts.insert( counts.end(), std::begin( longCounts ), std::end( longCounts ) );
+	const size_t maxCount = 1001;
+	const size_t offsets [] = { 0, 1, 3 };  // unaligned starts of all the arrays
+	const size_t guard = 8;  // elements after the end of the output that must stay unchanged
+
+	const SimdLevel levels [] = { SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+	const BlendMode modes [] = { BlendMode::Normal, BlendMode::Add, BlendMode::Multiply, BlendMode::Screen, BlendMode::Lighten };
+	const uint8_t amounts [] = { 0, 1, 128, 200, 255 };
+	const SimdLevel defaultLevel = simdLevel();
+
+	uint32_t seed = 12345;
+	vector< Color > a( maxCount + 4 ), b( maxCount + 4 ), table( 257 ), initialColors( maxCount + 4 + guard );
+	vector< HSV > hsv( maxCount + 4 );
+	vector< uint8_t > indexes( maxCount + 4 ), pixels( (maxCount + 4) * 8 );
+	vector< uint16_t > positions( maxCount + 4 );
+	vector< uint32_t > initialSums( 8 + guard );
+	ChannelLUT luts [3];
+
+	// weights outside of 0..1 and negative ones, so that the results get clamped
+	const float matrixValues [3][3] = {
+		{ 1.50f, -0.40f, 0.10f },
+		{ -0.20f, 1.30f, 0.30f },
+		{ 0.05f, -0.60f, 2.00f },
+	};
+	const ColorMatrix matrix = ColorMatrix::fromFloats( matrixValues );
+
+	size_t checks = 0, failures = 0;
+	for (SimdLevel level : levels)
+	{
+		if (!isSupported( level ))
+			continue;
+
+		size_t levelChecks = checks, levelFailures = failures;
+		for (size_t count : counts)
+		{
+			for (size_t offset : offsets)
+			{
+				fillRandom( a.data(), a.size() * sizeof( Color ), seed );
+				fillRandom( b.data(), b.size() * sizeof( Color ), seed );
+				fillRandom( table.data(), table.size() * sizeof( Color ), seed );
+				fillRandom( initialColors.data(), initialColors.size() * sizeof( Color ), seed );
+				fillRandom( hsv.data(), hsv.size() * sizeof( HSV ), seed );
+				fillRandom( indexes.data(), indexes.size(), seed );
+				fillRandom( positions.data(), positions.size() * sizeof( uint16_t ), seed );
+				fillRandom( pixels.data(), pixels.size(), seed );
+				fillRandom( luts, sizeof( luts ), seed );
+				initialSums.assign( initialSums.size(), 0 );
+				for (size_t i = 0; i < initialSums.size(); ++i)
+					initialSums[i] = uint32_t( i * 1000 );
+
+				const Color * srcA = a.data() + offset;
+				const Color * srcB = b.data() + offset;
+				auto check = [&]( bool same ) { ++checks; failures += same ? 0 : 1; };
+
+				check( sameAsScalar( level, "fill", count, offset, initialColors, [&]( Color * dst ) {
+					fill( dst, count, srcA[0] );
+				}));
+				check( sameAsScalar( level, "scale", count, offset, initialColors, [&]( Color * dst ) {
+					scale( dst, srcA, count, Color( 0, 128, 255 ) );
+				}));
+				check( sameAsScalar( level, "addSaturated", count, offset, initialColors, [&]( Color * dst ) {
+					addSaturated( dst, srcA, srcB, count );
+				}));
+				for (uint8_t amount : amounts)
+				{
+					check( sameAsScalar( level, "scale", count, offset, initialColors, [&]( Color * dst ) {
+						scale( dst, srcA, count, amount );
+					}));
+					check( sameAsScalar( level, "lerp", count, offset, initialColors, [&]( Color * dst ) {
+						lerp( dst, srcA, srcB, count, amount );
+					}));
+					for (BlendMode mode : modes)
+					{
+						// blending is in place, the initial buffer is the frame below the layer
+						check( sameAsScalar( level, enumString( mode ), count, offset, initialColors, [&]( Color * dst ) {
+							blend( dst, srcA, count, mode, amount );
+						}));
+					}
+				}
+				check( sameAsScalar( level, "fromHSV", count, offset, initialColors, [&]( Color * dst ) {
+					fromHSV( dst, hsv.data() + offset, count );
+				}));
+				check( sameAsScalar( level, "lookup", count, offset, initialColors, [&]( Color * dst ) {
+					lookup( dst, indexes.data() + offset, count, table.data() );
+				}));
+				check( sameAsScalar( level, "lookupInterpolated", count, offset, initialColors, [&]( Color * dst ) {
+					lookupInterpolated( dst, positions.data() + offset, count, table.data() );
+				}));
+				check( sameAsScalar( level, "transform", count, offset, initialColors, [&]( Color * dst ) {
+					transform( dst, srcA, count, matrix, luts[0], luts[1], luts[2] );
+				}));
+				for (uint32_t bytesPerPixel = 1; bytesPerPixel <= 8; ++bytesPerPixel)
+				{
+					check( sameAsScalar( level, "sumPixels", count, 0, initialSums, [&]( uint32_t * sums ) {
+						sumPixels( pixels.data() + offset, count, bytesPerPixel, sums );
+					}));
+				}
+			}
+		}
+		printf( "verify: %-6s %zu checks against the scalar kernels, %zu failed\n",
+			enumString( level ), checks - levelChecks, failures - levelFailures );
+	}
+
+	setSimdLevel( defaultLevel );
+	return failures == 0;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct Benchmark
+{
+	const char * name;
+	bool (* run)();
+};
+
+static const Benchmark benchmarks [] =
+{
+	{ "deserialize", benchDeserialize },
+	{ "memory",      benchMemory },
+	{ "colorops",    benchColorOps },
+	{ "hsv",         benchHSV },
+	{ "blend",       benchBlend },
+	{ "palette",     benchPalette },
+	{ "calibration", benchCalibration },
+	{ "parallel",    benchParallel },
+	{ "parse",       benchParse },
+	{ "spectrum",    benchSpectrum },
+	{ "sampler",     benchSampler },
+};
+
+int main( int argc, char * argv [] )
+{
+	if (argc > 2 || (argc == 2 && (strcmp( argv[1], "--help" ) == 0 || strcmp( argv[1], "-h" ) == 0)))
+	{
+		printf( "Usage: " USAGE "\n" );
+		printf( "Benchmarks:" );
+		for (const Benchmark & benchmark : benchmarks)
+			printf( " %s", benchmark.name );
+		printf( "\n" );
+		return argc > 2 ? 1 : 0;
+	}
+
+	if (argc == 2 && strcmp( argv[1], "--verify" ) == 0)
+	{
+		return verifyKernels() ? 0 : 1;
+	}
+
+	bool found = false;
+	bool succeeded = true;
+	for (const Benchmark & benchmark : benchmarks)
+	{
+		if (argc == 1 || strcmp( argv[1], benchmark.name ) == 0)
+		{
+			found = true;
+			succeeded &= benchmark.run();
+		}
+	}
+
+	if (!found)
+	{
+		printf( "Unknown benchmark: %s\n", argv[1] );
+		return 1;
+	}
+
+	return succeeded ? 0 : 1;
+}
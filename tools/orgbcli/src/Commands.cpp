@@ -322,14 +322,31 @@ REGISTER_COMMAND( setcolor, "<device_id> [(zone|led):<id>] <color>", "orgb::Clie
 	Color color = args.getNext< Color >();
 
 	// Device list cannot be re-used from the previous 'list' command, because that command may have been executed in
-	// a different process in non-interactive mode or not executed at all.
-	DeviceListResult listResult = client.requestDeviceList();
+	// a different process in non-interactive mode or not executed at all. But this command is often run repeatedly
+	// from scripts, so use the on-disk cache that is shared between the processes.
+	DeviceListResult listResult = client.requestDeviceListCached();
 	if (listResult.status != RequestStatus::Success)
 	{
 		cout << "Failed to get a recent device list: " << enumString( listResult.status ) << endl;
 		return false;
 	}
 
+	// The cache may have been written before the devices were re-plugged or replaced, so make sure
+	// the device at this index is still the same one, otherwise the list is downloaded again.
+	// A device that is not in the cache at all may have been added since, which also means downloading it again.
+	uint32_t cachedIdx = deviceID.idx;
+	if (cachedIdx == UINT32_MAX)
+	{
+		const Device * cachedDevice = listResult.devices.find( deviceID.str );
+		cachedIdx = cachedDevice ? cachedDevice->idx : UINT32_MAX;
+	}
+	RequestStatus verifyStatus = client.verifyCachedDevice( listResult.devices, cachedIdx );
+	if (verifyStatus != RequestStatus::Success)
+	{
+		cout << "Failed to get a recent device list: " << enumString( verifyStatus ) << endl;
+		return false;
+	}
+
 	const Device * device = findDevice( listResult.devices, deviceID );
 	if (!device)
 		return false;